@@ -13,17 +13,17 @@ namespace utility::memory {
 #endif
 	using byte = unsigned char;
 
-	struct Page {															//   
+	struct Page {															//Структура заголовка страницы памяти
 		constexpr Page(size_t bytes_count, Page* link = nullptr) 
 			: size{ bytes_count }, prev{ link } 
 		{
 		}
-		size_t offset{ 0 };													//offset  size -  ,    !
+		size_t offset{ 0 };													//offset и size - в байтах, размер заголовка не учитывается!
 		size_t size;
 		Page* prev;
 	};
 
-	struct FreeBlock {														//   
+	struct FreeBlock {														//Структура заголовка освобожденного блока
 		constexpr FreeBlock(FreeBlock* link) 
 			: prev{ link } 
 		{
@@ -5,14 +5,16 @@
 #include <utility>
 
 /***********************************************************
-ObjectPool    MakeDummyObjectHolder
-       
-  ,    
-(   ObjectPool<OpTy>
-   ).
-object_holder    
-  .
-       (CRTP)
+ObjectPool предоставляет возможность использования MakeDummyObjectHolder
+пула для выделения памяти под объекты конкретного типа
+при помощи аллокатора, реализованного в виде синглтона
+(для каждой инстанциации ObjectPool<OpTy>
+существует единственный экземпляр аллокатора).
+object_holder позволяет хранить и удалять
+указатели полиморфных типов.
+Типы команд передаются в виде шаблонного параметра (CRTP).
+Пул не потокобезопасен: команды из других потоков
+создаются в потоке-владельце (см. TaskManager::Submit)
 ************************************************************/
 template <class Interface>
 using object_holder = std::unique_ptr<Interface, void(*)(Interface*)>;
@@ -26,10 +28,10 @@ template <class Interface, class Object = Interface>
 class ObjectPool {
 public:
 	using shared_allocator_t = utility::memory::PoolAllocator<Object>;
-	using object_holder = object_holder<Interface>;
+	using object_holder = ::object_holder<Interface>;
 protected:
-	template <class... Types>										//  unique_ptr<Interface>    Object,
-	static object_holder allocate_instance(Types&&... args) {	//      																
+	template <class... Types>										//Создает указатель unique_ptr<Interface> на объект типа Object,
+	static object_holder allocate_instance(Types&&... args) {	//передавая в конструктор последнего все полученные аргументы																
 		static_assert(std::is_base_of_v<Interface, Object>, "Interface must be the parent of same type of Object");
 		auto& alloc{ get_allocator() };
 		object_holder obj_holder(
@@ -38,7 +40,7 @@ protected:
 		);
 		std::allocator_traits<shared_allocator_t>::construct(
 			alloc,
-			static_cast<Object*>(obj_holder.get()),					//  static_assert ,    		
+			static_cast<Object*>(obj_holder.get()),					//С помощью static_assert проверено, что такое преобразование возмжно		
 			std::forward<Types>(args)...
 		);
 		return obj_holder;
@@ -0,0 +1,137 @@
+#include "bench_harness.h"
+
+#include <iomanip>
+#include <numeric>
+#include <ctime>
+using namespace std;
+
+namespace bench {
+	namespace {
+		struct Summary {
+			double min_ns, median_ns, mean_ns, max_ns;
+		};
+
+		Summary summarize(vector<double> samples) {
+			if (samples.empty()) {
+				return { 0, 0, 0, 0 };
+			}
+			sort(samples.begin(), samples.end());
+			size_t middle{ samples.size() / 2 };
+			double median{
+				samples.size() % 2 ? samples[middle] : (samples[middle - 1] + samples[middle]) / 2
+			};
+			double mean{ accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size()) };
+			return { samples.front(), median, mean, samples.back() };
+		}
+
+		double items_per_second(size_t items, double time_ns) {
+			return time_ns > 0 ? static_cast<double>(items) * 1e9 / time_ns : 0;
+		}
+
+		void write_json_string(ostream& out, string_view str) {
+			out << '"';
+			for (char ch : str) {
+				if (ch == '"' || ch == '\\') {
+					out << '\\';
+				}
+				out << ch;
+			}
+			out << '"';
+		}
+
+		string compiler_name() {
+#if defined(_MSC_VER)
+			return "MSVC " + to_string(_MSC_VER);
+#elif defined(__clang__)
+			return "Clang " __clang_version__;
+#elif defined(__GNUC__)
+			return "GCC " __VERSION__;
+#else
+			return "unknown";
+#endif
+		}
+	}
+
+	Harness::Harness(Settings settings)
+		: m_settings(move(settings))
+	{
+		m_settings.repetitions = max<size_t>(m_settings.repetitions, 1);
+	}
+
+	void Harness::WriteJson(ostream& out) const {
+		time_t now{ time(nullptr) };
+		char date[32]{};
+		strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+		out << "{\n  \"context\": {\n    \"date\": \"" << date << "\",\n    \"compiler\": ";
+		write_json_string(out, compiler_name());
+#ifdef NDEBUG
+		out << ",\n    \"build_type\": \"release\"";
+#else
+		out << ",\n    \"build_type\": \"debug\"";
+#endif
+		out << ",\n    \"repetitions\": " << m_settings.repetitions << "\n  },\n  \"benchmarks\": [";
+		out << fixed << setprecision(1);
+		for (size_t idx = 0; idx < m_results.size(); ++idx) {
+			const auto& result{ m_results[idx] };
+			Summary summary{ summarize(result.samples_ns) };
+			out << (idx ? ",\n" : "\n") << "    {\"name\": ";
+			write_json_string(out, result.info.name);
+			out << ", \"params\": {";
+			for (size_t param_idx = 0; param_idx < result.info.params.size(); ++param_idx) {
+				const auto& [name, value] {result.info.params[param_idx]};
+				out << (param_idx ? ", " : "");
+				write_json_string(out, name);
+				out << ": " << value;
+			}
+			out << "}, \"items\": " << result.info.items
+				<< ", \"min_ns\": " << summary.min_ns
+				<< ", \"median_ns\": " << summary.median_ns
+				<< ", \"mean_ns\": " << summary.mean_ns
+				<< ", \"max_ns\": " << summary.max_ns
+				<< ", \"items_per_second\": " << items_per_second(result.info.items, summary.median_ns)
+				<< "}";
+		}
+		out << "\n  ]\n}\n";
+	}
+
+	void Harness::WriteText(ostream& out) const {
+		vector<string> titles;
+		size_t title_width{ string_view("benchmark").size() };
+		for (const auto& result : m_results) {
+			string title{ result.info.name };
+			for (const auto& [name, value] : result.info.params) {
+				title += ' ' + name + '=' + to_string(value);
+			}
+			title_width = max(title_width, title.size());
+			titles.push_back(move(title));
+		}
+		title_width += 2;
+
+		out << left << setw(title_width) << "benchmark" << right
+			<< setw(12) << "items" << setw(14) << "median, ms" << setw(14) << "min, ms" << setw(16) << "items/s" << '\n';
+		out << fixed;
+		for (size_t idx = 0; idx < m_results.size(); ++idx) {
+			const auto& result{ m_results[idx] };
+			Summary summary{ summarize(result.samples_ns) };
+			out << left << setw(title_width) << titles[idx] << right
+				<< setw(12) << result.info.items
+				<< setw(14) << setprecision(3) << summary.median_ns / 1e6
+				<< setw(14) << summary.min_ns / 1e6
+				<< setw(16) << setprecision(0) << items_per_second(result.info.items, summary.median_ns) << '\n';
+		}
+	}
+
+	const vector<Measurement>& Harness::GetResults() const noexcept {
+		return m_results;
+	}
+
+	bool Harness::selected(string_view name) const {
+		return m_settings.filter.empty() || name.find(m_settings.filter) != string_view::npos;
+	}
+
+	void Harness::report_progress(const Measurement& measurement) const {
+		clog << measurement.info.name << ": "
+			<< fixed << setprecision(3) << summarize(measurement.samples_ns).median_ns / 1e6 << " ms\n";
+	}
+}
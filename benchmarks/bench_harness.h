@@ -0,0 +1,87 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <chrono>
+#include <algorithm>
+
+/***********************************************************
+Минимальный самодостаточный каркас для замеров.
+Каждый замер состоит из подготовки (не учитывается во времени)
+и тела; подготовка выполняется перед каждым повтором заново,
+поэтому изменяющие данные операции всегда работают с
+одинаковым исходным состоянием.
+Результаты выводятся в JSON (для отслеживания регрессий
+между версиями) или в виде текстовой таблицы
+************************************************************/
+
+namespace bench {
+	using param_list = std::vector<std::pair<std::string, size_t>>;				//Параметры синтетических данных
+
+	struct Case {
+		std::string name;
+		param_list params;
+		size_t items{ 1 };															//Число элементов, обрабатываемых за один повтор
+	};
+
+	struct Measurement {
+		Case info;
+		std::vector<double> samples_ns;												//Время каждого повтора
+	};
+
+	struct Settings {
+		size_t repetitions{ 5 };
+		std::string filter;															//Подстрока имени замера; пустая - все замеры
+	};
+
+	template <class Ty>
+	inline void DoNotOptimize(const Ty& value) {									//Не даёт компилятору выбросить вычисление результата
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "g"(&value) : "memory");								//Барьер: адрес считается прочитанным, память - изменённой
+#else
+		static const void* volatile sink;
+		sink = &value;
+		static_cast<void>(sink);													//Чтение volatile-переменной компилятор не вправе опустить
+#endif
+	}
+
+	class Harness {
+	public:
+		using clock = std::chrono::steady_clock;
+	public:
+		explicit Harness(Settings settings = {});
+
+		template <class Setup, class Body>
+		Harness& Run(Case info, Setup setup, Body body) {						//Setup: Fixture(); Body: void(Fixture&)
+			if (!selected(info.name)) {
+				return *this;
+			}
+			Measurement measurement{ std::move(info), {} };
+			measurement.samples_ns.reserve(m_settings.repetitions);
+			for (size_t idx = 0; idx < m_settings.repetitions; ++idx) {
+				auto fixture{ setup() };
+				auto start{ clock::now() };
+				body(fixture);
+				auto finish{ clock::now() };
+				measurement.samples_ns.push_back(
+					std::chrono::duration<double, std::nano>(finish - start).count()
+				);
+			}																		//Фикстура уничтожается вне замера
+			report_progress(measurement);
+			m_results.push_back(std::move(measurement));
+			return *this;
+		}
+
+		void WriteJson(std::ostream& out) const;
+		void WriteText(std::ostream& out) const;
+		const std::vector<Measurement>& GetResults() const noexcept;
+	private:
+		bool selected(std::string_view name) const;
+		void report_progress(const Measurement& measurement) const;
+	private:
+		Settings m_settings;
+		std::vector<Measurement> m_results;
+	};
+}
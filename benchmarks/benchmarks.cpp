@@ -0,0 +1,1006 @@
+#include "bench_harness.h"
+#include "company_generator.h"
+#include "xml_parse.h"
+#include "xml_serialize.h"
+#include "schema_reader.h"
+#include "xml_wrapper_command.h"
+#include "task_manager.h"
+#include "company_manager_engine.h"
+#include "autosave.h"
+#include "employee_index.h"
+#include "pool_allocator.h"
+#include "thread_pool.h"
+#include "tracing.h"
+
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <future>
+#include <thread>
+#include <numeric>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <limits>
+#include <stdexcept>
+using namespace std;
+
+/***********************************************************
+Набор замеров основных этапов работы с документом:
+разбор XML, чтение и запись файла с конвейерным
+вводом-выводом и без него, построение обёрток, правка подразделений,
+синхронизация, сериализация, табличный импорт/экспорт, накладные
+расходы динамических и статических цепочек обработчиков,
+пропускная способность TaskManager (выполнение, отмена, повтор,
+отправка команд из 1-32 потоков),
+поиск по индексу сотрудников, сравнение пулового
+аллокатора со стандартным, пропускная способность
+общего пула потоков и стоимость трассировочных Span.
+Пример запуска для сценария на 1 млн сотрудников:
+CompanyManagerBench --departments 1000 --employees 1000 --repetitions 1 --filter table/
+************************************************************/
+
+namespace {
+	struct Options {
+		bench::Settings settings;
+		bool show_help{ false };
+		bench::CompanyShape shape;
+		bool json{ true };
+		string output_path;
+	};
+
+	Options parse_options(int argc, char* argv[]) {
+		Options options;
+		auto next_value{
+			[argc, argv](int& idx) -> string {
+				if (idx + 1 >= argc) {
+					throw invalid_argument("Missing value for "s + argv[idx]);
+				}
+				return argv[++idx];
+			}
+		};
+		for (int idx = 1; idx < argc; ++idx) {
+			string_view arg{ argv[idx] };
+			if (arg == "--help" || arg == "-h") {
+				options.show_help = true;
+			}
+			else if (arg == "--departments") {
+				options.shape.departments = stoul(next_value(idx));
+			}
+			else if (arg == "--employees") {
+				options.shape.employees_per_department = stoul(next_value(idx));
+			}
+			else if (arg == "--name-length") {
+				options.shape.name_length = stoul(next_value(idx));
+			}
+			else if (arg == "--seed") {
+				options.shape.seed = static_cast<uint32_t>(stoul(next_value(idx)));
+			}
+			else if (arg == "--repetitions") {
+				options.settings.repetitions = stoul(next_value(idx));
+			}
+			else if (arg == "--filter") {
+				options.settings.filter = next_value(idx);
+			}
+			else if (arg == "--format") {
+				string format{ next_value(idx) };
+				if (format != "json" && format != "text") {
+					throw invalid_argument("Unknown format: " + format);
+				}
+				options.json = format == "json";
+			}
+			else if (arg == "--output") {
+				options.output_path = next_value(idx);
+			}
+			else {
+				throw invalid_argument("Unknown option: " + string(arg));
+			}
+		}
+		return options;
+	}
+
+	void print_usage(ostream& out) {
+		out << "Usage: CompanyManagerBench [--departments N] [--employees N] [--name-length N] [--seed N]\n"
+			<< "                           [--repetitions N] [--filter SUBSTRING] [--format json|text] [--output FILE]\n";
+	}
+
+	struct LoadedCompany {															//Документ и обёртки над ним, как после CompanyManager::Load()
+		xml::Document document;
+		wrapper::Company company;
+
+		explicit LoadedCompany(const bench::CompanyGenerator& generator)
+			: document(generator.MakeDocument()), company(addressof(document.GetRoot()))
+		{
+		}
+		LoadedCompany(LoadedCompany&&) = default;
+	};
+
+	size_t edited_per_department(const bench::CompanyShape& shape) {				//Правится каждый десятый сотрудник
+		return max<size_t>(shape.employees_per_department / 10, 1);
+	}
+
+/*Разбор и сериализация XML*/
+
+	void parse_benchmarks(bench::Harness& harness, const bench::CompanyGenerator& generator, const bench::param_list& params) {
+		struct ParseFixture {
+			unique_ptr<istringstream> input;
+			xml::Document document;
+		};
+		const string text{ generator.MakeXmlText() };
+		harness.Run(
+			{ "xml/Reader::Load", params, generator.GetShape().EmployeeCount() },
+			[&text] { return ParseFixture{ make_unique<istringstream>(text), {} }; },
+			[](ParseFixture& fixture) {
+				fixture.document = xml::Reader(*fixture.input).Load();
+			});
+
+		struct WrapperFixture {
+			unique_ptr<istringstream> input;
+			xml::Document document;
+			optional<wrapper::Company> company;
+		};
+		harness.Run(
+			{ "wrapper/Reader::Load+Company", params, generator.GetShape().EmployeeCount() },	//Общий разбор и второй обход DOM-дерева
+			[&text] { return WrapperFixture{ make_unique<istringstream>(text), {}, nullopt }; },
+			[](WrapperFixture& fixture) {
+				fixture.document = xml::Reader(*fixture.input).Load();
+				fixture.company.emplace(addressof(fixture.document.GetRoot()));
+			});
+		harness.Run(
+			{ "wrapper/SchemaReader::Load", params, generator.GetShape().EmployeeCount() },
+			[&text] { return WrapperFixture{ make_unique<istringstream>(text), {}, nullopt }; },
+			[](WrapperFixture& fixture) {
+				auto result{ wrapper::SchemaReader(*fixture.input).Load() };
+				fixture.document = move(result.document);
+				fixture.company.emplace(move(result.company));
+			});
+		harness.Run(
+			{ "wrapper/SchemaReader::Load (shared function, salary)", params, generator.GetShape().EmployeeCount() },	//Выигрыш по памяти - при name_length больше буфера SSO
+			[&text] { return WrapperFixture{ make_unique<istringstream>(text), {}, nullopt }; },
+			[](WrapperFixture& fixture) {
+				wrapper::SchemaReader reader(*fixture.input);
+				reader
+					.ShareValues(wrapper::Employee::Field::Function)
+					.ShareValues(wrapper::Employee::Field::Salary);
+				auto result{ reader.Load() };
+				fixture.document = move(result.document);
+				fixture.company.emplace(move(result.company));
+			});
+
+		struct SaveFixture {
+			xml::Document document;
+			unique_ptr<ostringstream> output;
+		};
+		harness.Run(
+			{ "xml/Writer::Save", params, generator.GetShape().EmployeeCount() },
+			[&generator] { return SaveFixture{ generator.MakeDocument(), make_unique<ostringstream>() }; },
+			[](SaveFixture& fixture) {
+				xml::Writer writer(*fixture.output);
+				writer.SetIndentType(make_unique<xml::Space>(3));
+				writer.SetBasicIndentCount(0);
+				writer.Save(fixture.document);
+				bench::DoNotOptimize(fixture.output->tellp());
+			});
+	}
+
+/*Файловый ввод-вывод: последовательный и конвейерный (ReadAhead/WriteBehind)*/
+
+	void file_benchmarks(bench::Harness& harness, const bench::CompanyGenerator& generator, const bench::param_list& params) {
+		namespace file_operation = worker::file_operation;
+		const string path{ (filesystem::temp_directory_path() / "company_manager_bench.xml").string() };
+		{
+			ofstream output(path);
+			output << generator.MakeXmlText();
+		}
+		auto check{
+			[](file_operation::Result result) {
+				if (result != file_operation::Result::Success) {
+					throw runtime_error("File pipeline failed");
+				}
+			}
+		};
+		auto tune{
+			[](xml::Writer& writer) {
+				writer.SetIndentType(make_unique<xml::Space>(3));
+				writer.SetBasicIndentCount(0);
+			}
+		};
+
+		harness.Run(
+			{ "file/Load (ifstream)", params, generator.GetShape().EmployeeCount() },
+			[] { return xml::Document{}; },
+			[&path](xml::Document& document) {
+				ifstream input(path);
+				document = xml::Reader(input).Load();
+			});
+		harness.Run(
+			{ "file/Load (read-ahead)", params, generator.GetShape().EmployeeCount() },
+			[] { return xml::Document{}; },
+			[&path, &check](xml::Document& document) {
+				ifstream input;
+				file_operation::PipelinedInput pipe;
+				xml::Reader reader(pipe.GetStream());
+				file_operation::Result result;
+				MakeStaticPipeline<file_operation::Result>(
+					file_operation::stage::OpenForReading(input, path),
+					file_operation::stage::ReadAhead(input, pipe),
+					file_operation::stage::ReadXml(reader, document)
+				).Process(result);
+				check(result);
+			});
+
+		harness.Run(
+			{ "file/Save (ofstream)", params, generator.GetShape().EmployeeCount() },
+			[&generator] { return generator.MakeDocument(); },
+			[&path, &tune](xml::Document& document) {
+				ofstream output(path);
+				xml::Writer writer(output);
+				tune(writer);
+				writer.Save(document);
+				output.flush();
+			});
+		harness.Run(
+			{ "file/Save (write-behind)", params, generator.GetShape().EmployeeCount() },
+			[&generator] { return generator.MakeDocument(); },
+			[&path, &check, &tune](xml::Document& document) {
+				ofstream output;
+				file_operation::PipelinedOutput pipe;
+				xml::Writer writer(pipe.GetStream());
+				tune(writer);
+				file_operation::Result result;
+				MakeStaticPipeline<file_operation::Result>(
+					file_operation::stage::OpenForWriting(output, path),
+					file_operation::stage::WriteBehind(output, pipe),
+					file_operation::stage::WriteXml(writer, document)
+				).Process(result);
+				check(result);
+			});
+		filesystem::remove(path);
+	}
+
+/*Построение обёрток и синхронизация*/
+
+	void wrapper_benchmarks(bench::Harness& harness, const bench::CompanyGenerator& generator, const bench::param_list& params) {
+		const auto& shape{ generator.GetShape() };
+
+		struct WrapFixture {
+			xml::Document document;
+			optional<wrapper::Company> company;
+		};
+		harness.Run(
+			{ "wrapper/Company::Company", params, shape.EmployeeCount() },
+			[&generator] { return WrapFixture{ generator.MakeDocument(), nullopt }; },
+			[](WrapFixture& fixture) {
+				fixture.company.emplace(addressof(fixture.document.GetRoot()));
+			});
+
+		size_t edited{ edited_per_department(shape) };
+		struct InsertFixture {
+			LoadedCompany loaded;
+			vector<vector<wrapper::Employee>> recruits;								//Новые сотрудники для каждого подразделения
+		};
+		auto make_insert_fixture{
+			[&generator, &shape, edited] {
+				InsertFixture fixture{ LoadedCompany(generator), {} };
+				auto alloc{ fixture.loaded.company.GetAllocator() };
+				for (size_t idx = 0; idx < shape.departments; ++idx) {
+					fixture.recruits.push_back(
+						generator.MakeEmployees(alloc, idx, shape.employees_per_department, edited)
+					);
+				}
+				return fixture;
+			}
+		};
+		harness.Run(
+			{ "wrapper/Department::InsertEmployee", params, shape.departments * edited },
+			make_insert_fixture,
+			[](InsertFixture& fixture) {
+				size_t idx{ 0 };
+				for (auto& department : fixture.loaded.company.GetDepartments()) {
+					for (auto& employee : fixture.recruits[idx]) {
+						department.InsertEmployee(move(employee));
+					}
+					++idx;
+				}
+			});
+		harness.Run(
+			{ "wrapper/Department::InsertEmployees", params, shape.departments * edited },
+			make_insert_fixture,
+			[](InsertFixture& fixture) {
+				size_t idx{ 0 };
+				for (auto& department : fixture.loaded.company.GetDepartments()) {
+					bench::DoNotOptimize(department.InsertEmployees(move(fixture.recruits[idx++])));
+				}
+			});
+
+		struct EraseFixture {
+			LoadedCompany loaded;
+			vector<pair<wrapper::Department*, wrapper::FullNameRef>> victims;		//Итераторы инвалидируются при удалении соседей
+		};
+		harness.Run(
+			{ "wrapper/Department::EraseEmployee", params, shape.departments * edited },
+			[&generator] {
+				EraseFixture fixture{ LoadedCompany(generator), {} };
+				for (auto& department : fixture.loaded.company.GetDepartments()) {
+					size_t idx{ 0 };
+					for (const auto& [full_name, _] : department.GetEmployees()) {
+						if (idx++ % 10 == 0) {
+							fixture.victims.emplace_back(addressof(department), full_name);
+						}
+					}
+				}
+				return fixture;
+			},
+			[](EraseFixture& fixture) {
+				for (auto& [department, full_name] : fixture.victims) {
+					department->EraseEmployee(full_name);
+				}
+			});
+
+		struct RenameFixture {
+			LoadedCompany loaded;
+			vector<pair<wrapper::Department*, wrapper::FullNameRef>> targets;
+		};
+		harness.Run(
+			{ "wrapper/Department::ChangeEmployeeSurname", params, shape.departments * edited },
+			[&generator] {
+				RenameFixture fixture{ LoadedCompany(generator), {} };
+				for (auto& department : fixture.loaded.company.GetDepartments()) {
+					size_t idx{ 0 };
+					for (const auto& [full_name, _] : department.GetEmployees()) {
+						if (idx++ % 10 == 0) {
+							fixture.targets.emplace_back(addressof(department), full_name);
+						}
+					}
+				}
+				return fixture;
+			},
+			[](RenameFixture& fixture) {
+				for (auto& [department, full_name] : fixture.targets) {
+					department->ChangeEmployeeSurname(full_name, "Z" + full_name.surname.get());	//Строки узлов не перемещаются - ссылки остаются валидны
+				}
+			});
+
+		struct DepartmentRenameFixture {
+			LoadedCompany loaded;
+			vector<string> names;
+		};
+		harness.Run(
+			{ "wrapper/Company::RenameDepartment", params, shape.departments },
+			[&generator] {
+				DepartmentRenameFixture fixture{ LoadedCompany(generator), {} };
+				for (const auto& department : fixture.loaded.company.GetDepartments()) {
+					fixture.names.push_back(department.GetName());
+				}
+				return fixture;
+			},
+			[](DepartmentRenameFixture& fixture) {
+				for (const auto& name : fixture.names) {
+					fixture.loaded.company.RenameDepartment(name, name + " (renamed)");
+				}
+			});
+
+		struct LookupFixture {
+			LoadedCompany loaded;
+			vector<wrapper::FullNameRef> names;
+		};
+		auto make_lookup_fixture{
+			[&generator] {
+				LookupFixture fixture{ LoadedCompany(generator), {} };
+				for (const auto& department : fixture.loaded.company.GetDepartments()) {
+					size_t idx{ 0 };
+					for (const auto& [full_name, _] : department.GetEmployees()) {
+						if (idx++ % 10 == 0) {
+							fixture.names.push_back(full_name);
+						}
+					}
+				}
+				return fixture;
+			}
+		};
+		size_t lookups{ shape.departments * edited };
+		harness.Run(
+			{ "wrapper/Company::FindEmployees", params, lookups },
+			make_lookup_fixture,
+			[](LookupFixture& fixture) {
+				size_t found{ 0 };
+				for (const auto& full_name : fixture.names) {
+					for (const auto& location : fixture.loaded.company.FindEmployees(full_name)) {
+						found += location.second.department != nullptr;
+					}
+				}
+				bench::DoNotOptimize(found);
+			});
+		harness.Run(
+			{ "wrapper/Department::Find (all departments)", params, min<size_t>(lookups, 1000) },	//O(D log N) на запрос
+			make_lookup_fixture,
+			[](LookupFixture& fixture) {
+				size_t found{ 0 };
+				for (size_t idx = 0; idx < min<size_t>(fixture.names.size(), 1000); ++idx) {
+					for (const auto& department : fixture.loaded.company.GetDepartments()) {
+						found += department.Find(fixture.names[idx]) != department.GetEmployees().end();
+					}
+				}
+				bench::DoNotOptimize(found);
+			});
+
+		harness.Run(
+			{ "wrapper/Company::Synchronize", params, shape.EmployeeCount() },
+			[&generator, edited] {
+				LoadedCompany loaded(generator);									//Каждое подразделение изменено: вставка, удаление и переименование
+				auto alloc{ loaded.company.GetAllocator() };
+				const auto& shape{ generator.GetShape() };
+				size_t idx{ 0 };
+				for (auto& department : loaded.company.GetDepartments()) {
+					department.InsertEmployees(generator.MakeEmployees(alloc, idx++, shape.employees_per_department, edited));
+					auto employees{ department.GetEmployees() };
+					if (employees.begin() != employees.end()) {
+						department.EraseEmployee(employees.begin());
+					}
+				}
+				return loaded;
+			},
+			[](LoadedCompany& loaded) {
+				loaded.company.Synchronize();
+			});
+
+		struct SnapshotFixture {
+			LoadedCompany loaded;
+			snapshot::SnapshotCache cache;
+		};
+		harness.Run(
+			{ "wrapper/SnapshotCache::Make (cold)", params, shape.EmployeeCount() },
+			[&generator] {
+				return SnapshotFixture{ LoadedCompany(generator), {} };
+			},
+			[](SnapshotFixture& fixture) {
+				bench::DoNotOptimize(fixture.cache.Make(fixture.loaded.company));
+			});
+		harness.Run(
+			{ "wrapper/SnapshotCache::Make (one department changed)", params, shape.departments },
+			[&generator] {
+				SnapshotFixture fixture{ LoadedCompany(generator), {} };
+				fixture.cache.Make(fixture.loaded.company);							//Снимки всех подразделений уже в кэше
+				return fixture;
+			},
+			[](SnapshotFixture& fixture) {
+				for (auto& department : fixture.loaded.company.GetDepartments()) {	//Между снимками меняется одно подразделение
+					department.SetName(department.GetName().get());
+					bench::DoNotOptimize(fixture.cache.Make(fixture.loaded.company));
+				}
+			});
+		const size_t autosave_budget{ AutosaveSettings{}.snapshot_budget };
+		harness.Run(
+			{ "wrapper/SnapshotCache::Prepare (autosave budget)", params, min(autosave_budget, shape.EmployeeCount()) },	//Задержка редактора на один Autosaver::Poll()
+			[&generator] {
+				return SnapshotFixture{ LoadedCompany(generator), {} };
+			},
+			[autosave_budget](SnapshotFixture& fixture) {
+				bench::DoNotOptimize(fixture.cache.Prepare(fixture.loaded.company, autosave_budget));
+			});
+	}
+
+/*Табличный импорт и экспорт*/
+
+	void table_benchmarks(bench::Harness& harness, const bench::CompanyGenerator& generator, const bench::param_list& params) {
+		const auto& shape{ generator.GetShape() };
+		const string csv{ generator.MakeTable(table::Format::Csv) };
+
+		struct ImportFixture {
+			unique_ptr<istringstream> input;
+			unique_ptr<CompanyManager> company_manager;
+		};
+		harness.Run(
+			{ "table/LoadStaff+ImportEmployees", params, shape.EmployeeCount() },
+			[&csv] {
+				ImportFixture fixture{ make_unique<istringstream>(csv), make_unique<CompanyManager>() };
+				fixture.company_manager->Create();
+				return fixture;
+			},
+			[](ImportFixture& fixture) {
+				auto& cm{ *fixture.company_manager };
+				auto staff{ table::LoadStaff(*fixture.input, cm.GetAllocator()) };
+				command::xml_wrapper::ImportEmployees::make_instance(cm, move(staff))->Execute();
+			});
+
+		struct ExportFixture {
+			LoadedCompany loaded;
+			unique_ptr<ostringstream> output;
+		};
+		harness.Run(
+			{ "table/Writer::WriteCompany", params, shape.EmployeeCount() },
+			[&generator] { return ExportFixture{ LoadedCompany(generator), make_unique<ostringstream>() }; },
+			[](ExportFixture& fixture) {
+				table::Writer(*fixture.output)
+					.WriteCompany(fixture.loaded.company);
+			});
+	}
+
+/*Поиск сотрудников*/
+
+	void search_benchmarks(bench::Harness& harness, const bench::CompanyGenerator& generator, const bench::param_list& params) {
+		const auto& shape{ generator.GetShape() };
+
+		struct BuildFixture {
+			LoadedCompany loaded;
+			unique_ptr<search::EmployeeIndex> index;
+		};
+		harness.Run(
+			{ "search/EmployeeIndex::Build", params, shape.EmployeeCount() },
+			[&generator] { return BuildFixture{ LoadedCompany(generator), make_unique<search::EmployeeIndex>() }; },
+			[](BuildFixture& fixture) {
+				fixture.index->Build(fixture.loaded.company);
+			});
+
+		struct SharedIndex {															//Строится однократно и только для выбранных замеров
+			optional<LoadedCompany> loaded;
+			search::EmployeeIndex index;
+		};
+		auto shared{ make_shared<SharedIndex>() };
+		auto get_index{
+			[shared, &generator]() -> SharedIndex& {
+				if (!shared->loaded) {
+					shared->loaded.emplace(generator);
+					shared->index.Build(shared->loaded->company);
+				}
+				return *shared;
+			}
+		};
+
+		constexpr size_t QUERY_COUNT{ 1000 };										//Время на элемент - задержка одного запроса
+		vector<string> surnames;
+		vector<size_t> salaries;
+		for (size_t idx = 0; idx < QUERY_COUNT; ++idx) {
+			size_t department_idx{ idx % shape.departments };
+			size_t employee_idx{ (idx * 7919) % shape.employees_per_department };
+			auto data{ generator.MakePersonalData(department_idx, employee_idx) };
+			surnames.push_back(move(data.surname));
+			salaries.push_back(data.salary);
+		}
+		vector<string> prefixes, typos;
+		for (const auto& surname : surnames) {
+			prefixes.push_back(surname.substr(0, 4));
+			string typo{ surname };
+			typo[typo.size() / 2] = typo[typo.size() / 2] == 'x' ? 'y' : 'x';			//Одна замена символа
+			typos.push_back(move(typo));
+		}
+
+		struct QueryFixture {
+			SharedIndex* shared;
+			size_t found{ 0 };
+		};
+		auto make_query_fixture{
+			[get_index] { return QueryFixture{ addressof(get_index()) }; }
+		};
+		harness.Run(
+			{ "search/EmployeeIndex::FindByPrefix", params, QUERY_COUNT },
+			make_query_fixture,
+			[&prefixes](QueryFixture& fixture) {
+				for (const auto& prefix : prefixes) {
+					fixture.found += fixture.shared->index.FindByPrefix(search::Field::Surname, prefix).size();
+				}
+				bench::DoNotOptimize(fixture.found);
+			});
+		harness.Run(
+			{ "search/EmployeeIndex::FindFuzzy", params, QUERY_COUNT },
+			make_query_fixture,
+			[&typos](QueryFixture& fixture) {
+				for (const auto& typo : typos) {
+					fixture.found += fixture.shared->index.FindFuzzy(search::Field::Surname, typo).size();
+				}
+				bench::DoNotOptimize(fixture.found);
+			});
+		harness.Run(
+			{ "search/EmployeeIndex::FindBySalary", params, QUERY_COUNT },
+			make_query_fixture,
+			[&salaries](QueryFixture& fixture) {
+				for (size_t salary : salaries) {
+					fixture.found += fixture.shared->index.FindBySalary(salary, salary + 100).size();
+				}
+				bench::DoNotOptimize(fixture.found);
+			});
+		harness.Run(
+			{ "search/Company::Find (linear)", params, QUERY_COUNT / 100 },			//Прежний способ поиска - для сравнения
+			make_query_fixture,
+			[&surnames](QueryFixture& fixture) {
+				for (size_t idx = 0; idx < QUERY_COUNT / 100; ++idx) {
+					for (const auto& department : fixture.shared->loaded->company.GetDepartments()) {
+						for (const auto& [full_name, employee] : department.GetEmployees()) {
+							fixture.found += full_name.surname.get() == surnames[idx];
+						}
+					}
+				}
+				bench::DoNotOptimize(fixture.found);
+			});
+
+		size_t edited{ edited_per_department(shape) };
+		harness.Run(
+			{ "search/EmployeeIndex::Erase+Insert", params, shape.departments * edited },	//Поддержка индекса командами правки
+			make_query_fixture,
+			[edited](QueryFixture& fixture) {
+				auto& index{ fixture.shared->index };
+				for (const auto& department : fixture.shared->loaded->company.GetDepartments()) {
+					size_t idx{ 0 };
+					for (const auto& [full_name, employee] : department.GetEmployees()) {
+						if (idx++ == edited) {
+							break;
+						}
+						index.Erase(employee);
+						index.Insert(department, employee);
+					}
+				}
+			});
+	}
+
+/*Цепочки обработчиков: сборка во время выполнения и на этапе компиляции*/
+
+	void pipeline_benchmarks(bench::Harness& harness, size_t run_count) {
+		namespace file_operation = worker::file_operation;
+		const string path{ "company.xml" };
+		bench::param_list params{ { "runs", run_count }, { "stages", 4 } };
+		struct Empty {};
+		harness.Run(
+			{ "pipeline/PipelineBuilder", params, run_count },
+			[] { return Empty{}; },
+			[&path, run_count](Empty&) {
+				size_t succeeded{ 0 };
+				for (size_t idx = 0; idx < run_count; ++idx) {
+					file_operation::Result result;
+					file_operation::PipelineBuilder()
+						.CheckPath(path)
+						.CheckPath(path)
+						.CheckPath(path)
+						.CheckPath(path)
+						.Assemble()->Process(result);
+					succeeded += result == file_operation::Result::Success;
+				}
+				bench::DoNotOptimize(succeeded);
+			});
+		harness.Run(
+			{ "pipeline/StaticPipeline", params, run_count },
+			[] { return Empty{}; },
+			[&path, run_count](Empty&) {
+				size_t succeeded{ 0 };
+				for (size_t idx = 0; idx < run_count; ++idx) {
+					file_operation::Result result;
+					MakeStaticPipeline<file_operation::Result>(
+						file_operation::stage::CheckPath(path),
+						file_operation::stage::CheckPath(path),
+						file_operation::stage::CheckPath(path),
+						file_operation::stage::CheckPath(path)
+					).Process(result);
+					succeeded += result == file_operation::Result::Success;
+				}
+				bench::DoNotOptimize(succeeded);
+			});
+	}
+
+/*Система команд*/
+
+	void task_benchmarks(bench::Harness& harness, size_t command_count) {
+		using department_it = wrapper::Company::department_it;
+		bench::param_list params{ { "commands", command_count } };
+		struct TaskFixture {
+			unique_ptr<CompanyManager> company_manager;
+			unique_ptr<TaskManager<CompanyManager>> tasks;
+			vector<wrapper::Department> departments;
+		};
+		auto make_fixture{
+			[command_count](size_t processed, size_t cancelled) {
+				TaskFixture fixture{
+					make_unique<CompanyManager>(),
+					make_unique<TaskManager<CompanyManager>>(command_count, numeric_limits<size_t>::max()),	//Без вытеснения из очередей
+					{}
+				};
+				auto& cm{ fixture.company_manager->Create() };
+				for (size_t idx = 0; idx < command_count; ++idx) {
+					fixture.departments.push_back(
+						wrapper::DepartmentBuilder()
+							.SetAllocator(cm.GetAllocator())
+							.SetName("Department " + to_string(idx))
+							.Assemble()
+					);
+				}
+				for (size_t idx = 0; idx < processed; ++idx) {
+					fixture.tasks->Process(command::xml_wrapper::AddDepartment::make_instance(cm, move(fixture.departments[idx])));
+				}
+				for (size_t idx = 0; idx < cancelled; ++idx) {
+					fixture.tasks->Cancel();
+				}
+				return fixture;
+			}
+		};
+		harness.Run(
+			{ "task/TaskManager::Process", params, command_count },
+			[&make_fixture] { return make_fixture(0, 0); },
+			[command_count](TaskFixture& fixture) {
+				auto& cm{ *fixture.company_manager };
+				for (size_t idx = 0; idx < command_count; ++idx) {
+					auto result{
+						fixture.tasks->Process(command::xml_wrapper::AddDepartment::make_instance(cm, move(fixture.departments[idx])))
+					};
+					bench::DoNotOptimize(get<department_it>(result.value));			//Результат извлекается без RTTI и выделения памяти
+				}
+			});
+		harness.Run(
+			{ "task/TaskManager::Cancel", params, command_count },
+			[&make_fixture, command_count] { return make_fixture(command_count, 0); },
+			[command_count](TaskFixture& fixture) {
+				for (size_t idx = 0; idx < command_count; ++idx) {
+					bench::DoNotOptimize(fixture.tasks->Cancel().type);
+				}
+			});
+		harness.Run(
+			{ "task/TaskManager::Repeat", params, command_count },
+			[&make_fixture, command_count] { return make_fixture(command_count, command_count); },
+			[command_count](TaskFixture& fixture) {
+				for (size_t idx = 0; idx < command_count; ++idx) {
+					auto result{ fixture.tasks->Repeat() };
+					bench::DoNotOptimize(get<department_it>(result.value));
+				}
+			});
+		for (size_t producer_count : { 1, 2, 4, 8, 16, 32 }) {					//Конкуренция производителей за MpscQueue; узлы строит потребитель
+			harness.Run(
+				{ "task/TaskManager::Submit+Drain", { { "commands", command_count }, { "producers", producer_count } }, command_count },
+				[&make_fixture] { return make_fixture(0, 0); },
+				[command_count, producer_count](TaskFixture& fixture) {
+					auto& cm{ *fixture.company_manager };
+					vector<thread> producers;
+					for (size_t producer = 0; producer < producer_count; ++producer) {
+						producers.emplace_back([&fixture, command_count, producer_count, producer] {
+							for (size_t idx = producer; idx < command_count; idx += producer_count) {
+								fixture.tasks->Submit([name = "Submitted " + to_string(idx)](CompanyManager& target) {
+									return command::xml_wrapper::AddDepartment::make_instance(
+										target,
+										wrapper::DepartmentBuilder()
+											.SetAllocator(target.GetAllocator())
+											.SetName(name)
+											.Assemble()
+									);
+								});
+							}
+						});
+					}
+					while (fixture.tasks->GetDrainedCount() < command_count) {		//Потребитель - текущий поток, как GUI-поток в приложении
+						if (!fixture.tasks->HasSubmitted()) {
+							this_thread::yield();
+							continue;
+						}
+						bench::DoNotOptimize(fixture.tasks->DrainSubmitted(cm).type);
+					}
+					for (auto& producer : producers) {
+						producer.join();
+					}
+				});
+		}
+	}
+
+/*Трассировка*/
+
+	void tracing_benchmarks(bench::Harness& harness, size_t span_count) {
+		bench::param_list params{ { "spans", span_count } };
+		struct Empty {};
+		auto run_spans{
+			[span_count](Empty&) {
+				for (size_t idx = 0; idx < span_count; ++idx) {
+					tracing::Span span("bench/span", "bench");
+					span.SetCount(static_cast<int64_t>(idx));
+				}
+			}
+		};
+		harness.Run(
+			{ "trace/Span (disabled)", params, span_count },
+			[] { return Empty{}; },
+			run_spans);
+		harness.Run(
+			{ "trace/Span (enabled)", params, span_count },
+			[] {
+				tracing::Tracer::Instance().Start();										//Буфер потока заполняется по кругу
+				return Empty{};
+			},
+			run_spans);
+		tracing::Tracer::Instance().Stop();
+	}
+
+/*Пул потоков*/
+
+	long fork_join_sum(concurrency::ThreadPool& pool, const vector<long>& values, size_t first, size_t last) {
+		constexpr size_t SEQUENTIAL_LIMIT{ 2048 };
+		if (last - first <= SEQUENTIAL_LIMIT) {
+			return accumulate(values.begin() + first, values.begin() + last, 0L);
+		}
+		size_t middle{ first + (last - first) / 2 };
+		auto right{
+			pool.Submit([&pool, &values, middle, last] { return fork_join_sum(pool, values, middle, last); })
+		};
+		long left{ fork_join_sum(pool, values, first, middle) };					//Правую половину перехватит простаивающий поток
+		return left + right.Get();
+	}
+
+	void thread_pool_benchmarks(bench::Harness& harness, size_t task_count) {
+		auto& pool{ concurrency::ThreadPool::Shared() };
+		bench::param_list params{ { "tasks", task_count }, { "threads", pool.ThreadCount() } };
+		struct Empty {};
+		harness.Run(
+			{ "pool/Submit+Get", params, task_count },
+			[] { return Empty{}; },
+			[&pool, task_count](Empty&) {
+				vector<concurrency::Future<size_t>> results;
+				results.reserve(task_count);
+				for (size_t idx = 0; idx < task_count; ++idx) {
+					results.push_back(pool.Submit([idx] { return idx; }));
+				}
+				size_t sum{ 0 };
+				for (auto& result : results) {
+					sum += result.Get();
+				}
+				bench::DoNotOptimize(sum);
+			});
+		harness.Run(
+			{ "pool/Submit+Then", params, task_count },
+			[] { return Empty{}; },
+			[&pool, task_count](Empty&) {
+				vector<concurrency::Future<size_t>> results;
+				results.reserve(task_count);
+				for (size_t idx = 0; idx < task_count; ++idx) {
+					results.push_back(
+						pool.Submit([idx] { return idx; }).Then([](size_t value) { return value * 2; })
+					);
+				}
+				for (auto& result : results) {
+					bench::DoNotOptimize(result.Get());
+				}
+			});
+		const size_t async_count{ max<size_t>(task_count / 100, 1) };			//Поток на задачу - прежний способ распараллеливания
+		harness.Run(
+			{ "pool/std::async (baseline)", { { "tasks", async_count } }, async_count },
+			[] { return Empty{}; },
+			[async_count](Empty&) {
+				vector<future<size_t>> results;
+				results.reserve(async_count);
+				for (size_t idx = 0; idx < async_count; ++idx) {
+					results.push_back(async(launch::async, [idx] { return idx; }));
+				}
+				for (auto& result : results) {
+					bench::DoNotOptimize(result.get());
+				}
+			});
+
+		struct SumFixture {
+			vector<long> values;
+		};
+		const size_t value_count{ task_count * 100 };
+		auto make_values{
+			[value_count] {
+				SumFixture fixture{ vector<long>(value_count) };
+				iota(fixture.values.begin(), fixture.values.end(), 0L);
+				return fixture;
+			}
+		};
+		harness.Run(
+			{ "pool/fork-join (recursive)", { { "values", value_count }, { "threads", pool.ThreadCount() } }, value_count },
+			make_values,
+			[&pool](SumFixture& fixture) {
+				bench::DoNotOptimize(fork_join_sum(pool, fixture.values, 0, fixture.values.size()));
+			});
+		harness.Run(
+			{ "pool/ParallelFor", { { "values", value_count }, { "threads", pool.ThreadCount() } }, value_count },
+			make_values,
+			[&pool](SumFixture& fixture) {
+				atomic<long> sum{ 0 };
+				pool.ParallelFor(fixture.values.size(), 1 << 14, [&fixture, &sum](size_t first, size_t last) {
+					sum += accumulate(fixture.values.begin() + first, fixture.values.begin() + last, 0L);
+				});
+				bench::DoNotOptimize(sum.load());
+			});
+
+		auto metrics{ pool.GetMetrics() };											//Накоплены за все замеры, включая табличный импорт
+		cerr << "pool metrics: threads=" << pool.ThreadCount()
+			<< " executed=" << metrics.executed
+			<< " stolen=" << metrics.stolen
+			<< " helped=" << metrics.helped
+			<< " queue_depth=" << metrics.queue_depth
+			<< " idle=" << chrono::duration<double, milli>(metrics.idle_time).count() << " ms\n";
+	}
+
+/*Аллокаторы*/
+
+	template <class Allocator>
+	void allocator_benchmark(bench::Harness& harness, string name, size_t count) {
+		using traits = std::allocator_traits<Allocator>;
+		struct AllocFixture {
+			unique_ptr<Allocator> alloc;
+			vector<typename traits::pointer> blocks;
+		};
+		auto setup{
+			[count] {
+				AllocFixture fixture{ make_unique<Allocator>(), {} };
+				fixture.blocks.reserve(count);
+				return fixture;
+			}
+		};
+		harness.Run(
+			{ name + "/allocate+deallocate", { { "blocks", count } }, count },
+			setup,
+			[count](AllocFixture& fixture) {										//Все блоки выделяются, затем освобождаются в обратном порядке
+				for (size_t idx = 0; idx < count; ++idx) {
+					fixture.blocks.push_back(traits::allocate(*fixture.alloc, 1));
+				}
+				while (!fixture.blocks.empty()) {
+					traits::deallocate(*fixture.alloc, fixture.blocks.back(), 1);
+					fixture.blocks.pop_back();
+				}
+			});
+		harness.Run(
+			{ name + "/interleaved", { { "blocks", count } }, count },
+			setup,
+			[count](AllocFixture& fixture) {										//Чередование выделений и освобождений, как при правке дерева
+				for (size_t idx = 0; idx < count; ++idx) {
+					fixture.blocks.push_back(traits::allocate(*fixture.alloc, 1));
+					if (idx % 3 == 2) {
+						traits::deallocate(*fixture.alloc, fixture.blocks[fixture.blocks.size() - 2], 1);
+						fixture.blocks.erase(fixture.blocks.end() - 2);
+					}
+				}
+				for (auto block : fixture.blocks) {
+					traits::deallocate(*fixture.alloc, block, 1);
+				}
+				fixture.blocks.clear();
+			});
+	}
+}
+
+int main(int argc, char* argv[]) {
+	Options options;
+	try {
+		options = parse_options(argc, argv);
+	}
+	catch (const exception& exc) {
+		cerr << "error: " << exc.what() << "\n";
+		print_usage(cerr);
+		return 2;
+	}
+	if (options.show_help) {
+		print_usage(cout);
+		return 0;
+	}
+
+	bench::CompanyGenerator generator(options.shape);
+	bench::param_list params{
+		{ "departments", options.shape.departments },
+		{ "employees_per_department", options.shape.employees_per_department },
+		{ "name_length", options.shape.name_length }
+	};
+	bench::Harness harness(options.settings);
+	parse_benchmarks(harness, generator, params);
+	file_benchmarks(harness, generator, params);
+	wrapper_benchmarks(harness, generator, params);
+	table_benchmarks(harness, generator, params);
+	search_benchmarks(harness, generator, params);
+
+	pipeline_benchmarks(harness, options.shape.EmployeeCount());
+	task_benchmarks(harness, options.shape.departments * 10);
+	tracing_benchmarks(harness, options.shape.EmployeeCount());
+	thread_pool_benchmarks(harness, options.shape.EmployeeCount());
+
+	size_t block_count{ options.shape.EmployeeCount() * 6 };						//Примерное число узлов документа
+	allocator_benchmark<utility::memory::PoolAllocator<xml::Node>>(harness, "allocator/PoolAllocator<Node>", block_count);
+	allocator_benchmark<std::allocator<xml::Node>>(harness, "allocator/std::allocator<Node>", block_count);
+
+	ofstream file_output;
+	if (!options.output_path.empty()) {
+		file_output.open(options.output_path);
+		if (!file_output) {
+			cerr << "error: unable to open " << options.output_path << "\n";
+			return 1;
+		}
+	}
+	ostream& output{ options.output_path.empty() ? cout : file_output };
+	if (options.json) {
+		harness.WriteJson(output);
+	}
+	else {
+		harness.WriteText(output);
+	}
+	return 0;
+}
@@ -0,0 +1,155 @@
+#include "company_generator.h"
+#include "xml_serialize.h"
+
+#include <sstream>
+#include <memory>
+using namespace std;
+
+namespace bench {
+	namespace {
+		uint64_t split_mix(uint64_t value) noexcept {							//Быстрое детерминированное перемешивание битов (SplitMix64)
+			value += 0x9E3779B97F4A7C15ull;
+			value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+			value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+			return value ^ (value >> 31);
+		}
+
+		enum class Field : uint64_t {
+			Department,
+			Surname,
+			Name,
+			MiddleName,
+			Function,
+			Salary
+		};
+
+		uint64_t make_key(uint32_t seed, Field field, size_t department_idx, size_t employee_idx) noexcept {
+			uint64_t key{ split_mix(seed) };
+			key = split_mix(key ^ static_cast<uint64_t>(field));
+			key = split_mix(key ^ department_idx);
+			return split_mix(key ^ employee_idx);
+		}
+	}
+
+	size_t CompanyShape::EmployeeCount() const noexcept {
+		return departments * employees_per_department;
+	}
+
+	CompanyGenerator::CompanyGenerator(CompanyShape shape)
+		: m_shape(shape)
+	{
+	}
+
+	const CompanyShape& CompanyGenerator::GetShape() const noexcept {
+		return m_shape;
+	}
+
+	string CompanyGenerator::DepartmentName(size_t department_idx) const {
+		return make_name(make_key(m_shape.seed, Field::Department, department_idx, 0), department_idx);
+	}
+
+	wrapper::PersonalData CompanyGenerator::MakePersonalData(size_t department_idx, size_t employee_idx) const {
+		wrapper::PersonalData data;
+		data.surname = make_name(make_key(m_shape.seed, Field::Surname, department_idx, employee_idx), employee_idx);
+		data.name = make_name(make_key(m_shape.seed, Field::Name, department_idx, employee_idx), 0);
+		data.middle_name = make_name(make_key(m_shape.seed, Field::MiddleName, department_idx, employee_idx), 0);
+		data.function = make_name(make_key(m_shape.seed, Field::Function, department_idx, employee_idx % 16), 0);	//Должностей немного
+		data.salary = 1000 + make_key(m_shape.seed, Field::Salary, department_idx, employee_idx) % 100000;
+		return data;
+	}
+
+	wrapper::Employee CompanyGenerator::MakeEmployee(xml::allocator_holder alloc, size_t department_idx, size_t employee_idx) const {
+		auto data{ MakePersonalData(department_idx, employee_idx) };
+		return wrapper::EmployeeBuilder()
+			.SetAllocator(move(alloc))
+			.SetSurname(move(data.surname))
+			.SetName(move(data.name))
+			.SetMiddleName(move(data.middle_name))
+			.SetFunction(move(data.function))
+			.SetSalary(data.salary)
+			.Assemble();
+	}
+
+	vector<wrapper::Employee> CompanyGenerator::MakeEmployees(
+		xml::allocator_holder alloc,
+		size_t department_idx,
+		size_t first,
+		size_t count
+	) const {
+		vector<wrapper::Employee> employees;
+		employees.reserve(count);
+		for (size_t idx = first; idx < first + count; ++idx) {
+			employees.push_back(MakeEmployee(alloc, department_idx, idx));
+		}
+		return employees;
+	}
+
+	wrapper::Department CompanyGenerator::MakeDepartment(xml::allocator_holder alloc, size_t department_idx) const {
+		return wrapper::DepartmentBuilder()
+			.SetAllocator(alloc)
+			.SetName(DepartmentName(department_idx))
+			.InsertEmployees(MakeEmployees(alloc, department_idx, 0, m_shape.employees_per_department))
+			.Assemble();
+	}
+
+	wrapper::Company CompanyGenerator::MakeCompany(xml::allocator_holder alloc) const {
+		wrapper::CompanyBuilder builder;
+		for (size_t idx = 0; idx < m_shape.departments; ++idx) {
+			builder.AddDepartment(MakeDepartment(alloc, idx));
+		}
+		return builder
+			.SetAllocator(move(alloc))
+			.Assemble();
+	}
+
+	xml::Document CompanyGenerator::MakeDocument() const {
+		xml::allocator_holder alloc{ xml::MakeDefaultAllocator() };
+		wrapper::Company company{ MakeCompany(alloc) };
+		return xml::DocumentBuilder()
+			.SetDeclaration(
+				xml::ServiceNodeBuilder()
+					.SetAllocator(alloc)
+					.AddServiceSymbols('?', '?')
+					.SetAttribute("version", "1.0")
+					.SetAttribute("encoding", "UTF-8")
+					.Assemble()
+			)
+			.SetRoot(company.BuildXmlTree())										//Обёртка переходит в режим наблюдения и может быть уничтожена
+			.SetAllocator(alloc)
+			.Assemble();
+	}
+
+	string CompanyGenerator::MakeXmlText() const {
+		ostringstream output;
+		xml::Writer writer(output);
+		writer.SetIndentType(make_unique<xml::Space>(3));
+		writer.SetBasicIndentCount(0);
+		writer.Save(MakeDocument());
+		return output.str();
+	}
+
+	string CompanyGenerator::MakeTable(table::Format format) const {
+		ostringstream output;
+		table::Writer(output, format)
+			.WriteCompany(MakeCompany(xml::MakeDefaultAllocator()));
+		return output.str();
+	}
+
+	string CompanyGenerator::make_name(uint64_t key, size_t unique_id) const {
+		constexpr size_t ALPHABET_SIZE{ 26 };
+		string tail;																//Номер в 26-ричной записи обеспечивает уникальность
+		do {
+			tail.push_back(static_cast<char>('a' + unique_id % ALPHABET_SIZE));
+			unique_id /= ALPHABET_SIZE;
+		} while (unique_id);
+
+		size_t length{ max(m_shape.name_length, tail.size() + 1) };
+		string name(length - tail.size(), ' ');
+		for (auto& ch : name) {
+			key = split_mix(key);
+			ch = static_cast<char>('a' + key % ALPHABET_SIZE);
+		}
+		name.front() = static_cast<char>(name.front() - 'a' + 'A');
+		return name + tail;
+	}
+}
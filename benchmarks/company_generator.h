@@ -0,0 +1,57 @@
+#pragma once
+#include "xml.h"
+#include "xml_node_builders.h"
+#include "xml_wrappers.h"
+#include "xml_wrappers_builders.h"
+#include "employee_table.h"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/***********************************************************
+Генератор синтетической компании для замеров.
+Форма компании задаётся числом подразделений, сотрудников
+в подразделении и длиной имён; при одинаковом seed
+генерируются одинаковые данные. ФИО сотрудников уникальны
+в пределах подразделения (хвост фамилии кодирует номер)
+************************************************************/
+
+namespace bench {
+	struct CompanyShape {
+		size_t departments{ 10 };
+		size_t employees_per_department{ 100 };
+		size_t name_length{ 8 };
+		uint32_t seed{ 42 };
+
+		size_t EmployeeCount() const noexcept;
+	};
+
+	class CompanyGenerator {
+	public:
+		explicit CompanyGenerator(CompanyShape shape);
+
+		const CompanyShape& GetShape() const noexcept;
+
+		std::string DepartmentName(size_t department_idx) const;
+		wrapper::PersonalData MakePersonalData(size_t department_idx, size_t employee_idx) const;	//employee_idx может выходить за пределы формы
+
+		wrapper::Employee MakeEmployee(xml::allocator_holder alloc, size_t department_idx, size_t employee_idx) const;
+		std::vector<wrapper::Employee> MakeEmployees(								//Сотрудники с номерами [first, first + count)
+			xml::allocator_holder alloc,
+			size_t department_idx,
+			size_t first,
+			size_t count
+		) const;
+		wrapper::Department MakeDepartment(xml::allocator_holder alloc, size_t department_idx) const;
+		wrapper::Company MakeCompany(xml::allocator_holder alloc) const;
+
+		xml::Document MakeDocument() const;											//Документ в собственном аллокаторе, как после CompanyManager::Create()
+		std::string MakeXmlText() const;
+		std::string MakeTable(table::Format format) const;
+	private:
+		std::string make_name(uint64_t key, size_t unique_id) const;
+	private:
+		CompanyShape m_shape;
+	};
+}
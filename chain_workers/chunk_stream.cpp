@@ -0,0 +1,140 @@
+#include "chunk_stream.h"
+
+#include <algorithm>
+#include <cstring>
+using namespace std;
+
+namespace worker {
+	namespace file_operation {
+		double StageStatistics::Throughput() const noexcept {
+			double seconds{ chrono::duration<double>(busy).count() };
+			return seconds > 0 ? bytes / seconds / (1 << 20) : 0;
+		}
+
+		ChunkChannel::ChunkChannel(ChunkSettings settings)
+			: data(max<size_t>(settings.queue_capacity, 1)),
+			free(max<size_t>(settings.queue_capacity, 1) + 2),					//Блоки в очереди и по одному у каждой из сторон
+			m_chunk_size(max<size_t>(settings.chunk_size, 1))
+		{
+		}
+
+		chunk_t ChunkChannel::Acquire() {
+			auto chunk{ free.TryPop() };
+			if (!chunk) {
+				chunk.emplace();
+				chunk->reserve(m_chunk_size + READ_HEADROOM);
+			}
+			chunk->clear();
+			return move(*chunk);
+		}
+
+		void ChunkChannel::Recycle(chunk_t&& chunk) {
+			free.TryPush(chunk);												//Лишний блок просто освобождается
+		}
+
+		size_t ChunkChannel::ChunkSize() const noexcept {
+			return m_chunk_size;
+		}
+
+		ChunkInputBuffer::ChunkInputBuffer(ChunkChannel& channel)
+			: m_channel(addressof(channel))
+		{
+		}
+
+		uint64_t ChunkInputBuffer::BytesRead() const noexcept {
+			return m_bytes;
+		}
+
+		ChunkInputBuffer::int_type ChunkInputBuffer::underflow() {
+			if (gptr() < egptr()) {
+				return traits_type::to_int_type(*gptr());
+			}
+			auto chunk{ m_channel->data.Pop() };
+			if (!chunk) {
+				return traits_type::eof();
+			}
+			constexpr size_t headroom{ ChunkChannel::READ_HEADROOM };
+			size_t putback{ eback() ? min<size_t>(gptr() - eback(), headroom) : 0 };
+			char* first{ chunk->data() + headroom };
+			if (putback) {
+				memcpy(first - putback, gptr() - putback, putback);			//Последние символы прежнего блока - для unget()
+			}
+			m_bytes += chunk->size() - headroom;
+			if (m_current.capacity()) {
+				m_channel->Recycle(move(m_current));
+			}
+			m_current = move(*chunk);
+			setg(first - putback, first, m_current.data() + m_current.size());
+			return traits_type::to_int_type(*gptr());
+		}
+
+		ChunkOutputBuffer::ChunkOutputBuffer(ChunkChannel& channel)
+			: m_channel(addressof(channel))
+		{
+			reset_put_area();
+		}
+
+		uint64_t ChunkOutputBuffer::BytesWritten() const noexcept {
+			return m_bytes;
+		}
+
+		ChunkOutputBuffer::int_type ChunkOutputBuffer::overflow(int_type ch) {
+			if (!push_chunk()) {
+				return traits_type::eof();
+			}
+			if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+				*pptr() = traits_type::to_char_type(ch);
+				pbump(1);
+			}
+			return traits_type::not_eof(ch);
+		}
+
+		int ChunkOutputBuffer::sync() {
+			return push_chunk() ? 0 : -1;
+		}
+
+		bool ChunkOutputBuffer::push_chunk() {
+			size_t size{ static_cast<size_t>(pptr() - pbase()) };
+			if (!size) {
+				return !m_channel->data.IsClosed();
+			}
+			m_chunk.resize(size);
+			m_bytes += size;
+			bool pushed{ m_channel->data.Push(move(m_chunk)) };					//false - стадия записи остановлена из-за ошибки
+			reset_put_area();
+			return pushed;
+		}
+
+		void ChunkOutputBuffer::reset_put_area() {
+			m_chunk = m_channel->Acquire();
+			m_chunk.resize(m_channel->ChunkSize());
+			setp(m_chunk.data(), m_chunk.data() + m_chunk.size());
+		}
+
+		PipelinedInput::PipelinedInput(ChunkSettings settings)
+			: m_channel(settings), m_buffer(m_channel), m_stream(addressof(m_buffer))
+		{
+		}
+
+		istream& PipelinedInput::GetStream() noexcept {
+			return m_stream;
+		}
+
+		const PipelineStatistics& PipelinedInput::GetStatistics() const noexcept {
+			return m_stats;
+		}
+
+		PipelinedOutput::PipelinedOutput(ChunkSettings settings)
+			: m_channel(settings), m_buffer(m_channel), m_stream(addressof(m_buffer))
+		{
+		}
+
+		ostream& PipelinedOutput::GetStream() noexcept {
+			return m_stream;
+		}
+
+		const PipelineStatistics& PipelinedOutput::GetStatistics() const noexcept {
+			return m_stats;
+		}
+	}
+}
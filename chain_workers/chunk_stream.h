@@ -0,0 +1,125 @@
+#pragma once
+#include "spsc_queue.h"
+
+#include <iostream>
+#include <streambuf>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+/***********************************************************
+Потоки std::istream/std::ostream поверх очереди блоков -
+для разнесения файлового ввода-вывода и разбора (сериализации)
+XML по разным потокам конвейера. xml::Reader и xml::Writer
+работают с ними как с обычными потоками и не знают,
+что по другую сторону очереди - отдельный поток.
+
+Освободившиеся блоки возвращаются производителю через
+обратную очередь, поэтому в установившемся режиме память
+не выделяется
+************************************************************/
+
+namespace worker {
+	namespace file_operation {
+		namespace stage {
+			class ReadAhead;
+			class WriteBehind;
+		}
+
+		using chunk_t = std::vector<char>;
+
+		struct ChunkSettings {
+			size_t chunk_size{ 1 << 16 };
+			size_t queue_capacity{ 8 };											//Блоков между стадиями
+		};
+
+		struct StageStatistics {
+			uint64_t bytes{ 0 };
+			uint64_t chunks{ 0 };
+			std::chrono::nanoseconds busy{ 0 };									//Без учёта ожидания другой стадии
+			uint64_t stalls{ 0 };
+			std::chrono::nanoseconds stalled{ 0 };
+			double Throughput() const noexcept;									//МБ/с полезной работы
+		};
+
+		struct PipelineStatistics {
+			StageStatistics io;													//Чтение или запись файла
+			StageStatistics xml;												//Разбор или сериализация
+		};
+
+		class ChunkChannel {
+		public:
+			static constexpr size_t READ_HEADROOM{ 8 };							//Резерв в начале блока чтения: xml::Reader возвращает символы через unget()
+		public:
+			explicit ChunkChannel(ChunkSettings settings);
+
+			chunk_t Acquire();													//Блок из обратной очереди либо новый
+			void Recycle(chunk_t&& chunk);
+			size_t ChunkSize() const noexcept;
+		public:
+			SpscQueue<chunk_t> data;
+			SpscQueue<chunk_t> free;
+		private:
+			size_t m_chunk_size;
+		};
+
+		class ChunkInputBuffer : public std::streambuf {						//Сторона потребителя
+		public:
+			explicit ChunkInputBuffer(ChunkChannel& channel);
+			uint64_t BytesRead() const noexcept;
+		protected:
+			int_type underflow() override;
+		private:
+			ChunkChannel* m_channel;
+			chunk_t m_current;													//Блок передаётся в область чтения без копирования
+			uint64_t m_bytes{ 0 };
+		};
+
+		class ChunkOutputBuffer : public std::streambuf {						//Сторона производителя
+		public:
+			explicit ChunkOutputBuffer(ChunkChannel& channel);
+			uint64_t BytesWritten() const noexcept;
+		protected:
+			int_type overflow(int_type ch) override;
+			int sync() override;												//Передаёт неполный блок
+		private:
+			bool push_chunk();
+			void reset_put_area();
+		private:
+			ChunkChannel* m_channel;
+			chunk_t m_chunk;
+			uint64_t m_bytes{ 0 };
+		};
+
+		/***********************************************************
+		Состояние конвейерного чтения: поток для xml::Reader и
+		очередь, которую заполняет стадия ReadAhead. Живёт дольше
+		собранной цепочки обработчиков; используется однократно
+		***********************************************************/
+		class PipelinedInput {
+		public:
+			explicit PipelinedInput(ChunkSettings settings = {});
+			std::istream& GetStream() noexcept;
+			const PipelineStatistics& GetStatistics() const noexcept;			//После завершения цепочки
+		private:
+			friend class stage::ReadAhead;
+			ChunkChannel m_channel;
+			ChunkInputBuffer m_buffer;
+			std::istream m_stream;
+			PipelineStatistics m_stats;
+		};
+
+		class PipelinedOutput {
+		public:
+			explicit PipelinedOutput(ChunkSettings settings = {});
+			std::ostream& GetStream() noexcept;
+			const PipelineStatistics& GetStatistics() const noexcept;
+		private:
+			friend class stage::WriteBehind;
+			ChunkChannel m_channel;
+			ChunkOutputBuffer m_buffer;
+			std::ostream m_stream;
+			PipelineStatistics m_stats;
+		};
+	}
+}
@@ -1,127 +1,235 @@
 #include "file_workers.h"
+#include "tracing.h"
 using namespace std;
 
 namespace worker {
 	namespace file_operation {
-		EmptyPathChecker::EmptyPathChecker(string_view path)
-			: m_path(path)
-		{
-		}
+		namespace stage {
+			namespace {
+				using clock = chrono::steady_clock;
 
-		void EmptyPathChecker::Process(Result& result) {
-			if (!m_path.empty()) {
-				result = Result::Success;
-				MyBase::pass_on(result);
-			}
-			else {
-				result = Result::EmptyPath;
+				void fill_stage(StageStatistics& stats, const SpscQueue<chunk_t>::Statistics& queue, bool producer) {
+					stats.stalls = producer ? queue.full_stalls : queue.empty_stalls;
+					stats.stalled = producer ? queue.full_wait : queue.empty_wait;
+				}
 			}
-		}
 
-		EmptyPathChecker::chain_worker_holder EmptyPathChecker::make_instance(string_view path) {
-			return allocate_instance(path);
-		}
-
-		OpenerForReading::OpenerForReading(ifstream& in, string_view path)
-			: m_input(in), m_path(path)
-		{
-		}
+			CheckPath::CheckPath(string_view path) noexcept
+				: m_path(path)
+			{
+			}
 
-		void OpenerForReading::Process(Result& result) {
-			m_input.open(m_path.data());
-			if (m_input.is_open()) {
-				result = Result::Success;
-				MyBase::pass_on(result);
+			bool CheckPath::operator()(Result& result) const {
+				result = m_path.empty() ?
+					Result::EmptyPath : Result::Success;
+				return result == Result::Success;
 			}
-			else {
-				result = Result::FileOpenError;
+
+			OpenForReading::OpenForReading(ifstream& in, string_view path) noexcept
+				: m_input(in), m_path(path)
+			{
 			}
-		}
 
-		OpenerForReading::chain_worker_holder OpenerForReading::make_instance(ifstream& in, string_view path) {
-			return allocate_instance(in, path);
-		}
+			bool OpenForReading::operator()(Result& result) {
+				m_input.open(m_path.data());
+				result = m_input.is_open() ?
+					Result::Success : Result::FileOpenError;
+				return result == Result::Success;
+			}
 
-		XmlReader::XmlReader(
-			xml::Reader& reader,
-			xml::Document& target,
-			std::optional<xml::allocator_holder> external_alloc
-		) : m_reader(reader), m_doc(target) {
-			if (external_alloc) {
-				m_external_alloc = move(*external_alloc);
+			ReadXml::ReadXml(
+				xml::Reader& reader,
+				xml::Document& target,
+				optional<xml::allocator_holder> external_alloc
+			) : m_reader(reader), m_doc(target) {
+				if (external_alloc) {
+					m_external_alloc = move(*external_alloc);
+				}
 			}
-		}
 
-		void XmlReader::Process(Result& result) {
-			try {
-				if (m_external_alloc) {
-					m_doc = m_reader.Load(move(m_external_alloc));
+			bool ReadXml::operator()(Result& result) {
+				try {
+					if (m_external_alloc) {
+						m_doc = m_reader.Load(move(m_external_alloc));
+					}
+					else {
+						m_doc = m_reader.Load();
+					}
 				}
-				else {
-					m_doc = m_reader.Load();
+				catch (...) {
+					result = Result::FileIOError;
+					throw;
 				}
+				result = m_reader.Fail() ?
+					Result::FileIOError : Result::Success;
+				return result == Result::Success;
 			}
-			catch (...) {
-				result = Result::FileIOError;
-				throw;
+
+			OpenForWriting::OpenForWriting(ofstream& out, string_view path) noexcept
+				: m_output(out), m_path(path)
+			{
 			}
-			result = m_reader.Fail() ?
-				Result::FileIOError : Result::Success;
-			if (result == Result::Success) {
-				MyBase::pass_on(result);
+
+			bool OpenForWriting::operator()(Result& result) {
+				m_output.open(m_path.data());
+				result = m_output.is_open() ?
+					Result::Success : Result::FileOpenError;
+				return result == Result::Success;
 			}
-		}
 
-		XmlReader::chain_worker_holder XmlReader::make_instance(
-			xml::Reader& reader,
-			xml::Document& target,
-			std::optional<xml::allocator_holder> external_alloc
-		) {
-			return allocate_instance(reader, target, external_alloc);
-		}
+			WriteXml::WriteXml(xml::Writer& writer, const xml::Document& source) noexcept
+				: m_writer(writer), m_doc(source)
+			{
+			}
 
-		OpenerForWriting::OpenerForWriting(ofstream& out, string_view path)
-			: m_output(out), m_path(path)
-		{
-		}
+			bool WriteXml::operator()(Result& result) {
+				try {
+					m_writer.Save(m_doc);
+				}
+				catch (...) {
+					result = Result::FileIOError;
+					throw;
+				}
+				result = m_writer.Fail() ?
+					Result::FileIOError : Result::Success;
+				return result == Result::Success;
+			}
 
-		void OpenerForWriting::Process(Result& result) {
-			m_output.open(m_path.data());
-			if (m_output.is_open()) {
-				result = Result::Success;
-				MyBase::pass_on(result);
+			ReadAhead::ReadAhead(ifstream& in, PipelinedInput& pipe) noexcept
+				: m_input(in), m_pipe(pipe)
+			{
 			}
-			else {
-				result = Result::FileOpenError;
+
+			void ReadAhead::start() {
+				m_pipe.m_stats = {};
+				m_io_ok = true;
+				m_start = clock::now();
+				m_io = thread([this] { m_io_ok = read_file(); });
 			}
-		}
 
-		OpenerForWriting::chain_worker_holder OpenerForWriting::make_instance(ofstream& out, string_view path) {
-			return allocate_instance(out, path);
-		}
+			void ReadAhead::stop() noexcept {
+				m_pipe.m_channel.data.Close();
+				m_io.join();
+			}
 
-		XmlWriter::XmlWriter(xml::Writer& writer, const xml::Document& source)
-			: m_writer(writer), m_doc(source)
-		{
-		}
+			void ReadAhead::finish(Result& result) {
+				stop();
+				auto& stats{ m_pipe.m_stats };
+				const auto& queue{ m_pipe.m_channel.data.GetStatistics() };
+				fill_stage(stats.io, queue, true);
+				fill_stage(stats.xml, queue, false);
+				stats.xml.busy = clock::now() - m_start;
+				stats.xml.busy -= min(stats.xml.busy, stats.xml.stalled);
+				stats.xml.bytes = m_pipe.m_buffer.BytesRead();
+				stats.xml.chunks = stats.io.chunks;
+				if (!m_io_ok && result == Result::Success) {
+					result = Result::FileIOError;
+				}
+			}
 
-		void XmlWriter::Process(Result& result) {
-			try {
-				m_writer.Save(m_doc);
+			bool ReadAhead::read_file() {
+				auto& channel{ m_pipe.m_channel };
+				auto& stats{ m_pipe.m_stats.io };
+				bool io_ok{ true };
+				tracing::Tracer::Instance().SetThreadName("file read-ahead");
+				try {
+					while (m_input) {
+						constexpr size_t headroom{ ChunkChannel::READ_HEADROOM };
+						chunk_t chunk{ channel.Acquire() };
+						size_t count;
+						{
+							tracing::Span span("file/read chunk", "io");				//Без ожидания места в очереди
+							auto start{ clock::now() };
+							chunk.resize(headroom + channel.ChunkSize());
+							m_input.read(chunk.data() + headroom, static_cast<streamsize>(channel.ChunkSize()));
+							count = static_cast<size_t>(m_input.gcount());
+							chunk.resize(headroom + count);
+							stats.busy += clock::now() - start;
+							span.SetCount(static_cast<int64_t>(count));
+						}
+						if (!count) {
+							break;
+						}
+						stats.bytes += count;
+						++stats.chunks;
+						if (!channel.data.Push(move(chunk))) {
+							break;														//Разбор завершён или прерван
+						}
+					}
+					io_ok = !m_input.bad();
+				}
+				catch (...) {
+					io_ok = false;
+				}
+				channel.data.Close();													//Конец файла для xml::Reader
+				return io_ok;
 			}
-			catch (...) {
-				result = Result::FileIOError;
-				throw;
+
+			WriteBehind::WriteBehind(ofstream& out, PipelinedOutput& pipe) noexcept
+				: m_output(out), m_pipe(pipe)
+			{
 			}
-			result = m_writer.Fail() ?
-				Result::FileIOError : Result::Success;
-			if (result == Result::Success) {
-				MyBase::pass_on(result);
+
+			void WriteBehind::start() {
+				m_pipe.m_stats = {};
+				m_io_ok = true;
+				m_start = clock::now();
+				m_io = thread([this] { m_io_ok = write_file(); });
 			}
-		}
 
-		XmlWriter::chain_worker_holder XmlWriter::make_instance(xml::Writer& writer, const xml::Document& source) {
-			return allocate_instance(writer, source);
+			void WriteBehind::stop() noexcept {
+				m_pipe.m_channel.data.Close();
+				m_io.join();
+			}
+
+			void WriteBehind::finish(Result& result) {
+				m_pipe.m_stream.flush();
+				stop();
+				auto& stats{ m_pipe.m_stats };
+				const auto& queue{ m_pipe.m_channel.data.GetStatistics() };
+				fill_stage(stats.io, queue, false);
+				fill_stage(stats.xml, queue, true);
+				stats.xml.busy = clock::now() - m_start;
+				stats.xml.busy -= min(stats.xml.busy, stats.xml.stalled);
+				stats.xml.bytes = m_pipe.m_buffer.BytesWritten();
+				stats.xml.chunks = stats.io.chunks;
+				if (result == Result::Success && (!m_io_ok || !m_pipe.m_stream)) {
+					result = Result::FileIOError;
+				}
+			}
+
+			bool WriteBehind::write_file() {
+				auto& channel{ m_pipe.m_channel };
+				auto& stats{ m_pipe.m_stats.io };
+				bool io_ok{ true };
+				tracing::Tracer::Instance().SetThreadName("file write-behind");
+				while (auto chunk{ channel.data.Pop() }) {
+					if (io_ok) {
+						tracing::Span span("file/write chunk", "io");
+						auto start{ clock::now() };
+						try {
+							m_output.write(chunk->data(), static_cast<streamsize>(chunk->size()));
+							io_ok = static_cast<bool>(m_output);
+						}
+						catch (...) {
+							io_ok = false;
+						}
+						stats.busy += clock::now() - start;
+						stats.bytes += chunk->size();
+						++stats.chunks;
+						if (!io_ok) {
+							channel.data.Close();											//Сериализация получит отказ при следующей передаче блока
+						}
+					}
+					channel.Recycle(move(*chunk));
+				}
+				if (io_ok) {
+					auto start{ clock::now() };
+					io_ok = static_cast<bool>(m_output.flush());
+					stats.busy += clock::now() - start;
+				}
+				return io_ok;
+			}
 		}
 
 		PipelineBuilder& PipelineBuilder::CheckPath(string_view path) {
@@ -136,11 +244,19 @@ namespace worker {
 			return MyBase::attach_node(OpenerForWriting::make_instance(out, path));
 		}
 
+		PipelineBuilder& PipelineBuilder::ReadAhead(ifstream& in, PipelinedInput& pipe) {
+			return MyBase::attach_node(AsyncFileReader::make_instance(in, pipe));
+		}
+
+		PipelineBuilder& PipelineBuilder::WriteBehind(ofstream& out, PipelinedOutput& pipe) {
+			return MyBase::attach_node(AsyncFileWriter::make_instance(out, pipe));
+		}
+
 		PipelineBuilder& PipelineBuilder::ReadXml(
 			xml::Reader& reader,
 			xml::Document& target,
 			std::optional<xml::allocator_holder> external_alloc) {
-			return MyBase::attach_node(XmlReader::make_instance(reader, target));
+			return MyBase::attach_node(XmlReader::make_instance(reader, target, move(external_alloc)));
 		}
 
 		PipelineBuilder& PipelineBuilder::WriteXml(xml::Writer& writer, const xml::Document& source) {
@@ -1,5 +1,6 @@
 #pragma once
 #include "worker_interface.h"
+#include "chunk_stream.h"
 #include "xml_parse.h"
 #include "xml_serialize.h"
 
@@ -9,6 +10,8 @@
 #include <string>
 #include <string_view>
 #include <optional>
+#include <thread>
+#include <chrono>
 #include <utility>
 
 namespace worker {
@@ -21,84 +24,149 @@ namespace worker {
 			FileIOError
 		};
 
-		template <class ConcreteWorker>
-		class FileWorker : public AllocatedChainWorker<ConcreteWorker, Result> {
-		public:
-			using MyBase = AllocatedChainWorker<ConcreteWorker, Result>;
-		};
+		/***********************************************************
+		Стадии файловых операций - для StaticPipeline напрямую
+		и для PipelineBuilder через StageWorker. Стадии-проверки
+		возвращают true, если цепочку следует продолжить
+		***********************************************************/
+		namespace stage {
+			class CheckPath {
+			public:
+				static constexpr const char* trace_name{ "file/CheckPath" };
 
-		class EmptyPathChecker : public FileWorker<EmptyPathChecker> {
-		public:
-			using MyBase = FileWorker<EmptyPathChecker>;
-			using chain_worker_holder = MyBase::chain_worker_holder;
-		public:
-			EmptyPathChecker(std::string_view path);
-			void Process(Result& result) override;
-			static chain_worker_holder make_instance(std::string_view path);
-		private:
-			std::string_view m_path;
-		};
+				explicit CheckPath(std::string_view path) noexcept;
+				bool operator()(Result& result) const;
+			private:
+				std::string_view m_path;
+			};
 
-		class OpenerForReading : public FileWorker<OpenerForReading> {
-		public:
-			using MyBase = FileWorker<OpenerForReading>;
-			using chain_worker_holder = MyBase::chain_worker_holder;
-		public:
-			OpenerForReading(std::ifstream& in, std::string_view path);
-			void Process(Result& result) override;
-			static chain_worker_holder make_instance(std::ifstream& in, std::string_view path);
-		private:
-			std::ifstream& m_input;
-			std::string_view m_path;
-		};
+			class OpenForReading {
+			public:
+				static constexpr const char* trace_name{ "file/OpenForReading" };
 
-		class XmlReader : public FileWorker<XmlReader> {
-		public:
-			using MyBase = FileWorker<XmlReader>;
-			using chain_worker_holder = MyBase::chain_worker_holder;
-		public:
-			XmlReader(
-				xml::Reader& reader,
-				xml::Document& target,
-				std::optional<xml::allocator_holder> external_alloc
-			);
-			void Process(Result& result) override;
-			static chain_worker_holder make_instance(
-				xml::Reader& reader,
-				xml::Document& target,
-				std::optional<xml::allocator_holder> external_alloc = std::nullopt
-			);
-		private:
-			xml::Reader& m_reader;
-			xml::Document& m_doc;
-			xml::allocator_holder m_external_alloc;
-		};
+				OpenForReading(std::ifstream& in, std::string_view path) noexcept;
+				bool operator()(Result& result);
+			private:
+				std::ifstream& m_input;
+				std::string_view m_path;
+			};
 
-		class OpenerForWriting : public FileWorker<OpenerForWriting> {
-		public:
-			using MyBase = FileWorker<OpenerForWriting>;
-			using chain_worker_holder = MyBase::chain_worker_holder;
-		public:
-			OpenerForWriting(std::ofstream& out, std::string_view path);
-			void Process(Result& result) override;
-			static chain_worker_holder make_instance(std::ofstream& out, std::string_view path);
-		private:
-			std::ofstream& m_output;
-			std::string_view m_path;
-		};
+			class ReadXml {
+			public:
+				static constexpr const char* trace_name{ "file/ReadXml" };
 
-		class XmlWriter : public FileWorker<XmlWriter> {
-		public:
-			using MyBase = FileWorker<XmlWriter>;
-			using chain_worker_holder = MyBase::chain_worker_holder;
-		public:
-			XmlWriter(xml::Writer& writer, const xml::Document& source);
-			void Process(Result& result) override;
-			static chain_worker_holder make_instance(xml::Writer& writer, const xml::Document& source);
-		private:
-			xml::Writer& m_writer;
-			const xml::Document& m_doc;
-		};
+				ReadXml(
+					xml::Reader& reader,
+					xml::Document& target,
+					std::optional<xml::allocator_holder> external_alloc = std::nullopt
+				);
+				bool operator()(Result& result);
+			private:
+				xml::Reader& m_reader;
+				xml::Document& m_doc;
+				xml::allocator_holder m_external_alloc;
+			};
+
+			class OpenForWriting {
+			public:
+				static constexpr const char* trace_name{ "file/OpenForWriting" };
+
+				OpenForWriting(std::ofstream& out, std::string_view path) noexcept;
+				bool operator()(Result& result);
+			private:
+				std::ofstream& m_output;
+				std::string_view m_path;
+			};
+
+			class WriteXml {
+			public:
+				static constexpr const char* trace_name{ "file/WriteXml" };
+
+				WriteXml(xml::Writer& writer, const xml::Document& source) noexcept;
+				bool operator()(Result& result);
+			private:
+				xml::Writer& m_writer;
+				const xml::Document& m_doc;
+			};
+
+			/***********************************************************
+			Стадии конвейерного ввода-вывода: чтение (запись) файла
+			выполняется в отдельном потоке и передаётся по очереди
+			блоков, пока следующие стадии цепочки разбирают
+			(сериализуют) XML в текущем потоке. Поток ввода-вывода
+			работает только с файлом и очередью, поэтому ObjectPool
+			и документ остаются в потоке, запустившем цепочку
+			***********************************************************/
+			class ReadAhead {
+			public:
+				static constexpr const char* trace_name{ "file/ReadAhead" };
+
+				ReadAhead(std::ifstream& in, PipelinedInput& pipe) noexcept;
+
+				template <class Next>
+				void operator()(Result& result, Next&& next) {
+					start();
+					try {
+						next(result);
+					}
+					catch (...) {
+						stop();														//Останавливает поток ввода-вывода, если он ждёт места в очереди
+						throw;
+					}
+					finish(result);
+				}
+			private:
+				void start();
+				void stop() noexcept;
+				void finish(Result& result);
+				bool read_file();												//Выполняется в потоке ввода-вывода; false при ошибке чтения
+			private:
+				std::ifstream& m_input;
+				PipelinedInput& m_pipe;
+				std::thread m_io;
+				bool m_io_ok{ true };
+				std::chrono::steady_clock::time_point m_start;
+			};
+
+			class WriteBehind {
+			public:
+				static constexpr const char* trace_name{ "file/WriteBehind" };
+
+				WriteBehind(std::ofstream& out, PipelinedOutput& pipe) noexcept;
+
+				template <class Next>
+				void operator()(Result& result, Next&& next) {
+					start();
+					try {
+						next(result);
+					}
+					catch (...) {
+						stop();
+						throw;
+					}
+					finish(result);
+				}
+			private:
+				void start();
+				void stop() noexcept;
+				void finish(Result& result);									//Передаёт неполный последний блок и дожидается записи
+				bool write_file();
+			private:
+				std::ofstream& m_output;
+				PipelinedOutput& m_pipe;
+				std::thread m_io;
+				bool m_io_ok{ true };
+				std::chrono::steady_clock::time_point m_start;
+			};
+		}
+
+		using EmptyPathChecker = StageWorker<stage::CheckPath, Result>;
+		using OpenerForReading = StageWorker<stage::OpenForReading, Result>;
+		using XmlReader = StageWorker<stage::ReadXml, Result>;
+		using OpenerForWriting = StageWorker<stage::OpenForWriting, Result>;
+		using XmlWriter = StageWorker<stage::WriteXml, Result>;
+		using AsyncFileReader = StageWorker<stage::ReadAhead, Result>;
+		using AsyncFileWriter = StageWorker<stage::WriteBehind, Result>;
 
 		class PipelineBuilder : public PipelineBuilderBase<PipelineBuilder, Result> {
 		public:
@@ -108,6 +176,8 @@ namespace worker {
 			PipelineBuilder& CheckPath(std::string_view path);
 			PipelineBuilder& OpenForReading(std::ifstream& in, std::string_view path);
 			PipelineBuilder& OpenForWriting(std::ofstream& out, std::string_view path);
+			PipelineBuilder& ReadAhead(std::ifstream& in, PipelinedInput& pipe);		//Далее - ReadXml с xml::Reader(pipe.GetStream())
+			PipelineBuilder& WriteBehind(std::ofstream& out, PipelinedOutput& pipe);	//Далее - WriteXml с xml::Writer(pipe.GetStream())
 
 			PipelineBuilder& ReadXml(
 				xml::Reader& reader,
@@ -0,0 +1,183 @@
+#pragma once
+#include <vector>
+#include <optional>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <thread>
+#include <utility>
+#include <cstdint>
+
+/***********************************************************
+Шаблон SpscQueue - ограниченная очередь для одного
+производителя и одного потребителя, соединяющая стадии
+конвейера в разных потоках. Push() и Pop() не захватывают
+мьютекс, пока в очереди есть место и данные; при заполнении
+(или опустошении) поток недолго уступает процессор, а затем
+засыпает до уведомления другой стороны.
+
+Ожидания записываются в статистику: простой производителя
+на полной очереди - признак того, что потребитель не
+успевает (back-pressure), простой потребителя на пустой -
+что медленнее производитель.
+
+Close() сообщает о конце потока данных либо об отмене:
+Push() после него возвращает false, Pop() дочитывает
+оставшиеся элементы и возвращает nullopt
+************************************************************/
+template <class Ty>
+class SpscQueue {
+public:
+	using value_type = Ty;
+	using clock = std::chrono::steady_clock;
+
+	struct Statistics {															//Каждое поле изменяет только одна сторона
+		uint64_t full_stalls{ 0 };
+		uint64_t empty_stalls{ 0 };
+		std::chrono::nanoseconds full_wait{ 0 };
+		std::chrono::nanoseconds empty_wait{ 0 };
+	};
+public:
+	explicit SpscQueue(size_t capacity)
+		: m_slots(capacity + 1)													//Одна ячейка всегда пуста: head == tail означает пустую очередь
+	{
+	}
+
+	size_t capacity() const noexcept {
+		return m_slots.size() - 1;
+	}
+
+	bool Push(Ty value) {														//Только производитель; false, если очередь закрыта
+		if (m_closed.load()) {
+			return false;
+		}
+		bool pushed{ try_push(value) };
+		if (!pushed) {
+			auto start{ clock::now() };
+			++m_stats.full_stalls;
+			pushed = wait_for([this, &value] { return try_push(value); });
+			m_stats.full_wait += clock::now() - start;
+		}
+		if (pushed) {
+			notify();
+		}
+		return pushed;
+	}
+
+	std::optional<Ty> Pop() {													//Только потребитель; nullopt - очередь закрыта и пуста
+		std::optional<Ty> value{ try_pop() };
+		if (!value && m_closed.load()) {
+			value = try_pop();													//Элемент мог появиться перед закрытием
+		}
+		else if (!value) {
+			auto start{ clock::now() };
+			++m_stats.empty_stalls;
+			if (!wait_for([this, &value] { value = try_pop(); return value.has_value(); })) {
+				value = try_pop();
+			}
+			m_stats.empty_wait += clock::now() - start;
+		}
+		if (value) {
+			notify();
+		}
+		return value;
+	}
+
+	std::optional<Ty> TryPop() {												//Без ожидания
+		std::optional<Ty> value{ try_pop() };
+		if (value) {
+			notify();
+		}
+		return value;
+	}
+
+	bool TryPush(Ty& value) {													//Без ожидания; при успехе value перемещается в очередь
+		if (m_closed.load() || !try_push(value)) {
+			return false;
+		}
+		notify();
+		return true;
+	}
+
+	void Close() noexcept {
+		m_closed.store(true);
+		notify();
+	}
+
+	bool IsClosed() const noexcept {
+		return m_closed.load();
+	}
+
+	const Statistics& GetStatistics() const noexcept {							//Достоверна после остановки обеих сторон
+		return m_stats;
+	}
+private:
+	bool try_push(Ty& value) {													//Не уведомляет: может выполняться под m_mutex в wait_for()
+		size_t tail{ m_tail.load(std::memory_order_relaxed) };
+		size_t next{ advance(tail) };
+		if (next == m_head.load(std::memory_order_acquire)) {
+			return false;
+		}
+		m_slots[tail] = std::move(value);
+		m_tail.store(next, std::memory_order_release);
+		return true;
+	}
+
+	std::optional<Ty> try_pop() {
+		size_t head{ m_head.load(std::memory_order_relaxed) };
+		if (head == m_tail.load(std::memory_order_acquire)) {
+			return std::nullopt;
+		}
+		std::optional<Ty> value{ std::move(m_slots[head]) };
+		m_head.store(advance(head), std::memory_order_release);
+		return value;
+	}
+
+	template <class Predicate>
+	bool wait_for(Predicate pred) {												//false, если очередь закрыли раньше, чем выполнился pred()
+		constexpr size_t SPIN_COUNT{ 64 };
+		for (size_t spin = 0; spin < SPIN_COUNT; ++spin) {
+			if (pred()) {
+				return true;
+			}
+			if (m_closed.load()) {
+				return false;
+			}
+			std::this_thread::yield();
+		}
+		std::unique_lock lock(m_mutex);
+		m_waiting.fetch_add(1);													//Барьеры с обеих сторон: другая сторона либо увидит
+		std::atomic_thread_fence(std::memory_order_seq_cst);					//ожидающего, либо её изменение будет замечено в pred()
+		bool done{ false };
+		m_changed.wait(lock, [this, &pred, &done] {
+			done = pred();
+			return done || m_closed.load();
+		});
+		m_waiting.fetch_sub(1);
+		return done;
+	}
+
+	void notify() {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (m_waiting.load()) {
+			{
+				std::lock_guard lock(m_mutex);
+			}
+			m_changed.notify_all();
+		}
+	}
+
+	size_t advance(size_t idx) const noexcept {
+		return ++idx == m_slots.size() ? 0 : idx;
+	}
+private:
+	std::vector<Ty> m_slots;
+	alignas(64) std::atomic<size_t> m_head{ 0 };								//Изменяет только потребитель
+	alignas(64) std::atomic<size_t> m_tail{ 0 };								//Изменяет только производитель
+	alignas(64) std::atomic<bool> m_closed{ false };
+	std::atomic<size_t> m_waiting{ 0 };
+	std::mutex m_mutex;
+	std::condition_variable m_changed;
+	Statistics m_stats;
+};
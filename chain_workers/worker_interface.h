@@ -1,16 +1,21 @@
 #pragma once
 #include "object_pool.h"
+#include "tracing.h"
 
 #include <stdexcept>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
 /***********************************************************
- ChainWorker    
-(    "")   
-.    ICommand,    
-   ,    
-      Process()
+Шаблон ChainWorker позволяет собирать цепочки команд
+(паттерн также известен как "Конвейер") и запускать их
+выполнение. В отличие от ICommand, не накладывает никаких 
+ограничений на повтор операций, однако требует явной передачи
+ссылки на целевой объект в метод Process()
 
-       (CRTP)
+Тип команды передается в виде шаблонного параметра (CRTP)
 ************************************************************/
 template <class TargetTy>
 class ChainWorker;
@@ -21,7 +26,7 @@ using chain_worker_holder = object_holder<ChainWorker<TargetTy>>;
 template <class TargetTy>
 class ChainWorker {
 public:
-	using chain_worker_holder = chain_worker_holder<TargetTy>;
+	using chain_worker_holder = ::chain_worker_holder<TargetTy>;
 public:
 	virtual void Process(TargetTy& target) = 0;
 	void SetNext(chain_worker_holder&& next) {
@@ -39,8 +44,8 @@ private:
 };
 
 /***********************************************************
- ,  
-ObjectPool  ChainWorker
+Промежуточный класс, объединяющий возможности
+ObjectPool и ChainWorker
 ***********************************************************/
 template <class ConcreteWorker, class TargetTy>
 class AllocatedChainWorker : public ObjectPool<ChainWorker<TargetTy>, ConcreteWorker>, public ChainWorker<TargetTy> {
@@ -55,13 +60,13 @@ public:
 };
 
 /***********************************************************
-     .
+Базовый класс для создания построителей цепочек.
 ***********************************************************/
 template <class ConcreteBuilder, class TargetTy>																	
 class PipelineBuilderBase {
 public:
-	using ChainWorker = ChainWorker<TargetTy>;
-	using chain_worker_holder = chain_worker_holder<TargetTy>;
+	using ChainWorker = ::ChainWorker<TargetTy>;
+	using chain_worker_holder = ::chain_worker_holder<TargetTy>;
 public:
 	chain_worker_holder Assemble() {
 		if (!m_strong_head) {
@@ -91,3 +96,114 @@ private:
 	chain_worker_holder m_strong_head{ MakeDummyObjectHolder<ChainWorker>() };
 	ChainWorker* m_weak_tail{ nullptr };
 };
+
+/***********************************************************
+Шаблон StaticPipeline - цепочка, собираемая на этапе
+компиляции: стадии хранятся в кортеже по значению, а переход
+к следующей стадии - обычный (встраиваемый) вызов. В отличие
+от PipelineBuilderBase, не выделяет память и не использует
+виртуальные функции, поэтому подходит для часто выполняемых
+внутренних цепочек; состав цепочки при этом фиксирован.
+
+Стадия - callable-object одного из двух видов:
+1. bool(TargetTy&) - движение по цепочке продолжится, только
+   если обработчик вернёт true (как у SingleHandlerWorker);
+2. void(TargetTy&, Next&&) - стадия сама вызывает next(target)
+   для выполнения оставшейся части цепочки и может выполнить
+   действия до и после неё (открытие и закрытие ресурсов,
+   запуск и остановка потоков)
+***********************************************************/
+namespace chain_detail {
+	template <class Stage, class = void>
+	struct stage_trace_name {												//Имя стадии в трассировке: Stage::trace_name, если объявлено
+		static constexpr const char* value{ "chain/stage" };
+	};
+
+	template <class Stage>
+	struct stage_trace_name<Stage, std::void_t<decltype(Stage::trace_name)>> {
+		static constexpr const char* value{ Stage::trace_name };
+	};
+
+	template <class Stage, class TargetTy, class Next>
+	void invoke_stage(Stage& stage, TargetTy& target, Next&& next) {
+		constexpr const char* name{ stage_trace_name<Stage>::value };
+		if constexpr (std::is_invocable_r_v<bool, Stage&, TargetTy&>) {
+			bool proceed;
+			{
+				tracing::Span span(name, "chain");								//Без последующих стадий
+				proceed = std::invoke(stage, target);
+			}
+			if (proceed) {
+				next(target);
+			}
+		}
+		else {
+			tracing::Span span(name, "chain");									//Включает последующие стадии
+			std::invoke(stage, target, std::forward<Next>(next));
+		}
+	}
+}
+
+template <class TargetTy, class... Stages>
+class StaticPipeline {
+public:
+	using target_type = TargetTy;
+public:
+	explicit StaticPipeline(Stages... stages)
+		: m_stages(std::move(stages)...)
+	{
+	}
+
+	void Process(TargetTy& target) {
+		process<0>(target);
+	}
+private:
+	template <size_t Idx>
+	void process(TargetTy& target) {
+		if constexpr (Idx < sizeof...(Stages)) {
+			chain_detail::invoke_stage(
+				std::get<Idx>(m_stages),
+				target,
+				[this](TargetTy& next_target) { process<Idx + 1>(next_target); }
+			);
+		}
+	}
+private:
+	std::tuple<Stages...> m_stages;
+};
+
+template <class TargetTy, class... Stages>
+StaticPipeline<TargetTy, std::decay_t<Stages>...> MakeStaticPipeline(Stages&&... stages) {
+	return StaticPipeline<TargetTy, std::decay_t<Stages>...>(std::forward<Stages>(stages)...);
+}
+
+/***********************************************************
+Шаблон StageWorker - стадия StaticPipeline в виде ChainWorker
+для сборки цепочек во время выполнения: одна реализация
+обработчика служит обоим видам цепочек
+***********************************************************/
+template <class Stage, class TargetTy>
+class StageWorker : public AllocatedChainWorker<StageWorker<Stage, TargetTy>, TargetTy> {
+public:
+	using MyBase = AllocatedChainWorker<StageWorker, TargetTy>;
+	using chain_worker_holder = typename MyBase::chain_worker_holder;
+public:
+	template <class... Types>
+	explicit StageWorker(Types&&... args)
+		: m_stage(std::forward<Types>(args)...)
+	{
+	}
+	void Process(TargetTy& target) override {
+		chain_detail::invoke_stage(
+			m_stage,
+			target,
+			[this](TargetTy& next_target) { MyBase::pass_on(next_target); }
+		);
+	}
+	template <class... Types>
+	static chain_worker_holder make_instance(Types&&... args) {
+		return MyBase::allocate_instance(std::forward<Types>(args)...);
+	}
+private:
+	Stage m_stage;
+};
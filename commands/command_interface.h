@@ -1,7 +1,7 @@
 #pragma once
 #include "object_pool.h"
 
-#include <any>
+#include <array>
 #include <optional>
 #include <variant>
 #include <memory>
@@ -11,14 +11,14 @@
 #include <type_traits>
 
 /***********************************************************
- ICommand      
-   . 
-     TargetTy   , 
-   Cancel()   
+Шаблон ICommand реализует интерфейс системы команд с 
+возможность выполнения и отмены. 
+Ссылка на целевой объект типа TargetTy передается в конструктор, 
+чтобы предотвратить вызов Cancel() для другого объекта
 ************************************************************/
 
 namespace command {
-	enum class Type {							//      GetType()
+	enum class Type {							//Список команд для определения типа вызовом GetType()
 	/*FileIO*/
 		File_GetPath,
 		File_SetPath,
@@ -49,19 +49,58 @@ namespace command {
 		Xml_ChangeEmployeeFunction,
 		View_ChangeEmployeeFullName,
 		Xml_UpdateEmployeeSalary,	
+
+	/*Composite*/
+		Xml_ImportEmployees,
+		Batch
 	};
 
-	enum class Purpose {	//              
+	enum class Purpose {	//Объединение команд различных типов в более крупные систематические единицы для регулирования порядка выполнения и отмены
 		FileIO = 7,				
 		Insert = 12,			
 		Remove = 16,		
-		EditFields = 24
+		EditFields = 24,
+		Batch = 26
+	};
+
+	constexpr size_t TYPE_COUNT{ static_cast<size_t>(Type::Batch) + 1 };
+
+	constexpr Purpose PurposeOf(Type type) noexcept {
+		constexpr Purpose purposes[]{													//Значение Purpose совпадает с последним типом своей категории
+			Purpose::FileIO, Purpose::Insert, Purpose::Remove, Purpose::EditFields, Purpose::Batch
+		};
+		for (Purpose purpose : purposes) {
+			if (static_cast<int>(type) <= static_cast<int>(purpose)) {
+				return purpose;
+			}
+		}
+		return Purpose::Batch;
+	}
+
+	/***********************************************************
+	Результат Execute() и Cancel() - std::variant известных
+	типов результатов команд над TargetTy. В отличие от
+	std::any значение хранится без выделения памяти, а
+	std::get не требует RTTI. Базовый набор: пустой результат,
+	флаг и счётчик (Composite); набор для конкретного TargetTy
+	объявляется специализацией result_traits рядом с его
+	командами, до первого использования ICommand<TargetTy>
+	************************************************************/
+	template <class... Types>
+	using basic_result = std::variant<std::monostate, bool, size_t, Types...>;
+
+	template <class TargetTy>
+	struct result_traits {
+		using type = basic_result<>;
 	};
 
+	template <class TargetTy>
+	using result_t = typename result_traits<TargetTy>::type;
+
 	/***********************************************************
-	   Execute()  Cancel() 
-	   ,   
-	XMLWrapperTree ( - xml)  TreeModelView ( - view)
+	Последовательность выполнения операций Execute() и Cancel() 
+	для команд различных категорий, применяемых попарно к
+	XMLWrapperTree (далее - xml) и TreeModelView (далее - view)
 
 	Insert: 
 		Execute (xml) -> Execute (view)
@@ -72,12 +111,15 @@ namespace command {
 	EditFields:
 		Execute (xml) -> Execute (view)
 		Cancel - unspecified
+	Batch:
+		Execute (xml) -> полная пересборка view
+		Cancel (xml) -> полная пересборка view
 	************************************************************/
 
 	template <class TargetTy>
 	class ICommand {
-	private:
-		using purpose_t = std::underlying_type_t<Purpose>;
+	public:
+		using result_type = result_t<TargetTy>;
 	public:
 		ICommand(TargetTy& target) noexcept
 			: m_target(std::addressof(target))
@@ -85,45 +127,36 @@ namespace command {
 		}
 		virtual ~ICommand() = default;
 
-		virtual std::any Execute() = 0;
-		virtual std::any Cancel() = 0;
+		virtual result_type Execute() = 0;
+		virtual result_type Cancel() = 0;
 		virtual Type GetType() const noexcept = 0;
+		virtual size_t RetainedMemory() const noexcept = 0;							//Оценка объёма памяти (в байтах), удерживаемой командой в очереди отмены/повтора
 		Purpose GetPurpose() const noexcept {
-			return static_cast<Purpose>(
-				*std::upper_bound(
-					command_purpose.begin(),
-					command_purpose.end(),
-					static_cast<purpose_t>(GetType())
-				)
-			);
+			return PurposeOf(GetType());
+		}
+		virtual bool Absorb(const ICommand& /*next*/) noexcept {						//Слияние со следующей, уже выполненной командой: при успехе next
+			return false;															//больше не нужна, а отмена *this возвращает состояние до обеих
 		}
 	protected:
 		TargetTy& get_target() const noexcept {
 			return *m_target;
 		}
-		static std::any make_default_value() noexcept {
-			return std::any{};
+		static result_type make_default_value() noexcept {
+			return result_type{};
 		}
 	private:
-		static constexpr std::array<std::underlying_type_t<Purpose>, 4> command_purpose{
-			static_cast<purpose_t>(Purpose::FileIO),
-			static_cast<purpose_t>(Purpose::Insert),
-			static_cast<purpose_t>(Purpose::Remove),
-			static_cast<purpose_t>(Purpose::EditFields)
-		};
-
 		enum class State {
 			Default,
 			Executed,
 			Cancelled
 		};
 		void register_execute() {
-			if (m_state == State::Executed) {											//   
+			if (m_state == State::Executed) {											//Повторное выполнение команды запрещено
 				throw_impossible_to_execute();
 			}
 			m_state = State::Executed;
 		}
-		void register_cancel() {													//   
+		void register_cancel() {													//Отмена невыполненной команды недопустима
 			if (m_state != State::Executed) {
 				throw_impossible_to_execute();
 			}
@@ -144,20 +177,23 @@ namespace command {
 	using command_holder = object_holder<ICommand<TargetTy>>;
 
 	/***********************************************************
-	 ,  
-	ObjectPool   ICommand
+	Промежуточный класс, объединяющий возможности
+	ObjectPool и интерфейс ICommand
 	***********************************************************/
 	template <class ConcreteCommand, class TargetTy>
 	class AllocatedCommand : public ObjectPool<ICommand<TargetTy>, ConcreteCommand>, public ICommand<TargetTy> {
 	public:
 		using MyAllocationBase = ObjectPool<ICommand<TargetTy>, ConcreteCommand>;
 		using MyCommandBase = ICommand<TargetTy>;
-		using command_holder = command_holder<TargetTy>;
+		using command_holder = command::command_holder<TargetTy>;
 	public:
 		using MyCommandBase::MyCommandBase;
-		static command_holder make_instance(TargetTy& target) {						//      
+		static command_holder make_instance(TargetTy& target) {						//Для классов команд без дополнительных аргументов конструктора
 			return MyAllocationBase::allocate_instance(target);
 		}
+		size_t RetainedMemory() const noexcept override {							//Команды, владеющие узлами XML, дополняют оценку размером поддерева
+			return sizeof(ConcreteCommand);
+		}
 	};
 }
 
@@ -0,0 +1,35 @@
+#pragma once
+#include "command_interface.h"
+#include "company_manager_engine.h"
+
+#include <string_view>
+
+/***********************************************************
+Типы результатов команд над CompanyManager (file_io и
+xml_wrapper). Заголовок подключается всеми файлами
+объявлений этих команд, поэтому специализация видна
+до первого использования ICommand<CompanyManager>
+************************************************************/
+
+namespace command {
+	namespace xml_wrapper {
+		struct ImportStatistics {														//Результат ImportEmployees::Execute()
+			size_t
+				inserted{ 0 },
+				duplicates{ 0 },
+				departments_created{ 0 };
+		};
+	}
+
+	template <>
+	struct result_traits<CompanyManager> {
+		using type = basic_result<														//size_t также хранит wrapper::Employee::salary_t
+			std::string_view,															//file_io::GetPath
+			worker::file_operation::Result,												//file_io::Load, file_io::Save
+			wrapper::RenameResult,
+			wrapper::Company::department_it,
+			wrapper::Department::employee_it,
+			xml_wrapper::ImportStatistics
+		>;
+	};
+}
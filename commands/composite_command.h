@@ -0,0 +1,111 @@
+#pragma once
+#include "command_interface.h"
+
+#include <vector>
+#include <utility>
+
+/***********************************************************
+Шаблон Composite объединяет последовательность команд
+в единую единицу отмены/повтора. Подкоманды выполняются
+в порядке добавления и отменяются в обратном порядке.
+Если одна из подкоманд завершается с ошибкой, уже
+обработанные подкоманды возвращаются в исходное
+состояние, и исключение передаётся вызывающему коду -
+таким образом Composite либо применяется целиком,
+либо не применяется вовсе
+************************************************************/
+
+namespace command {
+	template <class TargetTy>
+	class Composite : public AllocatedCommand<Composite<TargetTy>, TargetTy> {
+	public:
+		using MyBase = AllocatedCommand<Composite<TargetTy>, TargetTy>;
+		using command_holder = typename MyBase::command_holder;
+		using command_list = std::vector<command_holder>;
+		using result_type = typename MyBase::result_type;
+	public:
+		Composite(TargetTy& target, command_list commands = {}) noexcept
+			: MyBase(target), m_commands(std::move(commands))
+		{
+		}
+
+		result_type Execute() override {												//return type: size_t (количество выполненных подкоманд)
+			size_t executed_count{ 0 };
+			try {
+				for (; executed_count < m_commands.size(); ++executed_count) {
+					m_commands[executed_count]->Execute();
+				}
+			}
+			catch (...) {
+				cancel_range(executed_count);
+				throw;
+			}
+			return executed_count;
+		}
+
+		result_type Cancel() override {												//return type: size_t (количество отменённых подкоманд)
+			size_t not_cancelled_count{ m_commands.size() };
+			try {
+				for (; not_cancelled_count > 0; --not_cancelled_count) {
+					m_commands[not_cancelled_count - 1]->Cancel();
+				}
+			}
+			catch (...) {
+				execute_range(not_cancelled_count);
+				throw;
+			}
+			return m_commands.size();
+		}
+
+		Type GetType() const noexcept override {
+			return Type::Batch;
+		}
+
+		size_t RetainedMemory() const noexcept override {
+			size_t usage{ MyBase::RetainedMemory() + m_commands.capacity() * sizeof(command_holder) };
+			for (const auto& command : m_commands) {
+				usage += command->RetainedMemory();
+			}
+			return usage;
+		}
+
+		Composite& Append(command_holder&& command) {								//Добавленная команда считается выполненной вместе с предыдущими
+			m_commands.push_back(std::move(command));
+			return *this;
+		}
+
+		size_t Size() const noexcept {
+			return m_commands.size();
+		}
+
+		bool Empty() const noexcept {
+			return m_commands.empty();
+		}
+
+		static command_holder make_instance(TargetTy& target, command_list commands) {
+			return MyBase::allocate_instance(target, std::move(commands));
+		}
+	private:
+		void cancel_range(size_t executed_count) noexcept {							//Откат при неудачном Execute()
+			while (executed_count > 0) {
+				try {
+					m_commands[--executed_count]->Cancel();
+				}
+				catch (...) {														//Исходное исключение важнее ошибки отката
+				}
+			}
+		}
+
+		void execute_range(size_t first_not_cancelled) noexcept {					//Повтор при неудачном Cancel()
+			for (; first_not_cancelled < m_commands.size(); ++first_not_cancelled) {
+				try {
+					m_commands[first_not_cancelled]->Execute();
+				}
+				catch (...) {
+				}
+			}
+		}
+	private:
+		command_list m_commands;
+	};
+}
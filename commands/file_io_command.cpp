@@ -5,7 +5,7 @@ namespace command {
 	namespace file_io {
 	/*GetPath*/
 
-		any GetPath::Execute() {
+		result_t<CompanyManager> GetPath::Execute() {
 			return get_target().GetPath();
 		}
 
@@ -21,7 +21,7 @@ namespace command {
 		{
 		}
 
-		any SetPath::Execute() {
+		result_t<CompanyManager> SetPath::Execute() {
 			get_target().SetPath(move(m_path));
 			return make_default_value();
 		}
@@ -36,7 +36,7 @@ namespace command {
 
 	/*CreateDocument*/
 
-		any CreateDocument::Execute() {
+		result_t<CompanyManager> CreateDocument::Execute() {
 			get_target().Create();
 			return make_default_value();
 		}
@@ -47,7 +47,7 @@ namespace command {
 
 	/*Load*/
 
-		any Load::Execute() {
+		result_t<CompanyManager> Load::Execute() {
 			return get_target().Load();
 		}
 
@@ -57,7 +57,7 @@ namespace command {
 
 	/*Save*/
 
-		any Save::Execute() {
+		result_t<CompanyManager> Save::Execute() {
 			return get_target().Save();
 		}
 
@@ -67,7 +67,7 @@ namespace command {
 
 	/*CheckLoaded*/
 
-		any CheckLoaded::Execute() {
+		result_t<CompanyManager> CheckLoaded::Execute() {
 			return get_target().IsLoaded();
 		}
 
@@ -75,7 +75,7 @@ namespace command {
 			return Type::File_CheckLoaded;
 		}
 
-		any CheckSaved::Execute() {
+		result_t<CompanyManager> CheckSaved::Execute() {
 			return get_target().IsSaved();
 		}
 
@@ -83,7 +83,7 @@ namespace command {
 			return Type::File_CheckSaved;
 		}
 
-		any Reset::Execute() {
+		result_t<CompanyManager> Reset::Execute() {
 			get_target().Reset();
 			return make_default_value();
 		}
@@ -1,4 +1,5 @@
 #include "command_interface.h"
+#include "company_manager_result.h"
 #include "company_manager_engine.h"
 
 namespace command {
@@ -9,7 +10,7 @@ namespace command {
 			using MyBase = AllocatedCommand<ConcreteCommand, CompanyManager>;
 		public:
 			using MyBase::MyBase;
-			std::any Cancel() override {									//       
+			result_t<CompanyManager> Cancel() override {					//Дочерние классы все ещё могут переопределить операцию отмены
 				throw std::logic_error("File IO operations can't be cancelled");
 			}
 		};
@@ -19,7 +20,7 @@ namespace command {
 			using MyBase = CommandBase<GetPath>;
 		public:
 			using MyBase::MyBase;
-			std::any Execute() override;
+			result_t<CompanyManager> Execute() override;
 			Type GetType() const noexcept override;
 		};
 
@@ -28,7 +29,7 @@ namespace command {
 			using MyBase = CommandBase<SetPath>;
 		public:
 			SetPath(CompanyManager& cm, std::string path) noexcept;
-			std::any Execute() override;
+			result_t<CompanyManager> Execute() override;
 			Type GetType() const noexcept override;
 			static command_holder make_instance(CompanyManager& cm, std::string path);
 		private:
@@ -40,7 +41,7 @@ namespace command {
 			using MyBase = CommandBase<CreateDocument>;
 		public:
 			using MyBase::MyBase;
-			std::any Execute() override;
+			result_t<CompanyManager> Execute() override;
 			Type GetType() const noexcept override;
 		};
 
@@ -49,7 +50,7 @@ namespace command {
 			using MyBase = CommandBase<Load>;
 		public:
 			using MyBase::MyBase;
-			std::any Execute() override;
+			result_t<CompanyManager> Execute() override;
 			Type GetType() const noexcept override;
 		};
 
@@ -58,7 +59,7 @@ namespace command {
 			using MyBase = CommandBase<Save>;
 		public:
 			using MyBase::MyBase;
-			std::any Execute() override;
+			result_t<CompanyManager> Execute() override;
 			Type GetType() const noexcept override;
 		};
 
@@ -67,7 +68,7 @@ namespace command {
 			using MyBase = CommandBase<CheckLoaded>;
 		public:
 			using MyBase::MyBase;
-			std::any Execute() override;
+			result_t<CompanyManager> Execute() override;
 			Type GetType() const noexcept override;
 		};
 
@@ -76,7 +77,7 @@ namespace command {
 			using MyBase = CommandBase<CheckSaved>;
 		public:
 			using MyBase::MyBase;
-			std::any Execute() override;
+			result_t<CompanyManager> Execute() override;
 			Type GetType() const noexcept override;
 		};
 
@@ -85,7 +86,7 @@ namespace command {
 			using MyBase = CommandBase<Reset>;
 		public:
 			using MyBase::MyBase;
-			std::any Execute() override;
+			result_t<CompanyManager> Execute() override;
 			Type GetType() const noexcept override;
 		};
 	}
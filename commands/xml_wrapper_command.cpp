@@ -12,7 +12,7 @@ namespace command {
 		{
 		}
 
-		any RenameDepartment::Execute() {
+		result_t<CompanyManager> RenameDepartment::Execute() {
 			string old_name(m_current_name);	
 			auto result{										
 				get_tree_ref().RenameDepartment(
@@ -23,7 +23,7 @@ namespace command {
 			return result;
 		}
 
-		any RenameDepartment::Cancel() {
+		result_t<CompanyManager> RenameDepartment::Cancel() {
 			return Execute();								//"data swap"
 		}
 
@@ -31,6 +31,10 @@ namespace command {
 			return Type::Xml_RenameDepartment;
 		}
 
+		size_t RenameDepartment::RetainedMemory() const noexcept {
+			return MyBase::RetainedMemory() + m_new_name.capacity();
+		}
+
 		RenameDepartment::command_holder RenameDepartment::make_instance(
 			CompanyManager& cm,
 			wrapper::string_ref current_name,
@@ -43,18 +47,20 @@ namespace command {
 		{
 		}
 
-		any AddDepartment::Execute() {
+		result_t<CompanyManager> AddDepartment::Execute() {
 			auto it{ 
 				get_tree_ref()
 					.AddDepartment(
 						move(get_wrapper())
 					)
 			};
-			m_value.emplace<wrapper::string_ref>(it->GetName());		//  
+			m_value.emplace<wrapper::string_ref>(it->GetName());		//Сохраняем название подразделения
+			index_department(*it);
 			return it;
 		}
 
-		any AddDepartment::Cancel() {
+		result_t<CompanyManager> AddDepartment::Cancel() {
+			unindex_department(get_tree_ref().at(get_substitute()));
 			m_value = get_tree_ref()
 				.ExtractDepartment(
 					get_substitute()
@@ -78,7 +84,7 @@ namespace command {
 		{
 		}
 
-		any InsertDepartment::Execute() {
+		result_t<CompanyManager> InsertDepartment::Execute() {
 			auto it{ 
 				get_tree_ref()
 					.InsertDepartment(
@@ -86,11 +92,13 @@ namespace command {
 						move(get_wrapper())
 				)
 			};
-			m_value.emplace<wrapper::string_ref>(it->GetName());			//  
+			m_value.emplace<wrapper::string_ref>(it->GetName());			//Сохраняем название подразделения
+			index_department(*it);
 			return it;
 		}
 
-		any InsertDepartment::Cancel() {
+		result_t<CompanyManager> InsertDepartment::Cancel() {
+			unindex_department(get_tree_ref().at(get_substitute()));
 			m_value = get_tree_ref()
 				.ExtractDepartment(
 					get_substitute()
@@ -117,21 +125,22 @@ namespace command {
 		{
 		}
 
-		any RemoveDepartment::Execute() {
+		result_t<CompanyManager> RemoveDepartment::Execute() {
 			auto& tree{ get_tree_ref() };
-			const auto* next{												//     
+			const auto* next{												//Указатель на следующее по списку подразделение
 				tree.TryGetNext(get_substitute())
 			};
 			if (next) {
-				m_before = next->GetName();									//  -  ,   
+				m_before = next->GetName();									//Если удаляемое - не последнее, сохраняем имя следующего
 			}
+			unindex_department(tree.at(get_substitute()));
 			m_value = get_tree_ref().ExtractDepartment(
 				get_substitute()
 			);
 			return make_default_value();
 		}
 
-		any RemoveDepartment::Cancel() {
+		result_t<CompanyManager> RemoveDepartment::Cancel() {
 			auto& tree{ get_tree_ref() };
 			department_it it;
 			if (m_before) {
@@ -141,9 +150,10 @@ namespace command {
 				);
 			}
 			else {
-				it = tree.AddDepartment(move(get_wrapper()));					//  
+				it = tree.AddDepartment(move(get_wrapper()));					//Сохраняем наименование подразделения
 			}
 			m_value = it->GetName();
+			index_department(*it);
 			return it;
 		}
 
@@ -158,15 +168,17 @@ namespace command {
 			return allocate_instance(cm, department);
 		}
 
-		any ChangeEmployeeSurname::Execute() {
+		result_t<CompanyManager> ChangeEmployeeSurname::Execute() {
 			auto& employee{ get_employee() };					
 			string old_surname(employee.GetSurname());
+			unindex_employee(employee);
 			wrapper::RenameResult result{
 				get_department().ChangeEmployeeSurname(
 					get_full_name(),
 					move(m_value)
 				)
 			};
+			index_employee(get_department(), employee);							//Узел перевставляется без перемещения сотрудника
 			m_value = move(old_surname);
 			return result;
 		}
@@ -175,15 +187,17 @@ namespace command {
 			return Type::Xml_ChangeEmployeeSurname;
 		}
 
-		any ChangeEmployeeName::Execute() {
+		result_t<CompanyManager> ChangeEmployeeName::Execute() {
 			auto& employee{ get_employee() };
 			string old_name(employee.GetName());
+			unindex_employee(employee);
 			wrapper::RenameResult result{
 				get_department().ChangeEmployeeName(
 					get_full_name(),
 					move(m_value)
 				)
 			};
+			index_employee(get_department(), employee);							//Узел перевставляется без перемещения сотрудника
 			m_value = move(old_name);
 			return result;
 		}
@@ -192,15 +206,17 @@ namespace command {
 			return Type::Xml_ChangeEmployeeName;
 		}
 
-		any ChangeEmployeeMiddleName::Execute() {
+		result_t<CompanyManager> ChangeEmployeeMiddleName::Execute() {
 			auto& employee{ get_employee() };
 			string old_middle_name(employee.GetMiddleName());
+			unindex_employee(employee);
 			wrapper::RenameResult result{
 				get_department().ChangeEmployeeMiddleName(
 					get_full_name(),
 					move(m_value)
 				)
 			};
+			index_employee(get_department(), employee);							//Узел перевставляется без перемещения сотрудника
 			m_value = move(old_middle_name);
 			return result;
 		}
@@ -209,10 +225,12 @@ namespace command {
 			return Type::Xml_ChangeEmployeeMiddleName;
 		}
 
-		any ChangeEmployeeFunction::Execute() {
+		result_t<CompanyManager> ChangeEmployeeFunction::Execute() {
 			auto& employee{ get_employee() };
 			string old_function(employee.GetFunction());
-			employee.SetFunction(move(m_value));
+			unindex_employee(employee);
+			get_department().ChangeEmployeeFunction(get_full_name(), move(m_value));
+			index_employee(get_department(), employee);
 			m_value = move(old_function);
 			return make_default_value();
 		}
@@ -221,11 +239,14 @@ namespace command {
 			return Type::Xml_ChangeEmployeeFunction;
 		}
 
-		any UpdateEmployeeSalary::Execute() {
-			salary_t previous_value{ get_employee().GetSalary() };
+		result_t<CompanyManager> UpdateEmployeeSalary::Execute() {
+			auto& employee{ get_employee() };
+			salary_t previous_value{ employee.GetSalary() };
+			unindex_employee(employee);
 			get_department().UpdateEmployeeSalary(
 				get_full_name(), get_value()
 			);
+			index_employee(get_department(), employee);
 			m_value = previous_value;
 			return previous_value;
 		}
@@ -242,17 +263,19 @@ namespace command {
 		{
 		}
 
-		any InsertEmployee::Execute() {
+		result_t<CompanyManager> InsertEmployee::Execute() {
 			auto it{
 				get_department().InsertEmployee(
 					std::move(get_wrapper())
 				)
 			};
 			m_value = it->first;													//FullNameRef
+			index_employee(get_department(), it->second);
 			return it;
 		}
 
-		any InsertEmployee::Cancel() {
+		result_t<CompanyManager> InsertEmployee::Cancel() {
+			unindex_employee(get_department().at(get_substitute()));
 			m_value = get_department().ExtractEmployee(
 				get_substitute()
 			);
@@ -278,20 +301,22 @@ namespace command {
 		{
 		}
 
-		any RemoveEmployee::Execute() {
+		result_t<CompanyManager> RemoveEmployee::Execute() {
+			unindex_employee(get_department().at(get_substitute()));
 			m_value = get_department().ExtractEmployee(
 				get_substitute()
 			);
 			return make_default_value();
 		}
 
-		any RemoveEmployee::Cancel() {
+		result_t<CompanyManager> RemoveEmployee::Cancel() {
 			auto it{
 				get_department().InsertEmployee(
 					std::move(get_wrapper())
 				)
 			};
 			m_value = it->first;													//FullNameRef
+			index_employee(get_department(), it->second);
 			return it;
 		}
 
@@ -305,5 +330,100 @@ namespace command {
 		) {
 			return allocate_instance(cm, employee);
 		}
+
+		ImportEmployees::ImportEmployees(CompanyManager& cm, vector<wrapper::StaffList> staff)
+			: MyBase(cm)
+		{
+			m_staff.reserve(staff.size());
+			for (auto& [department, employees] : staff) {
+				m_staff.push_back(DepartmentStaff{ move(department), move(employees), {}, nullopt, false });
+			}
+		}
+
+		result_t<CompanyManager> ImportEmployees::Execute() {
+			Statistics stats;
+			for (auto& staff : m_staff) {
+				auto& department{ prepare_department(staff, stats) };
+				vector<wrapper::FullNameRef> candidates;
+				candidates.reserve(staff.pending.size());
+				for (const auto& employee : staff.pending) {
+					candidates.push_back(employee.GetFullName());
+				}
+				auto duplicates{ department.InsertEmployees(move(staff.pending)) };	//Узлы дубликатов живы до конца итерации, 
+				staff.pending.clear();												//поэтому ссылки на их поля остаются валидными
+				staff.inserted.clear();
+				for (const auto& full_name : candidates) {
+					auto it{ department.Find(full_name) };							//Вставленный сотрудник - тот, чей ключ ссылается на ту же строку
+					if (addressof(it->first.surname.get()) == addressof(full_name.surname.get())) {
+						staff.inserted.push_back(full_name);
+					}
+				}
+				for (const auto& full_name : staff.inserted) {
+					index_employee(department, department.at(full_name));
+				}
+				stats.inserted += staff.inserted.size();
+				stats.duplicates += candidates.size() - staff.inserted.size();
+			}
+			return stats;
+		}
+
+		result_t<CompanyManager> ImportEmployees::Cancel() {
+			auto& company{ get_tree_ref() };
+			for (auto staff_it = m_staff.rbegin(); staff_it != m_staff.rend(); ++staff_it) {		//В порядке, обратном вставке
+				auto& department{ company.at(staff_it->name) };
+				staff_it->pending.reserve(staff_it->inserted.size());
+				for (const auto& full_name : staff_it->inserted) {
+					unindex_employee(department.at(full_name));
+					staff_it->pending.push_back(department.ExtractEmployee(full_name));
+				}
+				staff_it->inserted.clear();
+				if (staff_it->created) {
+					staff_it->extracted = company.ExtractDepartment(staff_it->name);
+				}
+			}
+			return make_default_value();
+		}
+
+		Type ImportEmployees::GetType() const noexcept {
+			return Type::Xml_ImportEmployees;
+		}
+
+		size_t ImportEmployees::RetainedMemory() const noexcept {
+			size_t usage{ MyBase::RetainedMemory() + m_staff.capacity() * sizeof(DepartmentStaff) };
+			for (const auto& staff : m_staff) {
+				usage += staff.name.capacity() + staff.inserted.capacity() * sizeof(wrapper::FullNameRef);
+				for (const auto& employee : staff.pending) {
+					usage += sizeof(wrapper::Employee) + employee.MemoryUsage();
+				}
+				if (staff.extracted) {
+					usage += staff.extracted->MemoryUsage();
+				}
+			}
+			return usage;
+		}
+
+		ImportEmployees::command_holder ImportEmployees::make_instance(CompanyManager& cm, vector<wrapper::StaffList> staff) {
+			return allocate_instance(cm, move(staff));
+		}
+
+		wrapper::Department& ImportEmployees::prepare_department(DepartmentStaff& staff, Statistics& stats) {
+			auto& company{ get_tree_ref() };
+			if (staff.extracted) {													//Повтор после отмены
+				auto& department{ *company.AddDepartment(move(*staff.extracted)) };
+				staff.extracted.reset();
+				return department;
+			}
+			if (company.Containts(staff.name)) {
+				return company.at(staff.name);
+			}
+			staff.created = true;
+			++stats.departments_created;
+			return *company.AddDepartment(
+				wrapper::DepartmentBuilder()
+					.SetName(staff.name)
+					.SetAllocator(get_target().GetAllocator())
+					.Assemble()
+			);
+		}
 	}
 }
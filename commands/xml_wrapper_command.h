@@ -1,8 +1,11 @@
 #pragma once
 #include "command_interface.h"
+#include "company_manager_result.h"
 #include "company_manager_engine.h"
 
 #include <utility>
+#include <vector>
+#include <optional>
 #include <variant>
 #include <string_view>
 #include <type_traits>
@@ -15,12 +18,34 @@ namespace command {
 		public:
 			using MyBase::MyBase;
 		protected:
-			wrapper::Company* get_tree_ptr() {									//    Modify()  
+			wrapper::Company* get_tree_ptr() {									//При отсутствии открытого документа Modify() выбросит исключение
                 return std::addressof(MyBase::get_target().Modify());
 			}
 			wrapper::Company& get_tree_ref() {
                 return MyBase::get_target().Modify();
 			}
+
+			/*** Поддержка индекса поиска: записи удаляются, пока узлы живы, и добавляются после изменения ***/
+			void index_employee(const wrapper::Department& department, const wrapper::Employee& employee) {
+				if (auto* index = MyBase::get_target().GetSearchIndex()) {
+					index->Insert(department, employee);
+				}
+			}
+			void unindex_employee(const wrapper::Employee& employee) {
+				if (auto* index = MyBase::get_target().GetSearchIndex()) {
+					index->Erase(employee);
+				}
+			}
+			void index_department(const wrapper::Department& department) {
+				if (auto* index = MyBase::get_target().GetSearchIndex()) {
+					index->InsertDepartment(department);
+				}
+			}
+			void unindex_department(const wrapper::Department& department) {
+				if (auto* index = MyBase::get_target().GetSearchIndex()) {
+					index->EraseDepartment(department);
+				}
+			}
 		};
 
 		class RenameDepartment : public ModifyCommand<RenameDepartment> {
@@ -33,9 +58,10 @@ namespace command {
 				wrapper::string_ref current_name,
 				std::string new_name
 			) noexcept;
-			std::any Execute() override;									//return type: wrapper::RenameResult
-			std::any Cancel() override;										//return type: wrapper::RenameResult
+			result_t<CompanyManager> Execute() override;					//return type: wrapper::RenameResult
+			result_t<CompanyManager> Cancel() override;						//return type: wrapper::RenameResult
 			Type GetType() const noexcept override;
+			size_t RetainedMemory() const noexcept override;
 			static command_holder make_instance(
 				CompanyManager& cm,
 				wrapper::string_ref current_name,
@@ -52,15 +78,22 @@ namespace command {
 			using MyBase = ModifyCommand<ConcreteCommand>;
 			using command_holder = typename MyBase::command_holder;
 		public:
-			ModifyCompany(CompanyManager& cm, const SubstituteTy& substitute)		//SubstituteTy   	
+			ModifyCompany(CompanyManager& cm, const SubstituteTy& substitute)		//SubstituteTy должен дёшево копироваться	
 				noexcept(std::is_nothrow_copy_constructible_v<SubstituteTy>)
 				: MyBase(cm), m_value(substitute) 
 			{
 			}
-			ModifyCompany(CompanyManager& cm, WrapperTy&& value) noexcept		    //  move c-tor
+			ModifyCompany(CompanyManager& cm, WrapperTy&& value) noexcept		    //Экономия вызова move c-tor
 				: MyBase(cm), m_value(std::move(value))
 			{
 			}
+			size_t RetainedMemory() const noexcept override {						//Извлечённое поддерево принадлежит команде до её уничтожения
+				size_t usage{ MyBase::RetainedMemory() };
+				if (std::holds_alternative<WrapperTy>(m_value)) {
+					usage += std::get<WrapperTy>(m_value).MemoryUsage();
+				}
+				return usage;
+			}
 		protected:
 			WrapperTy& get_wrapper() {
                 return std::get<WrapperTy>(m_value);
@@ -77,17 +110,17 @@ namespace command {
 
 		class AddDepartment : public ModifyCompany<AddDepartment, wrapper::Department, wrapper::string_ref> {
 		public:																			
-			using MyBase = ModifyCompany<AddDepartment, wrapper::Department, wrapper::string_ref>;  //  , ..   
-			using command_holder = MyBase::command_holder;										//   "--<>"	
+			using MyBase = ModifyCompany<AddDepartment, wrapper::Department, wrapper::string_ref>;  //Хранить итератор нельзя, т.к. он может инвалидироваться
+			using command_holder = MyBase::command_holder;										//при последовательности операций "вставка-удаление-<отмена>"	
 		public:
 			AddDepartment(CompanyManager& cm, wrapper::Department&& department) noexcept;
-			std::any Execute() override;										//return type: wrapper::Company::department_it	
-			std::any Cancel() override;											//return type: empty std::any
+			result_t<CompanyManager> Execute() override;						//return type: wrapper::Company::department_it	
+			result_t<CompanyManager> Cancel() override;							//return type: std::monostate
 			Type GetType() const noexcept override;
 			static command_holder make_instance(CompanyManager& cm, wrapper::Department&& department);
 		};
 
-		//- ObjectPool'a    AddDepartment 
+		//Из-за ObjectPool'a неследоваться напрямую от AddDepartment нельзя
 		class InsertDepartment : public ModifyCompany<InsertDepartment, wrapper::Department, wrapper::string_ref> {
 		public:
 			using MyBase = ModifyCompany<InsertDepartment, wrapper::Department, wrapper::string_ref>;
@@ -98,8 +131,8 @@ namespace command {
 				wrapper::string_ref before,
 				wrapper::Department&& department
 			) noexcept;
-			std::any Execute() override;										//return type: wrapper::Company::department_it	
-			std::any Cancel() override;											//return type: empty std::any	
+			result_t<CompanyManager> Execute() override;						//return type: wrapper::Company::department_it	
+			result_t<CompanyManager> Cancel() override;							//return type: std::monostate	
 			Type GetType() const noexcept override;
 			static command_holder make_instance(
 				CompanyManager& cm,
@@ -120,8 +153,8 @@ namespace command {
 				CompanyManager& cm,
 				wrapper::string_ref department
 			) noexcept;
-			std::any Execute() override;										//return type: empty std::any	
-			std::any Cancel() override;											//return type: wrapper::Company::department_it	
+			result_t<CompanyManager> Execute() override;						//return type: std::monostate	
+			result_t<CompanyManager> Cancel() override;							//return type: wrapper::Company::department_it	
 			Type GetType() const noexcept override;
 			static command_holder make_instance(
 				CompanyManager& cm,
@@ -132,12 +165,12 @@ namespace command {
 		};
 
 		/************************************************************************************************************************
-		   EmployeePersonalFile  FullNameRef,   ?
-		 FullNameRef     XML-  Employee.    - xml::container_t = 
-		   ,  ,     ,  node_holder'.
-		         ,    , 
-		  ,      XML-Employee (surname, name, middle_name, function, salary) 
-		  .
+		Почему можно в EmployeePersonalFile хранить FullNameRef, не опасаясь инвалидации?
+		Поля FullNameRef ссылаются на дочерние узлы XML-узла типа Employee. Контейнер дочерних узлов - xml::container_t = 
+		перемещается без перемещения элементов, кроме того, он содержит не сами узлы, а node_holder'ы.
+		Поскольку все операции вставки и удаления извлекают данные из хранилищ, а не удаляют непосредственно, 
+		инвалидируются лишь итераторы, а все текстовые дочерние узлы XML-Employee (surname, name, middle_name, function, salary) 
+		продолжат быть доступны.
 		*************************************************************************************************************************/
 
 		struct EmployeePersonalFile {
@@ -159,9 +192,16 @@ namespace command {
 				: MyBase(cm), m_employee(employee), m_value(std::move(value))
 			{
 			}
-			std::any Cancel() override {
+			result_t<CompanyManager> Cancel() override {
 				return static_cast<ConcreteCommand*>(this)->Execute();						//"data swap"
 			}
+			bool Absorb(const ICommand<CompanyManager>& next) noexcept override {			//Правка того же поля того же сотрудника: m_value уже хранит
+				if (next.GetType() != this->GetType()) {										//исходное значение, а документ - итоговое
+					return false;
+				}
+				const auto& other{ static_cast<const ModifyEmployeeFields&>(next) };
+				return refers_to_same_employee(other.m_employee);
+			}
             static command_holder make_instance(
                 CompanyManager& cm,
                 const EmployeePersonalFile& employee,
@@ -182,6 +222,13 @@ namespace command {
 			wrapper::Employee& get_employee() {
 				return get_department().at(get_full_name());
 			}	
+			bool refers_to_same_employee(const EmployeePersonalFile& other) const noexcept {	//Ссылки на текстовые узлы сотрудника не инвалидируются (см. выше)
+				const auto& [department, full_name] {m_employee};
+				return std::addressof(department.get()) == std::addressof(other.department_name.get())
+					&& std::addressof(full_name.surname.get()) == std::addressof(other.employee_name.surname.get())
+					&& std::addressof(full_name.name.get()) == std::addressof(other.employee_name.name.get())
+					&& std::addressof(full_name.middle_name.get()) == std::addressof(other.employee_name.middle_name.get());
+			}
 		protected:
 			EmployeePersonalFile m_employee;
 			SwappedFieldTy m_value;
@@ -194,6 +241,9 @@ namespace command {
 			using command_holder = typename MyBase::command_holder;
 		public:
 			using MyBase::MyBase;
+			size_t RetainedMemory() const noexcept override {
+				return MyBase::RetainedMemory() + MyBase::m_value.capacity();
+			}
 		};
 
 		class ChangeEmployeeSurname : public ModifyEmployeeTextFields<ChangeEmployeeSurname> {
@@ -202,7 +252,7 @@ namespace command {
 			using command_holder = MyBase::command_holder;
 		public:
 			using MyBase::MyBase;
-			std::any Execute() override;										//return type: wrapper::RenameResult
+			result_t<CompanyManager> Execute() override;						//return type: wrapper::RenameResult
             Type GetType() const noexcept override;
 		};
 
@@ -212,7 +262,7 @@ namespace command {
 			using command_holder = MyBase::command_holder;
 		public:
 			using MyBase::MyBase;
-			std::any Execute() override;										//return type: empty std::any
+			result_t<CompanyManager> Execute() override;						//return type: std::monostate
             Type GetType() const noexcept override;
 		};
 
@@ -222,7 +272,7 @@ namespace command {
 			using command_holder = MyBase::command_holder;
 		public:
 			using MyBase::MyBase;	
-			std::any Execute() override;										//return type: empty std::any
+			result_t<CompanyManager> Execute() override;						//return type: std::monostate
             Type GetType() const noexcept override;
 		};
 
@@ -232,7 +282,7 @@ namespace command {
 			using command_holder = MyBase::command_holder;
 		public:
 			using MyBase::MyBase;
-			std::any Execute() override;										//return type: empty std::any
+			result_t<CompanyManager> Execute() override;						//return type: std::monostate
             Type GetType() const noexcept override;
 		};
 
@@ -243,7 +293,7 @@ namespace command {
 			using salary_t = wrapper::Employee::salary_t;
 		public:
 			using MyBase::MyBase;
-			std::any Execute() override;										//return type: salary_t (salary before execute)
+			result_t<CompanyManager> Execute() override;						//return type: salary_t (salary before execute)
             Type GetType() const noexcept override;
 		};
 
@@ -287,8 +337,8 @@ namespace command {
 				wrapper::string_ref department,
 				wrapper::Employee&& employee
 			) noexcept;
-			std::any Execute() override;										//return type: wrapper::Department::employee_it
-			std::any Cancel() override;											//return type: empty std::any
+			result_t<CompanyManager> Execute() override;						//return type: wrapper::Department::employee_it
+			result_t<CompanyManager> Cancel() override;							//return type: std::monostate
 			Type GetType() const noexcept override;
 			static command_holder make_instance(
 				CompanyManager& cm,
@@ -297,7 +347,7 @@ namespace command {
 			);
 		};
 
-		class RemoveEmployee : public ModifyDepartment<RemoveEmployee> {		// ,     InsertEmployee
+		class RemoveEmployee : public ModifyDepartment<RemoveEmployee> {		//Выполняет действия, полность обратные операциям в InsertEmployee
 		public:
 			using MyBase = ModifyDepartment<RemoveEmployee>;
 			using command_holder = MyBase::command_holder;
@@ -306,13 +356,45 @@ namespace command {
 				CompanyManager& cm,
 				const EmployeePersonalFile& employee
 			);
-			std::any Execute() override;										//return type: empty std::anyt
-			std::any Cancel() override;											//return type: wrapper::Department::employee_i
+			result_t<CompanyManager> Execute() override;						//return type: std::monostate
+			result_t<CompanyManager> Cancel() override;							//return type: wrapper::Department::employee_it
 			Type GetType() const noexcept override;
 			static command_holder make_instance(
 				CompanyManager& cm,
 				const EmployeePersonalFile& employee
 			);
 		};
+
+		/************************************************************************************************************************
+		ImportEmployees выполняет пакетную вставку сотрудников (например, загруженных из CSV/TSV) как одну команду.
+		Отсутствующие подразделения создаются в конце списка. При отмене вставленные сотрудники и созданные подразделения
+		извлекаются и хранятся в команде - так же, как в InsertEmployee, что делает повтор дешёвым.
+		Сотрудники, уже имеющиеся в подразделении, отбрасываются.
+		*************************************************************************************************************************/
+
+		class ImportEmployees : public ModifyCommand<ImportEmployees> {
+		public:
+			using MyBase = ModifyCommand<ImportEmployees>;
+			using command_holder = MyBase::command_holder;
+			using Statistics = ImportStatistics;
+		public:
+			ImportEmployees(CompanyManager& cm, std::vector<wrapper::StaffList> staff);
+			result_t<CompanyManager> Execute() override;						//return type: Statistics
+			result_t<CompanyManager> Cancel() override;							//return type: std::monostate
+			Type GetType() const noexcept override;
+			size_t RetainedMemory() const noexcept override;
+			static command_holder make_instance(CompanyManager& cm, std::vector<wrapper::StaffList> staff);
+		protected:
+			struct DepartmentStaff {
+				std::string name;
+				std::vector<wrapper::Employee> pending;							//Сотрудники, ожидающие вставки
+				std::vector<wrapper::FullNameRef> inserted;						//Вставленные при последнем Execute()
+				std::optional<wrapper::Department> extracted;					//Созданное командой и извлечённое при отмене подразделение
+				bool created{ false };
+			};
+			wrapper::Department& prepare_department(DepartmentStaff& staff, Statistics& stats);
+		protected:
+			std::vector<DepartmentStaff> m_staff;
+		};
 	}
 }
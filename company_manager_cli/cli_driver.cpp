@@ -0,0 +1,581 @@
+#include "cli_driver.h"
+#include "tracing.h"
+
+#include <fstream>
+#include <iomanip>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+using namespace std;
+
+namespace cli {
+	Driver::Driver(ostream& output, ostream& log, Settings settings)
+		: m_output(addressof(output)), m_log(addressof(log)), m_settings(move(settings))
+	{
+		if (m_settings.metrics_period_ms) {
+			chrono::milliseconds period{ m_settings.metrics_period_ms };
+			m_service.SetMetricsDump(
+				[this](const task::Metrics& metrics) { report_metrics(*m_log, "service", metrics); }, period
+			);
+			m_modify.SetMetricsDump(
+				[this](const task::Metrics& metrics) { report_metrics(*m_log, "modify", metrics); }, period
+			);
+		}
+		for (auto field : m_settings.shared_fields) {
+			m_company_manager.ShareValues(field);
+		}
+	}
+
+	int Driver::Run() {
+		bool success{ true };
+		bool tracing_enabled{ !m_settings.trace_path.empty() };
+		if (tracing_enabled) {
+			tracing::Tracer::Instance().SetThreadName("main");
+			tracing::Tracer::Instance().Start();
+		}
+		auto start{ clock::now() };
+
+		PipelineBuilder pipeline;
+		for (const auto& operation : m_settings.operations) {
+			pipeline.AddHandler(
+				[this, &operation](bool& success) {									//Захват this и ссылки - в пределах SSO std::function
+					success = run_operation(operation);
+					return success;													//Ошибка прерывает цепочку
+				});
+		}
+		if (!m_settings.operations.empty()) {
+			pipeline.Assemble()->Process(success);
+		}
+		report_timing(Operation{ "total", {} }, success, clock::now() - start);
+		if (tracing_enabled) {
+			auto& tracer{ tracing::Tracer::Instance() };
+			tracer.Stop();
+			if (!tracer.SaveChromeTrace(m_settings.trace_path)) {
+				success = fail("Unable to write " + m_settings.trace_path);
+			}
+		}
+		return success ? ExitCode::Success : ExitCode::OperationFailed;
+	}
+
+	Settings Driver::ParseCommandLine(int argc, const char* const argv[]) {
+		Settings settings;
+		auto next_value{
+			[argc, argv](int& idx, string_view option) -> string {
+				if (idx + 1 >= argc) {
+					throw usage_error("Missing value for " + string(option));
+				}
+				return argv[++idx];
+			}
+		};
+		for (int idx = 1; idx < argc; ++idx) {
+			string_view arg{ argv[idx] };
+			if (arg == "--help" || arg == "-h") {
+				settings.show_help = true;
+			}
+			else if (arg == "--timing") {
+				string format{ next_value(idx, arg) };
+				if (format == "text") {
+					settings.timing = TimingFormat::Text;
+				}
+				else if (format == "json") {
+					settings.timing = TimingFormat::Json;
+				}
+				else {
+					throw usage_error("Unknown timing format: " + format);
+				}
+			}
+			else if (arg == "--threads") {
+				string count{ next_value(idx, arg) };
+				try {
+					settings.thread_count = stoul(count);
+				}
+				catch (const exception&) {
+					throw usage_error("Invalid thread count: " + count);
+				}
+			}
+			else if (arg == "--metrics-period") {
+				string period{ next_value(idx, arg) };
+				try {
+					settings.metrics_period_ms = stoul(period);
+				}
+				catch (const exception&) {
+					throw usage_error("Invalid metrics period: " + period);
+				}
+			}
+			else if (arg == "--trace") {
+				settings.trace_path = next_value(idx, arg);
+			}
+			else if (arg == "--share-values") {
+				string fields{ next_value(idx, arg) };
+				for (size_t first = 0; first <= fields.size(); ) {
+					size_t last{ min(fields.find(',', first), fields.size()) };
+					string_view name{ string_view(fields).substr(first, last - first) };
+					bool found{ false };
+					for (size_t field_idx = 0; field_idx < wrapper::Employee::FIELD_COUNT && !found; ++field_idx) {
+						auto field{ static_cast<wrapper::Employee::Field>(field_idx) };
+						if (wrapper::Employee::GetFieldName(field) == name && wrapper::Employee::IsShareable(field)) {
+							settings.shared_fields.push_back(field);
+							found = true;
+						}
+					}
+					if (!found) {
+						throw usage_error("Field can't be shared: " + string(name));
+					}
+					first = last + 1;
+				}
+			}
+			else {
+				const OperationInfo* info{ find_operation(arg) };
+				if (!info) {
+					throw usage_error("Unknown operation: " + string(arg));
+				}
+				Operation operation{ string(info->name), {} };
+				for (size_t arg_idx = 0; arg_idx < info->arity; ++arg_idx) {
+					operation.args.push_back(next_value(idx, arg));
+				}
+				settings.operations.push_back(move(operation));
+			}
+		}
+		return settings;
+	}
+
+	void Driver::PrintUsage(ostream& out) {
+		out << "Usage: CompanyManagerCLI [--timing text|json] [--threads N] [--metrics-period MS] [--trace FILE]\n"
+			<< "                         [--share-values function,salary] OPERATION...\n"
+			<< "Operations are executed in order; the first failure stops the run.\n"
+			<< "--trace writes spans in Chrome Trace JSON (chrome://tracing, ui.perfetto.dev).\n"
+			<< "--share-values keeps repeated values of the listed fields once per loaded document.\n\n";
+		for (const auto& info : get_operations()) {
+			string synopsis{ "--" + string(info.name) + ' ' + string(info.arguments) };
+			out << "  " << left << setw(40) << synopsis << info.description << '\n';
+		}
+	}
+
+	const Driver::operation_table& Driver::get_operations() {
+		static const operation_table operations{
+			{ "create", "", "create an empty document", 0, &Driver::create },
+			{ "load", "FILE", "load an XML document", 1, &Driver::load },
+			{ "save", "", "save the document to its current path", 0, &Driver::save },
+			{ "save-as", "FILE", "save the document to FILE", 1, &Driver::save_as },
+			{ "import", "TABLE", "import employees from CSV/TSV", 1, &Driver::import_table },
+			{ "export", "TABLE", "export employees to CSV/TSV", 1, &Driver::export_table },
+			{ "stats", "", "print headcount and average salary per department", 0, &Driver::stats },
+			{ "find", "SURNAME", "print employees with the given surname", 1, &Driver::find },
+			{ "metrics", "", "print per-command latency and undo history memory", 0, &Driver::metrics },
+			{ "add-department", "NAME", "add an empty department", 1, &Driver::add_department },
+			{ "remove-department", "NAME", "remove a department with its staff", 1, &Driver::remove_department },
+			{ "index-salary", "DEPARTMENT|* PERCENT", "change salaries by PERCENT", 2, &Driver::index_salary },
+			{ "undo", "", "cancel the last editing operation", 0, &Driver::undo }
+		};
+		return operations;
+	}
+
+	const Driver::OperationInfo* Driver::find_operation(string_view name) {
+		constexpr string_view prefix{ "--" };
+		if (name.substr(0, prefix.size()) != prefix) {
+			return nullptr;
+		}
+		name.remove_prefix(prefix.size());
+		const auto& operations{ get_operations() };
+		auto it{
+			find_if(
+				operations.begin(), operations.end(),
+				[name](const OperationInfo& info) {
+					return info.name == name;
+				})
+		};
+		return it != operations.end() ? addressof(*it) : nullptr;
+	}
+
+	bool Driver::run_operation(const Operation& operation) {
+		bool success{ false };
+		const OperationInfo* info{ find_operation("--" + operation.name) };
+		tracing::Span span(info->name.data(), "cli");									//Имена операций - строковые литералы
+		auto start{ clock::now() };
+		try {
+			success = invoke(info->handler, this, operation.args);
+		}
+		catch (const exception& exc) {
+			success = fail(exc.what());
+		}
+		report_timing(operation, success, clock::now() - start);
+		return success;
+	}
+
+/*Работа с файлами*/
+
+	bool Driver::create(const args_t&) {
+		auto [_, result] {
+			m_service.Process(command::file_io::CreateDocument::make_instance(m_company_manager))
+		};
+		m_modify.ResetQueues();															//История правок относится к прежнему документу
+		return handle_task_result(result, m_service);
+	}
+
+	bool Driver::load(const args_t& args) {
+		m_service.Process(command::file_io::SetPath::make_instance(m_company_manager, args.front()));
+		auto [value, result] {
+			m_service.Process(command::file_io::Load::make_instance(m_company_manager))
+		};
+		m_modify.ResetQueues();
+		report_stages("load");
+		report_sharing("load");
+		return handle_task_result(result, m_service)
+			&& handle_file_result(get<worker::file_operation::Result>(value), "load");
+	}
+
+	bool Driver::save(const args_t&) {
+		if (!check_loaded()) {
+			return false;
+		}
+		auto [value, result] {
+			m_service.Process(command::file_io::Save::make_instance(m_company_manager))
+		};
+		report_stages("save");
+		return handle_task_result(result, m_service)
+			&& handle_file_result(get<worker::file_operation::Result>(value), "save");
+	}
+
+	bool Driver::save_as(const args_t& args) {
+		if (!check_loaded()) {
+			return false;
+		}
+		m_service.Process(command::file_io::SetPath::make_instance(m_company_manager, args.front()));
+		return save(args);
+	}
+
+	bool Driver::import_table(const args_t& args) {
+		if (!check_loaded()) {
+			return false;
+		}
+		const string& path{ args.front() };
+		ifstream input(path, ios::binary);
+		if (!input) {
+			return fail("Unable to open " + path);
+		}
+		auto staff{
+			table::LoadStaff(
+				input,
+				m_company_manager.GetAllocator(),
+				{ table::FormatFromPath(path), m_settings.thread_count }
+			)
+		};
+		auto [value, result] {
+			m_modify.Process(command::xml_wrapper::ImportEmployees::make_instance(m_company_manager, move(staff)))
+		};
+		if (!handle_task_result(result, m_modify)) {
+			return false;
+		}
+		auto stats{ get<command::xml_wrapper::ImportEmployees::Statistics>(value) };
+		*m_output << "imported\t" << stats.inserted
+			<< "\tduplicates\t" << stats.duplicates
+			<< "\tdepartments_created\t" << stats.departments_created << '\n';
+		return true;
+	}
+
+	bool Driver::export_table(const args_t& args) {
+		if (!check_loaded()) {
+			return false;
+		}
+		const string& path{ args.front() };
+		ofstream output(path, ios::binary);
+		table::Writer(output, table::FormatFromPath(path))
+			.WriteCompany(m_company_manager.Read());
+		return output ? true : fail("Unable to write " + path);
+	}
+
+/*Запросы*/
+
+	bool Driver::stats(const args_t&) {
+		if (!check_loaded()) {
+			return false;
+		}
+		size_t total_count{ 0 };
+		double total_salary{ 0 };
+		*m_output << "department\temployees\taverage_salary\n" << fixed << setprecision(2);
+		for (const auto& department : m_company_manager.Read().GetDepartments()) {
+			size_t count{ department.EmployeeCount() };
+			double average{ department.AverageSalary() };
+			*m_output << department.GetName().get() << '\t' << count << '\t' << average << '\n';
+			total_count += count;
+			total_salary += average * static_cast<double>(count);
+		}
+		*m_output << "*\t" << total_count << '\t'
+			<< (total_count ? total_salary / static_cast<double>(total_count) : 0.0) << '\n';
+		return true;
+	}
+
+	bool Driver::find(const args_t& args) {
+		if (!check_loaded()) {
+			return false;
+		}
+		const string& surname{ args.front() };
+		const auto& index{ *m_company_manager.EnableSearchIndex().GetSearchIndex() };	//Строится при первом поиске, далее поддерживается командами
+		table::Writer writer(*m_output, table::Format::Tsv);
+		writer.WriteHeader();
+		for (const auto& match : index.FindByPrefix(search::Field::Surname, surname, numeric_limits<size_t>::max())) {
+			if (match.employee->GetSurname().get() == surname) {						//Индекс не учитывает регистр
+				writer.WriteEmployee(match.department->GetName().get(), *match.employee);
+			}
+		}
+		return true;
+	}
+
+	bool Driver::metrics(const args_t&) {
+		report_metrics(*m_output, "service", m_service.GetMetrics());
+		report_metrics(*m_output, "modify", m_modify.GetMetrics());
+		return true;
+	}
+
+/*Редактирование*/
+
+	bool Driver::add_department(const args_t& args) {
+		if (!check_loaded()) {
+			return false;
+		}
+		const string& name{ args.front() };
+		if (m_company_manager.Read().Containts(name)) {
+			return fail("Department " + name + " already exists");
+		}
+		auto [_, result] {
+			m_modify.Process(
+				command::xml_wrapper::AddDepartment::make_instance(
+					m_company_manager,
+					wrapper::DepartmentBuilder()
+						.SetAllocator(m_company_manager.GetAllocator())
+						.SetName(name)
+						.Assemble()
+				)
+			)
+		};
+		return handle_task_result(result, m_modify);
+	}
+
+	bool Driver::remove_department(const args_t& args) {
+		if (!check_loaded()) {
+			return false;
+		}
+		const string& name{ args.front() };
+		const auto& company{ m_company_manager.Read() };
+		if (!company.Containts(name)) {
+			return fail("Department " + name + " doesn't exist");
+		}
+		auto [_, result] {
+			m_modify.Process(
+				command::xml_wrapper::RemoveDepartment::make_instance(
+					m_company_manager,
+					company.at(name).GetName()										//Команда хранит ссылку на название - оно должно принадлежать узлу
+				)
+			)
+		};
+		return handle_task_result(result, m_modify);
+	}
+
+	bool Driver::index_salary(const args_t& args) {
+		using command::xml_wrapper::UpdateEmployeeSalary;
+		if (!check_loaded()) {
+			return false;
+		}
+		const string& target{ args[0] };
+		double percent{ 0 };
+		try {
+			percent = stod(args[1]);
+		}
+		catch (const exception&) {
+			return fail("Invalid percent: " + args[1]);
+		}
+		if (percent < -100) {
+			return fail("Salary can't be reduced by more than 100%");
+		}
+
+		const auto& company{ m_company_manager.Read() };
+		if (target != "*" && !company.Containts(target)) {
+			return fail("Department " + target + " doesn't exist");
+		}
+		TaskManager<CompanyManager>::task_list commands;
+		for (const auto& department : company.GetDepartments()) {
+			if (target != "*" && department.GetName().get() != target) {
+				continue;
+			}
+			for (const auto& [full_name, employee] : department.GetEmployees()) {
+				auto salary{ employee.GetSalary() };
+				auto new_salary{
+					static_cast<UpdateEmployeeSalary::salary_t>(
+						llround(static_cast<double>(salary) * (100 + percent) / 100)
+					)
+				};
+				if (new_salary != salary) {
+					commands.push_back(
+						UpdateEmployeeSalary::make_instance(
+							m_company_manager,
+							{ department.GetName(), full_name },
+							new_salary
+						)
+					);
+				}
+			}
+		}
+		size_t changed{ commands.size() };
+		if (changed) {
+			auto [_, result] {m_modify.ProcessBatch(m_company_manager, move(commands))};
+			if (!handle_task_result(result, m_modify)) {
+				return false;
+			}
+		}
+		*m_output << "salaries_changed\t" << changed << '\n';
+		return true;
+	}
+
+	bool Driver::undo(const args_t&) {
+		auto [_, result] {m_modify.Cancel()};
+		if (result == task::ResultType::EmptyQueue) {
+			return fail("Nothing to undo");
+		}
+		return handle_task_result(result, m_modify);
+	}
+
+	bool Driver::check_loaded() {
+		return m_company_manager.IsLoaded() ? true : fail("No document loaded");
+	}
+
+	bool Driver::handle_file_result(worker::file_operation::Result result, string_view action) {
+		using worker::file_operation::Result;
+		switch (result) {
+		case Result::Success: return true;
+		case Result::EmptyPath: return fail("Unable to " + string(action) + ": empty path");
+		case Result::FileOpenError: return fail("Unable to " + string(action) + ": can't open file");
+		case Result::NoData: return fail("Unable to " + string(action) + ": no data");
+		default: return fail("Unable to " + string(action) + ": I/O error");
+		}
+	}
+
+	bool Driver::handle_task_result(task::ResultType result, TaskManager<CompanyManager>& tm) {
+		if (result == task::ResultType::Success) {
+			return true;
+		}
+		return fail(tm.GetErrorLog().empty() ? "Internal error" : tm.GetErrorLog().back());
+	}
+
+	bool Driver::fail(string_view message) {
+		*m_log << "error: " << message << '\n';
+		return false;
+	}
+
+	void Driver::report_timing(const Operation& operation, bool success, clock::duration elapsed) {
+		double elapsed_ms{ chrono::duration<double, milli>(elapsed).count() };
+		switch (m_settings.timing) {
+		case TimingFormat::Text:
+			*m_log << "[timing] " << operation.name;
+			for (const auto& arg : operation.args) {
+				*m_log << ' ' << arg;
+			}
+			*m_log << ": " << (success ? "ok" : "failed") << ", "
+				<< fixed << setprecision(3) << elapsed_ms << " ms\n";
+			break;
+		case TimingFormat::Json:
+			*m_log << "{\"operation\":";
+			write_json_string(*m_log, operation.name);
+			*m_log << ",\"arguments\":[";
+			for (size_t idx = 0; idx < operation.args.size(); ++idx) {
+				if (idx) {
+					*m_log << ',';
+				}
+				write_json_string(*m_log, operation.args[idx]);
+			}
+			*m_log << "],\"status\":\"" << (success ? "ok" : "failed")
+				<< "\",\"elapsed_ms\":" << fixed << setprecision(3) << elapsed_ms << "}\n";
+			break;
+		default: break;
+		}
+	}
+
+	void Driver::report_stages(string_view operation) {
+		using worker::file_operation::StageStatistics;
+		const auto& stats{ m_company_manager.GetIoStatistics() };
+		const pair<string_view, const StageStatistics*> stages[]{
+			{ "io", addressof(stats.io) },
+			{ "xml", addressof(stats.xml) }
+		};
+		for (const auto& [name, stage] : stages) {
+			double busy_ms{ chrono::duration<double, milli>(stage->busy).count() };
+			double stalled_ms{ chrono::duration<double, milli>(stage->stalled).count() };
+			switch (m_settings.timing) {
+			case TimingFormat::Text:
+				*m_log << "[timing] " << operation << '/' << name << ": "
+					<< stage->bytes << " bytes in " << stage->chunks << " chunks, "
+					<< fixed << setprecision(3) << busy_ms << " ms busy, "
+					<< stage->stalls << " stalls (" << stalled_ms << " ms), "
+					<< setprecision(1) << stage->Throughput() << " MB/s\n";
+				break;
+			case TimingFormat::Json:
+				*m_log << "{\"operation\":";
+				write_json_string(*m_log, operation);
+				*m_log << ",\"stage\":";
+				write_json_string(*m_log, name);
+				*m_log << ",\"bytes\":" << stage->bytes << ",\"chunks\":" << stage->chunks
+					<< fixed << setprecision(3) << ",\"busy_ms\":" << busy_ms
+					<< ",\"stalls\":" << stage->stalls << ",\"stalled_ms\":" << stalled_ms << "}\n";
+				break;
+			default: break;
+			}
+		}
+	}
+
+	void Driver::report_sharing(string_view operation) {
+		if (m_settings.shared_fields.empty()) {
+			return;
+		}
+		const auto& stats{ m_company_manager.GetLoadStatistics() };
+		switch (m_settings.timing) {
+		case TimingFormat::Text:
+			*m_log << "[timing] " << operation << "/shared: "
+				<< stats.shared_values << " values, " << stats.distinct_shared_values << " distinct, ratio "
+				<< fixed << setprecision(1) << stats.DeduplicationRatio() << ", "
+				<< stats.saved_bytes << " bytes saved\n";
+			break;
+		case TimingFormat::Json:
+			*m_log << "{\"operation\":";
+			write_json_string(*m_log, operation);
+			*m_log << ",\"stage\":\"shared\",\"values\":" << stats.shared_values
+				<< ",\"distinct\":" << stats.distinct_shared_values
+				<< fixed << setprecision(3) << ",\"ratio\":" << stats.DeduplicationRatio()
+				<< ",\"saved_bytes\":" << stats.saved_bytes << "}\n";
+			break;
+		default: break;
+		}
+	}
+
+	void Driver::report_metrics(ostream& out, string_view task_manager, const task::Metrics& metrics) {
+		if (m_settings.timing == TimingFormat::Json) {
+			out << "{\"task_manager\":";
+			write_json_string(out, task_manager);
+			out << ",\"metrics\":";
+			metrics.WriteJson(out);
+			out << "}\n";
+		}
+		else {
+			metrics.WriteText(out, "[metrics] " + string(task_manager) + '/');
+		}
+	}
+
+	void Driver::write_json_string(ostream& out, string_view str) {
+		out << '"';
+		for (char ch : str) {
+			switch (ch) {
+			case '"': out << "\\\""; break;
+			case '\\': out << "\\\\"; break;
+			case '\n': out << "\\n"; break;
+			case '\r': out << "\\r"; break;
+			case '\t': out << "\\t"; break;
+			default:
+				if (static_cast<unsigned char>(ch) < 0x20) {					//Прочие управляющие символы
+					out << "\\u" << hex << setw(4) << setfill('0') << static_cast<int>(ch) << dec << setfill(' ');
+				}
+				else {
+					out << ch;
+				}
+			}
+		}
+		out << '"';
+	}
+}
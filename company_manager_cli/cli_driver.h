@@ -0,0 +1,124 @@
+#pragma once
+/*Engine headers*/
+#include "task_manager.h"
+#include "internal_workers.h"
+#include "file_io_command.h"
+#include "xml_wrapper_command.h"
+#include "company_manager_engine.h"
+#include "employee_table.h"
+
+/*Standart Library headers*/
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <chrono>
+#include <stdexcept>
+
+/***********************************************************
+Консольный драйвер CompanyManager, не зависящий от Qt.
+Операции задаются аргументами командной строки и выполняются
+по порядку в одном конвейере (как и действия главного окна):
+ошибка в очередной операции прерывает обработку.
+Результаты запросов выводятся в output (TSV), сообщения
+об ошибках и время выполнения операций - в log
+(текстом или JSON Lines для последующей обработки скриптами)
+************************************************************/
+
+namespace cli {
+	class usage_error : public std::invalid_argument {
+	public:
+		using std::invalid_argument::invalid_argument;
+	};
+
+	enum class TimingFormat {
+		None,
+		Text,
+		Json
+	};
+
+	struct Operation {
+		std::string name;
+		std::vector<std::string> args;
+	};
+
+	struct Settings {
+		std::vector<Operation> operations;
+		TimingFormat timing{ TimingFormat::None };
+		size_t thread_count{ 0 };													//Потоки разбора при импорте: 0 - по числу аппаратных
+		size_t metrics_period_ms{ 0 };												//Периодический вывод метрик команд в журнал: 0 - отключён
+		std::string trace_path;														//Chrome Trace JSON; пустой - без трассировки
+		std::vector<wrapper::Employee::Field> shared_fields;						//Значения полей хранятся в пуле документа
+		bool show_help{ false };
+	};
+
+	enum ExitCode : int {
+		Success = 0,
+		OperationFailed = 1,
+		InvalidUsage = 2
+	};
+
+	class Driver {
+	public:
+		using clock = std::chrono::steady_clock;
+		using args_t = std::vector<std::string>;
+		using PipelineBuilder = worker::ui_internal::PipelineBuilder<bool>;			//bool-флаг успешного выполнения всех операций
+	public:
+		Driver(std::ostream& output, std::ostream& log, Settings settings);
+		int Run();
+
+		static Settings ParseCommandLine(int argc, const char* const argv[]);	//Выбрасывает usage_error
+		static void PrintUsage(std::ostream& out);
+	private:
+		using handler_t = bool (Driver::*)(const args_t&);
+		struct OperationInfo {
+			std::string_view name;
+			std::string_view arguments;
+			std::string_view description;
+			size_t arity;
+			handler_t handler;
+		};
+		using operation_table = std::vector<OperationInfo>;					//Порядок элементов - порядок вывода в справке
+		static const operation_table& get_operations();
+		static const OperationInfo* find_operation(std::string_view name);
+
+		bool run_operation(const Operation& operation);						//Замер времени и перехват исключений
+
+	/*Работа с файлами*/
+		bool create(const args_t& args);
+		bool load(const args_t& args);
+		bool save(const args_t& args);
+		bool save_as(const args_t& args);
+		bool import_table(const args_t& args);
+		bool export_table(const args_t& args);
+
+	/*Запросы*/
+		bool stats(const args_t& args);
+		bool find(const args_t& args);
+		bool metrics(const args_t& args);
+
+	/*Редактирование*/
+		bool add_department(const args_t& args);
+		bool remove_department(const args_t& args);
+		bool index_salary(const args_t& args);								//Пакетная индексация зарплат одной отменяемой операцией
+		bool undo(const args_t& args);
+
+		bool check_loaded();
+		bool handle_file_result(worker::file_operation::Result result, std::string_view action);
+		bool handle_task_result(task::ResultType result, TaskManager<CompanyManager>& tm);
+		bool fail(std::string_view message);
+
+		void report_timing(const Operation& operation, bool success, clock::duration elapsed);
+		void report_stages(std::string_view operation);						//Стадии конвейера ввода-вывода последней загрузки или сохранения
+		void report_sharing(std::string_view operation);					//Дедупликация значений при последней загрузке (при --share-values)
+		void report_metrics(std::ostream& out, std::string_view task_manager, const task::Metrics& metrics);	//Формат JSON, если выбран --timing json
+		static void write_json_string(std::ostream& out, std::string_view str);
+	private:
+		std::ostream* m_output;
+		std::ostream* m_log;
+		Settings m_settings;
+		CompanyManager m_company_manager;
+		TaskManager<CompanyManager> m_service{ TaskManager<CompanyManager>(0) };	//Команды не добавляются в очередь для отмены
+		TaskManager<CompanyManager> m_modify;
+	};
+}
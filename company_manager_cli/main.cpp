@@ -0,0 +1,19 @@
+#include "cli_driver.h"
+
+
+int main(int argc, char* argv[]) {
+	cli::Settings settings;
+	try {
+		settings = cli::Driver::ParseCommandLine(argc, argv);
+	}
+	catch (const cli::usage_error& exc) {
+		std::cerr << "error: " << exc.what() << "\n\n";
+		cli::Driver::PrintUsage(std::cerr);
+		return cli::ExitCode::InvalidUsage;
+	}
+	if (settings.show_help || settings.operations.empty()) {
+		cli::Driver::PrintUsage(std::cout);
+		return cli::ExitCode::Success;
+	}
+	return cli::Driver(std::cout, std::cerr, std::move(settings)).Run();
+}
@@ -0,0 +1,218 @@
+#include "autosave.h"
+#include "tracing.h"
+
+#include <filesystem>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+using namespace std;
+namespace fs = std::filesystem;
+
+Autosaver::Autosaver(CompanyManager& cm, AutosaveSettings settings)
+	: m_cm(addressof(cm)),
+	m_settings(move(settings)),
+	m_saved_edit_count(cm.GetEditCount()),
+	m_last_capture(clock::now()),
+	m_worker([this] { run(); })
+{
+}
+
+Autosaver::~Autosaver() {
+	{
+		lock_guard lock(m_mutex);
+		m_stop = true;
+	}
+	m_state_changed.notify_all();
+	m_worker.join();
+}
+
+bool Autosaver::Poll() {
+	if (!m_cm->IsLoaded()) {
+		return false;
+	}
+	auto now{ clock::now() };
+	if (m_cm->IsSaved()) {															//Правки до явного сохранения уже в документе
+		m_saved_edit_count = m_cm->GetEditCount();
+		m_last_capture = now;
+		m_preparing = false;
+		return false;
+	}
+	if (!m_preparing && !is_due(now)) {
+		return false;
+	}
+	m_preparing = !m_cm->PrepareSnapshot(m_settings.snapshot_budget);
+	if (m_preparing) {
+		return false;																//Продолжим в следующем Poll()
+	}
+	capture(now);
+	return true;
+}
+
+bool Autosaver::Flush() {
+	if (!m_cm->IsLoaded()) {
+		return false;
+	}
+	m_preparing = false;
+	capture(clock::now());
+	return true;
+}
+
+Autosaver& Autosaver::DiscardRecovery() {
+	m_saved_edit_count = m_cm->GetEditCount();
+	m_last_capture = clock::now();
+	m_preparing = false;
+	submit({ nullptr, m_last_path.empty() ? GetRecoveryPath() : move(m_last_path), {} });	//Вытесняет ещё не записанный снимок
+	m_last_path.clear();
+	return *this;
+}
+
+Autosaver& Autosaver::Wait() {
+	unique_lock lock(m_mutex);
+	m_state_changed.wait(lock, [this] { return !m_pending && !m_busy; });
+	return *this;
+}
+
+Autosaver::Statistics Autosaver::GetStatistics() const {
+	lock_guard lock(m_mutex);
+	return m_stats;
+}
+
+string Autosaver::GetRecoveryPath() const {
+	if (!m_settings.recovery_path.empty()) {
+		return m_settings.recovery_path;
+	}
+	if (auto document_path{ m_cm->GetPath() }; !document_path.empty()) {
+		return RecoveryPathFor(document_path);
+	}
+	error_code ec;
+	fs::path temp_dir{ fs::temp_directory_path(ec) };
+	return (ec ? fs::path{} : temp_dir).append("CompanyManager.recovery.xml").string();
+}
+
+string Autosaver::RecoveryPathFor(string_view document_path) {
+	return string(document_path).append(".recovery");
+}
+
+bool Autosaver::HasNewerRecovery(const string& document_path, const string& recovery_path) noexcept {
+	error_code ec;
+	if (!fs::is_regular_file(recovery_path, ec)) {
+		return false;
+	}
+	auto recovery_time{ fs::last_write_time(recovery_path, ec) };
+	if (ec) {
+		return false;
+	}
+	auto document_time{ fs::last_write_time(document_path, ec) };
+	return ec || recovery_time > document_time;
+}
+
+bool Autosaver::is_due(clock::time_point now) const noexcept {
+	uint64_t edits{ m_cm->GetEditCount() - m_saved_edit_count };
+	auto elapsed{ now - m_last_capture };
+	return edits
+		&& (
+			(edits >= m_settings.edit_threshold && elapsed >= m_settings.min_interval)
+			|| elapsed >= m_settings.max_interval
+		);
+}
+
+void Autosaver::capture(clock::time_point now) {
+	Task task{ m_cm->Snapshot(), GetRecoveryPath(), {} };								//Снимки подразделений уже в кэше - остаётся собрать указатели
+	if (m_last_path != task.path) {
+		if (!m_last_path.empty()) {
+			task.obsolete_paths.push_back(move(m_last_path));
+		}
+		m_last_path = task.path;
+	}
+	m_saved_edit_count = m_cm->GetEditCount();
+	m_last_capture = now;
+	submit(move(task));
+}
+
+void Autosaver::submit(Task task) {
+	{
+		lock_guard lock(m_mutex);
+		if (m_pending) {															//Вытесняемая задача могла нести пути на удаление
+			auto& pending_paths{ m_pending->obsolete_paths };
+			move(pending_paths.begin(), pending_paths.end(), back_inserter(task.obsolete_paths));
+		}
+		m_pending = move(task);
+	}
+	m_state_changed.notify_all();
+}
+
+void Autosaver::run() {
+	lower_thread_priority();
+	tracing::Tracer::Instance().SetThreadName("autosave");
+	unique_lock lock(m_mutex);
+	for (;;) {
+		m_state_changed.wait(lock, [this] { return m_stop || m_pending; });
+		if (!m_pending) {
+			break;																	//Остановка - после записи последнего снимка
+		}
+		Task task{ move(*m_pending) };
+		m_pending.reset();
+		move(m_obsolete_paths.begin(), m_obsolete_paths.end(), back_inserter(task.obsolete_paths));	//Не удалённые из-за прошлого сбоя
+		m_obsolete_paths.clear();
+		m_busy = true;
+		lock.unlock();
+		Result result{ execute(task) };
+		bool saving{ static_cast<bool>(task.company) };
+		if (result != Result::Success) {
+			m_obsolete_paths = move(task.obsolete_paths);							//Удалятся после следующей успешной записи
+		}
+		task = {};																	//Снимок освобождается вне блокировки
+		lock.lock();
+		m_busy = false;
+		if (saving) {
+			++(result == Result::Success ? m_stats.saved : m_stats.failed);
+			m_stats.last_result = result;
+		}
+		m_state_changed.notify_all();
+	}
+}
+
+Autosaver::Result Autosaver::execute(const Task& task) noexcept {
+	tracing::Span span("engine/Autosaver::execute");
+	Result result{ Result::Success };
+	error_code ec;
+	if (!task.company) {
+		fs::remove(task.path, ec);
+		result = ec ? Result::FileIOError : Result::Success;
+	}
+	else {
+		try {
+			result = CompanyManager::SaveSnapshot(*task.company, task.path);
+		}
+		catch (...) {																//Сбой автосохранения не должен завершать приложение
+			result = Result::FileIOError;
+		}
+	}
+	if (result == Result::Success) {												//Только после записи новой копии: при сбое прежняя остаётся единственной
+		for (const auto& obsolete_path : task.obsolete_paths) {
+			if (obsolete_path != task.path) {										//Документ мог вернуться к прежнему пути
+				fs::remove(obsolete_path, ec);
+			}
+		}
+	}
+	return result;
+}
+
+void Autosaver::lower_thread_priority() noexcept {
+#if defined(_WIN32)
+	SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);			//Также понижает приоритет дискового ввода-вывода
+#elif defined(__linux__)
+	setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 19);		//nice применяется к отдельному потоку
+#endif
+}
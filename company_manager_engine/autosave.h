@@ -0,0 +1,97 @@
+#pragma once
+#include "company_manager_engine.h"
+#include "company_snapshot.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstdint>
+
+/***********************************************************
+Автосохранение в файл восстановления.
+Poll() вызывается по таймеру в потоке редактора и лишь решает,
+пора ли сохраняться: по числу правок (не менее edit_threshold
+и не чаще min_interval) либо по времени (не реже max_interval
+при наличии правок). Снимок компании готовится порциями
+по snapshot_budget сотрудников за вызов, поэтому даже первый
+снимок большого документа не задерживает редактор дольше
+одного кадра. Сериализация и запись выполняются в отдельном
+потоке с пониженным приоритетом; если поток ещё занят,
+ожидающий снимок заменяется более свежим.
+
+Фоновый поток не использует команды и файловые Worker'ы:
+их ObjectPool не является потокобезопасным
+************************************************************/
+
+struct AutosaveSettings {
+	std::string recovery_path;													//Пусто - <документ>.recovery либо временный каталог для несохранённого документа
+	size_t edit_threshold{ 20 };
+	std::chrono::milliseconds min_interval{ std::chrono::seconds(30) };
+	std::chrono::milliseconds max_interval{ std::chrono::minutes(5) };
+	size_t snapshot_budget{ 20000 };											//Сотрудников за один Poll()
+};
+
+class Autosaver {
+public:
+	using clock = std::chrono::steady_clock;
+	using Result = worker::file_operation::Result;
+
+	struct Statistics {
+		size_t saved{ 0 };
+		size_t failed{ 0 };
+		std::optional<Result> last_result;
+	};
+public:
+	Autosaver(CompanyManager& cm, AutosaveSettings settings = {});
+	Autosaver(const Autosaver&) = delete;
+	Autosaver& operator=(const Autosaver&) = delete;
+	~Autosaver();																//Дожидается записи последнего переданного снимка
+
+	bool Poll();																//true, если снимок передан на запись
+	bool Flush();																//Немедленный полный снимок без учёта порогов
+	Autosaver& DiscardRecovery();												//После явного сохранения или закрытия документа
+	Autosaver& Wait();															//Ожидание завершения фоновых операций
+
+	Statistics GetStatistics() const;
+	std::string GetRecoveryPath() const;										//Для текущего пути документа
+
+	static std::string RecoveryPathFor(std::string_view document_path);
+	static bool HasNewerRecovery(												//Файл восстановления новее документа (или документа нет)
+		const std::string& document_path,
+		const std::string& recovery_path
+	) noexcept;
+private:
+	struct Task {
+		snapshot::company_holder company;										//nullptr - удаление файла восстановления
+		std::string path;
+		std::vector<std::string> obsolete_paths;								//Удаляются после успешной записи (путь документа сменился)
+	};
+private:
+	bool is_due(clock::time_point now) const noexcept;
+	void capture(clock::time_point now);
+	void submit(Task task);
+	void run();
+	static Result execute(const Task& task) noexcept;
+	static void lower_thread_priority() noexcept;
+private:
+	CompanyManager* m_cm;
+	AutosaveSettings m_settings;
+	uint64_t m_saved_edit_count;												//Поля ниже используются только потоком редактора
+	clock::time_point m_last_capture;
+	bool m_preparing{ false };													//Снимок готовится в нескольких Poll()
+	std::string m_last_path;
+
+	mutable std::mutex m_mutex;													//Защищает поля ниже
+	std::condition_variable m_state_changed;
+	std::optional<Task> m_pending;
+	bool m_busy{ false };
+	bool m_stop{ false };
+	Statistics m_stats;
+	std::vector<std::string> m_obsolete_paths;									//Не удалены из-за сбоя записи; только для фонового потока
+	std::thread m_worker;														//Запускается последним
+};
@@ -1,54 +1,114 @@
 #include "company_manager_engine.h"
+#include "tracing.h"
+
+#include <filesystem>
 using namespace std;
 using worker::file_operation::Result;
+namespace stage = worker::file_operation::stage;
 
 CompanyManager& CompanyManager::Create() {
 	Reset();
 	m_xml_tree = build_default_tree();
 	update_stats_after_create();
+	rebuild_search_index();
 	return *this;
 }
 
 Result CompanyManager::Load() {
+	tracing::Span span("engine/CompanyManager::Load");
 	ifstream input;
-	xml::Reader reader(input);
+	worker::file_operation::PipelinedInput pipe;									//Чтение файла в отдельном потоке параллельно с разбором
+	wrapper::SchemaReader reader(pipe.GetStream());									//Обёртки строятся вместе с DOM-деревом за один проход
+	for (auto field : m_shared_fields) {
+		reader.ShareValues(field);
+	}
 
 	auto loader{
-		worker::file_operation::PipelineBuilder()
-			.CheckPath(m_file.current_path)
-			.OpenForReading(input, m_file.current_path)
-			.ReadXml(reader, m_xml_tree.m_document)
-			.Assemble()
+		MakeStaticPipeline<Result>(
+			stage::CheckPath(m_file.current_path),
+			stage::OpenForReading(input, m_file.current_path),
+			stage::ReadAhead(input, pipe),
+			[this, &reader](Result& result) {
+				result = Result::FileIOError;										//Исключение разбора пробрасывается, как и из stage::ReadXml
+				auto loaded{ reader.Load() };
+				if (reader.Fail()) {
+					return false;													//Прежний документ и его индекс поиска остаются в силе
+				}
+				if (m_search_index) {
+					m_search_index->Clear();										//Индекс ссылается на узлы прежнего документа
+				}
+				m_xml_tree.company = move(loaded.company);							//Прежние обёртки уничтожаются раньше узлов, на которые ссылаются
+				m_xml_tree.m_document = move(loaded.document);
+				result = Result::Success;
+				return true;
+			}
+		)
 	};
 
 	Result result;
-	loader->Process(result);
+	loader.Process(result);
+	m_io_stats = pipe.GetStatistics();
 	if (result == Result::Success) {
+		m_snapshots.Clear();														//Снимки прежнего документа остаются у их владельцев
+		m_load_stats = reader.GetStatistics();
 		update_stats_after_load();
+		rebuild_search_index();
 	}
 	return result;
 }
 
 Result CompanyManager::Save() {
+	tracing::Span span("engine/CompanyManager::Save");
 	ofstream output;
-	xml::Writer writer(output);
-	tune_xml_writer(writer);														//  
-	m_xml_tree.company.Synchronize();												// BuildXmlTree  , .. company   
+	worker::file_operation::PipelinedOutput pipe;									//Запись файла в отдельном потоке параллельно с сериализацией
+	xml::Writer writer(pipe.GetStream());
+	tune_xml_writer(writer);														//Установка количества отступов
+	m_xml_tree.company.Synchronize();												//Вызывать BuildXmlTree не требуется, т.к. company уже принадлежит документу
 
 	auto saver{
-		worker::file_operation::PipelineBuilder()
-			.CheckPath(m_file.current_path)
-			.OpenForWriting(output, m_file.current_path)
-			.WriteXml(writer, m_xml_tree.m_document)
-			.Assemble()
+		MakeStaticPipeline<Result>(
+			stage::CheckPath(m_file.current_path),
+			stage::OpenForWriting(output, m_file.current_path),
+			stage::WriteBehind(output, pipe),
+			stage::WriteXml(writer, m_xml_tree.m_document)
+		)
 	};
 
 	Result result;
-	saver->Process(result);
+	saver.Process(result);
+	m_io_stats = pipe.GetStatistics();
 	m_file.is_saved = true;
 	return result;
 }
 
+Result CompanyManager::Recover(const string& recovery_path) {
+	string document_path{ exchange(m_file.current_path, recovery_path) };
+	Result result{ Load() };
+	m_file.current_path = move(document_path);
+	if (result == Result::Success) {
+		m_file.is_saved = false;													//Восстановленные правки в документ ещё не записаны
+	}
+	return result;
+}
+
+const worker::file_operation::PipelineStatistics& CompanyManager::GetIoStatistics() const noexcept {
+	return m_io_stats;
+}
+
+CompanyManager& CompanyManager::ShareValues(wrapper::Employee::Field field) {
+	if (!wrapper::Employee::IsShareable(field)) {									//Ошибка - сразу, а не при следующей загрузке
+		throw invalid_argument("Field "s + string(wrapper::Employee::GetFieldName(field)) + " can't be shared");
+	}
+	if (find(m_shared_fields.begin(), m_shared_fields.end(), field) == m_shared_fields.end()) {
+		m_shared_fields.push_back(field);
+	}
+	return *this;
+}
+
+const wrapper::SchemaReader::Statistics& CompanyManager::GetLoadStatistics() const noexcept {
+	return m_load_stats;
+}
+
 bool CompanyManager::IsSaved() const noexcept {
 	return m_file.is_saved;
 }
@@ -72,6 +132,10 @@ CompanyManager& CompanyManager::SetPath(string path) noexcept {
 
 CompanyManager& CompanyManager::Reset() noexcept {
 	m_file = {};
+	m_snapshots.Clear();
+	if (m_search_index) {
+		m_search_index->Clear();
+	}
 	return *this;
 }
 
@@ -86,9 +150,88 @@ wrapper::Company& CompanyManager::Modify() {
 		throw logic_error("XML document not found");
 	}
 	m_file.is_saved = false;
+	++m_edit_count;
 	return m_xml_tree.company;
 }
 
+snapshot::company_holder CompanyManager::Snapshot() {
+	return m_snapshots.Make(Read());
+}
+
+bool CompanyManager::PrepareSnapshot(size_t employee_budget) {
+	return m_snapshots.Prepare(Read(), employee_budget);
+}
+
+uint64_t CompanyManager::GetEditCount() const noexcept {
+	return m_edit_count;
+}
+
+Result CompanyManager::SaveSnapshot(const snapshot::Company& company, const string& path) {
+	tracing::Span span("engine/CompanyManager::SaveSnapshot");
+	if (path.empty()) {
+		return Result::EmptyPath;
+	}
+	xml::allocator_holder tree_alloc{ xml::MakeDefaultAllocator() };				//Собственный аллокатор: с документом редактора ничего не разделяется
+	wrapper::CompanyBuilder company_builder;
+	company_builder.SetAllocator(tree_alloc);
+	for (const auto& department : company.GetDepartments()) {
+		vector<wrapper::Employee> staff;
+		staff.reserve(department->EmployeeCount());
+		for (const auto& employee : department->GetEmployees()) {
+			staff.push_back(
+				wrapper::EmployeeBuilder()
+					.SetAllocator(tree_alloc)
+					.SetSurname(employee.surname)
+					.SetName(employee.name)
+					.SetMiddleName(employee.middle_name)
+					.SetFunction(employee.function)
+					.SetSalary(employee.salary)
+					.Assemble()
+			);
+		}
+		company_builder.AddDepartment(
+			wrapper::DepartmentBuilder()
+				.SetAllocator(tree_alloc)
+				.SetName(department->GetName())
+				.InsertEmployees(move(staff))
+				.Assemble()
+		);
+	}
+	wrapper::Company wrappers{ company_builder.Assemble() };
+	xml::Document doc{
+		xml::DocumentBuilder()
+			.SetDeclaration(make_xml_declaration(tree_alloc))
+			.SetRoot(wrappers.BuildXmlTree())
+			.SetAllocator(tree_alloc)
+			.Assemble()
+	};
+
+	string temp_path{ path + ".tmp" };												//Прежняя копия остаётся целой, если запись прервётся
+	{
+		ofstream output;
+		xml::Writer writer(output);
+		tune_xml_writer(writer);
+
+		Result result;
+		MakeStaticPipeline<Result>(													//Статическая цепочка не использует ObjectPool
+			stage::OpenForWriting(output, temp_path),
+			stage::WriteXml(writer, doc),
+			[&output](Result& result) {
+				if (!output.flush()) {
+					result = Result::FileIOError;
+				}
+				return result == Result::Success;
+			}
+		).Process(result);
+		if (result != Result::Success) {
+			return result;
+		}
+	}
+	error_code ec;
+	filesystem::rename(temp_path, path, ec);
+	return ec ? Result::FileIOError : Result::Success;
+}
+
 xml::allocator_holder CompanyManager::GetAllocator() const {
 	if (!IsLoaded()) {
 		throw logic_error("XML document not found");
@@ -96,6 +239,25 @@ xml::allocator_holder CompanyManager::GetAllocator() const {
 	return m_xml_tree.company.GetAllocator();
 }
 
+CompanyManager& CompanyManager::EnableSearchIndex(bool enable) {
+	if (!enable) {
+		m_search_index.reset();
+	}
+	else if (!m_search_index) {
+		m_search_index = make_unique<search::EmployeeIndex>();
+		rebuild_search_index();
+	}
+	return *this;
+}
+
+search::EmployeeIndex* CompanyManager::GetSearchIndex() noexcept {
+	return m_search_index.get();
+}
+
+const search::EmployeeIndex* CompanyManager::GetSearchIndex() const noexcept {
+	return m_search_index.get();
+}
+
 bool CompanyManager::empty_path() const noexcept {
 	return m_file.current_path.empty();
 }
@@ -106,13 +268,19 @@ const string& CompanyManager::get_path() const noexcept {
 
 void CompanyManager::update_stats_after_create() {
 	m_file.is_loaded = true;
-	m_file.is_saved = false;														//     
+	m_file.is_saved = false;														//Файл не создается вместе с документом
 }
 
 
 void CompanyManager::update_stats_after_load() {
-	m_xml_tree.company = build_wrappers_tree(m_xml_tree.m_document);
-	m_file.is_loaded = true;
+	m_file.is_loaded = true;															//Обёртки построены SchemaReader'ом при разборе
+}
+
+void CompanyManager::rebuild_search_index() {
+	if (m_search_index && IsLoaded()) {
+		tracing::Span span("engine/rebuild search index");
+		m_search_index->Build(m_xml_tree.company);
+	}
 }
 
 CompanyManager::XmlTree CompanyManager::build_default_tree() {
@@ -143,11 +311,7 @@ xml::node_holder CompanyManager::make_xml_declaration(xml::allocator_holder allo
 		.Assemble();
 }
 
-wrapper::Company CompanyManager::build_wrappers_tree(xml::Document& doc) {
-	return wrapper::Company(addressof(doc.GetRoot()));
-}
-
 void CompanyManager::tune_xml_writer(xml::Writer& writer) {
-	writer.SetIndentType(make_unique <xml::Space>(3));							//   (3 )
+	writer.SetIndentType(make_unique <xml::Space>(3));							//Шаг одного отступа (3 пробела)
 	writer.SetBasicIndentCount(0);
 }
@@ -2,11 +2,15 @@
 #include "file_workers.h"
 #include "xml_wrappers.h"
 #include "xml_wrappers_builders.h"
+#include "schema_reader.h"
+#include "employee_index.h"
+#include "company_snapshot.h"
 
 #include <iostream>
 #include <fstream>
 #include <memory>
 #include <functional>
+#include <vector>
 
 class CompanyManager {
 private:
@@ -23,6 +27,10 @@ public:
 	CompanyManager& Create();
 	worker::file_operation::Result Load();
 	worker::file_operation::Result Save();
+	worker::file_operation::Result Recover(const std::string& recovery_path);	//Загрузка файла восстановления: путь документа сохраняется, is_saved сбрасывается
+	const worker::file_operation::PipelineStatistics& GetIoStatistics() const noexcept;	//Стадии последнего Load() или Save()
+	CompanyManager& ShareValues(wrapper::Employee::Field field);		//Значения поля хранятся в пуле документа, начиная со следующего Load()
+	const wrapper::SchemaReader::Statistics& GetLoadStatistics() const noexcept;	//Разбор последнего успешного Load(), включая дедупликацию
 
 	bool IsSaved() const noexcept;
 	bool IsLoaded() const noexcept;
@@ -33,21 +41,39 @@ public:
 	CompanyManager& Reset() noexcept;
 
 	const wrapper::Company& Read() const;
-	wrapper::Company& Modify();											//  is_saved
+	wrapper::Company& Modify();											//Сбрасывает флаг is_saved
+	snapshot::company_holder Snapshot();								//Неизменяемый снимок для фоновых читателей; вызывается в потоке, выполняющем изменения
+	bool PrepareSnapshot(size_t employee_budget);						//Снимки не более чем employee_budget сотрудников за вызов; true, если Snapshot() уже не создаёт новых
+	uint64_t GetEditCount() const noexcept;								//Число вызовов Modify() за время жизни объекта
+
+	static worker::file_operation::Result SaveSnapshot(					//Не использует ObjectPool и может вызываться из любого потока
+		const snapshot::Company& company,
+		const std::string& path
+	);
 
 	xml::allocator_holder GetAllocator() const;
+
+	CompanyManager& EnableSearchIndex(bool enable = true);				//Индекс строится по текущему документу и поддерживается командами xml_wrapper
+	search::EmployeeIndex* GetSearchIndex() noexcept;					//nullptr, если индекс не включён
+	const search::EmployeeIndex* GetSearchIndex() const noexcept;
 private:
 	bool empty_path() const noexcept;
 	const std::string& get_path() const noexcept;
 	void update_stats_after_create();
 	void update_stats_after_load();
+	void rebuild_search_index();
 
 	static XmlTree build_default_tree();
 	static xml::node_holder make_xml_declaration(xml::allocator_holder alloc);
-	
-	static wrapper::Company build_wrappers_tree(xml::Document& doc);
+
 	static void tune_xml_writer(xml::Writer& writer);
 private:
 	FileInfo m_file;
 	XmlTree m_xml_tree;
+	std::unique_ptr<search::EmployeeIndex> m_search_index;
+	uint64_t m_edit_count{ 0 };
+	worker::file_operation::PipelineStatistics m_io_stats;
+	std::vector<wrapper::Employee::Field> m_shared_fields;
+	wrapper::SchemaReader::Statistics m_load_stats;
+	snapshot::SnapshotCache m_snapshots;								//Снимки неизменённых подразделений разделяются между снимками компании
 };
\ No newline at end of file
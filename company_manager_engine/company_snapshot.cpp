@@ -0,0 +1,132 @@
+#include "company_snapshot.h"
+
+#include <algorithm>
+using namespace std;
+
+namespace snapshot {
+	Department::Department(const wrapper::Department& department)
+		: m_name(department.GetName().get()),
+		m_revision(department.GetRevision())
+	{
+		m_employees.reserve(department.EmployeeCount());
+		for (const auto& [full_name, employee] : department.GetEmployees()) {
+			m_employees.push_back({
+				full_name.surname.get(),
+				full_name.name.get(),
+				full_name.middle_name.get(),
+				employee.GetFunction().get(),
+				employee.GetSalary()
+			});
+			m_summary_salary += m_employees.back().salary;
+		}
+	}
+
+	const string& Department::GetName() const noexcept {
+		return m_name;
+	}
+
+	const vector<Employee>& Department::GetEmployees() const noexcept {
+		return m_employees;
+	}
+
+	size_t Department::EmployeeCount() const noexcept {
+		return m_employees.size();
+	}
+
+	double Department::AverageSalary() const noexcept {
+		return EmployeeCount() ?
+			static_cast<double>(m_summary_salary) / EmployeeCount() : 0;
+	}
+
+	uint64_t Department::GetRevision() const noexcept {
+		return m_revision;
+	}
+
+	Company::Company(vector<department_holder> departments)
+		: m_departments(move(departments))
+	{
+		m_by_name.reserve(m_departments.size());
+		for (const auto& department : m_departments) {
+			m_by_name.emplace(department->GetName(), department.get());			//Из дубликатов доступно первое - как и в wrapper::Company
+			m_employee_count += department->EmployeeCount();
+		}
+	}
+
+	const vector<department_holder>& Company::GetDepartments() const noexcept {
+		return m_departments;
+	}
+
+	size_t Company::DepartmentCount() const noexcept {
+		return m_departments.size();
+	}
+
+	size_t Company::EmployeeCount() const noexcept {
+		return m_employee_count;
+	}
+
+	const Department* Company::Find(string_view name) const noexcept {
+		auto it{ m_by_name.find(name) };
+		return it == m_by_name.end() ? nullptr : it->second;
+	}
+
+	company_holder SnapshotCache::Make(const wrapper::Company& company) {
+		if (is_actual(company)) {
+			return m_company;
+		}
+		vector<department_holder> departments;
+		departments.reserve(company.DepartmentCount());
+		unordered_map<uint64_t, department_holder> actual;						//Снимки удалённых и изменённых подразделений из кэша уходят
+		actual.reserve(company.DepartmentCount());
+		for (const auto& department : company.GetDepartments()) {
+			uint64_t revision{ department.GetRevision() };
+			auto cached{ m_departments.find(revision) };
+			department_holder holder{
+				cached != m_departments.end() ?
+					cached->second : make_shared<const Department>(department)
+			};
+			actual.emplace(revision, holder);
+			departments.push_back(move(holder));
+		}
+		m_departments = move(actual);
+		m_company = make_shared<const Company>(move(departments));
+		return m_company;
+	}
+
+	bool SnapshotCache::Prepare(const wrapper::Company& company, size_t employee_budget) {
+		if (is_actual(company)) {
+			return true;
+		}
+		size_t snapshotted{ 0 };
+		for (const auto& department : company.GetDepartments()) {
+			uint64_t revision{ department.GetRevision() };
+			if (m_departments.count(revision)) {
+				continue;
+			}
+			if (snapshotted >= employee_budget) {
+				return false;
+			}
+			m_departments.emplace(revision, make_shared<const Department>(department));	//Устаревшие снимки вытеснит очередной Make()
+			snapshotted += max<size_t>(department.EmployeeCount(), 1);
+		}
+		return true;
+	}
+
+	SnapshotCache& SnapshotCache::Clear() noexcept {
+		m_departments.clear();
+		m_company.reset();
+		return *this;
+	}
+
+	bool SnapshotCache::is_actual(const wrapper::Company& company) const noexcept {
+		if (!m_company || m_company->DepartmentCount() != company.DepartmentCount()) {
+			return false;
+		}
+		auto snapshot_it{ m_company->GetDepartments().begin() };
+		for (const auto& department : company.GetDepartments()) {				//Ревизии уникальны, поэтому совпадение последовательностей
+			if ((*snapshot_it++)->GetRevision() != department.GetRevision()) {	//означает и тот же порядок подразделений
+				return false;
+			}
+		}
+		return true;
+	}
+}
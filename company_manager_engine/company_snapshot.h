@@ -0,0 +1,82 @@
+#pragma once
+#include "xml_wrappers.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+
+/***********************************************************
+Снимки компании для фоновых читателей (автосохранение, отчёты,
+построение индексов). Снимок - неизменяемая копия данных,
+не ссылающаяся на XML-дерево: он остаётся валидным при
+дальнейшем редактировании и может читаться из любого потока.
+
+Снимки подразделений разделяются между снимками компании:
+SnapshotCache пересоздаёт только подразделения, ревизия
+которых (wrapper::Department::GetRevision()) изменилась,
+а при отсутствии изменений возвращает прежний снимок компании.
+Сам кэш потокобезопасным не является и используется в потоке,
+выполняющем изменения. Prepare() позволяет создать недостающие
+снимки подразделений порциями, не задерживая этот поток надолго
+************************************************************/
+
+namespace snapshot {
+	using salary_t = wrapper::Employee::salary_t;
+
+	struct Employee {
+		std::string
+			surname,
+			name,
+			middle_name,
+			function;
+		salary_t salary{ 0 };
+	};
+
+	class Department {
+	public:
+		Department(const wrapper::Department& department);
+
+		const std::string& GetName() const noexcept;
+		const std::vector<Employee>& GetEmployees() const noexcept;			//В порядке ФИО, как в подразделении
+		size_t EmployeeCount() const noexcept;
+		double AverageSalary() const noexcept;
+		uint64_t GetRevision() const noexcept;								//Ревизия исходного подразделения
+	private:
+		std::string m_name;
+		std::vector<Employee> m_employees;
+		salary_t m_summary_salary{ 0 };
+		uint64_t m_revision;
+	};
+	using department_holder = std::shared_ptr<const Department>;
+
+	class Company {
+	public:
+		Company(std::vector<department_holder> departments);
+
+		const std::vector<department_holder>& GetDepartments() const noexcept;	//В порядке следования в компании
+		size_t DepartmentCount() const noexcept;
+		size_t EmployeeCount() const noexcept;
+		const Department* Find(std::string_view name) const noexcept;			//nullptr, если подразделения нет
+	private:
+		std::vector<department_holder> m_departments;
+		std::unordered_map<std::string_view, const Department*> m_by_name;
+		size_t m_employee_count{ 0 };
+	};
+	using company_holder = std::shared_ptr<const Company>;
+
+	class SnapshotCache {
+	public:
+		company_holder Make(const wrapper::Company& company);
+		bool Prepare(const wrapper::Company& company, size_t employee_budget);	//Заполняет кэш порциями, чтобы растянуть холодный Make() на несколько вызовов;
+																				//true, если снимки всех подразделений уже есть
+		SnapshotCache& Clear() noexcept;
+	private:
+		bool is_actual(const wrapper::Company& company) const noexcept;		//Снимок компании совпадает с текущим состоянием
+	private:
+		std::unordered_map<uint64_t, department_holder> m_departments;		//Ревизия -> снимок подразделения
+		company_holder m_company;
+	};
+}
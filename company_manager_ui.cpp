@@ -5,37 +5,62 @@ CompanyManagerUI::CompanyManagerUI(QWidget *parent)
 
 	m_gui->setupUi(this);
 
-/*  */
+/*Подключение кнопок меню*/
 	connect_menu_bar();
 	update_undo_redo_buttons();
 
-/*  */
+/*Настройка древовидного отображения*/
 	auto& tree_view{ *m_gui->tree_view };
 	tree_view.setModel(m_tree_model.get());
 	connect(tree_view.selectionModel(), &QItemSelectionModel::selectionChanged, this, &CompanyManagerUI::selection_changed);
 	show_viewers(false);
 
-/*    */
+/*Поиск сотрудников по индексу, который поддерживается командами правки документа*/
+	m_company_manager->EnableSearchIndex();
+	connect(m_gui->search_edit, &QLineEdit::returnPressed, this, &CompanyManagerUI::search_employee);
+
+/*Инициализация и подключение вспомогательных виджетов*/
 	initialize_stacked_viewers();
 	connect_item_viewers();
+
+/*Парные очереди: вытеснение из истории правок вытесняет и команды отображения*/
+	m_tasks->modify_xml.PairWith(m_tasks->tree_model);
+
+/*Слияние быстрых правок должности и зарплаты (правки ФИО парны командам TreeModel и не сливаются)*/
+	m_tasks->modify_xml.SetCoalescingWindow(command::Type::Xml_ChangeEmployeeFunction, EDIT_COALESCING_WINDOW);
+	m_tasks->modify_xml.SetCoalescingWindow(command::Type::Xml_UpdateEmployeeSalary, EDIT_COALESCING_WINDOW);
+
+/*Автосохранение в файл восстановления*/
+	auto* autosave_timer{ new QTimer(this) };
+	connect(autosave_timer, &QTimer::timeout, this, &CompanyManagerUI::autosave);
+	autosave_timer->start(AUTOSAVE_POLL_INTERVAL);
+
+/*Выполнение команд, отправленных из других потоков*/
+	auto* submission_timer{ new QTimer(this) };
+	connect(submission_timer, &QTimer::timeout, this, &CompanyManagerUI::drain_submitted_edits);
+	submission_timer->start(SUBMISSION_DRAIN_INTERVAL);
+}
+
+void CompanyManagerUI::SubmitEdit(TaskManager<CompanyManager>::submission_t factory) {
+	m_tasks->modify_xml.Submit(std::move(factory));
 }
 
 
 /*******************************************************************************************************************************
- std::function  Small Object Optimization
-
-,  std::function    heap   callable-.
-   -   ,     Small Object Optimization
-   .
-  SSO-  
-( ,     8  - https://en.cppreference.com/w/cpp/utility/functional/function/function)
-    .
-  ,   GCC8.1   16 , MSVC2019      40 .
-    Worker'   ,    
- .
-     (16 ),    this (..    
-       )        ,
- std::tuple<Types&...>,     SSO.
+Об std::function и Small Object Optimization
+
+Известно, что std::function использует аллокацию в heap для хранения callable-объектов.
+Поскольку выделение памяти - операция крайне медленная, все существующие реализации имеют Small Object Optimization
+для объектов небольшого размера.
+Однако размер SSO-буфера не стандартизирован
+(лишь гарантируется, что он не менее 8 байт - https://en.cppreference.com/w/cpp/utility/functional/function/function)
+и не афишируется разработчиками библиотек.
+Опытным путём выяснено, что на GCC8.1 он составляет 16 байт, MSVC2019 последних версий умеет оптимизировать до 40 байт.
+Посколько для хранения самих Worker'ов используется кастомный аллокатор, хотелось бы избежать дополнительных
+выделений памяти.
+Ориентируясь на меньшее значение буфера (16 байт), будем использовать захват this (т.к. срок жизни объект класса
+никогда не закончится раньше срока жизни цепочки обработчиков) и захват по ссылке либо единственной локальной переменной,
+либо std::tuple<Types&...>, чтобы гарантированно воспользоваться преимуществами SSO.
 ********************************************************************************************************************************/
 
 bool CompanyManagerUI::create() {
@@ -44,7 +69,7 @@ bool CompanyManagerUI::create() {
 	PipelineBuilder()
 		.AddHandler(
 			[this](bool& _) {
-				return close_helper(WarningMode::Hide);						//   . false,    
+				return close_helper(WarningMode::Hide);						//Закрываем ранее открытые документы. false, если пользователь отменил операцию
 			})
 		.AddHandler(
 			[this](bool& successfully_created) {
@@ -68,11 +93,12 @@ bool CompanyManagerUI::load() {
 		.AddHandler(
 			[this, &path](bool& _) {
 				path = request_load_file_path();
-				return !path.isEmpty();														//       
+				return !path.isEmpty();														//В случае отмены операции старый документ останется открытым
 			})
 		.AddHandler(
 			[this](bool& _) {
-				return close_helper(WarningMode::Hide);				//   . false,    
+				return close_helper(WarningMode::Hide, TreeModelMode::Retain);	//Закрываем ранее открытые документы. false, если пользователь отмени операцию.
+																				//Дерево модели сохраняется для сверки с новым документом
 			})
 		.AddHandler(
 			[this, &path](bool& _) {
@@ -81,13 +107,19 @@ bool CompanyManagerUI::load() {
 			})
 		.AddHandler(
 			[this](bool& successfully_loaded) {
-				auto result{ load_helper() };
+				auto result{ recover_helper() };
+				if (!result) {
+					result = load_helper();
+				}
 				if (result) {
 					successfully_loaded = handle_load_result(*result);
 				}
 				else {
 					unable_to_load_msg();
 				}
+				if (!successfully_loaded) {
+					m_tree_model->Reset();											//Сохранённое дерево модели сверять не с чем
+				}
 				return successfully_loaded;
 			})
 		.AddHandler(
@@ -109,11 +141,11 @@ bool CompanyManagerUI::save() {
 				if (
 					path.isEmpty()
 					|| !is_writable(path)
-					) {																	//     -   " "
+					) {																	//Если путь пуст или некорректен - переходим в "Сохранить как"
 					successfully_saved = save_as();
 					return false;
 				}
-				return true;														//     
+				return true;														//Иначе продолжаем движение по цепочке обработчиков
 			})
 		.AddHandler(
 			[this](bool& _) {
@@ -140,8 +172,8 @@ bool CompanyManagerUI::save() {
 				else {
 					unable_to_save_msg();
 				}
-				return false;														//  , 
-			})																		//      pass_on Worker'a
+				return false;														//Завершаем цепочку вручную, 
+			})																		//чтобы не производить дополнительную проверку в pass_on Worker'a
 		.Assemble()->Process(successfully_saved);
 	return successfully_saved;
 }
@@ -171,7 +203,7 @@ bool CompanyManagerUI::save_as() {
 		.AddHandler(
 			[this, &path](bool& _) {
 				path = request_save_file_path();
-				return !path.isEmpty();													//   -   (  )
+				return !path.isEmpty();													//Если путь пустой - прекращаем обработку (операция отменена пользователем)
 			})
 		.AddHandler(
 			[this, &path](bool& _) {
@@ -184,21 +216,121 @@ bool CompanyManagerUI::save_as() {
 				if (result) {
 					successfully_saved = handle_save_result(*result);
 				}
-				return false;													//  , 
-			})																	//      pass_on Worker'a
+				return false;													//Завершаем цепочку вручную, 
+			})																	//чтобы не производить дополнительную проверку в pass_on Worker'a
 		.Assemble()->Process(successfully_saved);
 	return successfully_saved;
 }
 
+bool CompanyManagerUI::import_employees() {
+	QString path;
+	std::vector<wrapper::StaffList> staff;
+	bool successfully_imported{ false };
+
+	PipelineBuilder()
+		.AddHandler(
+			[this](bool& _) {
+				if (!is_loaded()) {
+					not_loaded_msg();
+					return false;
+				}
+				return true;
+			})
+		.AddHandler(
+			[this, &path](bool& _) {
+				path = request_load_file_path(TABLE_FILTER);
+				return !path.isEmpty();
+			})
+		.AddHandler(
+			[this, &path, &staff](bool& _) {
+				std::string native_path{ path.toStdString() };
+				std::ifstream input(native_path, std::ios::binary);
+				try {
+					staff = table::LoadStaff(										//Разбор - в несколько потоков, сборка узлов - в аллокаторе документа
+						input,
+						m_company_manager->GetAllocator(),
+						{ table::FormatFromPath(native_path) }
+					);
+				}
+				catch (const std::exception& exc) {
+					unable_to_import_msg(exc.what());
+					return false;
+				}
+				return !staff.empty();
+			})
+		.AddHandler(
+			[this, &staff](bool& successfully_imported) {
+				std::optional<command::xml_wrapper::ImportEmployees::Statistics> stats;
+				successfully_imported = batch_helper(
+					[this, &staff, &stats](TaskManager<CompanyManager>& tm) {
+						auto result{
+							tm.Process(command::xml_wrapper::ImportEmployees::make_instance(*m_company_manager, std::move(staff)))
+						};
+						if (result.type == task::ResultType::Success) {
+							stats = std::get<command::xml_wrapper::ImportEmployees::Statistics>(result.value);
+						}
+						return result;
+					}
+				);
+				if (successfully_imported) {
+					reset_redo_queues();
+					import_result_msg(*stats);
+				}
+				update_undo_redo_buttons();
+				return false;
+			})
+		.Assemble()->Process(successfully_imported);
+	return successfully_imported;
+}
+
+bool CompanyManagerUI::export_employees() {
+	QString path;
+	bool successfully_exported{ false };
+
+	PipelineBuilder()
+		.AddHandler(
+			[this](bool& _) {
+				if (!is_loaded()) {
+					not_loaded_msg();
+					return false;
+				}
+				return true;
+			})
+		.AddHandler(
+			[this, &path](bool& _) {
+				path = request_save_file_path(TABLE_FILTER);
+				return !path.isEmpty();
+			})
+		.AddHandler(
+			[this, &path](bool& successfully_exported) {
+				std::string native_path{ path.toStdString() };
+				std::ofstream output(native_path, std::ios::binary);
+				table::Writer(output, table::FormatFromPath(native_path))				//Деструктор Writer'a сбрасывает буфер в поток
+					.WriteCompany(m_company_manager->Read());
+				successfully_exported = static_cast<bool>(output);
+				if (!successfully_exported) {
+					unable_to_save_msg();
+				}
+				return false;
+			})
+		.Assemble()->Process(successfully_exported);
+	return successfully_exported;
+}
+
 void CompanyManagerUI::close() {
-	close_helper(WarningMode::Show);											//,    
+	close_helper(WarningMode::Show);											//Предупреждение, если нет открытых документов
 }
 
 void CompanyManagerUI::exit() {
 	QWidget::close();
 }
 
-bool CompanyManagerUI::undo() {									//       
+bool CompanyManagerUI::undo() {									//Порядок отмены операций един для команд различных типов
+	if (!m_tasks->modify_xml.IsLastProcessedPaired()) {					//Пакет или правка без команды отображения (должность, оклад)
+		bool success{ batch_helper(&TaskManager<CompanyManager>::Cancel) };
+		update_undo_redo_buttons();
+		return success;
+	}
 	bool wrapper_success{ false };
 	PipelineBuilder()
 		.AddHandler(
@@ -210,7 +342,7 @@ bool CompanyManagerUI::undo() {									//
 				else {
 					wrapper_success = true;
 				}
-				return true;									//    TreeModel
+				return true;									//Попытка изменить данные в TreeModel
 			})
 		.AddHandler(
 			[this](bool& wrapper_success) {
@@ -219,7 +351,7 @@ bool CompanyManagerUI::undo() {									//
 					handle_internal_fatal_error(m_tasks->modify_xml);
 					if (wrapper_success) {
 						wrapper_success = false;
-						m_tasks->modify_xml.RepeatWithoutQueueing();		//    ,      -  
+						m_tasks->modify_xml.RepeatWithoutQueueing();		//Если обновление отбражения не удалось, но дерево данных обновлено успешно - отменяем изменения
 					}
 				}
 				return false;
@@ -230,10 +362,15 @@ bool CompanyManagerUI::undo() {									//
 	return wrapper_success;
 }
 
-bool CompanyManagerUI::redo() {									//       
+bool CompanyManagerUI::redo() {									//Порядок повторного выполнения операций зависит от типа команды
+	if (!m_tasks->modify_xml.IsLastCanceledPaired()) {
+		bool success{ batch_helper(&TaskManager<CompanyManager>::Repeat) };
+		update_undo_redo_buttons();
+		return success;
+	}
 	bool wrapper_success{ false };
 	bool reversed_order{
-		*m_tasks->modify_xml.GetLastProcessedPurpose() == command::Purpose::Remove	//  (..  )  -  
+		*m_tasks->modify_xml.GetLastProcessedPurpose() == command::Purpose::Remove	//Последняя выполненная (т.е. отменяемая сейчас) команда - удаление элемента
 	};
 
 	auto redo_in_wrapper_tree{
@@ -270,8 +407,8 @@ bool CompanyManagerUI::redo() {									//
 		}
 	};
 	if (reversed_order) {
-		wrapper_success = redo_helper(std::ref(redo_in_tree_model), std::ref(redo_in_wrapper_tree));		//..  -  ,    
-	}																										//  std::reference_wrapper
+		wrapper_success = redo_helper(std::ref(redo_in_tree_model), std::ref(redo_in_wrapper_tree));		//Т.к. обработчики - локальные переменные, можно передать их 
+	}																										//с помощью std::reference_wrapper
 	else {
 		wrapper_success = redo_helper(std::ref(redo_in_wrapper_tree), std::ref(redo_in_tree_model));
 	}
@@ -283,54 +420,54 @@ bool CompanyManagerUI::redo() {									//
 void CompanyManagerUI::about_program() const {
 	show_message(
 		message::Type::Info,
-		u8" ",
-		u8"Company Manager -  \n"
-		u8"    \n",
+		u8"О программе",
+		u8"Company Manager - управление персоналом\n"
+		u8"Обработка данных подразделений и сотрудников\n",
 		QMessageBox::Button::Ok
 	);
 }
 
 void CompanyManagerUI::selection_changed(const QItemSelection& selected, const QItemSelection& deselected) {
 	const auto& index_list{ selected.indexes() };
-	if (index_list.isEmpty()) {											//   
-		select_viewer(QModelIndex());									//  -   
+	if (index_list.isEmpty()) {											//Элементы для отображения отсутствуют
+		select_viewer(QModelIndex());									//Для установки виджета-заглушки в качестве отображения
 	}
 	else {
-		select_viewer(index_list.front());								//    
+		select_viewer(index_list.front());								//Возможен выбор только одного элемента
 	}
 }
 
 bool CompanyManagerUI::new_department() {
 	bool successfully_inserted{ false };
 
-	QModelIndex current_selection_idx{ get_current_selection_index() };									//  
-	bool append{																						//  
-		!current_selection_idx.isValid()																//  
-		|| *m_tree_model->GetItemType(current_selection_idx) != CompanyTreeModel::ItemType::Department	//   
-		|| current_selection_idx.row() + 1 == m_tree_model->rowCount()									//   
+	QModelIndex current_selection_idx{ get_current_selection_index() };									//Индекс выделенного элемента
+	bool append{																						//Добавление в конец
+		!current_selection_idx.isValid()																//Нет выделенных элементов
+		|| *m_tree_model->GetItemType(current_selection_idx) != CompanyTreeModel::ItemType::Department	//Валидность индекса уже проверена
+		|| current_selection_idx.row() + 1 == m_tree_model->rowCount()									//Последний элемент в списке
 	};
 
 	wrapper::DepartmentBuilder builder;
 	builder.SetAllocator(m_company_manager->GetAllocator());
-	std::variant<std::monostate, Company::department_view_it, Department> department;					//    
+	std::variant<std::monostate, Company::department_view_it, Department> department;					//Для проверки дубликатов перед вставкой
 
 	auto arg_tuple{ std::tie(builder, department, current_selection_idx, append) };
 
 	PipelineBuilder()
 		.AddHandler(
 			[&builder, &msg_factories = m_message_factories](bool& _) {
-				dialog::NewDepartment new_department_dialog(builder, msg_factories);				//   
+				dialog::NewDepartment new_department_dialog(builder, msg_factories);				//Диалоговое окно создания поздразделения
 				return new_department_dialog.exec() == QDialog::Accepted;
 			})
 		.AddHandler(
 			[this, &arg_tuple](bool& _) {
-				auto& [builder, department_holder, _1, _2] {arg_tuple};			//  . 
-				department_holder.emplace<Department>(builder.Assemble());		// const   auto&     
+				auto& [builder, department_holder, _1, _2] {arg_tuple};			//Распаковываем кортеж обратно. 
+				department_holder.emplace<Department>(builder.Assemble());		//Спецификатор const к ссылке auto& будет добавлен автоматически при необходимости
 				auto& department{ std::get<Department>(department_holder) };	
 
 				if (m_company_manager->Read().Containts(department.GetName())) {
 					already_exists_msg(
-						QString(u8" \"") + QString::fromStdString(department.GetName()) + u8'\"' // 
+						QString(u8"Подразделение \"") + QString::fromStdString(department.GetName()) + u8'\"' //уже сущесвует
 					);
 					return false;
 				}
@@ -351,7 +488,7 @@ bool CompanyManagerUI::new_department() {
 					if (auto it = insert_department_helper(
 						std::move(std::get<Department>(department_holder)),
 						*m_tree_model->GetDepartmentNameRef(
-							m_tree_model->GetNextItem(current_selection_idx)		//  ,   
+							m_tree_model->GetNextItem(current_selection_idx)		//Получаем имя элемента, следующего за выделенным
 						)
 					); it.has_value()) {
 						department_holder = *it;
@@ -376,9 +513,9 @@ bool CompanyManagerUI::new_department() {
 					handle_internal_fatal_error(m_tasks->tree_model);
 				}
 				else {
-					successfully_inserted = std::any_cast<bool>(value);
+					successfully_inserted = std::get<bool>(value);
 				}
-				return !successfully_inserted;														//      
+				return !successfully_inserted;														//Отмена операции и очистка в случае неудачи
 			})
 		.AddHandler(
 			[&task_manager = m_tasks->modify_xml](bool& _) {
@@ -391,7 +528,7 @@ bool CompanyManagerUI::new_department() {
 }
 
 bool CompanyManagerUI::remove_department(const DepartmentViewInfo& view_info) {
-	bool successfully_removed{ false };											// -  TreeModel,  -  CompanyManager
+	bool successfully_removed{ false };											//сначала - из TreeModel, потом - из CompanyManager
 	wrapper::string_ref department_name{ extract_department_name(view_info) };
 	auto arg_tuple{ std::tie(view_info, department_name) };
 
@@ -404,7 +541,7 @@ bool CompanyManagerUI::remove_department(const DepartmentViewInfo& view_info) {
 						command::tree_model::RemoveDepartment::make_instance(
 							*m_tree_model,
 							*m_company_manager,
-							department_name,										//      
+							department_name,										//После удаления выделение сместится на другой элемент
 							static_cast<size_t>(view_info.index.row())
 						)
 					)
@@ -423,7 +560,8 @@ bool CompanyManagerUI::remove_department(const DepartmentViewInfo& view_info) {
 						command::xml_wrapper::RemoveDepartment::make_instance(
 							*m_company_manager,
 							department_name
-						)
+						),
+						task::Pairing::Paired
 					)
 				};
 				if (result_type != task::ResultType::Success) {
@@ -432,7 +570,7 @@ bool CompanyManagerUI::remove_department(const DepartmentViewInfo& view_info) {
 				else {
 					successfully_removed = true;
 				}
-				return false;													//     
+				return false;													//Вручную останавливаем движение по цепочке обработчиков
 			})
 	.Assemble()->Process(successfully_removed);
 	update_redo_undo_actions_after_editing();
@@ -441,11 +579,11 @@ bool CompanyManagerUI::remove_department(const DepartmentViewInfo& view_info) {
 
 bool CompanyManagerUI::rename_department(const DepartmentViewInfo& view_info, const QString& new_name) {
 	if (new_name.isEmpty()) {
-		empty_field_msg(u8"");
+		empty_field_msg(u8"Наименование");
 		return false;
 	}
 	if (!rename_department_helper(view_info, new_name)) {
-		m_item_viewers.department->RestoreName();												//  
+		m_item_viewers.department->RestoreName();												//Возврат исходного значения
 		return false;
 	}
 	reset_redo_queues();
@@ -458,14 +596,14 @@ bool CompanyManagerUI::new_employee(const DepartmentViewInfo& view_info) {
 
 	wrapper::EmployeeBuilder builder;
 	builder.SetAllocator(m_company_manager->GetAllocator());
-	std::variant<std::monostate, Department::employee_view_it, Employee> employee;						// 
+	std::variant<std::monostate, Department::employee_view_it, Employee> employee;						//Временное хранилище
 
 	auto arg_tuple{ std::tie(builder, employee, view_info) };
 
 	PipelineBuilder()
 		.AddHandler(
 			[&builder, &msg_factories = m_message_factories](bool& _) {
-				dialog::NewEmployee new_employee_dialog(builder, msg_factories);							//   
+				dialog::NewEmployee new_employee_dialog(builder, msg_factories);							//Диалоговое окно создания поздразделения
 				return new_employee_dialog.exec() == QDialog::Accepted;
 			})
 		.AddHandler(
@@ -474,15 +612,14 @@ bool CompanyManagerUI::new_employee(const DepartmentViewInfo& view_info) {
 				employee_holder.emplace<Employee>(builder.Assemble());
 				const auto& employee_name{ std::get<Employee>(employee_holder).GetFullName() };
 
-				if (extract_department_ptr(view_info)->Containts(employee_name)
-					) {
+				if (m_company_manager->Read().FindEmployee(employee_name, *extract_department_ptr(view_info))) {	//Поиск по индексу компании
 					already_exists_msg(
-						QString(u8"   \"") + CompanyTreeModel::FullNameRefToQString(employee_name) + u8'\"'
+						QString(u8"Сотрудник с ФИО \"") + CompanyTreeModel::FullNameRefToQString(employee_name) + u8'\"'
 					);
 					return false;
 				}
 				return true;
-			})																									// Company
+			})																									//из Company
 		.AddHandler(
 			[this, &arg_tuple](bool& _0) {
 				auto& [_1, employee_holder, view_info] {arg_tuple};
@@ -491,15 +628,16 @@ bool CompanyManagerUI::new_employee(const DepartmentViewInfo& view_info) {
 						command::xml_wrapper::InsertEmployee::make_instance(
 							*m_company_manager,
 							extract_department_name(view_info),
-							std::move(std::get<Employee>(employee_holder))								//   
-						)
+							std::move(std::get<Employee>(employee_holder))								//Перемещаем сотрудника в команду
+						),
+						task::Pairing::Paired
 					)
 				};
 				if (result_type != task::ResultType::Success) {
 					handle_internal_fatal_error(m_tasks->modify_xml);
 					return false;
 				}
-				employee_holder = std::any_cast<Department::employee_it>(value);				//   employee_view_it
+				employee_holder = std::get<Department::employee_it>(value);				//Неявное преобразование в employee_view_it
 				return true;
 			})
 		.AddHandler(
@@ -513,8 +651,8 @@ bool CompanyManagerUI::new_employee(const DepartmentViewInfo& view_info) {
 								std::addressof(m_company_manager->Read()),
 								extract_department_name(view_info)
 							},
-							view_info.index.row(),												// 
-							std::get<Department::employee_view_it>(employee_holder)->second		//    
+							view_info.index.row(),												//Индекс подразделения
+							std::get<Department::employee_view_it>(employee_holder)->second		//Передаем ссылку на вставленный элемент
 						)
 					)
 				};
@@ -522,27 +660,27 @@ bool CompanyManagerUI::new_employee(const DepartmentViewInfo& view_info) {
 					handle_internal_fatal_error(m_tasks->tree_model);
 					return false;
 				}
-				successfully_inserted = std::any_cast<bool>(value);
+				successfully_inserted = std::get<bool>(value);
 				return !successfully_inserted;
 			})
 		.AddHandler(
-			[&task_manager = m_tasks->modify_xml](bool& _) {					//      
+			[&task_manager = m_tasks->modify_xml](bool& _) {					//Отмена операции и очистка в случае неудачи
 				task_manager.CancelWithoutQueueing();
 				return false;
 			})
 		.Assemble()->Process(successfully_inserted);
 	if (successfully_inserted) {
-		m_item_viewers.department->UpdateStats();								//..      
-	}																			// ,  
+		m_item_viewers.department->UpdateStats();								//Т.к. операция добавления сотрудника выполняется из окна
+	}																			//статистики подразделения, обновляем статистику
 	update_redo_undo_actions_after_editing();
 	return successfully_inserted;
 }
 
-bool CompanyManagerUI::remove_employee(const EmployeeViewInfo& view_info) {		//     :
-	bool successfully_removed{ false };											// -  TreeModel,  -  CompanyManager
-	EmployeePersonalFile personal_data{ extract_employee_personal_data(view_info) };	//   ,    TreeModel  
-																						// extract_employee_personal_data()   ,
-	PipelineBuilder()																	//  !
+bool CompanyManagerUI::remove_employee(const EmployeeViewInfo& view_info) {		//Удаление необходимо выполнять в обратном порядке:
+	bool successfully_removed{ false };											//сначала - из TreeModel, потом - из CompanyManager
+	EmployeePersonalFile personal_data{ extract_employee_personal_data(view_info) };	//Если не сохранить предварительно, после удаления из TreeModel индекс обновится
+																						//и extract_employee_personal_data() вернёт данные элемента,
+	PipelineBuilder()																	//следующего за удалённым!
 		.AddHandler(
 			[this, &view_info](bool& _0) {
 				auto [_1, result_type] {
@@ -553,7 +691,7 @@ bool CompanyManagerUI::remove_employee(const EmployeeViewInfo& view_info) {		//
 								std::addressof(m_company_manager->Read()),
 								extract_department_name(view_info)
 							},
-							view_info.index										//QModelIndex   
+							view_info.index										//QModelIndex пока ещеё валиден
 						)
 					)
 				};
@@ -570,7 +708,8 @@ bool CompanyManagerUI::remove_employee(const EmployeeViewInfo& view_info) {		//
 						command::xml_wrapper::RemoveEmployee::make_instance(
 							*m_company_manager,
 							personal_data
-						)
+						),
+						task::Pairing::Paired
 					)
 				};
 				if (result_type != task::ResultType::Success) {
@@ -579,7 +718,7 @@ bool CompanyManagerUI::remove_employee(const EmployeeViewInfo& view_info) {		//
 				else {
 					successfully_removed = true;
 				}
-				return false;													//     
+				return false;													//Вручную останавливаем движение по цепочке обработчиков
 			})
 		.Assemble()->Process(successfully_removed);
 	update_redo_undo_actions_after_editing();
@@ -596,7 +735,7 @@ bool CompanyManagerUI::change_employee_surname(const EmployeeViewInfo& view_info
 		.AddHandler(
 			[this, &new_surname](bool& _) {
 				if (new_surname.isEmpty()) {
-					empty_field_msg(u8"");
+					empty_field_msg(u8"Фамилия");
 					return false;
 				}
 				return true;
@@ -610,14 +749,15 @@ bool CompanyManagerUI::change_employee_surname(const EmployeeViewInfo& view_info
 							*m_company_manager,
 							extract_employee_personal_data(view_info),
 							new_surname.toStdString()
-						)
+						),
+						task::Pairing::Paired
 					)
 				};
 				if (result_type != task::ResultType::Success) {
 					handle_internal_fatal_error(m_tasks->modify_xml);
 				}
 				else {
-					successfully_changed = warning_if_employee_already_exists(std::any_cast<wrapper::RenameResult>(value));
+					successfully_changed = warning_if_employee_already_exists(std::get<wrapper::RenameResult>(value));
 				}
 				return successfully_changed;
 			})
@@ -626,7 +766,7 @@ bool CompanyManagerUI::change_employee_surname(const EmployeeViewInfo& view_info
 				auto& [view_info, new_surname, new_full_name] {arg_tuple};
 				new_full_name = CompanyTreeModel::FullNameRefToQString(
 					extract_employee_personal_data(view_info).employee_name
-				);																	 //      
+				);																	 //Для обновления отображения после удачого редактирования дерева
 				successfully_changed = rename_employee_in_tree_model(view_info, new_full_name);
 				return !successfully_changed;
 			})
@@ -653,7 +793,7 @@ bool CompanyManagerUI::change_employee_name(const EmployeeViewInfo& view_info, c
 		.AddHandler(
 			[this, &new_name](bool& _) {
 				if (new_name.isEmpty()) {
-					empty_field_msg(u8"");
+					empty_field_msg(u8"Имя");
 					return false;
 				}
 				return true;
@@ -667,7 +807,8 @@ bool CompanyManagerUI::change_employee_name(const EmployeeViewInfo& view_info, c
 							*m_company_manager,
 							extract_employee_personal_data(view_info),
 							new_name.toStdString()
-						)
+						),
+						task::Pairing::Paired
 					)
 				};
 				if (result_type != task::ResultType::Success) {
@@ -675,7 +816,7 @@ bool CompanyManagerUI::change_employee_name(const EmployeeViewInfo& view_info, c
 				}
 				else {
 					successfully_changed = warning_if_employee_already_exists(
-						std::any_cast<wrapper::RenameResult>(value)
+						std::get<wrapper::RenameResult>(value)
 					);
 				}
 				return successfully_changed;
@@ -712,7 +853,7 @@ bool CompanyManagerUI::change_employee_middle_name(const EmployeeViewInfo& view_
 		.AddHandler(
 			[this, &new_middle_name](bool& _) {
 				if (new_middle_name.isEmpty()) {
-					empty_optional_field_msg_dlg(u8"");
+					empty_optional_field_msg_dlg(u8"Отчество");
 					return false;
 				}
 				return true;
@@ -726,7 +867,8 @@ bool CompanyManagerUI::change_employee_middle_name(const EmployeeViewInfo& view_
 							*m_company_manager,
 							extract_employee_personal_data(view_info),
 							new_middle_name.toStdString()
-						)
+						),
+						task::Pairing::Paired
 					)
 				};
 				if (result_type != task::ResultType::Success) {
@@ -734,7 +876,7 @@ bool CompanyManagerUI::change_employee_middle_name(const EmployeeViewInfo& view_
 				}
 				else {
 					successfully_changed = warning_if_employee_already_exists(
-						std::any_cast<wrapper::RenameResult>(value)
+						std::get<wrapper::RenameResult>(value)
 					);
 				}
 				return successfully_changed;
@@ -770,7 +912,7 @@ bool CompanyManagerUI::change_employee_function(const EmployeeViewInfo& view_inf
 		.AddHandler(
 			[this, &new_function](bool& _) {
 				if (new_function.isEmpty()) {
-					return empty_optional_field_msg_dlg(u8"") == QMessageBox::StandardButton::Ok;
+					return empty_optional_field_msg_dlg(u8"Должность") == QMessageBox::StandardButton::Ok;
 				}
 				return true;
 			})
@@ -796,7 +938,7 @@ bool CompanyManagerUI::change_employee_function(const EmployeeViewInfo& view_inf
 			})
 		.Assemble()->Process(successfully_changed);
 	if (!successfully_changed) {
-		m_item_viewers.employee->RestoreFunction();														//      
+		m_item_viewers.employee->RestoreFunction();														//Считывание из дерева и восстановление предыдущего значения
 	}
 	update_redo_undo_actions_after_editing();
 	return successfully_changed;
@@ -837,17 +979,69 @@ bool CompanyManagerUI::update_employee_salary(const EmployeeViewInfo& view_info,
 			})
 		.Assemble()->Process(successfully_updated);
 	if (!successfully_updated) {
-		m_item_viewers.employee->RestoreSalary();														//   
+		m_item_viewers.employee->RestoreSalary();														//Повторное считывание из дерева
 	}
 	update_redo_undo_actions_after_editing();
 	return successfully_updated;
 }
 
+void CompanyManagerUI::search_employee() {
+	const auto* index{ m_company_manager->GetSearchIndex() };
+	QString query{ m_gui->search_edit->text().trimmed() };
+	if (!is_loaded() || !index || query.isEmpty()) {
+		return;
+	}
+	if (query != m_search.query) {
+		m_search = { query, 0 };
+	}
+	auto matches{ run_search_query(*index, query) };
+	if (matches.empty()) {
+		m_gui->status_bar->showMessage(u8"Сотрудники не найдены", 3000);
+		return;
+	}
+	size_t pos{ m_search.position++ % matches.size() };
+	QModelIndex found{ m_tree_model->LocateEmployee(*matches[pos].department, *matches[pos].employee) };
+	if (found.isValid()) {
+		m_gui->tree_view->scrollTo(found);
+		m_gui->tree_view->setCurrentIndex(found);									//Окно просмотра обновится в selection_changed()
+	}
+	m_gui->status_bar->showMessage(
+		QString(u8"Совпадение %1 из %2").arg(pos + 1).arg(matches.size()), 3000
+	);
+}
+
+void CompanyManagerUI::autosave() {
+	try {
+		m_autosaver->Poll();
+	}
+	catch (const std::exception&) {											//Автосохранение не должно мешать редактированию
+	}
+}
+
+void CompanyManagerUI::drain_submitted_edits() {
+	if (!is_loaded() || !m_tasks->modify_xml.HasSubmitted()) {					//Команды ждут открытия документа
+		return;
+	}
+	bool success{
+		batch_helper(
+			[&company_manager = *m_company_manager](TaskManager<CompanyManager>& tm) {
+				return tm.DrainSubmitted(company_manager);						//Одна запись истории и одна сверка модели на пакет
+			}
+		)
+	};
+	if (success) {
+		reset_redo_queues();
+	}
+	update_undo_redo_buttons();
+}
+
 void CompanyManagerUI::connect_menu_bar() {
 	connect(m_gui->new_btn, &QAction::triggered, this, &CompanyManagerUI::create);
 	connect(m_gui->open_btn, &QAction::triggered, this, &CompanyManagerUI::load);
 	connect(m_gui->save_btn, &QAction::triggered, this, &CompanyManagerUI::save);
 	connect(m_gui->save_as_btn, &QAction::triggered, this, &CompanyManagerUI::save_as);
+	connect(m_gui->import_btn, &QAction::triggered, this, &CompanyManagerUI::import_employees);
+	connect(m_gui->export_btn, &QAction::triggered, this, &CompanyManagerUI::export_employees);
 	connect(m_gui->close_btn, &QAction::triggered, this, &CompanyManagerUI::close);
 	connect(m_gui->exit_btn, &QAction::triggered, this, &CompanyManagerUI::exit);
 	connect(m_gui->undo_btn, &QAction::triggered, this, &CompanyManagerUI::undo);
@@ -857,10 +1051,10 @@ void CompanyManagerUI::connect_menu_bar() {
 
 void CompanyManagerUI::initialize_stacked_viewers() {
 	auto& stacked_viewer{ *m_gui->stacked_viewer };
-	m_item_viewers = {															//       
-		new QWidget(this),														//       new, 
-		new DepartmentView(this),												//..        
-		new EmployeeView(this)													//     
+	m_item_viewers = {															//Такая инициализация полей обеспечивает защиту от утечки памяти
+		new QWidget(this),														//при выбросе исключения в одном из вызовов new, 
+		new DepartmentView(this),												//т.к. к тому моменту остальные объекты гарантированно будут 
+		new EmployeeView(this)													//приняты во владение главным окном приложения
 	};
 	stacked_viewer.addWidget(m_item_viewers.dummy);
 	stacked_viewer.addWidget(m_item_viewers.department);
@@ -899,23 +1093,35 @@ void CompanyManagerUI::update_redo_undo_actions_after_editing() {
 	update_undo_redo_buttons();
 }
 
+template <class Operation>
+bool CompanyManagerUI::batch_helper(Operation operation) {
+	auto [_, result] {std::invoke(operation, m_tasks->modify_xml)};			//Пакет не имеет парных команд модели: вместо N поэлементных
+	m_tree_model->Synchronize(*m_company_manager);							//уведомлений модель сверяется с деревом данных один раз
+	if (result == task::ResultType::Fail) {
+		handle_internal_fatal_error(m_tasks->modify_xml);
+	}
+	update_viewers();
+	return result == task::ResultType::Success;
+}
+
 void CompanyManagerUI::update_viewers() {
-	select_viewer(																			//    
+	select_viewer(																			//Обновляем данные в окне просмотра
 		get_current_selection_index()
 	);			
 }
 
 void CompanyManagerUI::setup_viewers() {
 	m_tree_model->SetCompany(*m_company_manager);
-	m_gui->stacked_viewer->setCurrentWidget(m_item_viewers.dummy);							//   
+	update_viewers();																		//Выделение могло сохраниться после сверки модели, иначе - пустое окно просмотра
 	show_viewers(true);
 }
 
 void CompanyManagerUI::select_viewer(const QModelIndex& selected_item) {
 	using ItemType = CompanyTreeModel::ItemType;
 	auto item_type{ m_tree_model->GetItemType(selected_item) };
-	if (!item_type || *item_type == ItemType::Company) {							//    
+	if (!item_type || *item_type == ItemType::Company) {							//Не выделены поздразделения или работники
 		m_gui->stacked_viewer->setCurrentWidget(m_item_viewers.dummy);
+		return;
 	}
 	switch (*item_type) {
 	case ItemType::Department: {
@@ -945,7 +1151,7 @@ void CompanyManagerUI::update_employee_viewer(const QModelIndex& selected_item)
 		EmployeeView::view_info{ 
 			selected_item, 
 			std::tuple{
-				*m_tree_model->GetDepartmentNameRef(selected_item),		//   -        
+				*m_tree_model->GetDepartmentNameRef(selected_item),		//Раз объект выбран - он точно существует и является подразделением или сотрудником
 				std::get<const Employee*>(
 						m_tree_model->GetItemNode(selected_item)
 				)
@@ -955,6 +1161,7 @@ void CompanyManagerUI::update_employee_viewer(const QModelIndex& selected_item)
 }
 
 void CompanyManagerUI::show_viewers(bool on) {
+	m_gui->search_edit->setEnabled(on);
 	if (on) {
 		m_gui->company_viewer->show();
 		m_gui->stacked_viewer->show();
@@ -965,19 +1172,25 @@ void CompanyManagerUI::show_viewers(bool on) {
 	}
 }
 
-void CompanyManagerUI::reset_helper() {														//   
+void CompanyManagerUI::reset_helper(TreeModelMode tree_model_mode) {							//Сброк при закрытии документа
+	m_autosaver->DiscardRecovery();																//Пользователь уже решил судьбу несохранённых изменений
 	m_tasks->service.Process(command::file_io::Reset::make_instance(*m_company_manager));
-	m_tasks->service.ResetQueues();															//      
+	m_tasks->service.ResetQueues();															//Сброк очереди команд без очистки лога ошибок
 	m_tasks->modify_xml.ResetQueues();	
 	m_tasks->tree_model.ResetQueues();
 	update_undo_redo_buttons();
-	m_tree_model->Reset();
+	if (tree_model_mode == TreeModelMode::Reset) {
+		m_tree_model->Reset();
+	}
+	else {
+		m_tree_model->Detach();																//Узлы XML-дерева уже уничтожены
+	}
 	m_item_viewers.department->Reset();
 	m_item_viewers.employee->Reset();
 	show_viewers(false);
 }
 
-bool CompanyManagerUI::close_helper(WarningMode no_loaded) {
+bool CompanyManagerUI::close_helper(WarningMode no_loaded, TreeModelMode tree_model_mode) {
 	bool not_cancelled{ true };
 
 	PipelineBuilder()	
@@ -999,15 +1212,15 @@ bool CompanyManagerUI::close_helper(WarningMode no_loaded) {
 					};
 					auto user_answer{ save_before_close_request(file_name)};
 					switch (user_answer) {
-						case QMessageBox::StandardButton::Save: not_cancelled = save(); break;		//       
+						case QMessageBox::StandardButton::Save: not_cancelled = save(); break;		//В окне выбора пути операция может быть отменена
 						case QMessageBox::StandardButton::Cancel: not_cancelled = false; break;
 					}
 				}
 				return not_cancelled;
 			})
 		.AddHandler(
-			[this](bool& _) {
-				reset_helper();
+			[this, tree_model_mode](bool& _) {
+				reset_helper(tree_model_mode);
 				return false;
 			})
 		.Assemble()->Process(not_cancelled);
@@ -1016,7 +1229,7 @@ bool CompanyManagerUI::close_helper(WarningMode no_loaded) {
 
 void CompanyManagerUI::closeEvent(QCloseEvent* event) {
 	if (!close_helper(WarningMode::Hide)) {
-		event->ignore();															//    -   
+		event->ignore();															//Файл не был сохранён - пользователь отменил операцию
 	}
 	else {
 		event->accept();
@@ -1042,10 +1255,10 @@ QMessageBox::StandardButton CompanyManagerUI::show_message(
 }
 
 void CompanyManagerUI::internal_fatal_error_msg(QString title, const std::string& error_definition) const noexcept {
-	QString text(u8"  \n");
-	text += u8" : ";
+	QString text(u8"Произошёл неисправимый сбой\n");
+	text += u8"Системный лог: ";
 	text += error_definition.empty() ?
-		u8"()" : error_definition.data();
+		u8"(пусто)" : error_definition.data();
 	show_message(
 		message::Type::Critical,
 		std::move(title),
@@ -1058,7 +1271,7 @@ QModelIndex  CompanyManagerUI::get_current_selection_index() {
 }
 
 QMessageBox::StandardButton CompanyManagerUI::save_before_close_request(const QString& file_name) {
-	QString question(u8"   ");
+	QString question(u8"Сохранить изменения в файле");
 	if (!file_name.isEmpty()) {
 		question += ' ';
 		question += file_name;
@@ -1066,19 +1279,19 @@ QMessageBox::StandardButton CompanyManagerUI::save_before_close_request(const QS
 	question += u8"?";
 	return show_message(
 		message::Type::Question,
-		u8" ",
+		u8"Несохранённые изменения",
 		question,
 		QMessageBox::Button::Save | QMessageBox::Button::Discard | QMessageBox::Button::Cancel
 	);
 }
 
 void CompanyManagerUI::empty_field_msg(const QString& field) const{
-	QString text {u8" \""};
+	QString text {u8"Поле \""};
 	text += field;
-	text += u8"\"   ";
+	text += u8"\" должно быть заполнено";
 	show_message(
 		message::Type::Warning,
-		u8" ",
+		u8"Некорректное редактирование",
 		std::move(text),
 		QMessageBox::Button::Ok
 	);
@@ -1087,24 +1300,36 @@ void CompanyManagerUI::empty_field_msg(const QString& field) const{
 void CompanyManagerUI::already_exists_msg(const QString& element_category) const {
 	QString text(element_category);
 	if (text.isEmpty()) {
-		text = u8"";
+		text = u8"Элемент";
 	}
-	text += u8"  ";
+	text += u8" уже существует";
 	show_message(
 		message::Type::Warning,
-		u8" ",
+		u8"Некорректное редактирование",
 		std::move(text),
 		QMessageBox::Button::Ok
 	);
 }
 
 int CompanyManagerUI::empty_optional_field_msg_dlg(const QString& field) const {
-	QString text(u8"     \"");
+	QString text(u8"Сохранить работника с незаполненным полем \"");
 	text += field;
 	text += "\"?";
 	return show_message(
 		message::Type::Question,
-		u8" ",
+		u8"Ошибочное изменение",
+		std::move(text),
+		QMessageBox::Button::Yes | QMessageBox::Button::No
+	);
+}
+
+int CompanyManagerUI::recovery_msg_dlg(const QString& file_name) const {
+	QString text{ u8"Найдена более новая копия документа \"" };
+	text += file_name;
+	text += u8"\", сохранённая автоматически. Восстановить её?";
+	return show_message(
+		message::Type::Question,
+		u8"Восстановление документа",
 		std::move(text),
 		QMessageBox::Button::Yes | QMessageBox::Button::No
 	);
@@ -1113,8 +1338,8 @@ int CompanyManagerUI::empty_optional_field_msg_dlg(const QString& field) const {
 int CompanyManagerUI::zero_salary_msg_dlg() const {
 	return show_message(
 		message::Type::Warning,
-		u8" ",
-		u8"     ?",
+		u8"Ошибочное изменение",
+		u8"Сохранить работника с нулевым значением зарплаты?",
 		QMessageBox::Button::Yes | QMessageBox::Button::No
 	);
 }
@@ -1122,8 +1347,8 @@ int CompanyManagerUI::zero_salary_msg_dlg() const {
 void CompanyManagerUI::not_loaded_msg() const {
 	show_message(
 		message::Type::Warning,
-		u8"",
-		u8"  ",
+		u8"Предупреждение",
+		u8"Нет открытых документов",
 		QMessageBox::Button::Ok
 	);
 }
@@ -1131,8 +1356,8 @@ void CompanyManagerUI::not_loaded_msg() const {
 void CompanyManagerUI::invalid_load_path_msg() const {
 	show_message(
 		message::Type::Warning,
-		u8"  ",
-		u8"     ",
+		u8"Невозможно открыть файл",
+		u8"Проверьте корректность пути и имени файла",
 		QMessageBox::Button::Ok
 	);
 }
@@ -1140,8 +1365,29 @@ void CompanyManagerUI::invalid_load_path_msg() const {
 void CompanyManagerUI::invalid_save_path_msg() const {
 	show_message(
 		message::Type::Warning,
-		u8"  ",
-		u8"     ",
+		u8"Невозможно сохранить файл",
+		u8"Проверьте корректность пути и имени файла",
+		QMessageBox::Button::Ok
+	);
+}
+
+void CompanyManagerUI::unable_to_import_msg(const std::string& reason) const {
+	show_message(
+		message::Type::Warning,
+		u8"Невозможно импортировать сотрудников",
+		QString::fromStdString(reason),
+		QMessageBox::Button::Ok
+	);
+}
+
+void CompanyManagerUI::import_result_msg(const command::xml_wrapper::ImportEmployees::Statistics& stats) const {
+	show_message(
+		message::Type::Info,
+		u8"Импорт завершён",
+		QString(u8"Добавлено сотрудников: %1\nПропущено дубликатов: %2\nСоздано подразделений: %3")
+			.arg(stats.inserted)
+			.arg(stats.duplicates)
+			.arg(stats.departments_created),
 		QMessageBox::Button::Ok
 	);
 }
@@ -1149,8 +1395,8 @@ void CompanyManagerUI::invalid_save_path_msg() const {
 void CompanyManagerUI::unable_to_load_msg() const{
 	show_message(
 		message::Type::Critical,
-		u8"  ",
-		u8"   ,     ",
+		u8"Невозможно открыть файл",
+		u8"Файл недоступен для чтения, поврёжден или имеет неверный формат",
 		QMessageBox::Button::Ok
 	);
 }
@@ -1158,8 +1404,8 @@ void CompanyManagerUI::unable_to_load_msg() const{
 void CompanyManagerUI::unable_to_save_msg() const {
 	show_message(
 		message::Type::Critical,
-		u8"  ",
-		u8"   ",
+		u8"Невозможно сохранить файл",
+		u8"Файл защищён от записи",
 		QMessageBox::Button::Ok
 	);
 }
@@ -1167,15 +1413,15 @@ void CompanyManagerUI::unable_to_save_msg() const {
 void CompanyManagerUI::already_saved_msg() {
 	show_message(
 		message::Type::Info,
-		u8"  ",
-		u8"      ",
+		u8"Сохранение не требуется",
+		u8"Файл не претерпел изменений с последнего сохранения",
 		QMessageBox::Button::Ok
 	);
 }
 
 bool CompanyManagerUI::warning_if_employee_already_exists(wrapper::RenameResult result) const {
 	if (result == wrapper::RenameResult::IsDuplicate) {
-		already_exists_msg(u8"   ");
+		already_exists_msg(u8"Сотрудник с таким ФИО");
 		return false;
 	}
 	return true;
@@ -1183,22 +1429,22 @@ bool CompanyManagerUI::warning_if_employee_already_exists(wrapper::RenameResult
 
 bool CompanyManagerUI::warning_if_department_already_exists(wrapper::RenameResult result) const {
 	if (result == wrapper::RenameResult::IsDuplicate) {
-		already_exists_msg(u8"   ");
+		already_exists_msg(u8"Подразделение с таким наименованием");
 		return false;
 	}
 	return true;
 }
 
-QString CompanyManagerUI::request_load_file_path() {
+QString CompanyManagerUI::request_load_file_path(const char* filter) {
 	QString path;
 	for (;;) {
 		path = m_file_handlers->dialog.getOpenFileName(
 			this,
 			QObject::tr("Open file"),
 			"",
-			QObject::tr("XML files(*.xml) ;; All files(*.*) ")
+			QObject::tr(filter)
 		);
-		if (path.isEmpty() || is_readable(path)) {										//  ->   ""
+		if (path.isEmpty() || is_readable(path)) {										//Пустой путь -> Пользователь нажал "Отмена"
 			break;
 		}
 		else {
@@ -1208,16 +1454,16 @@ QString CompanyManagerUI::request_load_file_path() {
 	return path;
 }
 
-QString CompanyManagerUI::request_save_file_path() {
+QString CompanyManagerUI::request_save_file_path(const char* filter) {
 	QString path;
 	for (;;) {
 		path = m_file_handlers->dialog.getSaveFileName(
 			this,
 			QObject::tr("Open file"),
 			"",
-			QObject::tr("XML files(*.xml) ;; All files(*.*) ")
+			QObject::tr(filter)
 		);
-		if (path.isEmpty() || is_writable(path)) {										//  ->   ""
+		if (path.isEmpty() || is_writable(path)) {										//Пустой путь -> Пользователь нажал "Отмена"
 			break;
 		}
 		else {
@@ -1228,7 +1474,7 @@ QString CompanyManagerUI::request_save_file_path() {
 }
 
 QString CompanyManagerUI::get_current_file_path() {
-	return std::any_cast<std::string_view>(
+	return std::get<std::string_view>(
 			m_tasks->service.Process(command::file_io::GetPath::make_instance(*m_company_manager)).value
 	).data();
 }
@@ -1240,13 +1486,13 @@ QString CompanyManagerUI::extract_file_name(const QString& path) {
 
 
 bool CompanyManagerUI::is_loaded() const {
-	return std::any_cast<bool>(
+	return std::get<bool>(
 		m_tasks->service.Process(command::file_io::CheckLoaded::make_instance(*m_company_manager)).value
 		);
 }
 
 bool CompanyManagerUI::is_saved() const {
-	return std::any_cast<bool>(
+	return std::get<bool>(
 		m_tasks->service.Process(command::file_io::CheckSaved::make_instance(*m_company_manager)).value
 		);
 }
@@ -1263,8 +1509,8 @@ bool CompanyManagerUI::is_readable(const QString& path) const {
 }
 
 bool CompanyManagerUI::is_writable(const QString& path) const {
-	m_file_handlers->info.setFile(path);																//    -   
-	return !m_file_handlers->info.exists() || m_file_handlers->info.isWritable();						// -    
+	m_file_handlers->info.setFile(path);																//Если файла не существует - он будет создан
+	return !m_file_handlers->info.exists() || m_file_handlers->info.isWritable();						//Иначе - проверка на возможность записи
 }
 
 bool CompanyManagerUI::create_helper() {
@@ -1287,9 +1533,9 @@ std::optional<worker::file_operation::Result> CompanyManagerUI::load_helper() {
 		)
 	};
 	if (result_type != task::ResultType::Success) {
-		return std::nullopt;											//     
+		return std::nullopt;											//Сообщение об ошибке выведет вызывающий объект
 	}
-	return std::any_cast<worker::file_operation::Result>(value);
+	return std::get<worker::file_operation::Result>(value);
 }
 
 bool CompanyManagerUI::handle_load_result(worker::file_operation::Result result) {
@@ -1301,6 +1547,22 @@ bool CompanyManagerUI::handle_load_result(worker::file_operation::Result result)
 	};
 }
 
+std::optional<worker::file_operation::Result> CompanyManagerUI::recover_helper() {
+	std::string recovery_path{ m_autosaver->GetRecoveryPath() };
+	if (
+		!Autosaver::HasNewerRecovery(get_current_file_path().toStdString(), recovery_path)
+		|| recovery_msg_dlg(extract_file_name(get_current_file_path())) != QMessageBox::Button::Yes
+		) {
+		return std::nullopt;											//Будет загружен сам документ
+	}
+	try {
+		return m_company_manager->Recover(recovery_path);				//Документ помечается несохранённым
+	}
+	catch (const std::exception&) {
+		return worker::file_operation::Result::FileIOError;
+	}
+}
+
 std::optional<worker::file_operation::Result> CompanyManagerUI::save_helper() {
 	auto [value, result_type] {
 		m_tasks->service.Process(
@@ -1308,9 +1570,9 @@ std::optional<worker::file_operation::Result> CompanyManagerUI::save_helper() {
 		)
 	};
 	if (result_type != task::ResultType::Success) {
-		return std::nullopt;											//     
+		return std::nullopt;											//Сообщение об ошибке выведет вызывающий объект
 	}
-	return std::any_cast<worker::file_operation::Result>(value);
+	return std::get<worker::file_operation::Result>(value);
 }
 
 bool CompanyManagerUI::handle_save_result(worker::file_operation::Result result) {
@@ -1318,7 +1580,7 @@ bool CompanyManagerUI::handle_save_result(worker::file_operation::Result result)
 	switch (result) {
 	case Result::EmptyPath: case Result::FileOpenError: invalid_save_path_msg(); return false;
 	case Result::NoData: case Result::FileIOError: unable_to_save_msg(); return false;
-	default: return true;
+	default: m_autosaver->DiscardRecovery(); return true;
 	};
 }
 
@@ -1328,14 +1590,15 @@ std::optional<CompanyManagerUI::Company::department_view_it> CompanyManagerUI::a
 			command::xml_wrapper::AddDepartment::make_instance(
 				*m_company_manager, 
 				std::move(department)
-			)
+			),
+			task::Pairing::Paired
 		)
 	};
 	if (result_type != task::ResultType::Success) {
 		handle_internal_fatal_error(m_tasks->modify_xml);
 		return std::nullopt;
 	}
-	return std::any_cast<Company::department_it>(value);
+	return std::get<Company::department_it>(value);
 }
 
 std::optional<CompanyManagerUI::Company::department_view_it> CompanyManagerUI::insert_department_helper(Department&& department, wrapper::string_ref before) {
@@ -1345,14 +1608,15 @@ std::optional<CompanyManagerUI::Company::department_view_it> CompanyManagerUI::i
 				*m_company_manager, 
 				before, 
 				std::move(department)
-			)
+			),
+			task::Pairing::Paired
 		)
 	};
 	if (result_type != task::ResultType::Success) {
 		handle_internal_fatal_error(m_tasks->modify_xml);
 		return std::nullopt;
 	}
-	return std::any_cast<Company::department_it>(value);
+	return std::get<Company::department_it>(value);
 }
 
 bool CompanyManagerUI::rename_department_helper(const DepartmentViewInfo& view_info, const QString& new_name) {
@@ -1371,7 +1635,8 @@ bool CompanyManagerUI::rename_department_helper(const DepartmentViewInfo& view_i
 							*m_company_manager,
 							old_name,
 							new_name.toStdString()
-						)
+						),
+						task::Pairing::Paired
 					)
 				};
 				if (result_type != task::ResultType::Success) {
@@ -1379,7 +1644,7 @@ bool CompanyManagerUI::rename_department_helper(const DepartmentViewInfo& view_i
 					return false;
 				}
 				successfully_renamed = warning_if_department_already_exists(
-					std::any_cast<wrapper::RenameResult>(value)
+					std::get<wrapper::RenameResult>(value)
 				);
 				return successfully_renamed;
 			})
@@ -1390,15 +1655,14 @@ bool CompanyManagerUI::rename_department_helper(const DepartmentViewInfo& view_i
 					m_tasks->tree_model.Process(
 						command::tree_model::RenameDepartment::make_instance(
 							*m_tree_model,
-							view_info.index.row(),
-							new_name)
+							view_info.index.row())
 					)
 				};
 				if (result_type != task::ResultType::Success) {
 					handle_internal_fatal_error(m_tasks->tree_model);
 				}
 				else {
-					successfully_renamed = std::any_cast<bool>(value);
+					successfully_renamed = std::get<bool>(value);
 				}
 				return !successfully_renamed;
 			})
@@ -1418,7 +1682,7 @@ bool CompanyManagerUI::rename_employee_in_tree_model(const EmployeeViewInfo& vie
 			command::tree_model::ChangeEmployeeFullName::make_instance(
 				*m_tree_model,
 				command::tree_model::EmployeePersonalFile{
-					static_cast<size_t>(q_idx.parent().row()),						//   
+					static_cast<size_t>(q_idx.parent().row()),						//Позиция подразделения и сотрудника
 					static_cast<size_t>(q_idx.row())
 				},
 				new_full_name
@@ -1428,13 +1692,44 @@ bool CompanyManagerUI::rename_employee_in_tree_model(const EmployeeViewInfo& vie
 	if (result_type != task::ResultType::Success) {
 		handle_internal_fatal_error(m_tasks->tree_model);
 		return false;
-	}																	//   Viewer'e, ..  ,   - !
+	}																	//Обновляем индекс в Viewer'e, т.к. выделение сохранилось, а индекс - изменился!
 	m_item_viewers.employee->UpdateModelIndex(
-		std::any_cast<QModelIndex>(new_q_idx)
+		std::get<QModelIndex>(new_q_idx)
 	);
 	return true;
 }
 
+search::match_list CompanyManagerUI::run_search_query(const search::EmployeeIndex& index, const QString& query) {
+	static const QRegularExpression salary_range{ R"(^(\d+)\s*-\s*(\d+)$)" };
+	if (auto range = salary_range.match(query); range.hasMatch()) {
+		return index.FindBySalary(
+			range.captured(1).toULongLong(),
+			range.captured(2).toULongLong()
+		);
+	}
+	const std::string text{ query.toStdString() };									//UTF-8
+	search::match_list matches;
+	std::unordered_set<const Employee*> found;										//Сотрудник может подойти по нескольким полям
+	auto append{
+		[&matches, &found](search::match_list&& field_matches) {
+			for (const auto& match : field_matches) {
+				if (found.insert(match.employee).second) {
+					matches.push_back(match);
+				}
+			}
+		}
+	};
+	for (auto field : { search::Field::Surname, search::Field::Name, search::Field::MiddleName, search::Field::Function }) {
+		append(index.FindByPrefix(field, text));
+	}
+	if (matches.empty()) {															//Возможна опечатка
+		for (auto field : { search::Field::Surname, search::Field::Name }) {
+			append(index.FindFuzzy(field, text));
+		}
+	}
+	return matches;
+}
+
 const CompanyManagerUI::Department* CompanyManagerUI::extract_department_ptr(const DepartmentViewInfo& view_info) {
 	return std::get<const Department*>(view_info.items);
 }
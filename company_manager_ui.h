@@ -6,10 +6,12 @@
 #include "xml_wrapper_command.h"
 #include "tree_model_command.h"
 #include "company_manager_engine.h"
+#include "autosave.h"
 #include "message.h"
 #include "tree_model.h"
 #include "entry_view.h"
 #include "new_entry_dialog.h"
+#include "employee_table.h"
 
 /*GUI forms*/
 #include "ui_company_manager_ui.h"
@@ -19,15 +21,18 @@
 #include <array>
 #include <optional>
 #include <unordered_map>
+#include <unordered_set>
 #include <type_traits>
 #include <functional>
 #include <tuple>
+#include <fstream>
 
 /*Qt headers*/
 #include <QString>
 #include <QtWidgets>
 #include <QFile>
 #include <QEvent>
+#include <QRegularExpression>
 
 class CompanyManagerUI : public QMainWindow {
     Q_OBJECT
@@ -35,27 +40,30 @@ public:
 	using Company = wrapper::Company;
 	using Department = wrapper::Department;
 	using Employee = wrapper::Employee;
-	using PipelineBuilder = worker::ui_internal::PipelineBuilder<bool>;				//bool-      
+	using PipelineBuilder = worker::ui_internal::PipelineBuilder<bool>;				//bool-флаг для контроля успешного выполнения разнотипных операций
 	using DepartmentViewInfo = DepartmentView::view_info;
 	using EmployeeViewInfo = EmployeeView::view_info;
 	using EmployeePersonalFile = command::xml_wrapper::EmployeePersonalFile;
 public:
 	CompanyManagerUI(QWidget *parent = nullptr);
+	void SubmitEdit(TaskManager<CompanyManager>::submission_t factory);		//Потокобезопасно: команда будет создана и выполнена в GUI-потоке в составе пакета
 public slots:
 
-/* ""*/
+/*Меню "Файл"*/
 	bool create();
 	bool load();
 	bool save();
 	bool save_as();
+	bool import_employees();														//Пакетная загрузка сотрудников из CSV/TSV (отменяется одним действием)
+	bool export_employees();
 	void close();																		
 	void exit();
 
-/* ""*/
+/*Меню "Правка"*/
 	bool undo();
 	bool redo();
 
-/* " "*/
+/*Меню "О программе"*/
 	void about_program() const;
 
 private slots:
@@ -70,68 +78,87 @@ private slots:
 	bool change_employee_middle_name(const EmployeeViewInfo& view_info, const QString& new_middle_name);	
 	bool change_employee_function(const EmployeeViewInfo& view_info, const QString& new_function);			
 	bool update_employee_salary(const EmployeeViewInfo& view_info, Employee::salary_t new_salary);
+	void search_employee();																//Повторный Enter с тем же запросом - переход к следующему совпадению
+	void autosave();																	//По таймеру: снимок передаётся на запись в фоновый поток
+	void drain_submitted_edits();														//По таймеру: выполнение команд, отправленных через SubmitEdit()
 	
 private:
 
-/* */
+/*Вспомогательные структуры*/
+
+	static constexpr const char* XML_FILTER{ "XML files(*.xml) ;; All files(*.*) " };
+	static constexpr const char* TABLE_FILTER{ "CSV files(*.csv) ;; TSV files(*.tsv) ;; All files(*.*) " };
+	static constexpr int AUTOSAVE_POLL_INTERVAL{ 1000 };				//мс; Poll() лишь проверяет пороги автосохранения
+	static constexpr int SUBMISSION_DRAIN_INTERVAL{ 50 };				//мс; пустая очередь отправленных команд не трогает модель
+	static constexpr std::chrono::milliseconds EDIT_COALESCING_WINDOW{ 2000 };	//Быстрые правки одного поля сотрудника сливаются в одну запись истории
 
 	struct TaskManagement {
-		TaskManager<CompanyManager> service{ TaskManager<CompanyManager>(0) };		//      
-		TaskManager<CompanyManager> modify_xml;										//    (20)
+		TaskManager<CompanyManager> service{ TaskManager<CompanyManager>(0) };		//Команды не добавляются в очередля для отмены
+		TaskManager<CompanyManager> modify_xml;										//Стандартные емкость очереди команд и лимит удерживаемой памяти
 		TaskManager<CompanyTreeModel> tree_model;
 	};
 	struct FileHandlers {
 		mutable QFileInfo info;
 		QFileDialog dialog;
 	};
-	struct ItemViewers {											//   QStackedWidget 
-		QWidget* dummy;												//,   
+	struct SearchState {											//Совпадения не хранятся: указатели на узлы инвалидируются при правке документа
+		QString query;
+		size_t position{ 0 };
+	};
+	struct ItemViewers {											//Объектами будет владеть QStackedWidget 
+		QWidget* dummy;												//Заглушка, если выделение отсутствует
 		DepartmentView* department;
 		EmployeeView* employee;
 	};
 
 private:
 
-/*   */
+/*Инициализация интерфейса главного окна*/
 	void connect_menu_bar();
 	void initialize_stacked_viewers();
 	void connect_item_viewers();
 
-/*   */
-	void reset_redo_queues();										//   
-	void update_undo_redo_buttons();								///  ""  ""
-	void update_redo_undo_actions_after_editing();					//   
-	template <class FirstHandler, class SecondHandler>				//    
+/*Отмена и повтор операций*/
+	void reset_redo_queues();										//Сброс возможности повтора действия
+	void update_undo_redo_buttons();								//Активация/деактивация кнопок "Отменить" и "Вернуть"
+	void update_redo_undo_actions_after_editing();					//Объединяет два вышеперечисленных действия
+	template <class Operation>
+	bool batch_helper(Operation operation);							//Operation: Result(TaskManager<CompanyManager>&)
+	template <class FirstHandler, class SecondHandler>				//Для смены последовательности повтора операций
 	bool redo_helper(FirstHandler&& first_handler, SecondHandler&& second_handler){
 		bool success{ false };
-		PipelineBuilder()
-			.AddHandler(std::forward<FirstHandler>(first_handler))
-			.AddHandler(std::forward<SecondHandler>(second_handler))
-			.Assemble()->Process(success);
+		MakeStaticPipeline<bool>(										//Состав цепочки известен при компиляции
+			std::forward<FirstHandler>(first_handler),
+			std::forward<SecondHandler>(second_handler)
+		).Process(success);
 		return success;
 	}
 
-/*    */
-	void update_viewers();											//      
-	void setup_viewers();											//    
+/*Настройка и сброс элементов отображения*/
+	void update_viewers();											//Ручное обновление после отмены или повтора операции
+	void setup_viewers();											//Настройка после открытия нового файла
 	void select_viewer(const QModelIndex& selected_item);
 	void update_department_viewer(const QModelIndex& selected_item);
 	void update_employee_viewer(const QModelIndex& selected_item);
 	void show_viewers(bool on);
 	QModelIndex get_current_selection_index();
 
-/*    */
-	enum class WarningMode {										//   
+/*Сброс и действия при закрытии*/
+	enum class WarningMode {										//Режим показа предупреждающих сообщений
 		Hide,
 		Show
 	};
-	void reset_helper();
-	bool close_helper(WarningMode no_loaded);
-	void closeEvent(QCloseEvent* event) override;					//      
+	enum class TreeModelMode {										//Судьба дерева модели при закрытии документа
+		Reset,
+		Retain														//Для сверки с открываемым документом
+	};
+	void reset_helper(TreeModelMode tree_model_mode = TreeModelMode::Reset);
+	bool close_helper(WarningMode no_loaded, TreeModelMode tree_model_mode = TreeModelMode::Reset);
+	void closeEvent(QCloseEvent* event) override;					//Перехват события закрытия для запроса соранения файла
 
 private:
 
-/*   ,  */
+/*Обработка и логирование ошибок, предупреждающие сообщения*/
 
 	QMessageBox::StandardButton show_message(
 		message::Type,
@@ -143,7 +170,7 @@ private:
 	template <class TargetTy>
 	void handle_internal_fatal_error(TaskManager<TargetTy>& tm) const noexcept {
 		internal_fatal_error_msg(
-			u8" ",
+			u8"Критическая ошибка",
 			tm.GetErrorLog().back()									
 		);
 	}
@@ -152,49 +179,57 @@ private:
 		const std::string& error_definition = ""					
 	) const noexcept;	
 
-	QMessageBox::StandardButton save_before_close_request(				//         
+	QMessageBox::StandardButton save_before_close_request(				//В запросе сохранения файла действие зависит от нажатой пользователем кнопки
 		const QString& file_name
 	);
 
 	void empty_field_msg(const QString& field) const;
-	void already_exists_msg(const QString& element_category) const;			//return type: int =>   
+	void already_exists_msg(const QString& element_category) const;			//return type: int => запрашивает пользовательское действие
 	int empty_optional_field_msg_dlg(const QString& field) const;
 	int zero_salary_msg_dlg() const;
+	int recovery_msg_dlg(const QString& file_name) const;
 	void not_loaded_msg() const;
 	void invalid_load_path_msg() const;
 	void invalid_save_path_msg() const;
 	void unable_to_load_msg() const;
 	void unable_to_save_msg() const;
+	void unable_to_import_msg(const std::string& reason) const;
+	void import_result_msg(const command::xml_wrapper::ImportEmployees::Statistics& stats) const;
 	void already_saved_msg();
-	bool warning_if_employee_already_exists(wrapper::RenameResult result) const;	//   false,  result != Success
+	bool warning_if_employee_already_exists(wrapper::RenameResult result) const;	//Предупреждение и возврат false, если result != Success
 	bool warning_if_department_already_exists(wrapper::RenameResult result) const;
 
-/*    */
-	QString request_load_file_path();
-	QString request_save_file_path();
+/*Поиск сотрудников*/
+	static search::match_list run_search_query(const search::EmployeeIndex& index, const QString& query);	//"от-до" - диапазон зарплат, иначе - префикс полей ФИО и должности,
+																											//при отсутствии совпадений - нечёткий поиск по фамилии и имени
+
+/*Запрос и обработка имени файла*/
+	QString request_load_file_path(const char* filter = XML_FILTER);
+	QString request_save_file_path(const char* filter = XML_FILTER);
 	QString get_current_file_path();
-	QString extract_file_name(const QString& path);						//    
+	QString extract_file_name(const QString& path);						//Возвращает имя файла без расширения
 
 	bool is_loaded() const;
 	bool is_saved() const;
 	void set_file_path(const QString& path);
 
-/*     */
+/*Проверка возможности чтения и записи файлов*/
 	bool is_readable(const QString& path) const;
 	bool is_writable(const QString& path) const;
 
-/*     ,      */
+/*Вспомогательные методы для инициализации при создании, загрузке из файла и закрытии документа*/
 	bool create_helper();
 	std::optional<worker::file_operation::Result> load_helper();
+	std::optional<worker::file_operation::Result> recover_helper();	//Загрузка более нового файла восстановления, если пользователь согласится
 	bool handle_load_result(worker::file_operation::Result result);
 	std::optional<worker::file_operation::Result> save_helper();
 	bool handle_save_result(worker::file_operation::Result result);
-	std::optional<Company::department_view_it> add_department_helper(Department&& department);	//  	
-	std::optional<Company::department_view_it> insert_department_helper(Department&& department, wrapper::string_ref before);																												// 1  move c-tor
+	std::optional<Company::department_view_it> add_department_helper(Department&& department);	//Результат и итератор	
+	std::optional<Company::department_view_it> insert_department_helper(Department&& department, wrapper::string_ref before);																												//Экономим 1 вызов move c-tor
 	bool rename_department_helper(const DepartmentViewInfo& view_info, const QString& new_name);
-	bool rename_employee_in_tree_model(const EmployeeViewInfo& view_info, const QString& new_full_name);	//       
+	bool rename_employee_in_tree_model(const EmployeeViewInfo& view_info, const QString& new_full_name);	//Однотипные изменения модели стоит вынести в отдельный метод
 
-/* ,    */
+/*Распаковка данных, переданных элементами интерфейса */
 	static const Department* extract_department_ptr(const DepartmentViewInfo& view_info);
 	static wrapper::string_ref extract_department_name(const DepartmentViewInfo& view_info);
 	static wrapper::string_ref extract_department_name(const EmployeeViewInfo& view_info);
@@ -202,7 +237,7 @@ private:
 
 private:
 
-/* */
+/*Фабрики сообщений*/
 	message::Plantation m_message_factories{
 		message::MakeFactory<message::Question>(),
 		message::MakeFactory<message::Info>(),
@@ -214,9 +249,11 @@ private:
 	std::unique_ptr<Ui::CompanyManagerGUI> m_gui{ std::make_unique<Ui::CompanyManagerGUI>() };
 	std::unique_ptr<CompanyTreeModel> m_tree_model{ std::make_unique<CompanyTreeModel>() };
 	ItemViewers m_item_viewers;
+	SearchState m_search;
 
-/* */
+/*Основной движок*/
 	std::unique_ptr<CompanyManager> m_company_manager{std::make_unique<CompanyManager>() };
 	std::unique_ptr<TaskManagement> m_tasks{std::make_unique<TaskManagement>()};
 	std::unique_ptr<FileHandlers> m_file_handlers{ std::make_unique<FileHandlers>() };
+	std::unique_ptr<Autosaver> m_autosaver{ std::make_unique<Autosaver>(*m_company_manager) };	//Уничтожается раньше движка
 };
@@ -11,7 +11,7 @@ namespace dialog {
 		{
 		}
 	protected:
-		message::Factory& get_factory(message::Type type) const {						//    
+		message::Factory& get_factory(message::Type type) const {						//Логическая константность объекта не наруешается
 			return *(*m_plantation)[static_cast<size_t>(type)];
 		}
 	private:
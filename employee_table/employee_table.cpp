@@ -0,0 +1,443 @@
+#include "employee_table.h"
+#include "thread_pool.h"
+
+#include <thread>
+#include <charconv>
+#include <algorithm>
+#include <iterator>
+#include <cctype>
+using namespace std;
+
+namespace table {
+	char GetDelimiter(Format format) noexcept {
+		return format == Format::Tsv ? '\t' : ',';
+	}
+
+	Format FormatFromPath(string_view path) noexcept {
+		constexpr string_view tsv_extension{ ".tsv" };
+		if (path.size() < tsv_extension.size()) {
+			return Format::Csv;
+		}
+		auto extension{ path.substr(path.size() - tsv_extension.size()) };
+		return equal(
+			extension.begin(), extension.end(),
+			tsv_extension.begin(),
+			[](char left, char right) {
+				return tolower(static_cast<unsigned char>(left)) == right;
+			}
+		) ? Format::Tsv : Format::Csv;
+	}
+
+	Reader::Reader(istream& input, ReaderSettings settings)
+		: m_input(addressof(input)), m_settings(settings)
+	{
+		m_settings.chunk_size = max<size_t>(m_settings.chunk_size, 1);
+		for (size_t idx = 0; idx < COLUMN_COUNT; ++idx) {						//Порядок столбцов по умолчанию
+			m_columns[idx] = idx;
+		}
+	}
+
+	optional<record_list> Reader::ReadBatch() {
+		vector<Chunk> chunks;
+		for (size_t idx = 0; idx < thread_count(m_settings.thread_count); ++idx) {
+			auto chunk{ read_chunk() };
+			if (!chunk) {
+				break;
+			}
+			if (!m_header_checked) {
+				detect_header(*chunk);
+				m_header_checked = true;
+			}
+			chunks.push_back(move(*chunk));
+		}
+		if (chunks.empty()) {
+			return nullopt;
+		}
+		char delimiter{ GetDelimiter(m_settings.format) };
+		vector<concurrency::Future<record_list>> parsed_chunks;
+		for (size_t idx = 1; idx < chunks.size(); ++idx) {
+			parsed_chunks.push_back(
+				concurrency::ThreadPool::Shared().Submit(
+					[chunk = move(chunks[idx]), delimiter, columns = m_columns] {	//Задача владеет блоком: Future не дожидается её в деструкторе
+						return parse_chunk(chunk, delimiter, columns);
+					})
+			);
+		}
+		record_list records{ parse_chunk(chunks.front(), delimiter, m_columns) };	//Первый блок разбирается в текущем потоке
+		for (auto& parsed : parsed_chunks) {
+			auto chunk_records{ parsed.Get() };
+			records.insert(
+				records.end(),
+				make_move_iterator(chunk_records.begin()),
+				make_move_iterator(chunk_records.end())
+			);
+		}
+		return records;
+	}
+
+	record_list Reader::ReadAll() {
+		record_list records;
+		while (auto batch = ReadBatch()) {
+			records.insert(
+				records.end(),
+				make_move_iterator(batch->begin()),
+				make_move_iterator(batch->end())
+			);
+		}
+		return records;
+	}
+
+	size_t Reader::LinesRead() const noexcept {
+		return m_lines_read;
+	}
+
+	optional<Reader::Chunk> Reader::read_chunk() {							//Блок всегда заканчивается границей записи
+		string data{ move(m_tail) };
+		m_tail.clear();
+		size_t scanned{ 0 },
+			line_count{ 0 },
+			lines_before_boundary{ 0 };
+		optional<size_t> last_boundary;
+		bool quoted{ false };
+		for (;;) {
+			size_t old_size{ data.size() };
+			data.resize(old_size + m_settings.chunk_size);
+			m_input->read(data.data() + old_size, static_cast<streamsize>(m_settings.chunk_size));
+			data.resize(old_size + static_cast<size_t>(m_input->gcount()));
+			bool end_of_input{ static_cast<size_t>(m_input->gcount()) < m_settings.chunk_size };
+
+			for (; scanned < data.size(); ++scanned) {						//Перевод строки внутри кавычек не завершает запись.
+				if (data[scanned] == '"') {									//Экранированная кавычка ("") дважды меняет состояние
+					quoted = !quoted;
+				}
+				else if (data[scanned] == '\n') {
+					++line_count;
+					if (!quoted) {
+						last_boundary = scanned;
+						lines_before_boundary = line_count;
+					}
+				}
+			}
+			if (end_of_input) {
+				if (data.empty()) {
+					return nullopt;
+				}
+				Chunk chunk{ move(data), m_lines_read + 1 };
+				m_lines_read += line_count + (chunk.data.back() != '\n');
+				return chunk;
+			}
+			if (last_boundary) {
+				m_tail.assign(data, *last_boundary + 1, string::npos);
+				data.resize(*last_boundary + 1);
+				Chunk chunk{ move(data), m_lines_read + 1 };
+				m_lines_read += lines_before_boundary;
+				return chunk;
+			}
+		}																	//Запись длиннее блока - дочитываем
+	}
+
+	void Reader::detect_header(Chunk& chunk) {								//Заголовок опционален; при наличии задаёт порядок столбцов
+		constexpr string_view utf8_bom{ "\xEF\xBB\xBF" };
+		if (string_view(chunk.data).substr(0, utf8_bom.size()) == utf8_bom) {
+			chunk.data.erase(0, utf8_bom.size());
+		}
+		size_t line_end{ min(chunk.data.find('\n'), chunk.data.size()) };
+		string_view first_line{ string_view(chunk.data).substr(0, line_end) };
+		if (!first_line.empty() && first_line.back() == '\r') {
+			first_line.remove_suffix(1);
+		}
+		column_map columns;
+		columns.fill(COLUMN_COUNT);
+		size_t field_idx{ 0 };
+		char delimiter{ GetDelimiter(m_settings.format) };
+		for (size_t field_begin = 0; field_begin <= first_line.size(); ++field_idx) {
+			size_t field_end{ min(first_line.find(delimiter, field_begin), first_line.size()) };
+			auto field{ first_line.substr(field_begin, field_end - field_begin) };
+			auto column_it{
+				find_if(
+					column_names.begin(), column_names.end(),
+					[field](string_view name) {
+						return field.size() == name.size() && equal(
+							field.begin(), field.end(), name.begin(),
+							[](char left, char right) {
+								return tolower(static_cast<unsigned char>(left)) == tolower(static_cast<unsigned char>(right));
+							}
+						);
+					}
+				)
+			};
+			if (column_it == column_names.end()) {
+				return;															//Первая строка - данные
+			}
+			columns[static_cast<size_t>(distance(column_names.begin(), column_it))] = field_idx;
+			field_begin = field_end + 1;
+		}
+		if (find(columns.begin(), columns.end(), COLUMN_COUNT) != columns.end()) {
+			throw format_error("Line 1: incomplete header");
+		}
+		m_columns = columns;
+		chunk.data.erase(0, min(line_end + 1, chunk.data.size()));
+		++chunk.first_line;
+	}
+
+	namespace {
+		Record make_record(vector<string>& fields, const Reader::column_map& columns, size_t line) {
+			auto throw_error{
+				[line](const string& what) {
+					throw format_error("Line " + to_string(line) + ": " + what);
+				}
+			};
+			for (size_t column : columns) {
+				if (column >= fields.size()) {
+					throw_error("too few fields");
+				}
+			}
+			auto take_field{
+				[&fields, &columns](Column column) -> string&& {
+					return move(fields[columns[static_cast<size_t>(column)]]);
+				}
+			};
+			Record record;
+			record.department = take_field(Column::Department);
+			record.personal_data.surname = take_field(Column::Surname);
+			record.personal_data.name = take_field(Column::Name);
+			record.personal_data.middle_name = take_field(Column::MiddleName);		//Отчество и должность могут быть пустыми
+			record.personal_data.function = take_field(Column::Function);
+			if (record.department.empty() || record.personal_data.surname.empty() || record.personal_data.name.empty()) {
+				throw_error("department, surname and name are required");
+			}
+			const string& salary{ fields[columns[static_cast<size_t>(Column::Salary)]] };
+			if (!salary.empty()) {
+				auto [last, ec] {
+					from_chars(salary.data(), salary.data() + salary.size(), record.personal_data.salary)
+				};
+				if (ec != errc{} || last != salary.data() + salary.size()) {
+					throw_error("invalid salary '" + salary + "'");
+				}
+			}
+			return record;
+		}
+	}
+
+	record_list Reader::parse_chunk(const Chunk& chunk, char delimiter, const column_map& columns) {
+		record_list records;
+		vector<string> fields;
+		string field;
+		size_t line{ chunk.first_line },
+			record_line{ line };
+		bool quoted{ false };
+		auto finish_record{
+			[&]() {
+				fields.push_back(move(field));
+				field.clear();
+				if (fields.size() > 1 || !fields.front().empty()) {				//Пустые строки пропускаются
+					records.push_back(make_record(fields, columns, record_line));
+				}
+				fields.clear();
+			}
+		};
+		const string& data{ chunk.data };
+		const char stop_chars[]{ delimiter, '\n', '\r', '"' };
+		for (size_t idx = 0; idx < data.size(); ++idx) {
+			char ch{ data[idx] };
+			if (quoted) {
+				if (ch == '"') {
+					if (idx + 1 < data.size() && data[idx + 1] == '"') {
+						field.push_back('"');
+						++idx;
+					}
+					else {
+						quoted = false;
+					}
+				}
+				else {
+					line += ch == '\n';
+					field.push_back(ch);
+				}
+			}
+			else if (ch == '"' && field.empty()) {
+				quoted = true;
+			}
+			else if (ch == delimiter) {
+				fields.push_back(move(field));
+				field.clear();
+			}
+			else if (ch == '\n') {
+				finish_record();
+				record_line = ++line;
+			}
+			else if (ch != '\r') {														//Кавычка не в начале поля - обычный символ
+				size_t field_end{ data.find_first_of(stop_chars, idx + 1, size(stop_chars)) };	//Копируем неэкранированный фрагмент целиком
+				field_end = min(field_end, data.size());
+				field.append(data, idx, field_end - idx);
+				idx = field_end - 1;
+			}
+		}
+		if (quoted) {
+			throw format_error("Line " + to_string(record_line) + ": unterminated quoted field");
+		}
+		if (!field.empty() || !fields.empty()) {
+			finish_record();
+		}
+		return records;
+	}
+
+	size_t Reader::thread_count(size_t requested) noexcept {
+		return requested ? requested : max(thread::hardware_concurrency(), 1u);
+	}
+
+	Writer::Writer(ostream& output, Format format) noexcept
+		: m_output(addressof(output)), m_delimiter(GetDelimiter(format))
+	{
+	}
+
+	Writer::~Writer() {
+		try {
+			flush_buffer();
+		}
+		catch (...) {															//Исключения из деструктора не выпускаются
+		}
+	}
+
+	Writer& Writer::WriteHeader() {
+		for (auto name : column_names) {
+			append_field(name);
+		}
+		finish_row();
+		return *this;
+	}
+
+	Writer& Writer::WriteEmployee(string_view department, const wrapper::Employee& employee) {
+		append_field(department);
+		append_field(employee.GetSurname().get());
+		append_field(employee.GetName().get());
+		append_field(employee.GetMiddleName().get());
+		append_field(employee.GetFunction().get());
+		append_field(to_string(employee.GetSalary()));
+		finish_row();
+		++m_rows_written;
+		return *this;
+	}
+
+	Writer& Writer::WriteDepartment(const wrapper::Department& department) {
+		const string& name{ department.GetName() };
+		for (const auto& [full_name, employee] : department.GetEmployees()) {
+			WriteEmployee(name, employee);
+		}
+		return *this;
+	}
+
+	Writer& Writer::WriteCompany(const wrapper::Company& company) {
+		WriteHeader();
+		for (const auto& department : company.GetDepartments()) {
+			WriteDepartment(department);
+		}
+		return Flush();
+	}
+
+	Writer& Writer::Flush() {
+		flush_buffer();
+		m_output->flush();
+		return *this;
+	}
+
+	size_t Writer::RowsWritten() const noexcept {
+		return m_rows_written;
+	}
+
+	void Writer::append_field(string_view field) {
+		if (m_row_started) {
+			m_buffer.push_back(m_delimiter);
+		}
+		m_row_started = true;
+		const char special_chars[]{ m_delimiter, '"', '\n', '\r' };
+		bool needs_quotes{ field.find_first_of(special_chars, 0, size(special_chars)) != string_view::npos };
+		if (!needs_quotes) {
+			m_buffer.append(field);
+			return;
+		}
+		m_buffer.push_back('"');
+		for (char ch : field) {
+			if (ch == '"') {
+				m_buffer.push_back('"');										//Кавычки внутри поля удваиваются
+			}
+			m_buffer.push_back(ch);
+		}
+		m_buffer.push_back('"');
+	}
+
+	void Writer::finish_row() {
+		constexpr size_t flush_threshold{ 1 << 16 };
+		m_buffer.push_back('\n');
+		m_row_started = false;
+		if (m_buffer.size() >= flush_threshold) {
+			flush_buffer();
+		}
+	}
+
+	void Writer::flush_buffer() {
+		m_output->write(m_buffer.data(), static_cast<streamsize>(m_buffer.size()));
+		m_buffer.clear();
+	}
+
+	StaffBuilder::StaffBuilder(xml::allocator_holder alloc)
+		: m_alloc(move(alloc))
+	{
+	}
+
+	StaffBuilder& StaffBuilder::Append(record_list&& records) {
+		for (auto& [department, personal_data] : records) {
+			auto [it, inserted] {m_department_idx.try_emplace(department, m_staff.size())};
+			if (inserted) {
+				m_staff.push_back(wrapper::StaffList{ move(department), {} });
+			}
+			m_staff[it->second].employees.push_back(
+				wrapper::EmployeeBuilder()
+					.SetAllocator(m_alloc)												//Узлы создаются сразу в аллокаторе документа
+					.SetSurname(move(personal_data.surname))
+					.SetName(move(personal_data.name))
+					.SetMiddleName(move(personal_data.middle_name))
+					.SetFunction(move(personal_data.function))
+					.SetSalary(personal_data.salary)
+					.Assemble()
+			);
+			++m_employee_count;
+		}
+		records.clear();
+		return *this;
+	}
+
+	vector<wrapper::StaffList> StaffBuilder::Extract() {
+		m_department_idx.clear();
+		m_employee_count = 0;
+		return move(m_staff);
+	}
+
+	size_t StaffBuilder::EmployeeCount() const noexcept {
+		return m_employee_count;
+	}
+
+	vector<wrapper::StaffList> LoadStaff(istream& input, xml::allocator_holder alloc, ReaderSettings settings) {
+		Reader reader(input, settings);
+		StaffBuilder builder(move(alloc));
+		auto read_next{
+			[&reader]() {
+				return concurrency::ThreadPool::Shared().Submit([&reader] { return reader.ReadBatch(); });
+			}
+		};
+		auto next_batch{ read_next() };											//Разбор следующей порции идёт параллельно со сборкой узлов
+		try {
+			while (auto batch = next_batch.Get()) {
+				next_batch = read_next();
+				builder.Append(move(*batch));
+			}
+		}
+		catch (...) {
+			if (next_batch.IsValid()) {
+				next_batch.Wait();													//Задача ссылается на reader
+			}
+			throw;
+		}
+		return builder.Extract();
+	}
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include "xml_wrappers.h"
+#include "xml_wrappers_builders.h"
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <optional>
+#include <unordered_map>
+#include <stdexcept>
+
+/***********************************************************
+Потоковый импорт и экспорт сотрудников в табличных форматах
+CSV/TSV (выгрузки HR-систем). Одна строка таблицы - один
+сотрудник; столбцы: подразделение, фамилия, имя, отчество,
+должность, зарплата. Поля, содержащие разделитель, кавычки
+или переводы строк, заключаются в двойные кавычки (RFC 4180).
+
+Reader читает вход блоками, выровненными по границам записей,
+и разбирает несколько блоков параллельно в общем пуле потоков
+(concurrency::ThreadPool::Shared()). Узлы XML создаются
+только в одном потоке - StaffBuilder'ом, т.к. пуловый аллокатор
+документа не является потокобезопасным
+************************************************************/
+
+namespace table {
+	class format_error : public std::runtime_error {
+	public:
+		using std::runtime_error::runtime_error;
+	};
+
+	enum class Format {
+		Csv,
+		Tsv
+	};
+	char GetDelimiter(Format format) noexcept;
+	Format FormatFromPath(std::string_view path) noexcept;						//*.tsv - Tsv, иначе - Csv
+
+	enum class Column {
+		Department,
+		Surname,
+		Name,
+		MiddleName,
+		Function,
+		Salary
+	};
+	inline constexpr size_t COLUMN_COUNT{ 6 };
+	inline constexpr std::array<std::string_view, COLUMN_COUNT> column_names{	//Совпадают с именами узлов XML
+		"department", "surname", "name", "middleName", "function", "salary"
+	};
+
+	struct Record {
+		std::string department;
+		wrapper::PersonalData personal_data;
+	};
+	using record_list = std::vector<Record>;
+
+	struct ReaderSettings {
+		Format format{ Format::Csv };
+		size_t thread_count{ 0 };												//Блоков в порции; 0 - по числу аппаратных потоков
+		size_t chunk_size{ 1 << 20 };											//Размер блока (в байтах), разбираемого одним потоком
+	};
+
+	class Reader {
+	public:
+		using column_map = std::array<size_t, COLUMN_COUNT>;					//Column -> индекс поля в записи
+	public:
+		Reader(std::istream& input, ReaderSettings settings = {});
+
+		std::optional<record_list> ReadBatch();									//Очередная порция записей (по блоку на поток) или nullopt в конце ввода
+		record_list ReadAll();
+
+		size_t LinesRead() const noexcept;
+	private:
+		struct Chunk {
+			std::string data;
+			size_t first_line;													//Номер первой строки блока - для сообщений об ошибках
+		};
+		std::optional<Chunk> read_chunk();
+		void detect_header(Chunk& chunk);
+		static record_list parse_chunk(const Chunk& chunk, char delimiter, const column_map& columns);
+		static size_t thread_count(size_t requested) noexcept;
+	private:
+		std::istream* m_input;
+		ReaderSettings m_settings;
+		std::string m_tail;														//Незавершённая запись в конце предыдущего блока
+		column_map m_columns;
+		size_t m_lines_read{ 0 };
+		bool m_header_checked{ false };
+	};
+
+	class Writer {
+	public:
+		Writer(std::ostream& output, Format format = Format::Csv) noexcept;
+		~Writer();
+
+		Writer& WriteHeader();
+		Writer& WriteEmployee(std::string_view department, const wrapper::Employee& employee);
+		Writer& WriteDepartment(const wrapper::Department& department);
+		Writer& WriteCompany(const wrapper::Company& company);					//Заголовок и все сотрудники в порядке подразделений
+		Writer& Flush();
+
+		size_t RowsWritten() const noexcept;
+	private:
+		void append_field(std::string_view field);
+		void finish_row();
+		void flush_buffer();
+	private:
+		std::ostream* m_output;
+		std::string m_buffer;													//Строки накапливаются и выводятся крупными порциями
+		char m_delimiter;
+		size_t m_rows_written{ 0 };
+		bool m_row_started{ false };
+	};
+
+	/***********************************************************
+	StaffBuilder собирает узлы сотрудников в аллокаторе документа
+	и группирует их по подразделениям в порядке первого упоминания.
+	Результат передается команде ImportEmployees
+	************************************************************/
+	class StaffBuilder {
+	public:
+		explicit StaffBuilder(xml::allocator_holder alloc);
+
+		StaffBuilder& Append(record_list&& records);
+		std::vector<wrapper::StaffList> Extract();
+		size_t EmployeeCount() const noexcept;
+	private:
+		xml::allocator_holder m_alloc;
+		std::vector<wrapper::StaffList> m_staff;
+		std::unordered_map<std::string, size_t> m_department_idx;
+		size_t m_employee_count{ 0 };
+	};
+
+	std::vector<wrapper::StaffList> LoadStaff(								//Чтение следующей порции перекрывается со сборкой узлов текущей
+		std::istream& input,
+		xml::allocator_holder alloc,
+		ReaderSettings settings = {}
+	);
+}
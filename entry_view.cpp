@@ -7,7 +7,7 @@ DepartmentView::DepartmentView(QWidget* parent)
 	connect(m_gui->name_lnedit, &QLineEdit::returnPressed, this, &DepartmentView::name_changed_transmitter);
 	connect(m_gui->erase_department_btn, &QPushButton::clicked, this, &DepartmentView::erased_transmitter);
 	connect(m_gui->add_employee_btn, &QPushButton::clicked, this, &DepartmentView::employee_added_transmitter);
-	m_gui->employee_count_lnedit->setReadOnly(true);			//      
+	m_gui->employee_count_lnedit->setReadOnly(true);			//Статистические сведения не могут быть отредактированы вручную
 	m_gui->average_salary_lnedit->setReadOnly(true);
 }
 
@@ -28,7 +28,7 @@ void DepartmentView::RestoreName() {
 }
 
 void DepartmentView::UpdateStats() {
-	auto& department_it{ get_item<const wrapper::Department*>() };				//  
+	auto& department_it{ get_item<const wrapper::Department*>() };				//Запрос статистики подразделения
 	m_gui->employee_count_lnedit->setText(
 		QString::number(department_it->EmployeeCount())
 	);
@@ -56,7 +56,7 @@ DepartmentView& DepartmentView::SetDepartment(const view_info& department) {
 	MyBase::SetViewInfo(department);
 	UpdateView();
 	set_read_only_mode(true);
-	uncheck_enable_editing_chbox();							//  
+	uncheck_enable_editing_chbox();							//Сброс состояния кнопки
 	return*this;
 }
 
@@ -67,7 +67,7 @@ DepartmentView& DepartmentView::Reset() noexcept {
 }
 
 void DepartmentView::set_read_only_mode(bool on) {
-	m_gui->name_lnedit->setReadOnly(on);									//    
+	m_gui->name_lnedit->setReadOnly(on);									//Запрет или разрешение редактирования наименования
 }
 
 void DepartmentView::uncheck_enable_editing_chbox() {
@@ -78,7 +78,7 @@ EmployeeView::EmployeeView(QWidget* parent)
 	: MyBase(parent) {
 
 	m_gui->setupUi(this);
-	m_gui->salary_lnedit->setValidator(m_int_validator.get());				//,     
+	m_gui->salary_lnedit->setValidator(m_int_validator.get());				//Проверка, что значение является целым числом
 
 	connect(m_gui->enable_editing_chbox, &QCheckBox::stateChanged, this, &EmployeeView::view_mode);
 	connect(m_gui->surname_lnedit, &QLineEdit::returnPressed, this, &EmployeeView::surname_changed_transmitter);
@@ -46,7 +46,7 @@ public:
 	}
 protected:
 	const QModelIndex& get_index() const {
-		return m_view_info.value().index;									//       
+		return m_view_info.value().index;									//Проверка на случай попытки обращения к невалидному содержимому
 	}	
 	void update_model_index(const QModelIndex& new_q_idx) {
 		m_view_info.value().index = new_q_idx;
@@ -72,15 +72,15 @@ public:
 	DepartmentView& SetDepartment(const view_info& department);
 	DepartmentView& Reset() noexcept;
 
-	void UpdateView() override;					//  
-	void RestoreName();						//  
-	void UpdateStats();						//    (,   )
+	void UpdateView() override;					//Обновление всех полей
+	void RestoreName();						//Заново считывает имя
+	void UpdateStats();						//Загружает новые данные статистики (например, после добавления работника)
 signals:
 	void name_changed(const view_info&, const QString& new_name);
 	void erased(const view_info&);
 	void employee_added(const view_info&);
 private slots:
-	void view_mode(int mode);							//    
+	void view_mode(int mode);							//Переключает режимы чтения и редактирования
 	void name_changed_transmitter();			
 	void erased_transmitter();
 	void employee_added_transmitter();
@@ -92,8 +92,8 @@ private:
 	
 };
 
-class EmployeeView : public ViewBase<wrapper::string_ref, const wrapper::Employee*> {		//     
-	Q_OBJECT																								//   -  
+class EmployeeView : public ViewBase<wrapper::string_ref, const wrapper::Employee*> {		//Имя подразделения и указатель на сотрудника
+	Q_OBJECT																								//Итераторы не используются из-за их инвалидации
 public:
 	using MyBase = ViewBase<wrapper::string_ref, const wrapper::Employee*>;
 	using view_info = typename MyBase::ViewInfo;
@@ -101,10 +101,10 @@ public:
 	EmployeeView(QWidget* parent = nullptr);
 	EmployeeView& SetEmployee(const view_info& employee);
 	EmployeeView& Reset() noexcept;
-	void UpdateModelIndex(const QModelIndex& new_q_idx);			//  
+	void UpdateModelIndex(const QModelIndex& new_q_idx);			//Обновляет индекс элемента
 	
-	void UpdateView() override;										//      Employee
-	void RestoreSurname();											//  							
+	void UpdateView() override;										//Заново считывает все данные из узла Employee
+	void RestoreSurname();											//Сверка отдельных полей							
 	void RestoreName();
 	void RestoreMiddleName();
 	void RestoreFunction();
@@ -117,7 +117,7 @@ signals:
 	void function_changed(const view_info&, const QString& new_function);
 	void salary_updated(const view_info&, wrapper::Employee::salary_t new_salary);
 private slots:
-	void view_mode(int mode);													//    
+	void view_mode(int mode);													//Переключает режимы чтения и редактирования
 	void surname_changed_transmitter();
 	void name_changed_transmitter();
 	void middle_name_changed_transmitter();
@@ -129,7 +129,7 @@ private:
 	void uncheck_enable_editing_chbox();
 private:
 	std::unique_ptr<Ui::EmployeeViewGUI> m_gui{ std::make_unique<Ui::EmployeeViewGUI>() };
-	std::unique_ptr<QIntValidator> m_int_validator{ std::make_unique<QIntValidator>(0, std::numeric_limits<int>::max()) };	// 
+	std::unique_ptr<QIntValidator> m_int_validator{ std::make_unique<QIntValidator>(0, std::numeric_limits<int>::max()) };	//Диапазон значений
 };
 
 
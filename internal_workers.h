@@ -9,12 +9,12 @@
 namespace worker {
 	namespace ui_internal {
 		/********************************************************************************
-		 SingleHandlerWorker    
-		   .    callable-object
-		   Process()    TargetTy&.
-		   -       
-		         lambda expressions.
-		       ,    true.
+		Шаблон SingleHandlerWorker позволяет реализовывать цепочки обработчиков
+		для данных произвольного типа. Принимаемый в конструкторе callable-object
+		будет вызван в Process() с передачей аргумента TargetTy&.
+		Преимущество такого подхода - гибкость настройки и возможность работать с 
+		внутренними полями и методами классов путём их захвата в lambda expressions.
+		Движение по цепочку продолжится только в том случае, если обработчик вернёт true.
 		*********************************************************************************/
 		template <class TargetTy>
 		class SingleHandlerWorker : public AllocatedChainWorker<SingleHandlerWorker<TargetTy>, TargetTy> {
@@ -27,7 +27,12 @@ namespace worker {
 			{
 			}
 			void Process(TargetTy& target) {
-				if (m_handler(target)) {
+				bool proceed;
+				{
+					tracing::Span span("chain/handler", "chain");
+					proceed = m_handler(target);
+				}
+				if (proceed) {
                     MyBase::pass_on(target);
 				}
 			}
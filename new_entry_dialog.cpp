@@ -33,8 +33,8 @@ namespace dialog {
 	void NewDepartment::empty_name_msg() {
 		auto& factory{ get_factory(message::Type::Warning) };
 		factory
-			.SetTitle(u8"")
-			.SetText(u8"     ")
+			.SetTitle(u8"Ошибка")
+			.SetText(u8"Имя подразделения не может быть пустым")
 			.Create()->exec();
 	}
 
@@ -58,7 +58,7 @@ namespace dialog {
 				warning = &NewEmployee::empty_required_field_msg](NewEmployee& emp) {
 			QString surname{ surname_lnedit->text() };
 			if (surname.isEmpty()) {
-				std::invoke(warning, emp, u8"");						//   
+				std::invoke(warning, emp, u8"Фамилия");						//Предупреждение о незаполненном поле
 				return false;
 			}
 			builder->SetSurname(surname.toStdString());
@@ -69,7 +69,7 @@ namespace dialog {
 				warning = &NewEmployee::empty_required_field_msg](NewEmployee& emp) {
 			QString name{ name_lnedit->text() };
 			if (name.isEmpty()) {
-				std::invoke(warning, emp, u8"");
+				std::invoke(warning, emp, u8"Имя");
 				return false;
 			}
 			builder->SetName(name.toStdString());
@@ -80,8 +80,8 @@ namespace dialog {
 				question = &NewEmployee::empty_optional_field_msg](NewEmployee& emp) {
 			QString middle_name{ middle_name_lnedit->text() };
 			if (middle_name.isEmpty()) {
-				if (!std::invoke(question, emp, u8"")) {
-					return false;													//       "" 
+				if (!std::invoke(question, emp, u8"Отчество")) {
+					return false;													//Операция будет отменена только в случае нажатия "Отмена" пользователем
 				}
 			}
 			builder->SetMiddleName(middle_name.toStdString());
@@ -92,7 +92,7 @@ namespace dialog {
 				question = &NewEmployee::empty_optional_field_msg](NewEmployee& emp) {
 			QString function{ function_lnedit->text() };
 			if (function.isEmpty()) {
-				if (!std::invoke(question, emp, u8"")) {
+				if (!std::invoke(question, emp, u8"Должность")) {
 					return false;
 				}
 			}
@@ -113,7 +113,7 @@ namespace dialog {
 		})
 			.AddHandler(
 				[accept = &QDialog::accept](NewEmployee& emp) {
-			std::invoke(accept, emp);											// 
+			std::invoke(accept, emp);											//Закрытие окна
 			return false;
 		})
 			.Assemble()->Process(*this);
@@ -121,22 +121,22 @@ namespace dialog {
 
 	void NewEmployee::empty_required_field_msg(const QString& field) const {
 		auto& factory{ get_factory(message::Type::Warning) };
-		QString text(u8" \"");
+		QString text(u8"Поле \"");
 		text += field;
-		text += u8" \"    ";
+		text += u8" \" не может быть пустым";
 		factory
-			.SetTitle(u8"")
-			.SetText(std::move(text))													// ,      R("")
+			.SetTitle(u8"Ошибка")
+			.SetText(std::move(text))													//Экранирование кавычек, чтобы не использовать сырой литерал R("")
 			.Create()->exec();
 	}
 
-	bool NewEmployee::empty_optional_field_msg(const QString& field) const {					//  
+	bool NewEmployee::empty_optional_field_msg(const QString& field) const {					//Запрос пользовательского действия
 		auto& factory{ get_factory(message::Type::Warning) };
-		QString text(u8" \"");
+		QString text(u8"Поле \"");
 		text += field;
-		text += u8" \"  . ?";
+		text += u8" \" не заполнено. Продолжить?";
 		factory
-			.SetTitle(u8"")
+			.SetTitle(u8"Предупреждение")
 			.SetText(std::move(text))
 			.SetButtons(QMessageBox::StandardButton::Ok | QMessageBox::StandardButton::Cancel);
 		return factory.Create()->exec() == QMessageBox::StandardButton::Ok;
@@ -145,8 +145,8 @@ namespace dialog {
 	bool NewEmployee::invalid_salary_msg() const {
 		auto& factory{ get_factory(message::Type::Warning) };
 		factory
-			.SetTitle(u8"")
-			.SetText(u8"   .  ?")
+			.SetTitle(u8"Предупреждение")
+			.SetText(u8"Указана нулевая заработная плата. Вы уверены?")
 			.SetButtons(QMessageBox::StandardButton::Ok | QMessageBox::StandardButton::Cancel);
 		return factory.Create()->exec() == QMessageBox::StandardButton::Ok;
 	}
@@ -25,7 +25,7 @@ namespace dialog {
 			QDialog* parent = nullptr
 		);
 	private slots:
-		void accept();																	//   
+		void accept();																	//Проверяет корретность заполнения полей
 	private:
 		bool set_checked_name();
 		void empty_name_msg();
@@ -46,10 +46,10 @@ namespace dialog {
 			QDialog* parent = nullptr
 		);
 	private slots:
-		void set_checked_data();														//   
+		void set_checked_data();														//Проверяет корретность заполнения полей
 	private:
-		void empty_required_field_msg(const QString& field) const;						//  ""  ""   												
-		bool empty_optional_field_msg(const QString& field) const;						//true,       
+		void empty_required_field_msg(const QString& field) const;						//Только поля "Фамилия" и "Имя" обязательны к заполнению												
+		bool empty_optional_field_msg(const QString& field) const;						//true, если пользователь нажал согласился с незаполненными полями
 		bool invalid_salary_msg() const;
 	private:
 		wrapper::EmployeeBuilder* m_builder;
@@ -0,0 +1,606 @@
+#include "employee_index.h"
+
+#include <numeric>
+#include <tuple>
+#include <cmath>
+using namespace std;
+
+namespace search {
+	namespace {
+		constexpr char32_t TRIGRAM_BEGIN{ 0x110000 };								//Вне диапазона Unicode: границы слова
+		constexpr char32_t TRIGRAM_END{ 0x110001 };
+		constexpr size_t COMPACTION_THRESHOLD{ 1024 };								//Минимальное число удалённых записей для пересборки
+
+		char32_t fold_codepoint(char32_t cp) noexcept {
+			if (cp >= U'A' && cp <= U'Z') {
+				return cp - U'A' + U'a';
+			}
+			if (cp >= 0x0410 && cp <= 0x042F) {										//А-Я
+				cp += 0x20;
+			}
+			else if (cp >= 0x0400 && cp <= 0x040F) {								//U+0400-U+040F (в т.ч. Ё)
+				cp += 0x50;
+			}
+			return cp == 0x0451 ? 0x0435 : cp;										//ё -> е
+		}
+
+		void append_utf8(string& out, char32_t cp) {
+			if (cp < 0x80) {
+				out.push_back(static_cast<char>(cp));
+			}
+			else if (cp < 0x800) {
+				out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+				out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+			}
+			else if (cp < 0x10000) {
+				out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+				out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+				out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+			}
+			else {
+				out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+				out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+				out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+				out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+			}
+		}
+
+		size_t sequence_length(unsigned char lead) noexcept {
+			if (lead < 0x80) {
+				return 1;
+			}
+			if ((lead & 0xE0) == 0xC0) {
+				return 2;
+			}
+			if ((lead & 0xF0) == 0xE0) {
+				return 3;
+			}
+			return (lead & 0xF8) == 0xF0 ? 4 : 0;									//0 - недопустимый ведущий байт
+		}
+
+		template <class Handler>														//handler(cp, valid) для каждого символа
+		void decode_utf8(string_view text, Handler handler) {
+			for (size_t pos = 0; pos < text.size();) {
+				auto lead{ static_cast<unsigned char>(text[pos]) };
+				size_t length{ sequence_length(lead) };
+				bool valid{ length && pos + length <= text.size() };
+				char32_t cp{ length == 1 ? lead : static_cast<char32_t>(lead & (0x7F >> length)) };
+				for (size_t idx = 1; valid && idx < length; ++idx) {
+					auto next{ static_cast<unsigned char>(text[pos + idx]) };
+					valid = (next & 0xC0) == 0x80;
+					cp = (cp << 6) | (next & 0x3F);
+				}
+				if (!valid) {															//Битый байт считается отдельным символом
+					handler(static_cast<char32_t>(lead), false);
+					++pos;
+				}
+				else {
+					handler(cp, true);
+					pos += length;
+				}
+			}
+		}
+
+		u32string to_codepoints(string_view text) {
+			u32string result;
+			result.reserve(text.size());
+			decode_utf8(text, [&result](char32_t cp, bool) { result.push_back(cp); });
+			return result;
+		}
+
+		size_t count_codepoints(string_view text) noexcept {						//Без учёта продолжающих байтов UTF-8
+			return static_cast<size_t>(count_if(text.begin(), text.end(), [](char ch) {
+				return (static_cast<unsigned char>(ch) & 0xC0) != 0x80;
+			}));
+		}
+
+		vector<uint64_t> make_trigrams(const u32string& word) {						//Без повторов, по возрастанию
+			vector<uint64_t> trigrams;
+			if (word.empty()) {
+				return trigrams;
+			}
+			u32string padded;
+			padded.reserve(word.size() + 2);
+			padded.push_back(TRIGRAM_BEGIN);
+			padded += word;
+			padded.push_back(TRIGRAM_END);
+			trigrams.reserve(padded.size() - 2);
+			for (size_t idx = 0; idx + 2 < padded.size(); ++idx) {
+				trigrams.push_back(
+					(static_cast<uint64_t>(padded[idx]) << 42)
+					| (static_cast<uint64_t>(padded[idx + 1]) << 21)
+					| padded[idx + 2]
+				);
+			}
+			sort(trigrams.begin(), trigrams.end());
+			trigrams.erase(unique(trigrams.begin(), trigrams.end()), trigrams.end());
+			return trigrams;
+		}
+
+		size_t bounded_levenshtein(														//bound + 1, если расстояние больше bound
+			const u32string& lhs,
+			const u32string& rhs,
+			size_t bound,
+			vector<size_t>& buffer															//Две строки матрицы, переиспользуются между вызовами
+		) {
+			size_t width{ rhs.size() + 1 };
+			buffer.resize(2 * width);
+			size_t* prev{ buffer.data() };
+			size_t* current{ buffer.data() + width };
+			iota(prev, prev + width, size_t{ 0 });
+			for (size_t row = 1; row <= lhs.size(); ++row) {
+				current[0] = row;
+				size_t row_min{ current[0] };
+				for (size_t col = 1; col < width; ++col) {
+					current[col] = min({
+						prev[col] + 1,
+						current[col - 1] + 1,
+						prev[col - 1] + (lhs[row - 1] == rhs[col - 1] ? 0 : 1)
+					});
+					row_min = min(row_min, current[col]);
+				}
+				if (row_min > bound) {
+					return bound + 1;
+				}
+				swap(prev, current);
+			}
+			return min(prev[width - 1], bound + 1);
+		}
+
+		uint64_t key_prefix(const string& key) noexcept {							//Первые 8 байт в порядке сравнения строк
+			uint64_t prefix{ 0 };
+			for (size_t idx = 0; idx < sizeof(prefix); ++idx) {
+				prefix = (prefix << 8) | (idx < key.size() ? static_cast<unsigned char>(key[idx]) : 0);
+			}
+			return prefix;
+		}
+
+		template <class Key, class TieBreak>										//Упорядочивание по ключам без косвенных обращений при сравнении
+		vector<uint32_t> sort_by_key(vector<pair<Key, uint32_t>>& keyed, TieBreak tie_break) {
+			sort(keyed.begin(), keyed.end(), [&tie_break](const auto& lhs, const auto& rhs) {
+				return lhs.first != rhs.first ? lhs.first < rhs.first : tie_break(lhs.second, rhs.second);
+			});
+			vector<uint32_t> ids;
+			ids.reserve(keyed.size());
+			for (const auto& [key, id] : keyed) {
+				ids.push_back(id);
+			}
+			return ids;
+		}
+
+		bool starts_with(string_view text, string_view prefix) noexcept {
+			return text.substr(0, prefix.size()) == prefix;
+		}
+
+		wrapper::string_ref get_field_value(const wrapper::Employee& employee, Field field) {
+			switch (field) {
+			case Field::Surname: return employee.GetSurname();
+			case Field::Name: return employee.GetName();
+			case Field::MiddleName: return employee.GetMiddleName();
+			default: return employee.GetFunction();
+			}
+		}
+	}
+
+	string FoldCase(string_view text) {
+		string result;
+		result.reserve(text.size());
+		decode_utf8(text, [&result](char32_t cp, bool valid) {
+			if (valid) {
+				append_utf8(result, fold_codepoint(cp));
+			}
+			else {
+				result.push_back(static_cast<char>(cp));
+			}
+		});
+		return result;
+	}
+
+	EmployeeIndex& EmployeeIndex::Build(const wrapper::Company& company) {
+		Clear();
+		size_t employee_count{ 0 };
+		for (const auto& department : company.GetDepartments()) {
+			employee_count += department.EmployeeCount();
+		}
+		m_entries.reserve(employee_count);
+		m_by_employee.reserve(employee_count);
+		for (auto& index : m_fields) {
+			index.lookup.reserve(employee_count);										//Для должностей с запасом, зато без перехеширований
+		}
+
+		auto mark{ make_mark() };
+		for (const auto& department : company.GetDepartments()) {
+			for (const auto& [full_name, employee] : department.GetEmployees()) {
+				add_entry(department, employee);
+			}
+		}
+		commit(mark);
+		return *this;
+	}
+
+	EmployeeIndex& EmployeeIndex::Clear() noexcept {
+		m_entries.clear();
+		m_by_employee.clear();
+		for (auto& field : m_fields) {
+			field.terms.clear();
+			field.lookup.clear();
+			field.sorted.Clear();
+			field.trigrams.Clear();
+			field.has_trigrams = false;
+		}
+		m_by_salary.Clear();
+		m_dead_count = 0;
+		return *this;
+	}
+
+	EmployeeIndex& EmployeeIndex::Insert(const wrapper::Department& department, const wrapper::Employee& employee) {
+		auto mark{ make_mark() };
+		add_entry(department, employee);
+		commit(mark);
+		return *this;
+	}
+
+	EmployeeIndex& EmployeeIndex::Erase(const wrapper::Employee& employee) {
+		erase_entry(employee);
+		compact_if_needed();
+		return *this;
+	}
+
+	EmployeeIndex& EmployeeIndex::InsertDepartment(const wrapper::Department& department) {
+		auto mark{ make_mark() };
+		for (const auto& [full_name, employee] : department.GetEmployees()) {
+			add_entry(department, employee);
+		}
+		commit(mark);
+		return *this;
+	}
+
+	EmployeeIndex& EmployeeIndex::EraseDepartment(const wrapper::Department& department) {
+		for (const auto& [full_name, employee] : department.GetEmployees()) {
+			erase_entry(employee);
+		}
+		compact_if_needed();
+		return *this;
+	}
+
+	size_t EmployeeIndex::Size() const noexcept {
+		return m_by_employee.size();
+	}
+
+	bool EmployeeIndex::Empty() const noexcept {
+		return m_by_employee.empty();
+	}
+
+	match_list EmployeeIndex::FindByPrefix(Field field, string_view prefix, size_t limit) const {
+		match_list matches;
+		if (!limit) {
+			return matches;
+		}
+		const auto& index{ get_field(field) };
+		const string key{ FoldCase(prefix) };
+		index.sorted.VisitFrom(
+			[&index, &key](term_id id) { return index.terms[id].key < key; },
+			term_less(index),
+			[this, field, &index, &key, limit, &matches](term_id id) {
+				return starts_with(index.terms[id].key, key)
+					&& visit_term_entries(field, id, [this, limit, &matches](entry_id entry) {
+						return collect(entry, 0, limit, matches);
+					});
+			});
+		return matches;
+	}
+
+	match_list EmployeeIndex::FindFuzzy(Field field, string_view query, size_t max_distance, size_t limit) const {
+		if (!limit) {
+			return {};
+		}
+		const auto& index{ get_field(field) };
+		const u32string word{ to_codepoints(FoldCase(query)) };
+		auto trigrams{ make_trigrams(word) };
+		if (trigrams.size() <= 3 * max_distance) {									//Отбор по триграммам ничего не отсекает
+			return FindByPrefix(field, query, limit);
+		}
+
+/***********************************************************
+Каждая правка затрагивает не более трёх триграмм, поэтому
+терм на расстоянии <= max_distance содержит не менее
+required = t - 3 * max_distance из t триграмм запроса и
+встречается хотя бы в одном из t - required + 1 самых
+коротких списков. Кандидаты берутся только из них, а
+остальные списки лишь досчитывают совпадения
+************************************************************/
+		ensure_trigrams(index);
+		vector<const vector<term_id>*> postings;
+		postings.reserve(trigrams.size());
+		for (uint64_t trigram : trigrams) {
+			postings.push_back(index.trigrams.Find(trigram));
+		}
+		auto posting_size{
+			[](const vector<term_id>* list) {
+				return list ? list->size() : size_t{ 0 };
+			}
+		};
+		sort(
+			postings.begin(), postings.end(),
+			[&posting_size](const auto* lhs, const auto* rhs) { return posting_size(lhs) < posting_size(rhs); }
+		);
+		size_t required{ trigrams.size() - 3 * max_distance };
+		size_t probed{ trigrams.size() - required + 1 };
+
+		vector<term_id> probed_ids;
+		for (size_t idx = 0; idx < probed; ++idx) {
+			if (postings[idx]) {
+				probed_ids.insert(probed_ids.end(), postings[idx]->begin(), postings[idx]->end());
+			}
+		}
+		sort(probed_ids.begin(), probed_ids.end());
+		vector<pair<term_id, size_t>> candidates;									//(терм, число общих триграмм)
+		for (term_id id : probed_ids) {
+			if (candidates.empty() || candidates.back().first != id) {
+				candidates.emplace_back(id, 0);
+			}
+			++candidates.back().second;
+		}
+		for (size_t idx = probed; idx < postings.size(); ++idx) {					//Списки упорядочены по возрастанию термов
+			if (!postings[idx]) {
+				continue;
+			}
+			auto it{ postings[idx]->begin() };
+			for (auto& [id, shared] : candidates) {
+				it = lower_bound(it, postings[idx]->end(), id);
+				if (it == postings[idx]->end()) {
+					break;
+				}
+				shared += *it == id;
+			}
+		}
+
+		vector<pair<size_t, term_id>> found;										//(расстояние, терм)
+		u32string candidate_word;
+		vector<size_t> buffer;
+		for (const auto& [id, shared] : candidates) {
+			const auto& term{ index.terms[id] };
+			size_t length_diff{ term.length > word.size() ? term.length - word.size() : word.size() - term.length };
+			if (shared < required || length_diff > max_distance) {
+				continue;
+			}
+			candidate_word = to_codepoints(term.key);
+			size_t distance{ bounded_levenshtein(word, candidate_word, max_distance, buffer) };
+			if (distance <= max_distance) {
+				found.emplace_back(distance, id);
+			}
+		}
+		sort(found.begin(), found.end(), [&index](const auto& lhs, const auto& rhs) {
+			return tie(lhs.first, index.terms[lhs.second].key) < tie(rhs.first, index.terms[rhs.second].key);
+		});
+
+		match_list matches;
+		for (const auto& [distance, id] : found) {
+			bool proceed{
+				visit_term_entries(field, id, [this, distance = distance, limit, &matches](entry_id entry) {
+					return collect(entry, distance, limit, matches);
+				})
+			};
+			if (!proceed) {
+				break;
+			}
+		}
+		return matches;
+	}
+
+	match_list EmployeeIndex::FindBySalary(salary_t min, salary_t max, size_t limit) const {
+		match_list matches;
+		if (!limit || min > max) {
+			return matches;
+		}
+		m_by_salary.VisitFrom(
+			[min](const salary_key& key) { return key.first < min; },
+			less<salary_key>{},
+			[this, max, limit, &matches](const salary_key& key) {
+				return key.first <= max && collect(key.second, 0, limit, matches);
+			});
+		return matches;
+	}
+
+	void EmployeeIndex::TrigramPostings::Add(uint64_t trigram, term_id term) {
+		if ((m_lists.size() + 1) * 2 > m_keys.size()) {								//Заполнение не более половины
+			grow();
+		}
+		size_t slot{ find_slot(trigram) };
+		if (m_keys[slot] == EMPTY_KEY) {
+			m_keys[slot] = trigram;
+			m_slots[slot] = static_cast<uint32_t>(m_lists.size());
+			m_lists.emplace_back();
+		}
+		m_lists[m_slots[slot]].push_back(term);
+	}
+
+	const vector<EmployeeIndex::term_id>* EmployeeIndex::TrigramPostings::Find(uint64_t trigram) const noexcept {
+		if (m_keys.empty()) {
+			return nullptr;
+		}
+		size_t slot{ find_slot(trigram) };
+		return m_keys[slot] == EMPTY_KEY ? nullptr : addressof(m_lists[m_slots[slot]]);
+	}
+
+	void EmployeeIndex::TrigramPostings::Clear() noexcept {
+		m_keys.clear();
+		m_slots.clear();
+		m_lists.clear();
+	}
+
+	size_t EmployeeIndex::TrigramPostings::find_slot(uint64_t trigram) const noexcept {
+		size_t mask{ m_keys.size() - 1 };
+		size_t slot{ static_cast<size_t>((trigram * 0x9E3779B97F4A7C15ull) >> 32) & mask };	//Размер таблицы - степень двойки
+		while (m_keys[slot] != EMPTY_KEY && m_keys[slot] != trigram) {
+			slot = (slot + 1) & mask;
+		}
+		return slot;
+	}
+
+	void EmployeeIndex::TrigramPostings::grow() {
+		vector<uint64_t> keys(max<size_t>(m_keys.size() * 2, 1024), EMPTY_KEY);
+		vector<uint32_t> slots(keys.size());
+		swap(keys, m_keys);
+		swap(slots, m_slots);
+		for (size_t idx = 0; idx < keys.size(); ++idx) {
+			if (keys[idx] != EMPTY_KEY) {
+				size_t slot{ find_slot(keys[idx]) };
+				m_keys[slot] = keys[idx];
+				m_slots[slot] = slots[idx];
+			}
+		}
+	}
+
+	EmployeeIndex::Mark EmployeeIndex::make_mark() const noexcept {
+		Mark mark{ m_entries.size(), {} };
+		for (size_t idx = 0; idx < FIELD_COUNT; ++idx) {
+			mark.terms[idx] = m_fields[idx].terms.size();
+		}
+		return mark;
+	}
+
+	void EmployeeIndex::commit(const Mark& mark) {
+		for (size_t idx = 0; idx < FIELD_COUNT; ++idx) {
+			auto& index{ m_fields[idx] };
+			size_t first{ mark.terms[idx] };
+			if (index.terms.size() - first == 1) {									//Одиночная вставка - без выделения памяти
+				index.sorted.Insert(static_cast<term_id>(first), term_less(index));
+			}
+			else if (index.terms.size() > first) {
+				vector<pair<uint64_t, term_id>> keyed;
+				keyed.reserve(index.terms.size() - first);
+				for (size_t term = first; term < index.terms.size(); ++term) {
+					keyed.emplace_back(key_prefix(index.terms[term].key), static_cast<term_id>(term));
+				}
+				index.sorted.InsertSorted(sort_by_key(keyed, term_less(index)), term_less(index));
+			}
+		}
+		vector<salary_key> keys;
+		for (size_t id = mark.entries; id < m_entries.size(); ++id) {
+			if (m_entries[id].alive) {												//Повторно вставленные в том же пакете
+				keys.emplace_back(m_entries[id].salary, static_cast<entry_id>(id));
+			}
+		}
+		if (keys.size() == 1) {
+			m_by_salary.Insert(keys.front(), less<salary_key>{});
+		}
+		else if (!keys.empty()) {
+			sort(keys.begin(), keys.end());
+			m_by_salary.InsertSorted(move(keys), less<salary_key>{});
+		}
+	}
+
+	void EmployeeIndex::add_entry(const wrapper::Department& department, const wrapper::Employee& employee) {
+		auto id{ static_cast<entry_id>(m_entries.size()) };
+		auto [it, inserted] { m_by_employee.try_emplace(addressof(employee), id) };
+		if (!inserted) {																//Повторная вставка заменяет запись
+			m_entries[it->second].alive = false;
+			++m_dead_count;
+			it->second = id;
+		}
+		Entry entry{ addressof(department), addressof(employee), employee.GetSalary(), {}, {}, true };
+		for (size_t idx = 0; idx < FIELD_COUNT; ++idx) {
+			auto& index{ m_fields[idx] };
+			term_id term{ add_term(index, FoldCase(get_field_value(employee, static_cast<Field>(idx)).get())) };
+			entry.terms[idx] = term;
+			entry.next[idx] = index.terms[term].head;
+			index.terms[term].head = id;
+		}
+		m_entries.push_back(entry);
+	}
+
+	void EmployeeIndex::erase_entry(const wrapper::Employee& employee) {
+		auto it{ m_by_employee.find(addressof(employee)) };
+		if (it == m_by_employee.end()) {
+			return;
+		}
+		m_entries[it->second].alive = false;
+		m_by_employee.erase(it);
+		++m_dead_count;
+	}
+
+	EmployeeIndex::term_id EmployeeIndex::add_term(FieldIndex& index, string&& key) {
+		auto id{ static_cast<term_id>(index.terms.size()) };
+		index.terms.push_back(Term{ move(key), 0, NO_ENTRY });						//Ключ словаря должен ссылаться на строку в deque
+		auto [it, inserted] { index.lookup.try_emplace(index.terms.back().key, id) };
+		if (!inserted) {
+			index.terms.pop_back();
+			return it->second;
+		}
+		index.terms.back().length = static_cast<uint32_t>(count_codepoints(index.terms.back().key));
+		if (index.has_trigrams) {
+			add_trigrams(index, id);
+		}
+		return id;
+	}
+
+	void EmployeeIndex::add_trigrams(const FieldIndex& index, term_id term) {
+		for (uint64_t trigram : make_trigrams(to_codepoints(index.terms[term].key))) {
+			index.trigrams.Add(trigram, term);
+		}
+	}
+
+	void EmployeeIndex::ensure_trigrams(const FieldIndex& index) {
+		if (index.has_trigrams) {
+			return;
+		}
+		for (size_t term = 0; term < index.terms.size(); ++term) {					//По возрастанию - списки остаются упорядоченными
+			add_trigrams(index, static_cast<term_id>(term));
+		}
+		index.has_trigrams = true;
+	}
+
+	void EmployeeIndex::compact_if_needed() {										//Словарь термов сохраняется, перенумеровываются лишь записи
+		if (m_dead_count < max(COMPACTION_THRESHOLD, m_by_employee.size())) {
+			return;
+		}
+		vector<entry_id> new_ids(m_entries.size(), NO_ENTRY);
+		size_t alive_count{ 0 };
+		for (size_t id = 0; id < m_entries.size(); ++id) {
+			if (m_entries[id].alive) {
+				new_ids[id] = static_cast<entry_id>(alive_count);
+				m_entries[alive_count++] = m_entries[id];
+			}
+		}
+		m_entries.resize(alive_count);
+
+		for (auto& index : m_fields) {
+			for (auto& term : index.terms) {
+				term.head = NO_ENTRY;
+			}
+		}
+		for (size_t id = 0; id < m_entries.size(); ++id) {
+			auto& entry{ m_entries[id] };
+			for (size_t idx = 0; idx < FIELD_COUNT; ++idx) {
+				auto& term{ m_fields[idx].terms[entry.terms[idx]] };
+				entry.next[idx] = term.head;
+				term.head = static_cast<entry_id>(id);
+			}
+		}
+		m_by_salary.Transform([&new_ids](salary_key& key) {							//Нумерация монотонна - порядок сохраняется
+			key.second = new_ids[key.second];
+			return key.second != NO_ENTRY;
+		});
+		for (auto& [employee, id] : m_by_employee) {
+			id = new_ids[id];
+		}
+		m_dead_count = 0;
+	}
+
+	bool EmployeeIndex::collect(entry_id id, size_t distance, size_t limit, match_list& matches) const {
+		const auto& entry{ m_entries[id] };
+		if (entry.alive) {
+			matches.push_back(Match{ entry.department, entry.employee, distance });
+		}
+		return matches.size() < limit;
+	}
+
+	EmployeeIndex::FieldIndex& EmployeeIndex::get_field(Field field) noexcept {
+		return m_fields[static_cast<size_t>(field)];
+	}
+
+	const EmployeeIndex::FieldIndex& EmployeeIndex::get_field(Field field) const noexcept {
+		return m_fields[static_cast<size_t>(field)];
+	}
+}
@@ -0,0 +1,239 @@
+#pragma once
+#include "xml_wrappers.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <array>
+#include <unordered_map>
+#include <algorithm>
+#include <iterator>
+#include <tuple>
+#include <cmath>
+#include <cstdint>
+
+/***********************************************************
+Индекс для поиска сотрудников по всей компании: префиксный
+и нечёткий (с опечатками) поиск по фамилии, имени, отчеству
+и должности, а также поиск по диапазону зарплат.
+
+Значения полей приводятся к нижнему регистру (латиница и
+кириллица, Ё = Е) и хранятся в словаре: одинаковые значения
+(должности, распространённые имена) - один терм. Термы
+упорядочены для префиксного поиска; для нечёткого поиска
+по первому запросу к полю строятся списки термов по
+триграммам символов; запросы, слишком короткие для такого
+отбора, сводятся к префиксному.
+
+Индекс поддерживается инкрементально командами xml_wrapper:
+Erase() вызывается, пока узел сотрудника ещё жив, Insert() -
+после изменения. Удалённые записи помечаются и вычищаются
+пересборкой, когда их становится больше, чем живых
+************************************************************/
+
+namespace search {
+	enum class Field {
+		Surname,
+		Name,
+		MiddleName,
+		Function
+	};
+	inline constexpr size_t FIELD_COUNT{ 4 };
+
+	std::string FoldCase(std::string_view text);								//UTF-8; неизвестные символы копируются без изменений
+
+	struct Match {
+		const wrapper::Department* department;
+		const wrapper::Employee* employee;
+		size_t distance{ 0 };													//Расстояние Левенштейна (для нечёткого поиска)
+	};
+	using match_list = std::vector<Match>;
+
+	class EmployeeIndex {
+	public:
+		using salary_t = wrapper::Employee::salary_t;
+		static constexpr size_t DEFAULT_LIMIT{ 100 };
+	public:
+		EmployeeIndex& Build(const wrapper::Company& company);
+		EmployeeIndex& Clear() noexcept;
+
+		EmployeeIndex& Insert(const wrapper::Department& department, const wrapper::Employee& employee);
+		EmployeeIndex& Erase(const wrapper::Employee& employee);				//Неизвестные сотрудники игнорируются
+		EmployeeIndex& InsertDepartment(const wrapper::Department& department);
+		EmployeeIndex& EraseDepartment(const wrapper::Department& department);
+
+		size_t Size() const noexcept;
+		bool Empty() const noexcept;
+
+		match_list FindByPrefix(Field field, std::string_view prefix, size_t limit = DEFAULT_LIMIT) const;	//В алфавитном порядке
+		match_list FindFuzzy(																				//В порядке возрастания расстояния
+			Field field,
+			std::string_view query,
+			size_t max_distance = 1,
+			size_t limit = DEFAULT_LIMIT
+		) const;
+		match_list FindBySalary(salary_t min, salary_t max, size_t limit = DEFAULT_LIMIT) const;			//[min, max] по возрастанию
+	private:
+		using entry_id = uint32_t;
+		using term_id = uint32_t;
+		static constexpr entry_id NO_ENTRY{ UINT32_MAX };
+
+/***********************************************************
+Упорядоченный набор: большой основной массив и небольшой
+массив недавних вставок, который сливается с основным по
+достижении ~sqrt(n) элементов. Вставка стоит O(sqrt(n))
+вместо O(n) сдвига основного массива
+************************************************************/
+		template <class Value>
+		class SortedSet {
+		public:
+			template <class Less>
+			void Insert(Value value, Less less) {
+				m_recent.insert(std::upper_bound(m_recent.begin(), m_recent.end(), value, less), std::move(value));
+				merge_if_needed(less);
+			}
+			template <class Less>
+			void InsertSorted(std::vector<Value> values, Less less) {			//Пакетная вставка упорядоченных по less значений
+				if (m_main.empty() && m_recent.empty()) {
+					m_main = std::move(values);
+					return;
+				}
+				m_recent = merge(m_recent, values, less);
+				merge_if_needed(less);
+			}
+			template <class Mapper>												//mapper(value) возвращает false для удаления значения;
+			void Transform(Mapper mapper) {										//порядок после преобразования не должен нарушаться
+				for (auto* values : { &m_main, &m_recent }) {
+					auto last{ values->begin() };
+					for (auto& value : *values) {
+						if (mapper(value)) {
+							*last++ = std::move(value);
+						}
+					}
+					values->erase(last, values->end());
+				}
+			}
+			void Clear() noexcept {
+				m_main.clear();
+				m_recent.clear();
+			}
+
+			template <class IsBefore, class Less, class Visitor>				//is_before(value) - значение предшествует искомому диапазону;
+			void VisitFrom(IsBefore is_before, Less less, Visitor visitor) const {	//visitor(value) возвращает false для остановки обхода
+				auto main_it{ std::partition_point(m_main.begin(), m_main.end(), is_before) };
+				auto recent_it{ std::partition_point(m_recent.begin(), m_recent.end(), is_before) };
+				while (main_it != m_main.end() || recent_it != m_recent.end()) {
+					bool from_main{
+						recent_it == m_recent.end()
+						|| (main_it != m_main.end() && !less(*recent_it, *main_it))
+					};
+					if (!visitor(from_main ? *main_it++ : *recent_it++)) {
+						return;
+					}
+				}
+			}
+		private:
+			template <class Less>
+			void merge_if_needed(Less less) {
+				size_t limit{ std::max<size_t>(256, static_cast<size_t>(std::sqrt(static_cast<double>(m_main.size())))) };
+				if (m_recent.size() > limit) {
+					m_main = merge(m_main, m_recent, less);
+					m_recent.clear();
+				}
+			}
+			template <class Less>
+			static std::vector<Value> merge(const std::vector<Value>& lhs, const std::vector<Value>& rhs, Less less) {
+				std::vector<Value> merged;
+				merged.reserve(lhs.size() + rhs.size());
+				std::merge(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), std::back_inserter(merged), less);
+				return merged;
+			}
+		private:
+			std::vector<Value> m_main, m_recent;
+		};
+		using salary_key = std::pair<salary_t, entry_id>;
+
+/***********************************************************
+Списки термов по триграммам: открытая адресация с линейным
+пробированием (триграмм немного - несколько десятков тысяч,
+а обращений при построении - десятки миллионов)
+************************************************************/
+		class TrigramPostings {
+		public:
+			void Add(uint64_t trigram, term_id term);							//Идентификаторы термов должны возрастать
+			const std::vector<term_id>* Find(uint64_t trigram) const noexcept;
+			void Clear() noexcept;
+		private:
+			size_t find_slot(uint64_t trigram) const noexcept;
+			void grow();
+		private:
+			static constexpr uint64_t EMPTY_KEY{ UINT64_MAX };
+			std::vector<uint64_t> m_keys;
+			std::vector<uint32_t> m_slots;											//Индекс в m_lists
+			std::vector<std::vector<term_id>> m_lists;
+		};
+
+		struct Entry {
+			const wrapper::Department* department;
+			const wrapper::Employee* employee;
+			salary_t salary;
+			std::array<term_id, FIELD_COUNT> terms;
+			std::array<entry_id, FIELD_COUNT> next;								//Следующая запись с тем же термом
+			bool alive;
+		};
+
+		struct Term {
+			std::string key;													//Приведённое к нижнему регистру значение поля
+			uint32_t length;													//Длина в символах
+			entry_id head;														//Последняя добавленная запись, включая удалённые
+		};
+
+		struct FieldIndex {
+			std::deque<Term> terms;												//Адреса ключей стабильны
+			std::unordered_map<std::string_view, term_id> lookup;
+			SortedSet<term_id> sorted;											//Термы в алфавитном порядке
+			mutable TrigramPostings trigrams;									//Строятся при первом нечётком запросе по полю
+			mutable bool has_trigrams{ false };
+		};
+
+		struct Mark {															//Размеры хранилищ до начала пакета вставок
+			size_t entries;
+			std::array<size_t, FIELD_COUNT> terms;
+		};
+	private:
+		Mark make_mark() const noexcept;
+		void commit(const Mark& mark);											//Упорядочивание термов и записей, добавленных после mark
+		void add_entry(const wrapper::Department& department, const wrapper::Employee& employee);
+		void erase_entry(const wrapper::Employee& employee);
+		term_id add_term(FieldIndex& index, std::string&& key);
+		static void add_trigrams(const FieldIndex& index, term_id term);
+		static void ensure_trigrams(const FieldIndex& index);
+		void compact_if_needed();
+
+		template <class Visitor>
+		bool visit_term_entries(Field field, term_id term, Visitor visitor) const {	//visitor(entry) возвращает false для остановки обхода
+			for (entry_id id = get_field(field).terms[term].head; id != NO_ENTRY; id = m_entries[id].next[static_cast<size_t>(field)]) {
+				if (!visitor(id)) {
+					return false;
+				}
+			}
+			return true;
+		}
+		bool collect(entry_id id, size_t distance, size_t limit, match_list& matches) const;	//false, если лимит исчерпан
+
+		static auto term_less(const FieldIndex& index) {
+			return [&index](term_id lhs, term_id rhs) {
+				return index.terms[lhs].key < index.terms[rhs].key;
+			};
+		}
+		FieldIndex& get_field(Field field) noexcept;
+		const FieldIndex& get_field(Field field) const noexcept;
+	private:
+		std::vector<Entry> m_entries;
+		std::unordered_map<const wrapper::Employee*, entry_id> m_by_employee;
+		std::array<FieldIndex, FIELD_COUNT> m_fields;
+		SortedSet<salary_key> m_by_salary;
+		size_t m_dead_count{ 0 };
+	};
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+#include <optional>
+#include <utility>
+
+/***********************************************************
+Шаблон MpscQueue - неограниченная очередь для многих
+производителей и одного потребителя (интрузивный список
+Вьюкова). Push() из любого потока выполняет один atomic
+exchange и не захватывает мьютекс; ожидания нет, поэтому
+производитель никогда не блокируется потребителем.
+
+TryPop() и Empty() вызывает только поток-владелец. Между
+exchange и связыванием узла элемент производителя ещё
+не виден потребителю: TryPop() вернёт nullopt, и элемент
+будет извлечён при следующем опросе. Порядок элементов
+одного производителя сохраняется
+************************************************************/
+template <class Ty>
+class MpscQueue {
+public:
+	using value_type = Ty;
+private:
+	struct Node {
+		std::atomic<Node*> next{ nullptr };
+		std::optional<Ty> value;													//Пуст у фиктивного узла
+	};
+public:
+	MpscQueue()
+		: m_head(new Node),
+		m_tail(m_head.load())
+	{
+	}
+	MpscQueue(const MpscQueue&) = delete;
+	MpscQueue& operator=(const MpscQueue&) = delete;
+	~MpscQueue() {
+		while (m_tail) {															//Неизвлечённые элементы уничтожаются вместе с узлами
+			delete std::exchange(m_tail, m_tail->next.load(std::memory_order_relaxed));
+		}
+	}
+
+	void Push(Ty value) {															//Любой поток
+		Node* node{ new Node };
+		node->value.emplace(std::move(value));
+		Node* prev{ m_head.exchange(node, std::memory_order_acq_rel) };				//Производители упорядочиваются на exchange
+		prev->next.store(node, std::memory_order_release);							//Связывание публикует элемент потребителю
+	}
+
+	std::optional<Ty> TryPop() {													//Только потребитель
+		Node* next{ m_tail->next.load(std::memory_order_acquire) };
+		if (!next) {
+			return std::nullopt;
+		}
+		std::optional<Ty> value{ std::move(next->value) };
+		next->value.reset();														//Узел становится фиктивным
+		delete std::exchange(m_tail, next);
+		return value;
+	}
+
+	bool Empty() const noexcept {													//Только потребитель
+		return !m_tail->next.load(std::memory_order_acquire);
+	}
+private:
+	alignas(64) std::atomic<Node*> m_head;											//Последний добавленный узел; изменяют производители
+	alignas(64) Node* m_tail;														//Фиктивный узел перед первым элементом; изменяет только потребитель
+};
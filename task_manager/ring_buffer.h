@@ -0,0 +1,148 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <optional>
+#include <utility>
+#include <stdexcept>
+
+/***********************************************************
+Шаблон RingBuffer реализует кольцевой буфер ограниченной
+ёмкости. Ячейки выделяются по мере заполнения (удвоением,
+но не больше ёмкости), поэтому пустой буфер большой
+ёмкости не занимает памяти; после заполнения добавление
+и извлечение элементов не обращаются к куче (в отличие
+от std::list, создающего узел на каждую вставку).
+При переполнении самый старый элемент вытесняется
+и возвращается вызывающему коду.
+
+Ty должен иметь конструктор по умолчанию и оператор
+перемещающего присваивания: освобождённая ячейка
+сбрасывается в состояние Ty{}
+************************************************************/
+template <class Ty>
+class RingBuffer {
+public:
+	using value_type = Ty;
+public:
+	RingBuffer() = default;
+	explicit RingBuffer(size_t capacity) noexcept
+		: m_capacity(capacity)
+	{
+	}
+
+	size_t size() const noexcept {
+		return m_size;
+	}
+
+	size_t capacity() const noexcept {
+		return m_capacity;
+	}
+
+	void set_capacity(size_t capacity) {											//Уменьшение ёмкости не поддерживается
+		if (capacity < m_capacity) {
+			throw std::invalid_argument("Ring buffer capacity can't be decreased");
+		}
+		m_capacity = capacity;
+	}
+
+	bool empty() const noexcept {
+		return !m_size;
+	}
+
+	bool full() const noexcept {
+		return m_size == capacity();
+	}
+
+	Ty& front() {
+		throw_if_empty();
+		return m_storage[m_head];
+	}
+
+	const Ty& front() const {
+		throw_if_empty();
+		return m_storage[m_head];
+	}
+
+	Ty& back() {
+		throw_if_empty();
+		return m_storage[physical_index(m_size - 1)];
+	}
+
+	const Ty& back() const {
+		throw_if_empty();
+		return m_storage[physical_index(m_size - 1)];
+	}
+
+	Ty& operator[](size_t idx) noexcept {											//0 - самый старый элемент
+		return m_storage[physical_index(idx)];
+	}
+
+	const Ty& operator[](size_t idx) const noexcept {
+		return m_storage[physical_index(idx)];
+	}
+
+	std::optional<Ty> push_back(Ty&& value) {										//Возвращает вытесненный элемент, если буфер был заполнен
+		if (!capacity()) {
+			return std::optional<Ty>(std::move(value));								//Буфер нулевой ёмкости ничего не хранит
+		}
+		std::optional<Ty> evicted;
+		if (full()) {
+			evicted = pop_front();
+		}
+		else if (m_size == m_storage.size()) {
+			grow();
+		}
+		m_storage[physical_index(m_size)] = std::move(value);
+		++m_size;
+		return evicted;
+	}
+
+	Ty pop_back() {
+		throw_if_empty();
+		--m_size;
+		return std::exchange(m_storage[physical_index(m_size)], Ty{});
+	}
+
+	Ty pop_front() {
+		throw_if_empty();
+		Ty value{ std::exchange(m_storage[m_head], Ty{}) };
+		m_head = physical_index(1);
+		--m_size;
+		return value;
+	}
+
+	void clear() noexcept {
+		while (m_size) {
+			m_storage[physical_index(--m_size)] = Ty{};
+		}
+		m_head = 0;
+	}
+
+private:
+	static constexpr size_t MIN_GROWTH{ 8 };
+
+	void grow() {																	//Элементы переносятся в начало нового массива в логическом порядке
+		std::vector<Ty> storage(std::min(std::max(m_storage.size() * 2, MIN_GROWTH), m_capacity));
+		for (size_t idx = 0; idx < m_size; ++idx) {
+			storage[idx] = std::move(m_storage[physical_index(idx)]);
+		}
+		m_storage = std::move(storage);
+		m_head = 0;
+	}
+
+	size_t physical_index(size_t logical_idx) const noexcept {
+		size_t idx{ m_head + logical_idx };
+		return idx < m_storage.size() ? idx : idx - m_storage.size();				//logical_idx <= m_storage.size(), поэтому деление не требуется
+	}
+
+	void throw_if_empty() const {
+		if (empty()) {
+			throw std::out_of_range("Ring buffer is empty");
+		}
+	}
+private:
+	std::vector<Ty> m_storage;
+	size_t m_capacity{ 0 },
+		m_head{ 0 },
+		m_size{ 0 };
+};
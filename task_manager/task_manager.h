@@ -1,13 +1,24 @@
 #pragma once
 #include "command_interface.h"
+#include "composite_command.h"
+#include "ring_buffer.h"
+#include "mpsc_queue.h"
+#include "task_metrics.h"
+#include "tracing.h"
 
 #include <memory>
 #include <utility>
-#include <list>
 #include <deque>
+#include <vector>
 #include <string>
 #include <functional>
+#include <chrono>
+#include <array>
 #include <stdexcept>
+#include <algorithm>
+
+template <class TargetTy>
+class TaskManager;
 
 namespace task {
 	enum class ResultType {
@@ -15,36 +26,101 @@ namespace task {
 		Fail,
 		EmptyQueue
 	};
+
+	enum class Pairing {														//Есть ли у записи ведущего парная запись ведомого (см. TaskManager::PairWith)
+		Single,
+		Paired
+	};
+
+	/******************************************************
+	PairedHistory - сторона пары TaskManager'ов, очереди
+	которых содержат парные записи (правка дерева данных и
+	её отображение, см. TaskManager::PairWith). Вытеснение
+	по ёмкости и по лимиту памяти выполняет лишь ведущий:
+	вместе со своей парной записью (Pairing::Paired,
+	задаётся при Process()) он вытесняет самую старую
+	запись той же очереди ведомого, поэтому пары не
+	разрываются. Пакеты и правки без команды отображения
+	(должность, оклад) парных записей не имеют
+	*******************************************************/
+
+	class PairedHistory {
+	public:
+		enum class Queue {
+			Cancel,
+			Repeat
+		};
+	public:
+		PairedHistory() = default;
+		PairedHistory(const PairedHistory&) = delete;
+		PairedHistory& operator=(const PairedHistory&) = delete;
+		virtual ~PairedHistory() {
+			if (m_leader) {
+				m_leader->m_follower = nullptr;
+			}
+			if (m_follower) {
+				m_follower->m_leader = nullptr;
+			}
+		}
+	private:
+		template <class>
+		friend class ::TaskManager;
+		virtual size_t retained_memory() const noexcept = 0;
+		virtual void evict_oldest(Queue queue) noexcept = 0;
+		virtual void shrink_to_memory_budget() noexcept = 0;
+	private:
+		PairedHistory* m_leader{ nullptr };
+		PairedHistory* m_follower{ nullptr };
+	};
 }
 
 template <class TargetTy>
-class TaskManager {
+class TaskManager : public task::PairedHistory {
 public:
-	static constexpr size_t DEFAULT_QUEUE_CAPACITY{ 20 };						//   
+	static constexpr size_t DEFAULT_QUEUE_CAPACITY{ 4096 };						//Стандартная емкость очереди команд (ячейки выделяются по мере заполнения)
+	static constexpr size_t DEFAULT_MEMORY_BUDGET{ 64 * 1024 * 1024 };			//Стандартный лимит памяти (в байтах), удерживаемой обеими очередями
+	static constexpr size_t DEFAULT_DRAIN_BATCH{ 1024 };						//Стандартный предел числа команд, извлекаемых DrainSubmitted() за вызов
 
 	using task_t = command::ICommand<TargetTy>;
 	using task_holder = command::command_holder<TargetTy>;
-	using command_queue = std::list<task_holder>;
-	using error_log_t = std::deque<std::string>;								//deque         
+	using batch_t = command::Composite<TargetTy>;
+	using task_list = typename batch_t::command_list;
+	using error_log_t = std::deque<std::string>;								//deque эффективнее при заранее неизвестном числе добавленных в конец элементов
 	using ResultType = task::ResultType;	
+	using value_type = command::result_t<TargetTy>;								//std::variant известных результатов команд над TargetTy
+	using metrics_dump_t = std::function<void(const task::Metrics&)>;
+	using submission_t = std::function<task_holder(TargetTy&)>;					//Фабрика команды для Submit()
 	struct Result {
-		std::any value;
+		value_type value;
 		ResultType type;
 	};
 protected:
-	using internal_result_t = std::pair<std::any, bool>;
+	using internal_result_t = std::pair<value_type, bool>;
+	struct HistoryRecord {
+		task_holder task{ MakeDummyObjectHolder<task_t>() };						//RingBuffer требует конструктор по умолчанию
+		size_t retained_memory{ 0 };											//Оценка обновляется после каждого Execute()/Cancel()
+		task::Metrics::clock::time_point processed_at{};						//Момент последней правки через Process(); отмена и повтор его сбрасывают
+		task::Pairing pairing{ task::Pairing::Single };							//Переходит вместе с командой между очередями отмены и повтора
+	};
+	using command_queue = RingBuffer<HistoryRecord>;
 public:
-	TaskManager() = default;
-	TaskManager(size_t queue_capacity)
-		: m_queue_capacity(queue_capacity)
+	TaskManager()
+		: TaskManager(DEFAULT_QUEUE_CAPACITY)
+	{
+	}
+	TaskManager(size_t queue_capacity, size_t memory_budget = DEFAULT_MEMORY_BUDGET)
+		: m_cancel(queue_capacity),
+		m_repeat(queue_capacity),
+		m_queue_capacity(queue_capacity),
+		m_memory_budget(memory_budget)
 	{
 	}
 
 	/******************************************************
-	    TM 
-	        
-	  .     
-	:
+	Для возможности синхронизации нескольких TM необходимо
+	сначала добавлять команды в очередь и лишь после 
+	пытаться их обработать. В противном случае возможна 
+	ситуация:
 	<TM1>: 
 		cancel queue before process: a5-a4-a3-a2-a1
 		process: ax, success
@@ -53,19 +129,23 @@ public:
 		cancel queue before process: b5-b4-b3-b2-b1
 		process: bx, fail
 		cancel queue after process: b5-b4-b3-b2-b1
-	< cancel  TM1   >
+	<Вызов cancel у TM1 для освобождения ресурсов>
 	<TM1>:
 		cancel queue after cancel: (empty)-a4-a3-a2-a1
-	: b5 - sync failed
+	Результат: b5 - sync failed
 	*******************************************************/
 
-	Result Process(task_holder&& new_command) {
+	Result Process(task_holder&& new_command, task::Pairing pairing = task::Pairing::Single) {	//Pairing::Paired - вызывающий код помещает в ведомый
+		tracing::Span span("task/TaskManager::Process", "task");					//парную команду отображения
+		if (InTransaction()) {												//Внутри транзакции команда выполняется сразу, 
+			return process_in_transaction(std::move(new_command));			//а в очередь отмены попадает лишь при CommitTransaction()
+		}
 		task_t* command;
-		if (!m_queue_capacity) {						//      
+		if (!m_queue_capacity) {						//Если сохранение в очередь для отмены отключено
 			command = new_command.get();
 		}
 		else {
-			update_cancel_queue(std::move(new_command));
+			push_record(m_cancel, HistoryRecord{ std::move(new_command), 0, {}, pairing });
 			command = get_last_command(m_cancel);
 		}
 		auto [result, success] {try_to_execute(command)};
@@ -75,17 +155,125 @@ public:
 			}	
 			return make_failed_operation_result();		
 		}
+		if (m_queue_capacity > 0 && !try_to_coalesce()) {
+			update_retained_memory(m_cancel);
+		}
 		return make_successful_operation_result(std::move(result));
 	}
 
+	/******************************************************
+	Пакетная обработка: N команд выполняются и отменяются
+	как одна. Для массовых правок (импорт, индексация З/П)
+	это избавляет от N записей в очереди отмены и позволяет
+	вызывающему коду обновить представление один раз.
+	ProcessBatch() принимает готовый список команд;
+	Begin/Commit/RollbackTransaction() позволяют
+	накапливать команды по одной, анализируя результат
+	каждой из них
+	*******************************************************/
+
+	Result ProcessBatch(TargetTy& target, task_list&& commands) {
+		if (commands.empty()) {
+			return make_empty_queue_operation_result();
+		}
+		return Process(batch_t::make_instance(target, std::move(commands)));
+	}
+
+	void BeginTransaction(TargetTy& target) {
+		if (InTransaction()) {
+			throw std::logic_error("Transaction is already started");			//Вложенные транзакции не поддерживаются
+		}
+		m_transaction = batch_t::make_instance(target, task_list{});
+	}
+
+	Result CommitTransaction() {
+		task_holder transaction{ extract_transaction() };
+		if (static_cast<batch_t&>(*transaction).Empty()) {
+			return make_empty_queue_operation_result();
+		}
+		if (m_queue_capacity > 0) {
+			update_cancel_queue(std::move(transaction));						//Все подкоманды уже выполнены
+			update_retained_memory(m_cancel);
+		}
+		return make_successful_operation_result(value_type{});
+	}
+
+	Result RollbackTransaction() {
+		task_holder transaction{ extract_transaction() };
+		if (static_cast<batch_t&>(*transaction).Empty()) {
+			return make_empty_queue_operation_result();
+		}
+		auto [result, success] {try_to_cancel(transaction.get())};
+		if (!success) {
+			return make_failed_operation_result();
+		}
+		return make_successful_operation_result(move(result));
+	}
+
+	bool InTransaction() const noexcept {
+		return static_cast<bool>(m_transaction);
+	}
+
+	/******************************************************
+	Отправка команд из других потоков (импорт, скрипты,
+	сервер). Submit() потокобезопасен и не блокируется:
+	в очередь MpscQueue помещается лишь фабрика команды.
+	Команды создаёт и выполняет только поток-владелец:
+	DrainSubmitted() вызывает до max_batch фабрик и
+	обрабатывает команды одной записью в очереди отмены,
+	так что представление достаточно обновить один раз
+	за пакет.
+	Узлы документа (TreeAllocator с таблицей атомов и пулом
+	строк) и пулы команд (ObjectPool) не потокобезопасны,
+	поэтому производитель передаёт только данные по
+	значению, а узлы и обёртки строит фабрика.
+	std::function требует копируемую фабрику: захватить
+	некопируемые Department или Employee нельзя
+	*******************************************************/
+
+	void Submit(submission_t factory) {											//Любой поток
+		m_submitted.Push(std::move(factory));
+	}
+
+	bool HasSubmitted() const noexcept {										//Только поток-владелец
+		return !m_submitted.Empty();
+	}
+
+	Result DrainSubmitted(TargetTy& target, size_t max_batch = DEFAULT_DRAIN_BATCH) {	//Только поток-владелец
+		tracing::Span span("task/TaskManager::DrainSubmitted", "task");
+		task_list commands;
+		for (size_t drained = 0; drained < max_batch; ++drained) {
+			auto factory{ m_submitted.TryPop() };
+			if (!factory) {
+				break;
+			}
+			++m_drained_count;
+			try {
+				if (auto command = (*factory)(target); command) {
+					commands.push_back(std::move(command));
+				}
+			}
+			catch (const std::exception& exc) {								//Ошибка одной фабрики не отменяет остальные команды пакета
+				log_error_message(exc.what());
+			}
+		}
+		span.SetCount(commands.size());
+		return ProcessBatch(target, std::move(commands));						//Даже одиночная команда оборачивается в пакет: Purpose::Batch
+	}																			//сообщает владельцу, что парных команд представления нет
+
+	size_t GetDrainedCount() const noexcept {									//Число фабрик, извлечённых DrainSubmitted()
+		return m_drained_count;
+	}
+
 	Result Cancel() {					
-		if (m_cancel.empty()) {												//     
+		throw_if_in_transaction();
+		if (m_cancel.empty()) {												//Попытка проверить наличие команды в очереди
 			return make_empty_queue_operation_result();			
 		}
-		update_repeat_queue(												//     
-			extract_last_command(m_cancel)									//   
+		push_record(														//Выброс исключения при пустой очереди команд
+			m_repeat, extract_last_record(m_cancel)							//Строго для внутреннего использования
 		);
-		auto [result, success] {						//      ,   
+		auto [result, success] {						//Команду сначала необходимо поместить в очередь повтора, чтобы избежать рассинхронизации
 			try_to_cancel(
 				get_last_command(m_repeat)
 			)
@@ -94,10 +282,12 @@ public:
 			extract_last_command(m_repeat);
 			return make_failed_operation_result();
 		}	
+		update_retained_memory(m_repeat);
 		return make_successful_operation_result(move(result));
 	}
 
-	Result CancelWithoutQueueing() {									//     repeat (  )
+	Result CancelWithoutQueueing() {									//Отмена без сохранения в очередь repeat (для нештатных ситуаций)
+		throw_if_in_transaction();
 		if (m_cancel.empty()) {												
 			return make_empty_queue_operation_result();
 		}
@@ -111,13 +301,14 @@ public:
 	}
 
 	Result Repeat() {
+		throw_if_in_transaction();
 		if (m_repeat.empty()) {
 			return make_empty_queue_operation_result();
 		}
-		update_cancel_queue(
-			extract_last_command(m_repeat)
+		push_record(
+			m_cancel, extract_last_record(m_repeat)
 		);
-		auto [result, success] {						//      ,   
+		auto [result, success] {						//Команду сначала необходимо поместить в очередь отмены, чтобы избежать рассинхронизации
 			try_to_execute(
 				get_last_command(m_cancel)
 			)
@@ -126,12 +317,14 @@ public:
 			extract_last_command(m_cancel);
 			return make_failed_operation_result();
 		}																	
+		update_retained_memory(m_cancel);
 		return make_successful_operation_result(move(result));
 	}
 
 
-	Result RepeatWithoutQueueing() {									//     cancel (  )
-		if (m_cancel.empty()) {
+	Result RepeatWithoutQueueing() {									//Повтор без сохранения в очередь cancel (для нештатных ситуаций)
+		throw_if_in_transaction();
+		if (m_repeat.empty()) {
 			return make_empty_queue_operation_result();
 		}
 		task_holder task{ extract_last_command(m_repeat) };
@@ -151,7 +344,7 @@ public:
 		return m_repeat.size();
 	}
 
-	std::optional<command::Type> GetLastProcessedType() const noexcept {					//     
+	std::optional<command::Type> GetLastProcessedType() const noexcept {					//Получение типа последней успешно обработанной команды
 		task_t* command{ get_last_command(m_cancel) };
 		if (!command) {
 			return std::nullopt;
@@ -159,7 +352,7 @@ public:
 		return command->GetType();
 	}
 
-	std::optional<command::Type> GetLastCanceledType() const noexcept {						//    
+	std::optional<command::Type> GetLastCanceledType() const noexcept {						//Получение типа последней отменённой команды
 		task_t* command{ get_last_command(m_repeat) };
 		if (!command) {
 			return std::nullopt;
@@ -167,7 +360,15 @@ public:
 		return command->GetType();
 	}
 
-	std::optional<command::Purpose> GetLastProcessedPurpose() const noexcept {				//     
+	bool IsLastProcessedPaired() const noexcept {								//Есть ли у последней выполненной команды парная запись ведомого
+		return !m_cancel.empty() && m_cancel.back().pairing == task::Pairing::Paired;
+	}
+
+	bool IsLastCanceledPaired() const noexcept {								//Есть ли у последней отменённой команды парная запись ведомого
+		return !m_repeat.empty() && m_repeat.back().pairing == task::Pairing::Paired;
+	}
+
+	std::optional<command::Purpose> GetLastProcessedPurpose() const noexcept {				//Получение категории последней успешно обработанной команды
 		task_t* command{ get_last_command(m_cancel) };
 		if (!command) {
 			return std::nullopt;
@@ -175,7 +376,7 @@ public:
 		return command->GetPurpose();
 	}
 
-	std::optional<command::Purpose> GetLastCanceledPurpose() const noexcept {				//    
+	std::optional<command::Purpose> GetLastCanceledPurpose() const noexcept {				//Получение категории последней отменённой команды
 		task_t* command{ get_last_command(m_repeat) };	
 		if (!command) {
 			return std::nullopt;
@@ -183,17 +384,44 @@ public:
 		return command->GetPurpose();
 	}
 
+	size_t GetRetainedMemory() const noexcept {								//Суммарная оценка памяти, удерживаемой очередями отмены и повтора
+		return m_retained_memory;
+	}
+
+	size_t GetMemoryBudget() const noexcept {
+		return m_memory_budget;
+	}
+
+	void SetMemoryBudget(size_t memory_budget) noexcept {						//Уменьшение лимита сразу вытесняет самые старые команды;
+		m_memory_budget = memory_budget;										//у ведомого лимит не используется - память пары учитывает ведущий
+		shrink_to_memory_budget();
+	}
+
+	template <class FollowerTargetTy>
+	void PairWith(TaskManager<FollowerTargetTy>& follower) {					//*this - ведущий: правки данных, follower - их отображение
+		if (m_leader || m_follower || follower.m_leader || follower.m_follower
+			|| static_cast<task::PairedHistory*>(this) == std::addressof(follower)) {
+			throw std::logic_error("Task manager is already paired");
+		}
+		m_follower = std::addressof(follower);
+		follower.m_leader = this;
+		size_t follower_capacity{ m_queue_capacity + 1 };						//Ведомый сам не вытесняет: его запись может опередить запись ведущего
+		follower.m_cancel.set_capacity(std::max(follower.m_cancel.capacity(), follower_capacity));
+		follower.m_repeat.set_capacity(std::max(follower.m_repeat.capacity(), follower_capacity));
+		shrink_to_memory_budget();
+	}
+
 	void ResetCancelQueue() noexcept{
-		m_cancel.clear();
+		reset_queue(m_cancel);
 	}
 
 	void ResetRepeatQueue() noexcept {
-		m_repeat.clear();
+		reset_queue(m_repeat);
 	}
 
 	void ResetQueues() noexcept {
-		m_cancel.clear();
-		m_repeat.clear();
+		reset_queue(m_cancel);
+		reset_queue(m_repeat);
 	}
 
 	void ResetAll() noexcept {
@@ -201,6 +429,38 @@ public:
 		m_error_log.clear();
 	}
 
+	/******************************************************
+	Слияние быстрых последовательных правок: если команда
+	того же типа изменяет то же поле того же объекта, что и
+	предыдущая, и с прошлой правки прошло не более window,
+	в очереди отмены остаётся одна запись с исходным
+	значением (см. ICommand::Absorb). Окно отсчитывается
+	от последней поглощённой правки. Слияние выполняет лишь
+	Process() вне транзакции
+	*******************************************************/
+
+	void SetCoalescingWindow(command::Type type, std::chrono::milliseconds window) noexcept {	//Нулевое окно отключает слияние
+		m_coalescing_windows[static_cast<size_t>(type)] = window;
+	}
+
+	size_t GetCoalescedCount() const noexcept {								//Число поглощённых команд
+		return m_coalesced_count;
+	}
+
+	const task::Metrics& GetMetrics() const noexcept {							//Время выполнения и отмены, отказы и удерживаемая память по типам команд
+		return m_metrics;
+	}
+
+	void ResetMetrics() noexcept {
+		m_metrics.Reset();
+	}
+
+	void SetMetricsDump(metrics_dump_t dump, std::chrono::milliseconds period) {	//Вызывается перед обработкой команды, если с прошлого вызова прошло не менее period
+		m_metrics_dump = std::move(dump);
+		m_dump_period = period;
+		m_last_dump = task::Metrics::clock::now();
+	}
+
 	const error_log_t& GetErrorLog() const noexcept {
 		return m_error_log;
 	}
@@ -214,16 +474,116 @@ public:
 	}
 protected:
 	void update_cancel_queue(task_holder&& command) {
-		m_cancel.push_back(move(command));
-		if (CanBeCanceled() > m_queue_capacity) {
-			m_cancel.pop_front();
+		push_record(m_cancel, HistoryRecord{ move(command), 0, {}, task::Pairing::Single });
+	}
+
+	void push_record(command_queue& queue, HistoryRecord&& record) {
+		if (auto evicted = queue.push_back(std::move(record)); evicted) {		//При переполнении самая старая команда уничтожается
+			evict(queue, std::move(*evicted));
 		}
 	}
 
-	void update_repeat_queue(task_holder&& command) {
-		m_repeat.push_back(move(command));
-		if (CanBeRepeated() > m_queue_capacity) {
-			m_repeat.pop_front();
+	void evict(command_queue& queue, HistoryRecord&& record) noexcept {		//Вместе с записью ведущего вытесняется парная запись ведомого
+		release(record);
+		if (m_follower && record.pairing == task::Pairing::Paired) {
+			m_follower->evict_oldest(
+				std::addressof(queue) == std::addressof(m_cancel) ? Queue::Cancel : Queue::Repeat
+			);
+		}
+	}
+
+	void evict_oldest(Queue queue) noexcept override {
+		auto& target_queue{ queue == Queue::Cancel ? m_cancel : m_repeat };
+		if (!target_queue.empty()) {
+			evict(target_queue, target_queue.pop_front());
+		}
+	}
+
+	size_t retained_memory() const noexcept override {
+		return m_retained_memory;
+	}
+
+	void update_retained_memory(command_queue& queue) {							//Объём удерживаемой памяти меняется после выполнения или отмены:
+		auto& record{ queue.back() };											//например, RemoveEmployee забирает узел во владение
+		release(record);
+		record.retained_memory = record.task->RetainedMemory();
+		m_retained_memory += record.retained_memory;
+		m_metrics.Retain(record.task->GetType(), record.retained_memory);
+		shrink_to_memory_budget();
+	}
+
+	void shrink_to_memory_budget() noexcept override {							//Вытесняются самые старые записи: сначала из очереди отмены, затем из очереди повтора;
+		if (m_leader) {															//последние команды обеих очередей сохраняются всегда
+			m_leader->shrink_to_memory_budget();								//Лимит пары контролирует ведущий
+			return;
+		}
+		while (m_retained_memory + (m_follower ? m_follower->retained_memory() : 0) > m_memory_budget) {
+			if (m_cancel.size() > 1) {
+				evict(m_cancel, m_cancel.pop_front());
+			}
+			else if (m_repeat.size() > 1) {
+				evict(m_repeat, m_repeat.pop_front());
+			}
+			else {
+				break;
+			}
+		}
+	}
+
+	bool try_to_coalesce() {													//Вызывается после успешного выполнения последней команды очереди отмены
+		auto now{ task::Metrics::clock::now() };
+		task_t* command{ get_last_command(m_cancel) };
+		auto window{ m_coalescing_windows[static_cast<size_t>(command->GetType())] };
+		if (window.count() > 0 && m_cancel.size() > 1) {
+			auto& previous{ m_cancel[m_cancel.size() - 2] };
+			if (previous.processed_at != task::Metrics::clock::time_point{}
+				&& previous.pairing == task::Pairing::Single						//Поглощение парной записи оставило бы в ведомом запись без пары
+				&& m_cancel.back().pairing == task::Pairing::Single
+				&& now - previous.processed_at <= window
+				&& previous.task->Absorb(*command)) {
+				extract_last_command(m_cancel);										//Поглощённая команда уничтожается
+				++m_coalesced_count;
+				m_cancel.back().processed_at = now;
+				update_retained_memory(m_cancel);
+				return true;
+			}
+		}
+		m_cancel.back().processed_at = now;
+		return false;
+	}
+
+	void reset_queue(command_queue& queue) noexcept {
+		while (!queue.empty()) {
+			release(queue.pop_back());
+		}
+	}
+
+	void release(const HistoryRecord& record) noexcept {						//Записи без оценки (ещё не выполненные команды) память не учитывают
+		if (record.retained_memory) {
+			m_retained_memory -= record.retained_memory;
+			m_metrics.Release(record.task->GetType(), record.retained_memory);
+		}
+	}
+
+	Result process_in_transaction(task_holder&& command) {
+		auto [result, success] {try_to_execute(command.get())};
+		if (!success) {
+			return make_failed_operation_result();							//Решение об откате ранее выполненных принимает вызывающий код
+		}
+		static_cast<batch_t&>(*m_transaction).Append(std::move(command));
+		return make_successful_operation_result(std::move(result));
+	}
+
+	task_holder extract_transaction() {
+		if (!InTransaction()) {
+			throw std::logic_error("Transaction isn't started");
+		}
+		return std::exchange(m_transaction, MakeDummyObjectHolder<task_t>());
+	}
+
+	void throw_if_in_transaction() const {									//Отмена и повтор внутри транзакции нарушили бы порядок команд
+		if (InTransaction()) {
+			throw std::logic_error("Unable to cancel or repeat commands during transaction");
 		}
 	}
 
@@ -236,34 +596,40 @@ protected:
 	}
 
 	static task_t* get_last_command(const command_queue& queue) noexcept {
-		return queue.empty() ? nullptr : queue.back().get();
+		return queue.empty() ? nullptr : queue.back().task.get();
+	}
+
+	task_holder extract_last_command(command_queue& queue) {
+		return extract_last_record(queue).task;
 	}
 
-	static task_holder extract_last_command(command_queue& queue) {
+	HistoryRecord extract_last_record(command_queue& queue) {					//Оценка памяти и момент правки не переносятся
 		if (queue.empty()) {
 			throw std::out_of_range("Command queue is empty");
 		}
-		auto extracted_command = move(queue.back());
-		queue.pop_back();
-		return extracted_command;
+		auto extracted_record{ queue.pop_back() };
+		release(extracted_record);
+		return HistoryRecord{ move(extracted_record.task), 0, {}, extracted_record.pairing };
 	}
 
 	static Result make_empty_queue_operation_result() noexcept {
-		return { std::any{}, ResultType::EmptyQueue };
+		return { value_type{}, ResultType::EmptyQueue };
 	}
 
 	static Result make_failed_operation_result() noexcept {
-		return { std::any{}, ResultType::Fail };
+		return { value_type{}, ResultType::Fail };
 	}
 
-	static Result make_successful_operation_result(std::any&& value) noexcept {
-		return { move(value), ResultType::Success };							//  r-value ref -    move c-tor
+	static Result make_successful_operation_result(value_type&& value) noexcept {
+		return { move(value), ResultType::Success };							//Принимаем по r-value ref - экономим один вызов move c-tor
 	}
 
 private:
-	internal_result_t try_to_process(std::any(task_t::* method)(), task_t* command) {
+	internal_result_t try_to_process(value_type(task_t::* method)(), task_t* command) {
 		size_t error_count_before_op{ m_error_log.size() };
 		internal_result_t result;
+		auto start{ task::Metrics::clock::now() };
+		dump_metrics(start);													//До обработки: память предыдущей команды уже учтена
 		try {
             result.first = std::invoke(method, command);
 		}
@@ -274,17 +640,49 @@ private:
 			log_error_message("Unknown error");
 		}
 		result.second = m_error_log.size() == error_count_before_op;
+		auto finish{ task::Metrics::clock::now() };
+		if (method == &task_t::Execute) {
+			m_metrics.RecordExecute(command->GetType(), finish - start, result.second);
+		}
+		else {
+			m_metrics.RecordCancel(command->GetType(), finish - start, result.second);
+		}
 		return result;
 	}
 
+	void dump_metrics(task::Metrics::clock::time_point now) noexcept {
+		if (m_metrics_dump && now - m_last_dump >= m_dump_period) {
+			m_last_dump = now;
+			try {
+				m_metrics_dump(m_metrics);
+			}
+			catch (...) {															//Сбой вывода метрик не влияет на результат команды
+			}
+		}
+	}
+
 	void log_error_message(std::string msg) {
 		m_error_log.push_back(move(msg));
 	}
 
+private:
+	template <class>
+	friend class TaskManager;																	//PairWith() настраивает очереди ведомого
 private:
 	command_queue m_cancel, m_repeat;
+	task_holder m_transaction{ MakeDummyObjectHolder<task_t>() };			//Открытая транзакция (batch_t)
 	error_log_t m_error_log;
-	size_t m_queue_capacity{ DEFAULT_QUEUE_CAPACITY };
+	task::Metrics m_metrics;
+	std::array<std::chrono::milliseconds, command::TYPE_COUNT> m_coalescing_windows{};
+	size_t m_coalesced_count{ 0 };
+	MpscQueue<submission_t> m_submitted;									//Фабрики команд, отправленные через Submit()
+	size_t m_drained_count{ 0 };
+	metrics_dump_t m_metrics_dump;
+	std::chrono::milliseconds m_dump_period{ 0 };
+	task::Metrics::clock::time_point m_last_dump;
+	size_t m_queue_capacity{ DEFAULT_QUEUE_CAPACITY },
+		m_memory_budget{ DEFAULT_MEMORY_BUDGET },
+		m_retained_memory{ 0 };
 };
 
 
@@ -0,0 +1,348 @@
+#pragma once
+#include "command_interface.h"
+
+#include <array>
+#include <vector>
+#include <chrono>
+#include <string_view>
+#include <utility>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cstdint>
+
+/***********************************************************
+Метрики TaskManager по типам команд: гистограммы времени
+выполнения и отмены, число отказов и объём памяти,
+удерживаемой командами в очередях отмены и повтора.
+Сводка по категориям (command::Purpose) строится
+объединением метрик входящих в них типов.
+
+LatencyHistogram устроена по образцу HDR Histogram:
+значения до 2 * SUB_BUCKET_COUNT нс хранятся точно, далее
+каждая степень двойки делится на SUB_BUCKET_COUNT равных
+интервалов, поэтому относительная погрешность перцентилей
+не превышает 1 / SUB_BUCKET_COUNT при любом масштабе.
+Ячейки выделяются при первой записи: гистограммы
+неиспользуемых команд память не занимают
+************************************************************/
+
+namespace task {
+	class LatencyHistogram {
+	public:
+		using duration = std::chrono::nanoseconds;
+		static constexpr unsigned SUB_BUCKET_BITS{ 4 };
+		static constexpr size_t SUB_BUCKET_COUNT{ size_t{ 1 } << SUB_BUCKET_BITS };				//Погрешность ~6%
+		static constexpr size_t BUCKET_COUNT{ (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT };
+	public:
+		void Record(duration elapsed) {
+			uint64_t value{ static_cast<uint64_t>(std::max(elapsed.count(), duration::rep{ 0 })) };
+			if (m_buckets.empty()) {
+				m_buckets.resize(BUCKET_COUNT);
+			}
+			++m_buckets[bucket_index(value)];
+			m_min = m_count ? std::min(m_min, value) : value;
+			m_max = std::max(m_max, value);
+			m_sum += value;
+			++m_count;
+		}
+
+		void Merge(const LatencyHistogram& other) {
+			if (!other.m_count) {
+				return;
+			}
+			if (m_buckets.empty()) {
+				m_buckets.resize(BUCKET_COUNT);
+			}
+			for (size_t idx = 0; idx < BUCKET_COUNT; ++idx) {
+				m_buckets[idx] += other.m_buckets[idx];
+			}
+			m_min = m_count ? std::min(m_min, other.m_min) : other.m_min;
+			m_max = std::max(m_max, other.m_max);
+			m_sum += other.m_sum;
+			m_count += other.m_count;
+		}
+
+		uint64_t Count() const noexcept {
+			return m_count;
+		}
+
+		duration Min() const noexcept {
+			return duration(static_cast<duration::rep>(m_min));
+		}
+
+		duration Max() const noexcept {
+			return duration(static_cast<duration::rep>(m_max));
+		}
+
+		duration Mean() const noexcept {
+			return duration(m_count ? static_cast<duration::rep>(m_sum / m_count) : 0);
+		}
+
+		duration Percentile(double percent) const noexcept {						//Верхняя граница ячейки, в которую попал перцентиль
+			if (!m_count) {
+				return duration::zero();
+			}
+			double fraction{ std::clamp(percent, 0.0, 100.0) / 100 };
+			uint64_t rank{ std::max<uint64_t>(1, static_cast<uint64_t>(fraction * static_cast<double>(m_count) + 0.5)) };
+			uint64_t accumulated{ 0 };
+			for (size_t idx = 0; idx < BUCKET_COUNT; ++idx) {
+				accumulated += m_buckets[idx];
+				if (accumulated >= rank) {
+					uint64_t value{ std::clamp(bucket_upper_bound(idx), m_min, m_max) };
+					return duration(static_cast<duration::rep>(value));
+				}
+			}
+			return Max();
+		}
+
+		size_t AllocatedMemory() const noexcept {
+			return m_buckets.capacity() * sizeof(uint64_t);
+		}
+	private:
+		static size_t bucket_index(uint64_t value) noexcept {
+			if (value < 2 * SUB_BUCKET_COUNT) {
+				return static_cast<size_t>(value);
+			}
+			unsigned shift{ most_significant_bit(value) - SUB_BUCKET_BITS };			//value >> shift попадает в [SUB_BUCKET_COUNT, 2 * SUB_BUCKET_COUNT)
+			return (shift + 1) * SUB_BUCKET_COUNT + static_cast<size_t>(value >> shift) - SUB_BUCKET_COUNT;
+		}
+
+		static uint64_t bucket_upper_bound(size_t idx) noexcept {
+			if (idx < 2 * SUB_BUCKET_COUNT) {
+				return idx;
+			}
+			unsigned shift{ static_cast<unsigned>(idx / SUB_BUCKET_COUNT - 1) };
+			uint64_t sub_bucket{ idx % SUB_BUCKET_COUNT + SUB_BUCKET_COUNT };
+			return ((sub_bucket + 1) << shift) - 1;
+		}
+
+		static unsigned most_significant_bit(uint64_t value) noexcept {
+			unsigned bit{ 0 };
+			while (value >>= 1) {
+				++bit;
+			}
+			return bit;
+		}
+	private:
+		std::vector<uint64_t> m_buckets;
+		uint64_t m_count{ 0 },
+			m_sum{ 0 },
+			m_min{ 0 },
+			m_max{ 0 };
+	};
+
+	struct OperationMetrics {
+		LatencyHistogram latency;													//Включая завершившиеся отказом
+		uint64_t failures{ 0 };
+
+		void Merge(const OperationMetrics& other) {
+			latency.Merge(other.latency);
+			failures += other.failures;
+		}
+	};
+
+	struct CommandMetrics {
+		OperationMetrics execute;													//Execute() - первое выполнение и повтор
+		OperationMetrics cancel;
+		size_t retained_memory{ 0 };												//Удерживается очередями отмены и повтора в данный момент
+		size_t retained_commands{ 0 };
+
+		void Merge(const CommandMetrics& other) {
+			execute.Merge(other.execute);
+			cancel.Merge(other.cancel);
+			retained_memory += other.retained_memory;
+			retained_commands += other.retained_commands;
+		}
+
+		bool Empty() const noexcept {
+			return !execute.latency.Count() && !cancel.latency.Count() && !retained_commands;
+		}
+	};
+
+	class Metrics {
+	public:
+		using clock = std::chrono::steady_clock;
+	public:
+		void RecordExecute(command::Type type, clock::duration elapsed, bool success) {
+			record(get(type).execute, elapsed, success);
+		}
+
+		void RecordCancel(command::Type type, clock::duration elapsed, bool success) {
+			record(get(type).cancel, elapsed, success);
+		}
+
+		void Retain(command::Type type, size_t memory) noexcept {
+			auto& metrics{ get(type) };
+			metrics.retained_memory += memory;
+			++metrics.retained_commands;
+		}
+
+		void Release(command::Type type, size_t memory) noexcept {
+			auto& metrics{ get(type) };
+			metrics.retained_memory -= memory;
+			--metrics.retained_commands;
+		}
+
+		const CommandMetrics& ForType(command::Type type) const noexcept {
+			return m_commands[static_cast<size_t>(type)];
+		}
+
+		CommandMetrics ForPurpose(command::Purpose purpose) const {
+			CommandMetrics result;
+			for (size_t idx = 0; idx < command::TYPE_COUNT; ++idx) {
+				if (command::PurposeOf(static_cast<command::Type>(idx)) == purpose) {
+					result.Merge(m_commands[idx]);
+				}
+			}
+			return result;
+		}
+
+		CommandMetrics Total() const {
+			CommandMetrics result;
+			for (const auto& metrics : m_commands) {
+				result.Merge(metrics);
+			}
+			return result;
+		}
+
+		void Reset() noexcept {														//Сведения об удерживаемой памяти отражают состояние очередей и сохраняются
+			for (auto& metrics : m_commands) {
+				metrics.execute = {};
+				metrics.cancel = {};
+			}
+		}
+
+		void WriteText(std::ostream& out, std::string_view prefix) const {			//По строке на использованный тип команды и категорию
+			for (size_t idx = 0; idx < command::TYPE_COUNT; ++idx) {
+				auto type{ static_cast<command::Type>(idx) };
+				if (!m_commands[idx].Empty()) {
+					out << prefix << TypeName(type) << " (" << PurposeName(command::PurposeOf(type)) << "): ";
+					write_text(out, m_commands[idx]);
+				}
+			}
+			for (auto purpose : PURPOSES) {
+				if (auto metrics{ ForPurpose(purpose) }; !metrics.Empty()) {
+					out << prefix << PurposeName(purpose) << ": ";
+					write_text(out, metrics);
+				}
+			}
+		}
+
+		void WriteJson(std::ostream& out) const {
+			out << "{\"commands\":[";
+			bool first{ true };
+			for (size_t idx = 0; idx < command::TYPE_COUNT; ++idx) {
+				auto type{ static_cast<command::Type>(idx) };
+				if (!m_commands[idx].Empty()) {
+					out << (std::exchange(first, false) ? "" : ",")
+						<< "{\"type\":\"" << TypeName(type)
+						<< "\",\"purpose\":\"" << PurposeName(command::PurposeOf(type)) << "\",";
+					write_json(out, m_commands[idx]);
+					out << '}';
+				}
+			}
+			out << "],\"purposes\":[";
+			first = true;
+			for (auto purpose : PURPOSES) {
+				if (auto metrics{ ForPurpose(purpose) }; !metrics.Empty()) {
+					out << (std::exchange(first, false) ? "" : ",")
+						<< "{\"purpose\":\"" << PurposeName(purpose) << "\",";
+					write_json(out, metrics);
+					out << '}';
+				}
+			}
+			out << "],\"retained_bytes\":" << Total().retained_memory << '}';
+		}
+
+		static std::string_view TypeName(command::Type type) noexcept {
+			constexpr std::string_view names[]{
+				"File_GetPath", "File_SetPath", "File_CreateDocument", "File_Load", "File_Save",
+				"File_CheckLoaded", "File_CheckSaved", "File_Reset",
+				"Xml_AddDepartment", "Xml_InsertDepartment", "View_InsertDepartment",
+				"Xml_InsertEmployee", "View_InsertEmployee",
+				"Xml_RemoveDepartment", "View_RemoveDepartment", "Xml_RemoveEmployee", "View_RemoveEmployee",
+				"Xml_RenameDepartment", "View_RenameDepartment", "Xml_ChangeEmployeeSurname",
+				"Xml_ChangeEmployeeName", "Xml_ChangeEmployeeMiddleName", "Xml_ChangeEmployeeFunction",
+				"View_ChangeEmployeeFullName", "Xml_UpdateEmployeeSalary",
+				"Xml_ImportEmployees", "Batch"
+			};
+			static_assert(std::size(names) == command::TYPE_COUNT, "Type names must match command::Type");
+			return names[static_cast<size_t>(type)];
+		}
+
+		static std::string_view PurposeName(command::Purpose purpose) noexcept {
+			switch (purpose) {
+			case command::Purpose::FileIO: return "FileIO";
+			case command::Purpose::Insert: return "Insert";
+			case command::Purpose::Remove: return "Remove";
+			case command::Purpose::EditFields: return "EditFields";
+			default: return "Batch";
+			}
+		}
+	private:
+		static constexpr command::Purpose PURPOSES[]{
+			command::Purpose::FileIO, command::Purpose::Insert, command::Purpose::Remove,
+			command::Purpose::EditFields, command::Purpose::Batch
+		};
+
+		CommandMetrics& get(command::Type type) noexcept {
+			return m_commands[static_cast<size_t>(type)];
+		}
+
+		static void record(OperationMetrics& metrics, clock::duration elapsed, bool success) {
+			metrics.latency.Record(std::chrono::duration_cast<LatencyHistogram::duration>(elapsed));
+			metrics.failures += !success;
+		}
+
+		static double to_us(LatencyHistogram::duration value) noexcept {
+			return std::chrono::duration<double, std::micro>(value).count();
+		}
+
+		static void write_text(std::ostream& out, const CommandMetrics& metrics) {
+			const std::pair<std::string_view, const OperationMetrics*> operations[]{
+				{ "execute", std::addressof(metrics.execute) },
+				{ "cancel", std::addressof(metrics.cancel) }
+			};
+			auto flags{ out.flags() };													//Формат потока вызывающего восстанавливается в конце
+			auto precision{ out.precision() };
+			for (const auto& [name, operation] : operations) {
+				const auto& latency{ operation->latency };
+				if (latency.Count()) {
+					out << name << ' ' << latency.Count() << "x (" << operation->failures << " failed) "
+						<< std::fixed << std::setprecision(1)
+						<< "p50 " << to_us(latency.Percentile(50)) << " us, p99 " << to_us(latency.Percentile(99))
+						<< " us, max " << to_us(latency.Max()) << " us; ";
+				}
+			}
+			out << "retained " << metrics.retained_memory << " bytes in " << metrics.retained_commands << " commands\n";
+			out.flags(flags);
+			out.precision(precision);
+		}
+
+		static void write_json(std::ostream& out, const CommandMetrics& metrics) {
+			const std::pair<std::string_view, const OperationMetrics*> operations[]{
+				{ "execute", std::addressof(metrics.execute) },
+				{ "cancel", std::addressof(metrics.cancel) }
+			};
+			auto flags{ out.flags() };
+			auto precision{ out.precision() };
+			for (const auto& [name, operation] : operations) {
+				const auto& latency{ operation->latency };
+				out << '"' << name << "\":{\"count\":" << latency.Count() << ",\"failures\":" << operation->failures
+					<< std::fixed << std::setprecision(3)
+					<< ",\"mean_us\":" << to_us(latency.Mean())
+					<< ",\"p50_us\":" << to_us(latency.Percentile(50))
+					<< ",\"p90_us\":" << to_us(latency.Percentile(90))
+					<< ",\"p99_us\":" << to_us(latency.Percentile(99))
+					<< ",\"max_us\":" << to_us(latency.Max()) << "},";
+			}
+			out << "\"retained_bytes\":" << metrics.retained_memory
+				<< ",\"retained_commands\":" << metrics.retained_commands;
+			out.flags(flags);
+			out.precision(precision);
+		}
+	private:
+		std::array<CommandMetrics, command::TYPE_COUNT> m_commands;
+	};
+}
@@ -0,0 +1,82 @@
+#include "test_common.h"
+#include "spsc_queue.h"
+#include <chrono>
+#include <thread>
+#include <string>
+#include <vector>
+using namespace std;
+
+TEST_CASE("SpscQueue: full and empty edges without waiting") {
+	SpscQueue<string> queue(2);
+	CHECK(queue.capacity() == 2);
+	CHECK(!queue.TryPop());
+
+	string first{ "first" }, second{ "second" }, third{ "third" };
+	CHECK(queue.TryPush(first));
+	CHECK(queue.TryPush(second));
+	CHECK(!queue.TryPush(third));													//Очередь заполнена
+	CHECK(third == "third");														//Не принятый элемент не перемещается
+	CHECK(queue.TryPop() == optional<string>{ "first" });
+	CHECK(queue.TryPush(third));													//Ячейка освободилась, индексы переходят через границу
+	CHECK(queue.TryPop() == optional<string>{ "second" });
+	CHECK(queue.TryPop() == optional<string>{ "third" });
+	CHECK(!queue.TryPop());
+}
+
+TEST_CASE("SpscQueue: Close rejects new items and lets the consumer drain") {
+	SpscQueue<int> queue(4);
+	CHECK(queue.Push(1));
+	CHECK(queue.Push(2));
+	queue.Close();
+	CHECK(queue.IsClosed());
+	CHECK(!queue.Push(3));
+	int rejected{ 4 };
+	CHECK(!queue.TryPush(rejected));
+	CHECK(queue.Pop() == optional<int>{ 1 });
+	CHECK(queue.Pop() == optional<int>{ 2 });
+	CHECK(!queue.Pop());															//Закрыта и пуста - без ожидания
+}
+
+TEST_CASE("SpscQueue: blocked sides are released by the other side") {
+	SpscQueue<int> queue(1);
+	CHECK(queue.Push(1));
+	bool pushed{ false };
+	thread producer([&queue, &pushed] { pushed = queue.Push(2); });				//Ждёт освобождения ячейки
+	this_thread::sleep_for(chrono::milliseconds(20));
+	CHECK(queue.Pop() == optional<int>{ 1 });
+	producer.join();
+	CHECK(pushed);
+	CHECK(queue.Pop() == optional<int>{ 2 });
+
+	optional<int> popped{ 0 };
+	thread consumer([&queue, &popped] { popped = queue.Pop(); });				//Ждёт данных на пустой очереди
+	this_thread::sleep_for(chrono::milliseconds(20));
+	queue.Close();
+	consumer.join();
+	CHECK(!popped);
+}
+
+TEST_CASE("SpscQueue: every item arrives exactly once and in order") {
+	constexpr size_t ITEM_COUNT{ 100000 };
+	SpscQueue<size_t> queue(8);														//Маленькая ёмкость: обе стороны часто ждут
+	thread producer([&queue] {
+		for (size_t item = 0; item < ITEM_COUNT; ++item) {
+			queue.Push(item);
+		}
+		queue.Close();
+	});
+	size_t expected{ 0 };
+	bool in_order{ true };
+	while (auto item = queue.Pop()) {
+		in_order = in_order && *item == expected;
+		++expected;
+	}
+	producer.join();
+	CHECK(in_order);
+	CHECK(expected == ITEM_COUNT);
+	CHECK(!queue.TryPop());
+}
+
+int main() {
+	return test::RunTests();
+}
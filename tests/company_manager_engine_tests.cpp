@@ -0,0 +1,191 @@
+#include "test_common.h"
+#include "company_manager_engine.h"
+#include "autosave.h"
+#include "xml_wrapper_command.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+using namespace std;
+namespace fs = std::filesystem;
+using worker::file_operation::Result;
+
+namespace {
+	const char company_xml[]{
+		"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<departments>\n"
+		"   <department name=\"First\">\n"
+		"      <employments>\n"
+		"         <employment>\n"
+		"            <surname>Ivanov</surname>\n"
+		"            <name>Ivan</name>\n"
+		"            <middleName>Ivanovich</middleName>\n"
+		"            <function>Engineer</function>\n"
+		"            <salary>100</salary>\n"
+		"         </employment>\n"
+		"         <employment>\n"
+		"            <surname>Petrov</surname>\n"
+		"            <name>Petr</name>\n"
+		"            <middleName>Petrovich</middleName>\n"
+		"            <function>Manager</function>\n"
+		"            <salary>200</salary>\n"
+		"         </employment>\n"
+		"      </employments>\n"
+		"   </department>\n"
+		"</departments>\n"
+	};
+
+	const char shared_values_xml[]{												//Одинаковые должности и оклады
+		"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<departments>\n"
+		"   <department name=\"First\">\n"
+		"      <employments>\n"
+		"         <employment>\n"
+		"            <surname>Ivanov</surname>\n"
+		"            <name>Ivan</name>\n"
+		"            <middleName>Ivanovich</middleName>\n"
+		"            <function>Leading engineer of the platform department</function>\n"
+		"            <salary>100</salary>\n"
+		"         </employment>\n"
+		"         <employment>\n"
+		"            <surname>Petrov</surname>\n"
+		"            <name>Petr</name>\n"
+		"            <middleName>Petrovich</middleName>\n"
+		"            <function>Leading engineer of the platform department</function>\n"
+		"            <salary>100</salary>\n"
+		"         </employment>\n"
+		"      </employments>\n"
+		"   </department>\n"
+		"</departments>\n"
+	};
+
+	class TempFile {
+	public:
+		TempFile(const string& name, string_view content)
+			: m_path(fs::temp_directory_path() / name)
+		{
+			ofstream(m_path, ios::binary) << content;
+		}
+		~TempFile() {
+			error_code ec;
+			fs::remove(m_path, ec);
+		}
+
+		string Path() const {
+			return m_path.string();
+		}
+	private:
+		fs::path m_path;
+	};
+
+	bool finds_staff(const CompanyManager& cm) {
+		const auto* index{ cm.GetSearchIndex() };
+		return index
+			&& index->Size() == 2
+			&& index->FindByPrefix(search::Field::Surname, "petr").size() == 1;
+	}
+}
+
+TEST_CASE("CompanyManager: failed load keeps the previous document searchable") {
+	TempFile document("company_manager_engine_tests.xml", company_xml);
+	TempFile broken("company_manager_engine_tests_broken.xml", "<departments><department name=\"First\">");
+	CompanyManager cm;
+	cm.EnableSearchIndex();
+	cm.SetPath(document.Path());
+	CHECK(cm.Load() == Result::Success);
+	CHECK(finds_staff(cm));
+
+	cm.SetPath((fs::temp_directory_path() / "company_manager_engine_tests_missing.xml").string());
+	CHECK(cm.Load() != Result::Success);											//Ошибка ввода-вывода
+	CHECK(cm.IsLoaded());
+	CHECK(cm.Read().Containts("First"));
+	CHECK(finds_staff(cm));
+
+	cm.SetPath(broken.Path());
+	bool loaded{ false };
+	try {
+		loaded = cm.Load() == Result::Success;									//Ошибка разбора
+	}
+	catch (const exception&) {
+	}
+	CHECK(!loaded);
+	CHECK(cm.IsLoaded());
+	CHECK(finds_staff(cm));
+
+	cm.SetPath(document.Path());
+	CHECK(cm.Load() == Result::Success);											//Индекс перестроен по новому документу
+	CHECK(finds_staff(cm));
+}
+
+TEST_CASE("Autosaver: failed write keeps the previous recovery copy") {
+	TempFile document("autosave_tests.xml", company_xml);
+	TempFile moved("autosave_tests_moved.xml", company_xml);
+	CompanyManager cm;
+	cm.SetPath(document.Path());
+	CHECK(cm.Load() == Result::Success);
+	Autosaver autosaver(cm);
+	string first_recovery{ autosaver.GetRecoveryPath() };
+	autosaver.Flush();
+	autosaver.Wait();
+	CHECK(fs::exists(first_recovery));
+
+	cm.SetPath((fs::temp_directory_path() / "autosave_tests_missing_dir" / "document.xml").string());
+	autosaver.Flush();																//Каталога нет - запись не удаётся
+	autosaver.Wait();
+	CHECK(autosaver.GetStatistics().failed == 1);
+	CHECK(fs::exists(first_recovery));
+
+	cm.SetPath(moved.Path());
+	string moved_recovery{ autosaver.GetRecoveryPath() };
+	autosaver.Flush();
+	autosaver.Wait();
+	CHECK(fs::exists(moved_recovery));
+	CHECK(!fs::exists(first_recovery));											//Удалена после успешной записи новой копии
+
+	autosaver.DiscardRecovery().Wait();
+	CHECK(!fs::exists(moved_recovery));
+}
+
+TEST_CASE("CompanyManager: editing a shared value keeps other employees and undo restores sharing") {
+	using namespace command::xml_wrapper;
+	using Field = wrapper::Employee::Field;
+	TempFile document("company_manager_engine_tests_shared.xml", shared_values_xml);
+	CompanyManager cm;
+	cm.ShareValues(Field::Function).ShareValues(Field::Salary);
+	cm.SetPath(document.Path());
+	CHECK(cm.Load() == Result::Success);
+
+	auto& department{ cm.Modify().at("First") };
+	const wrapper::Employee* ivanov{ nullptr };
+	const wrapper::Employee* petrov{ nullptr };
+	for (const auto& [full_name, employee] : department.GetEmployees()) {
+		(employee.GetSurname().get() == "Ivanov" ? ivanov : petrov) = addressof(employee);
+	}
+	const string* shared_function{ addressof(petrov->GetFunction().get()) };
+	const string function{ *shared_function };
+	CHECK(addressof(ivanov->GetFunction().get()) == shared_function);
+	const auto& strings{ cm.Read().GetAllocator()->GetStrings() };
+	size_t pool_size{ strings.Size() },
+		references{ strings.References() };
+
+	EmployeePersonalFile personal_file{ department.GetName(), ivanov->GetFullName() };
+	auto change_function{ ChangeEmployeeFunction::make_instance(cm, personal_file, "Architect") };
+	auto update_salary{ UpdateEmployeeSalary::make_instance(cm, personal_file, 150) };
+	change_function->Execute();
+	update_salary->Execute();
+	CHECK(ivanov->GetFunction().get() == "Architect");
+	CHECK(ivanov->GetSalary() == 150);
+	CHECK(addressof(petrov->GetFunction().get()) == shared_function);				//Остальные сотрудники видят прежнее значение пула
+	CHECK(petrov->GetFunction().get() == function);
+	CHECK(petrov->GetSalary() == 100);
+
+	update_salary->Cancel();
+	change_function->Cancel();
+	CHECK(addressof(ivanov->GetFunction().get()) == shared_function);				//Отмена возвращает ссылку на значение пула, а не копию
+	CHECK(ivanov->GetSalary() == 100);
+	CHECK(strings.Size() == pool_size);											//Значения правки освобождены, оклад снова разделяется
+	CHECK(strings.References() == references);
+}
+
+int main() {
+	return test::RunTests();
+}
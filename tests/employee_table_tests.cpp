@@ -0,0 +1,39 @@
+#include "test_common.h"
+#include "employee_table.h"
+#include <sstream>
+using namespace std;
+
+TEST_CASE("table::Reader: quote inside unquoted field is a literal character") {
+	istringstream input(
+		"department,surname,name,middleName,function,salary\n"
+		"Dev,O\"Brien,Pat,,Engineer,100\n"
+		"Dev,Smith,Jo\"\"hn,,\"Lead, \"\"QA\"\"\",200\n"
+	);
+	auto records{ table::Reader(input).ReadAll() };
+	CHECK(records.size() == 2);
+	if (records.size() == 2) {
+		CHECK(records[0].personal_data.surname == "O\"Brien");
+		CHECK(records[0].personal_data.salary == 100);
+		CHECK(records[1].personal_data.name == "Jo\"\"hn");
+		CHECK(records[1].personal_data.function == "Lead, \"QA\"");
+	}
+}
+
+TEST_CASE("table::Reader: quote inside salary is reported with line number") {
+	istringstream input(
+		"department,surname,name,middleName,function,salary\n"
+		"Dev,Doe,John,,Engineer,1\"0"
+	);
+	string message;
+	try {
+		table::Reader(input).ReadAll();
+	}
+	catch (const table::format_error& exc) {
+		message = exc.what();
+	}
+	CHECK(message.find("Line 2") != string::npos);
+}
+
+int main() {
+	return test::RunTests();
+}
@@ -0,0 +1,304 @@
+#include "test_common.h"
+#include "company_manager_engine.h"
+#include "xml_wrapper_command.h"
+#include "xml_wrappers_builders.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+using namespace std;
+namespace fs = std::filesystem;
+using worker::file_operation::Result;
+using search::Field;
+
+namespace {
+	const char company_xml[]{
+		"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<departments>\n"
+		"   <department name=\"First\">\n"
+		"      <employments>\n"
+		"         <employment>\n"
+		"            <surname>Ivanov</surname>\n"
+		"            <name>Ivan</name>\n"
+		"            <middleName>Ivanovich</middleName>\n"
+		"            <function>Engineer</function>\n"
+		"            <salary>100</salary>\n"
+		"         </employment>\n"
+		"         <employment>\n"
+		"            <surname>Petrov</surname>\n"
+		"            <name>Petr</name>\n"
+		"            <middleName>Petrovich</middleName>\n"
+		"            <function>Manager</function>\n"
+		"            <salary>200</salary>\n"
+		"         </employment>\n"
+		"      </employments>\n"
+		"   </department>\n"
+		"   <department name=\"Second\">\n"
+		"      <employments>\n"
+		"         <employment>\n"
+		"            <surname>Sidorov</surname>\n"
+		"            <name>Sidor</name>\n"
+		"            <middleName>Sidorovich</middleName>\n"
+		"            <function>Engineer</function>\n"
+		"            <salary>300</salary>\n"
+		"         </employment>\n"
+		"         <employment>\n"
+		"            <surname>Ivanchenko</surname>\n"
+		"            <name>Ivan</name>\n"
+		"            <middleName>Petrovich</middleName>\n"
+		"            <function>Tester</function>\n"
+		"            <salary>150</salary>\n"
+		"         </employment>\n"
+		"      </employments>\n"
+		"   </department>\n"
+		"</departments>\n"
+	};
+
+	string make_large_company_xml(size_t employee_count) {						//Один отдел, зарплата равна номеру сотрудника
+		string xml{
+			"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+			"<departments>\n"
+			"   <department name=\"Staff\">\n"
+			"      <employments>\n"
+		};
+		for (size_t idx = 0; idx < employee_count; ++idx) {
+			xml += "         <employment>\n"
+				"            <surname>Employee" + to_string(idx) + "</surname>\n"
+				"            <name>Name</name>\n"
+				"            <middleName>Middle</middleName>\n"
+				"            <function>Worker</function>\n"
+				"            <salary>" + to_string(idx) + "</salary>\n"
+				"         </employment>\n";
+		}
+		xml += "      </employments>\n"
+			"   </department>\n"
+			"</departments>\n";
+		return xml;
+	}
+
+	class TempFile {
+	public:
+		TempFile(const string& name, string_view content)
+			: m_path(fs::temp_directory_path() / name)
+		{
+			ofstream(m_path, ios::binary) << content;
+		}
+		~TempFile() {
+			error_code ec;
+			fs::remove(m_path, ec);
+		}
+
+		string Path() const {
+			return m_path.string();
+		}
+	private:
+		fs::path m_path;
+	};
+
+	struct IndexedCompany {
+		IndexedCompany(const string& name, string_view content)
+			: file(name, content)
+		{
+			cm.EnableSearchIndex();
+			cm.SetPath(file.Path());
+			loaded = cm.Load() == Result::Success;
+		}
+
+		const search::EmployeeIndex& Index() const {
+			return *cm.GetSearchIndex();
+		}
+		wrapper::Department& Department(const string& name) {
+			return cm.Modify().at(name);
+		}
+		const wrapper::Employee* Find(const string& department, const string& surname) {	//Первый сотрудник отдела с такой фамилией
+			for (const auto& [full_name, employee] : Department(department).GetEmployees()) {
+				if (employee.GetSurname().get() == surname) {
+					return addressof(employee);
+				}
+			}
+			return nullptr;
+		}
+
+		TempFile file;
+		CompanyManager cm;
+		bool loaded{ false };
+	};
+
+	vector<string> surnames(const search::match_list& matches) {
+		vector<string> result;
+		for (const auto& match : matches) {
+			result.push_back(match.employee->GetSurname().get());
+		}
+		return result;
+	}
+
+	wrapper::Employee make_employee(const CompanyManager& cm, const string& surname, size_t salary) {
+		return wrapper::EmployeeBuilder()
+			.SetAllocator(cm.Read().GetAllocator())
+			.SetSurname(surname)
+			.SetName("Kuzma")
+			.SetMiddleName("Kuzmich")
+			.SetFunction("Designer")
+			.SetSalary(salary)
+			.Assemble();
+	}
+}
+
+TEST_CASE("EmployeeIndex: prefix search is case-insensitive, ordered and limited") {
+	IndexedCompany company("search_index_tests_prefix.xml", company_xml);
+	CHECK(company.loaded);
+	const auto& index{ company.Index() };
+	CHECK(index.Size() == 4);
+	CHECK(surnames(index.FindByPrefix(Field::Surname, "IVAN")) == vector<string>{ "Ivanchenko", "Ivanov" });
+	CHECK(surnames(index.FindByPrefix(Field::Surname, "ivan", 1)) == vector<string>{ "Ivanchenko" });
+	CHECK(index.FindByPrefix(Field::Surname, "ivanovo").empty());
+	CHECK(index.FindByPrefix(Field::Function, "eng").size() == 2);
+	CHECK(index.FindByPrefix(Field::MiddleName, "Petrovich").size() == 2);
+
+	auto matches{ index.FindByPrefix(Field::Surname, "sid") };
+	CHECK(matches.size() == 1);
+	CHECK(matches.front().department == addressof(company.Department("Second")));
+	CHECK(matches.front().employee == company.Find("Second", "Sidorov"));
+}
+
+TEST_CASE("EmployeeIndex: fuzzy search tolerates a typo") {
+	IndexedCompany company("search_index_tests_fuzzy.xml", company_xml);
+	CHECK(company.loaded);
+	const auto& index{ company.Index() };
+
+	auto matches{ index.FindFuzzy(Field::Surname, "Petrav") };				//Замена символа
+	CHECK(surnames(matches) == vector<string>{ "Petrov" });
+	CHECK(matches.front().distance == 1);
+	CHECK(surnames(index.FindFuzzy(Field::Surname, "Sidorv")) == vector<string>{ "Sidorov" });	//Пропуск символа
+	CHECK(index.FindFuzzy(Field::Surname, "Pitrav").empty());					//Две правки при max_distance = 1
+
+	matches = index.FindFuzzy(Field::Surname, "Ivanov");						//Сначала точное совпадение
+	CHECK(!matches.empty());
+	CHECK(matches.front().employee == company.Find("First", "Ivanov"));
+	CHECK(matches.front().distance == 0);
+}
+
+TEST_CASE("EmployeeIndex: salary range is inclusive and ascending") {
+	IndexedCompany company("search_index_tests_salary.xml", company_xml);
+	CHECK(company.loaded);
+	const auto& index{ company.Index() };
+	CHECK(surnames(index.FindBySalary(150, 200)) == vector<string>{ "Ivanchenko", "Petrov" });
+	CHECK(surnames(index.FindBySalary(0, 1000, 2)) == vector<string>{ "Ivanov", "Ivanchenko" });
+	CHECK(index.FindBySalary(201, 299).empty());
+	CHECK(index.FindBySalary(300, 100).empty());
+}
+
+TEST_CASE("EmployeeIndex: InsertEmployee command indexes the employee until cancelled") {
+	IndexedCompany company("search_index_tests_insert.xml", company_xml);
+	CHECK(company.loaded);
+	auto& cm{ company.cm };
+	const auto& index{ company.Index() };
+
+	auto insert{
+		command::xml_wrapper::InsertEmployee::make_instance(
+			cm, company.Department("First").GetName(), make_employee(cm, "Kuznetsov", 250)
+		)
+	};
+	insert->Execute();
+	CHECK(index.Size() == 5);
+	auto matches{ index.FindByPrefix(Field::Surname, "kuz") };
+	CHECK(matches.size() == 1);
+	CHECK(matches.front().department == addressof(company.Department("First")));
+	CHECK(matches.front().employee == company.Find("First", "Kuznetsov"));
+	CHECK(surnames(index.FindBySalary(250, 250)) == vector<string>{ "Kuznetsov" });
+	CHECK(surnames(index.FindFuzzy(Field::Function, "Desiner")) == vector<string>{ "Kuznetsov" });
+
+	insert->Cancel();
+	CHECK(index.Size() == 4);
+	CHECK(index.FindByPrefix(Field::Surname, "kuz").empty());
+	CHECK(index.FindBySalary(250, 250).empty());
+}
+
+TEST_CASE("EmployeeIndex: rename through ModifyCommand replaces the indexed term") {
+	IndexedCompany company("search_index_tests_rename.xml", company_xml);
+	CHECK(company.loaded);
+	auto& cm{ company.cm };
+	const auto& index{ company.Index() };
+	const auto* petrov{ company.Find("First", "Petrov") };
+
+	auto rename{
+		command::xml_wrapper::ChangeEmployeeSurname::make_instance(
+			cm, { company.Department("First").GetName(), petrov->GetFullName() }, "Smirnov"
+		)
+	};
+	rename->Execute();
+	CHECK(index.Size() == 4);
+	CHECK(index.FindByPrefix(Field::Surname, "petr").empty());
+	auto matches{ index.FindByPrefix(Field::Surname, "smir") };
+	CHECK(matches.size() == 1);
+	CHECK(matches.front().employee == petrov);									//Узел сотрудника не перемещается
+	CHECK(surnames(index.FindFuzzy(Field::Surname, "Smirnof")) == vector<string>{ "Smirnov" });
+	CHECK(index.FindByPrefix(Field::Name, "petr").size() == 1);					//Прочие поля не затронуты
+	CHECK(index.FindBySalary(200, 200).size() == 1);
+
+	rename->Cancel();
+	CHECK(index.Size() == 4);
+	CHECK(index.FindByPrefix(Field::Surname, "smir").empty());
+	CHECK(index.FindFuzzy(Field::Surname, "Smirnof").empty());
+	CHECK(surnames(index.FindByPrefix(Field::Surname, "petr")) == vector<string>{ "Petrov" });
+}
+
+TEST_CASE("EmployeeIndex: removals past the compaction threshold keep queries exact") {
+	constexpr size_t EMPLOYEE_COUNT{ 1500 }, REMOVED_COUNT{ 1200 };			//Пересборка при 1024 удалённых записях
+	IndexedCompany company("search_index_tests_compaction.xml", make_large_company_xml(EMPLOYEE_COUNT));
+	CHECK(company.loaded);
+	auto& cm{ company.cm };
+	const auto& index{ company.Index() };
+	CHECK(index.Size() == EMPLOYEE_COUNT);
+
+	auto& department{ company.Department("Staff") };
+	vector<wrapper::FullNameRef> removed;
+	for (const auto& [full_name, employee] : department.GetEmployees()) {
+		if (employee.GetSalary() < REMOVED_COUNT) {
+			removed.push_back(full_name);
+		}
+	}
+	CHECK(removed.size() == REMOVED_COUNT);
+	vector<command::command_holder<CompanyManager>> commands;					//Извлечённые сотрудники живут в командах
+	for (const auto& full_name : removed) {
+		commands.push_back(
+			command::xml_wrapper::RemoveEmployee::make_instance(cm, { department.GetName(), full_name })
+		);
+		commands.back()->Execute();
+	}
+	CHECK(index.Size() == EMPLOYEE_COUNT - REMOVED_COUNT);
+
+	auto by_salary{ index.FindBySalary(0, EMPLOYEE_COUNT, EMPLOYEE_COUNT) };
+	CHECK(by_salary.size() == EMPLOYEE_COUNT - REMOVED_COUNT);
+	bool consistent{ true };
+	for (size_t idx = 0; idx < by_salary.size(); ++idx) {
+		const auto& match{ by_salary[idx] };
+		consistent = consistent
+			&& match.department == addressof(department)
+			&& match.employee->GetSalary() == REMOVED_COUNT + idx
+			&& department.Containts(match.employee->GetFullName());
+	}
+	CHECK(consistent);
+	CHECK(index.FindByPrefix(Field::Surname, "employee", EMPLOYEE_COUNT).size() == EMPLOYEE_COUNT - REMOVED_COUNT);
+	CHECK(index.FindByPrefix(Field::Surname, "Employee10").empty());			//Employee10, Employee100..109 и Employee1000..1099 удалены
+	CHECK(surnames(index.FindByPrefix(Field::Surname, "Employee1499")) == vector<string>{ "Employee1499" });
+	CHECK(index.FindBySalary(0, REMOVED_COUNT - 1).empty());
+
+	auto fuzzy{ index.FindFuzzy(Field::Surname, "Employee130") };				//Сам терм удалён, Employee1300..1309 и т.п. - нет
+	bool only_alive{ !fuzzy.empty() };
+	for (const auto& match : fuzzy) {
+		only_alive = only_alive && match.distance == 1 && match.employee->GetSalary() >= REMOVED_COUNT;
+	}
+	CHECK(only_alive);
+
+	commands.back()->Cancel();													//Возврат после пересборки
+	CHECK(index.Size() == EMPLOYEE_COUNT - REMOVED_COUNT + 1);
+	const auto& restored_employee{ department.at(removed.back()) };
+	auto restored{ index.FindBySalary(restored_employee.GetSalary(), restored_employee.GetSalary()) };
+	CHECK(restored.size() == 1);
+	CHECK(restored.front().employee == addressof(restored_employee));
+}
+
+int main() {
+	return test::RunTests();
+}
@@ -0,0 +1,316 @@
+#include "test_common.h"
+#include "task_manager.h"
+#include "mpsc_queue.h"
+#include <vector>
+#include <limits>
+#include <type_traits>
+#include <thread>
+#include <memory>
+#include <cstdint>
+#include <chrono>
+#include <sstream>
+using namespace std;
+
+namespace {
+	struct Data {																	//Цель ведущего: дерево данных
+		vector<int> values;
+	};
+	struct View {																	//Цель ведомого: отображение
+		vector<int> values;
+	};
+
+	template <class TargetTy>
+	class Append : public command::AllocatedCommand<Append<TargetTy>, TargetTy> {
+	public:
+		using MyBase = command::AllocatedCommand<Append<TargetTy>, TargetTy>;
+		using typename MyBase::result_type;
+		using typename MyBase::command_holder;
+	public:
+		Append(TargetTy& target, int value, size_t retained, command::Type type) noexcept
+			: MyBase(target), m_value(value), m_retained(retained), m_type(type)
+		{
+		}
+
+		static command_holder make_instance(TargetTy& target, int value, size_t retained = 0, command::Type type = default_type()) {
+			return MyBase::allocate_instance(target, value, retained, type);
+		}
+
+		result_type Execute() override {
+			this->get_target().values.push_back(m_value);
+			return result_type{};
+		}
+		result_type Cancel() override {
+			this->get_target().values.pop_back();
+			return result_type{};
+		}
+		command::Type GetType() const noexcept override {
+			return m_type;
+		}
+		size_t RetainedMemory() const noexcept override {
+			return m_retained;
+		}
+	private:
+		static constexpr command::Type default_type() noexcept {
+			return std::is_same_v<TargetTy, Data> ? command::Type::Xml_AddDepartment : command::Type::View_InsertDepartment;
+		}
+	private:
+		int m_value;
+		size_t m_retained;
+		command::Type m_type;
+	};
+
+	struct PairedManagers {
+		PairedManagers(size_t capacity, size_t memory_budget)
+			: xml(capacity, memory_budget), view(capacity, memory_budget)
+		{
+			xml.PairWith(view);
+		}
+
+		void Process(int value, size_t retained = 0) {								//Как и в CompanyManagerUI: правка данных, затем отображения
+			xml.Process(Append<Data>::make_instance(data, value, retained), task::Pairing::Paired);
+			view.Process(Append<View>::make_instance(shown, value, retained));
+		}
+
+		void Edit(int value) {														//Правка без команды отображения (как должность и оклад)
+			xml.Process(Append<Data>::make_instance(data, -value, 0, command::Type::Xml_UpdateEmployeeSalary));
+		}
+
+		bool InSync() const {														//Отображение содержит ровно парные правки данных
+			vector<int> paired;
+			for (int value : data.values) {
+				if (value >= 0) {
+					paired.push_back(value);
+				}
+			}
+			return paired == shown.values;
+		}
+
+		bool UndoAll() {
+			bool in_sync{ true };
+			while (xml.CanBeCanceled()) {
+				bool paired{ xml.IsLastProcessedPaired() };
+				xml.Cancel();
+				if (paired) {
+					view.Cancel();
+				}
+				in_sync = in_sync && InSync();
+			}
+			return in_sync && !view.CanBeCanceled();
+		}
+
+		bool RedoAll() {
+			bool in_sync{ true };
+			while (xml.CanBeRepeated()) {
+				bool paired{ xml.IsLastCanceledPaired() };
+				xml.Repeat();
+				if (paired) {
+					view.Repeat();
+				}
+				in_sync = in_sync && InSync();
+			}
+			return in_sync && !view.CanBeRepeated();
+		}
+
+		Data data;
+		View shown;
+		TaskManager<Data> xml;
+		TaskManager<View> view;
+	};
+}
+
+TEST_CASE("RingBuffer: grows on demand and keeps order after wrapping") {
+	RingBuffer<int> buffer(10);
+	for (int value = 0; value < 25; ++value) {
+		buffer.push_back(int{ value });
+	}
+	CHECK(buffer.size() == 10);
+	CHECK(buffer.front() == 15);
+	CHECK(buffer.back() == 24);
+	for (size_t idx = 0; idx < buffer.size(); ++idx) {
+		CHECK(buffer[idx] == static_cast<int>(15 + idx));
+	}
+}
+
+TEST_CASE("TaskManager: capacity eviction removes partner records together") {
+	PairedManagers managers(3, numeric_limits<size_t>::max());
+	managers.Process(1);
+	managers.Process(2);
+	managers.xml.Process(Append<Data>::make_instance(managers.data, -3, 0, command::Type::Batch));	//Пакет без парной команды
+	managers.Process(4);
+	CHECK(managers.xml.CanBeCanceled() == 3);
+	CHECK(managers.view.CanBeCanceled() == 2);
+	CHECK(managers.UndoAll());
+	CHECK(managers.data.values == vector<int>{ 1 });
+	CHECK(managers.shown.values == vector<int>{ 1 });
+}
+
+TEST_CASE("TaskManager: unpaired edits evict nothing from the follower") {
+	PairedManagers managers(3, numeric_limits<size_t>::max());
+	managers.Process(1);
+	managers.Edit(1);
+	managers.Process(2);
+	managers.Edit(2);
+	managers.Edit(3);
+	managers.Process(3);															//Вытеснены 1, -1 и 2: у ведомого остаётся лишь пара записи 3
+	CHECK(managers.xml.CanBeCanceled() == 3);
+	CHECK(managers.view.CanBeCanceled() == 1);
+	CHECK(managers.InSync());
+	CHECK(managers.UndoAll());
+	CHECK(managers.data.values == vector<int>{ 1, -1, 2 });
+	CHECK(managers.shown.values == vector<int>{ 1, 2 });
+	CHECK(managers.RedoAll());
+	CHECK(managers.data.values == vector<int>{ 1, -1, 2, -2, -3, 3 });
+
+	managers.Edit(4);																//Очередь повтора пуста: вытесняется -2
+	CHECK(managers.UndoAll());
+	CHECK(managers.shown.values == vector<int>{ 1, 2 });
+}
+
+TEST_CASE("TaskManager: memory budget covers both paired managers") {
+	PairedManagers managers(100, 100);
+	for (int value = 0; value < 5; ++value) {
+		managers.Process(value, 30);
+		CHECK(managers.xml.GetRetainedMemory() + managers.view.GetRetainedMemory() <= 100
+			|| managers.xml.CanBeCanceled() == 1);
+		CHECK(managers.xml.CanBeCanceled() == managers.view.CanBeCanceled());
+	}
+	CHECK(managers.xml.CanBeCanceled() == 1);
+	CHECK(managers.UndoAll());
+	CHECK(managers.data.values == managers.shown.values);
+}
+
+TEST_CASE("TaskManager: repeat queue eviction stays paired") {
+	PairedManagers managers(2, numeric_limits<size_t>::max());
+	for (int value = 0; value < 2; ++value) {
+		managers.Process(value);
+	}
+	managers.xml.Cancel();
+	managers.view.Cancel();
+	managers.xml.Cancel();
+	managers.view.Cancel();
+	managers.Process(10);
+	managers.Process(11);															//Очередь повтора не сбрасывается: вытеснение - по ёмкости очереди отмены
+	CHECK(managers.xml.CanBeRepeated() == managers.view.CanBeRepeated());
+	CHECK(managers.xml.CanBeCanceled() == managers.view.CanBeCanceled());
+}
+
+TEST_CASE("TaskManager: batch and transaction are one undo unit") {
+	Data data;
+	TaskManager<Data> manager(8);
+	TaskManager<Data>::task_list commands;
+	for (int value = 1; value <= 3; ++value) {
+		commands.push_back(Append<Data>::make_instance(data, value));
+	}
+	CHECK(manager.ProcessBatch(data, std::move(commands)).type == task::ResultType::Success);
+	CHECK(manager.CanBeCanceled() == 1);
+	CHECK(manager.GetLastProcessedPurpose() == command::Purpose::Batch);
+	manager.Cancel();
+	CHECK(data.values.empty());
+	manager.Repeat();
+	CHECK(data.values == vector<int>{ 1, 2, 3 });
+
+	manager.BeginTransaction(data);
+	manager.Process(Append<Data>::make_instance(data, 4));
+	manager.Process(Append<Data>::make_instance(data, 5));
+	CHECK(data.values.size() == 5);												//Команды транзакции выполняются сразу
+	CHECK(manager.CommitTransaction().type == task::ResultType::Success);
+	CHECK(manager.CanBeCanceled() == 2);
+	manager.Cancel();
+	CHECK(data.values == vector<int>{ 1, 2, 3 });
+
+	manager.BeginTransaction(data);
+	manager.Process(Append<Data>::make_instance(data, 6));
+	CHECK(manager.RollbackTransaction().type == task::ResultType::Success);
+	CHECK(data.values == vector<int>{ 1, 2, 3 });
+	CHECK(manager.CanBeCanceled() == 1);
+}
+
+TEST_CASE("MpscQueue: empty edges and FIFO order of a single producer") {
+	MpscQueue<int> queue;
+	CHECK(queue.Empty());
+	CHECK(!queue.TryPop());
+	for (int value = 0; value < 3; ++value) {
+		queue.Push(value);
+	}
+	CHECK(!queue.Empty());
+	for (int value = 0; value < 3; ++value) {
+		CHECK(queue.TryPop() == optional<int>{ value });
+	}
+	CHECK(queue.Empty());															//Опустошённая очередь снова принимает элементы
+	CHECK(!queue.TryPop());
+	queue.Push(3);
+	CHECK(queue.TryPop() == optional<int>{ 3 });
+	CHECK(!queue.TryPop());
+}
+
+TEST_CASE("MpscQueue: items of every producer arrive exactly once and in order") {
+	constexpr size_t PRODUCER_COUNT{ 4 };
+	constexpr uint32_t ITEM_COUNT{ 20000 };
+	MpscQueue<uint64_t> queue;
+	vector<thread> producers;
+	for (size_t producer = 0; producer < PRODUCER_COUNT; ++producer) {
+		producers.emplace_back([&queue, producer] {
+			for (uint32_t seq = 0; seq < ITEM_COUNT; ++seq) {
+				queue.Push(static_cast<uint64_t>(producer) << 32 | seq);				//Производитель и номер элемента
+			}
+		});
+	}
+	vector<uint32_t> expected(PRODUCER_COUNT, 0);
+	size_t received{ 0 };
+	bool in_order{ true };
+	while (received < PRODUCER_COUNT * ITEM_COUNT) {
+		auto item{ queue.TryPop() };
+		if (!item) {
+			this_thread::yield();													//Элемент мог быть ещё не связан производителем
+			continue;
+		}
+		auto producer{ static_cast<size_t>(*item >> 32) };
+		auto seq{ static_cast<uint32_t>(*item) };
+		in_order = in_order && producer < PRODUCER_COUNT && seq == expected[producer];
+		if (producer < PRODUCER_COUNT) {
+			expected[producer] = seq + 1;
+		}
+		++received;
+	}
+	for (auto& producer : producers) {
+		producer.join();
+	}
+	CHECK(in_order);
+	CHECK(expected == vector<uint32_t>(PRODUCER_COUNT, ITEM_COUNT));
+	CHECK(queue.Empty());															//Лишних элементов нет
+	CHECK(!queue.TryPop());
+}
+
+TEST_CASE("MpscQueue: unpopped items are destroyed with the queue") {
+	auto item{ make_shared<int>(1) };
+	weak_ptr<int> observer{ item };
+	{
+		MpscQueue<shared_ptr<int>> queue;
+		queue.Push(make_shared<int>(2));
+		queue.Push(move(item));
+		CHECK(queue.TryPop().value_or(nullptr) != nullptr);						//Извлечённый элемент уничтожается сразу
+		CHECK(!observer.expired());
+	}
+	CHECK(observer.expired());
+}
+
+TEST_CASE("Metrics: writers leave the caller's stream format unchanged") {
+	task::Metrics metrics;
+	metrics.RecordExecute(command::Type::Xml_UpdateEmployeeSalary, chrono::microseconds(1500), true);
+	metrics.RecordCancel(command::Type::Xml_UpdateEmployeeSalary, chrono::microseconds(250), false);
+	for (bool json : { false, true }) {
+		ostringstream out;
+		out.precision(2);
+		json ? metrics.WriteJson(out) : metrics.WriteText(out, "");
+		CHECK(out.str().find(json ? "\"p50_us\":" : "p50 ") != string::npos);
+		CHECK(out.precision() == 2);
+		CHECK(!(out.flags() & ios::fixed));
+		out.str({});
+		out << 1.25;
+		CHECK(out.str() == "1.2");
+	}
+}
+
+int main() {
+	return test::RunTests();
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <iostream>
+#include <functional>
+#include <exception>
+#include <vector>
+#include <utility>
+
+/***********************************************************
+Минимальная обвязка регрессионных тестов без внешних
+зависимостей: TEST_CASE регистрирует функцию, CHECK
+отмечает провал и продолжает выполнение, RunTests()
+возвращает код завершения для ctest
+************************************************************/
+
+namespace test {
+	using case_list = std::vector<std::pair<const char*, std::function<void()>>>;
+
+	inline case_list& Cases() {
+		static case_list cases;
+		return cases;
+	}
+
+	inline size_t& Failures() {
+		static size_t failures{ 0 };
+		return failures;
+	}
+
+	struct Registrar {
+		Registrar(const char* name, std::function<void()> body) {
+			Cases().emplace_back(name, std::move(body));
+		}
+	};
+
+	inline int RunTests() {
+		for (const auto& [name, body] : Cases()) {
+			size_t failures_before{ Failures() };
+			try {
+				body();
+			}
+			catch (const std::exception& exc) {
+				std::cerr << name << ": unexpected exception: " << exc.what() << '\n';
+				++Failures();
+			}
+			std::cout << (Failures() == failures_before ? "[ OK ] " : "[FAIL] ") << name << '\n';
+		}
+		return Failures() ? 1 : 0;
+	}
+}
+
+#define TEST_CONCAT_IMPL(left, right) left##right
+#define TEST_CONCAT(left, right) TEST_CONCAT_IMPL(left, right)
+
+#define TEST_CASE(name)																\
+	static void TEST_CONCAT(test_case_, __LINE__)();								\
+	static test::Registrar TEST_CONCAT(test_registrar_, __LINE__){ name, TEST_CONCAT(test_case_, __LINE__) };	\
+	static void TEST_CONCAT(test_case_, __LINE__)()
+
+#define CHECK(...)																	\
+	do {																			\
+		if (!(__VA_ARGS__)) {														\
+			std::cerr << __FILE__ << ':' << __LINE__ << ": CHECK(" #__VA_ARGS__ ") failed\n";	\
+			++test::Failures();														\
+		}																			\
+	} while (false)
@@ -0,0 +1,76 @@
+#include "test_common.h"
+#include "atom_table.h"
+#include "xml_node_builders.h"
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+using namespace std;
+
+namespace {
+	constexpr array<string_view, 2> first_vocabulary{ "surname", "name" };
+	constexpr array<string_view, 1> second_vocabulary{ "salary" };
+}
+
+TEST_CASE("AtomTable: vocabulary stays valid after other vocabularies are interned") {
+	xml::AtomTable atoms;
+	const auto& first{ atoms.InternVocabulary(first_vocabulary) };
+	vector<xml::atom_t> expected(first.begin(), first.end());
+	atoms.InternVocabulary(second_vocabulary);
+	static array<array<string_view, 1>, 64> extra_vocabularies{};			//Каждый массив - отдельный словарь
+	for (auto& vocabulary : extra_vocabularies) {
+		vocabulary[0] = "extra";
+		atoms.InternVocabulary(vocabulary);
+	}
+	CHECK(first == expected);
+	CHECK(addressof(atoms.InternVocabulary(first_vocabulary)) == addressof(first));
+	CHECK(atoms.Resolve(first[1]) == "name");
+}
+
+TEST_CASE("AtomTable: Find does not intern") {
+	xml::AtomTable atoms;
+	atoms.Intern("department");
+	CHECK(!atoms.Find("employments"));
+	CHECK(atoms.Size() == 1);
+	CHECK(atoms.Find("department") == optional<xml::atom_t>{ 0 });
+}
+
+TEST_CASE("StringPool: writing shared text copies it only into the written node") {
+	auto alloc{ xml::MakeDefaultAllocator() };
+	const auto& strings{ alloc->GetStrings() };
+	const string value{ "Leading engineer of the platform department" };		//Длиннее буфера SSO
+	auto make_field{
+		[&alloc, &value] {
+			auto node{ xml::NodeBuilder().SetAllocator(alloc).SetName("function").Assemble() };
+			node->ShareText(value);
+			return node;
+		}
+	};
+	auto first{ make_field() }, second{ make_field() };
+	CHECK(strings.Size() == 1);
+	CHECK(strings.References() == 2);
+	CHECK(first->IsSharedText() && second->IsSharedText());
+	CHECK(addressof(as_const(*first).AsText()) == addressof(as_const(*second).AsText()));
+
+	first->AsText() += " (acting)";													//Неконстантный доступ - копирование при записи
+	CHECK(!first->IsSharedText());
+	CHECK(second->IsSharedText());
+	CHECK(as_const(*second).AsText() == value);
+	CHECK(strings.References() == 1);
+
+	first->ShareText(value);														//Возврат прежнего значения - снова ссылка на строку пула
+	CHECK(first->IsSharedText());
+	CHECK(addressof(as_const(*first).AsText()) == addressof(as_const(*second).AsText()));
+	CHECK(strings.Size() == 1);
+	CHECK(strings.References() == 2);
+
+	first.reset();
+	second.reset();
+	CHECK(strings.Size() == 0);														//Строка удаляется с последней ссылкой
+	CHECK(strings.References() == 0);
+}
+
+int main() {
+	return test::RunTests();
+}
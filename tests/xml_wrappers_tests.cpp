@@ -0,0 +1,393 @@
+#include "test_common.h"
+#include "xml_parse.h"
+#include "xml_wrappers_builders.h"
+#include "xml_serialize.h"
+#include "schema_reader.h"
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+using namespace std;
+
+namespace {
+	const char company_xml[]{
+		"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<departments>\n"
+		"   <department name=\"First\">\n"
+		"      <employments>\n"
+		"         <employment>\n"
+		"            <surname>Ivanov</surname>\n"
+		"            <name>Ivan</name>\n"
+		"            <middleName>Ivanovich</middleName>\n"
+		"            <function>Engineer</function>\n"
+		"            <salary>100</salary>\n"
+		"         </employment>\n"
+		"      </employments>\n"
+		"   </department>\n"
+		"   <department name=\"Second\">\n"
+		"      <employments>\n"
+		"         <employment>\n"
+		"            <surname>Petrov</surname>\n"
+		"            <name>Petr</name>\n"
+		"            <middleName>Petrovich</middleName>\n"
+		"            <function>Manager</function>\n"
+		"            <salary>200</salary>\n"
+		"         </employment>\n"
+		"      </employments>\n"
+		"   </department>\n"
+		"   <department name=\"Third\">\n"
+		"      <employments>\n"
+		"      </employments>\n"
+		"   </department>\n"
+		"</departments>\n"
+	};
+
+	struct LoadedCompany {
+		LoadedCompany()
+			: document(load()), company(addressof(document.GetRoot()))
+		{
+		}
+
+		static xml::Document load() {
+			istringstream input(company_xml);
+			return xml::Reader(input).Load();
+		}
+
+		xml::Document document;
+		wrapper::Company company;
+	};
+
+	struct FullName {
+		wrapper::FullNameRef Ref() const {
+			return { cref(surname), cref(name), cref(middle_name) };
+		}
+
+		string surname, name, middle_name;
+	};
+
+	/*** Итог загрузки, сравнимый между SchemaReader и Reader + Company ***/
+	struct LoadOutcome {
+		string document;														//Сериализованный документ
+		string company;															//Подразделения и сотрудники в порядке обхода обёрток
+		string error;															//Текст исключения; прочие поля при этом пусты
+
+		bool operator==(const LoadOutcome& other) const {						//Тексты ошибок разбора у путей могут различаться
+			return tie(document, company) == tie(other.document, other.company)
+				&& error.empty() == other.error.empty();
+		}
+	};
+
+	string describe(const wrapper::Company& company) {
+		ostringstream output;
+		for (const auto& department : company.GetDepartments()) {
+			output << department.GetName().get() << ": " << department.EmployeeCount()
+				<< ", average " << department.AverageSalary() << '\n';
+			for (const auto& [full_name, employee] : department.GetEmployees()) {
+				output << "  " << employee.GetSurname().get() << ' ' << employee.GetName().get()
+					<< ' ' << employee.GetMiddleName().get() << ", " << employee.GetFunction().get()
+					<< ", " << employee.GetSalary() << '\n';
+			}
+		}
+		return output.str();
+	}
+
+	template <class Loader>														//loader() возвращает документ и компанию
+	LoadOutcome capture(Loader loader) {
+		try {
+			auto [document, company] { loader() };
+			ostringstream output;
+			xml::Writer(output).Save(document);
+			return { output.str(), describe(company), {} };
+		}
+		catch (const exception& ex) {
+			return { {}, {}, ex.what() };
+		}
+	}
+
+	LoadOutcome load_generic(const string& text) {
+		return capture([&text] {
+			istringstream input(text);
+			xml::Document document{ xml::Reader(input).Load() };
+			wrapper::Company company(addressof(document.GetRoot()));
+			return pair{ move(document), move(company) };
+		});
+	}
+
+	LoadOutcome load_schema(const string& text, size_t& fallback_nodes, bool share_values = false) {
+		return capture([&text, &fallback_nodes, share_values] {
+			istringstream input(text);
+			wrapper::SchemaReader reader(input);
+			if (share_values) {
+				reader.ShareValues(wrapper::Employee::Field::Function).ShareValues(wrapper::Employee::Field::Salary);
+			}
+			auto result{ reader.Load() };
+			fallback_nodes = reader.GetStatistics().fallback_nodes;
+			return pair{ move(result.document), move(result.company) };
+		});
+	}
+
+	bool loads_alike(const string& text, size_t expected_fallback_nodes = 0) {	//Выводит расхождение для отладки
+		auto generic{ load_generic(text) };
+		bool alike{ true };
+		for (bool share_values : { false, true }) {
+			size_t fallback_nodes{ 0 };
+			auto schema{ load_schema(text, fallback_nodes, share_values) };
+			if (!(schema == generic) || (generic.error.empty() && fallback_nodes != expected_fallback_nodes)) {
+				cerr << "Reader + Company:\n" << generic.document << generic.company << generic.error << '\n'
+					<< "SchemaReader (fallback nodes: " << fallback_nodes << "):\n"
+					<< schema.document << schema.company << schema.error << '\n';
+				alike = false;
+			}
+		}
+		return alike;
+	}
+
+	vector<string> surnames_of(const wrapper::Department& department) {			//В порядке обхода Workgroup
+		vector<string> surnames;
+		for (const auto& [full_name, employee] : department.GetEmployees()) {
+			surnames.push_back(full_name.surname.get());
+		}
+		return surnames;
+	}
+
+	wrapper::Employee make_employee(const FullName& full_name, const wrapper::Company& company) {
+		return wrapper::EmployeeBuilder()
+			.SetAllocator(company.GetAllocator())
+			.SetSurname(full_name.surname)
+			.SetName(full_name.name)
+			.SetMiddleName(full_name.middle_name)
+			.SetFunction("Tester")
+			.SetSalary(300)
+			.Assemble();
+	}
+}
+
+TEST_CASE("Company: directory survives rebuild after erasing a non-last department") {
+	LoadedCompany loaded;
+	auto& company{ loaded.company };
+	const FullName petrov{ "Petrov", "Petr", "Petrovich" };
+	CHECK(company.ContainsEmployee(petrov.Ref()));
+	company.EraseDepartment("First");
+	company.Synchronize();													//Оставшиеся подразделения перестраиваются
+	CHECK(company.ContainsEmployee(petrov.Ref()));
+	const auto& second{ company.at("Second") };
+	const auto* location{ company.FindEmployee(petrov.Ref(), second) };
+	CHECK(location && location->department == addressof(second));
+
+	const FullName sidorov{ "Sidorov", "Sidor", "Sidorovich" };				//Нанятые после пересборки сотрудники попадают в индекс
+	company.at("Third").InsertEmployee(make_employee(sidorov, company));
+	CHECK(company.ContainsEmployee(sidorov.Ref()));
+	company.Synchronize();
+	CHECK(company.ContainsEmployee(sidorov.Ref()));
+	CHECK(company.FindEmployee(sidorov.Ref(), company.at("Third")) != nullptr);
+}
+
+TEST_CASE("Company: directory survives rebuild after inserting a department in the middle") {
+	LoadedCompany loaded;
+	auto& company{ loaded.company };
+	company.InsertDepartment(
+		"Second",
+		wrapper::DepartmentBuilder()
+			.SetAllocator(company.GetAllocator())
+			.SetName("Inserted")
+			.Assemble()
+	);
+	company.Synchronize();
+	const FullName ivanov{ "Ivanov", "Ivan", "Ivanovich" },
+		petrov{ "Petrov", "Petr", "Petrovich" };
+	CHECK(company.ContainsEmployee(ivanov.Ref()));
+	CHECK(company.ContainsEmployee(petrov.Ref()));
+	const FullName sidorov{ "Sidorov", "Sidor", "Sidorovich" };
+	company.at("Inserted").InsertEmployee(make_employee(sidorov, company));
+	CHECK(company.ContainsEmployee(sidorov.Ref()));
+}
+
+TEST_CASE("Company: extracted department is detached from the directory") {
+	LoadedCompany loaded;
+	auto& company{ loaded.company };
+	auto extracted{ company.ExtractDepartment("First") };
+	company.Synchronize();
+	const FullName ivanov{ "Ivanov", "Ivan", "Ivanovich" };
+	CHECK(!company.ContainsEmployee(ivanov.Ref()));
+	CHECK(extracted.Containts(ivanov.Ref()));
+}
+
+TEST_CASE("Company: department lookup survives new attributes on the department node") {
+	LoadedCompany loaded;
+	auto& company{ loaded.company };
+	auto& first_node{ *loaded.document.GetRoot().AsContainer().front() };
+	for (size_t idx = 0; idx < 32; ++idx) {										//Вектор атрибутов узла перераспределяется
+		first_node["attribute" + to_string(idx)] = "value";
+	}
+	CHECK(company.Containts("First"));
+	CHECK(company.GetDepartmentPosition("First") == optional<size_t>{ 0 });
+	CHECK(company.RenameDepartment("First", "Renamed") == wrapper::RenameResult::Success);
+	CHECK(company.Containts("Renamed") && !company.Containts("First"));
+}
+
+TEST_CASE("SchemaReader: matches Reader + Company on a plain document") {
+	CHECK(loads_alike(company_xml));
+}
+
+TEST_CASE("SchemaReader: nodes outside the schema fall back to the generic parser") {
+	CHECK(loads_alike(
+		"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<departments>\n"
+		"   <department name=\"First\">\n"
+		"      <note>Moved from the old office</note>\n"
+		"      <employments>\n"
+		"         <employment>\n"
+		"            <surname>Ivanov</surname>\n"
+		"            <name>Ivan</name>\n"
+		"            <middleName>Ivanovich</middleName>\n"
+		"            <phone>1234</phone>\n"
+		"            <function>Engineer</function>\n"
+		"            <salary>100</salary>\n"
+		"         </employment>\n"
+		"         <contractor>\n"
+		"            <surname>Petrov</surname>\n"
+		"            <name>Petr</name>\n"
+		"            <middleName>Petrovich</middleName>\n"
+		"            <function>Manager</function>\n"
+		"            <salary>200</salary>\n"
+		"         </contractor>\n"
+		"      </employments>\n"
+		"   </department>\n"
+		"</departments>\n",
+		3
+	));
+}
+
+TEST_CASE("SchemaReader: only the first <employments> of a department is staff") {
+	CHECK(loads_alike(
+		"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<departments>\n"
+		"   <department name=\"First\">\n"
+		"      <employments>\n"
+		"         <employment>\n"
+		"            <surname>Ivanov</surname>\n"
+		"            <name>Ivan</name>\n"
+		"            <middleName>Ivanovich</middleName>\n"
+		"            <function>Engineer</function>\n"
+		"            <salary>100</salary>\n"
+		"         </employment>\n"
+		"      </employments>\n"
+		"      <employments>\n"
+		"         <employment>\n"
+		"            <surname>Petrov</surname>\n"
+		"            <name>Petr</name>\n"
+		"            <middleName>Petrovich</middleName>\n"
+		"            <function>Manager</function>\n"
+		"            <salary>200</salary>\n"
+		"         </employment>\n"
+		"      </employments>\n"
+		"   </department>\n"
+		"</departments>\n",
+		1
+	));
+}
+
+TEST_CASE("SchemaReader: a repeated field overrides the previous one") {
+	CHECK(loads_alike(
+		"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<departments>\n"
+		"   <department name=\"First\">\n"
+		"      <employments>\n"
+		"         <employment>\n"
+		"            <surname>Ivanov</surname>\n"
+		"            <name>Ivan</name>\n"
+		"            <middleName>Ivanovich</middleName>\n"
+		"            <function>Engineer</function>\n"
+		"            <salary>100</salary>\n"
+		"            <function>Architect</function>\n"
+		"            <salary>150</salary>\n"
+		"         </employment>\n"
+		"      </employments>\n"
+		"   </department>\n"
+		"</departments>\n"
+	));
+}
+
+TEST_CASE("SchemaReader: text bodies in place of containers behave like the generic path") {
+	const string text_department{
+		"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<departments>\n"
+		"   <department name=\"Closed\">Disbanded</department>\n"
+		"</departments>\n"
+	};
+	CHECK(!load_generic(text_department).error.empty());						//Подразделение без дочерних узлов отвергается
+	CHECK(loads_alike(text_department));
+	CHECK(loads_alike(
+		"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<departments>\n"
+		"   <department name=\"Vacant\">\n"
+		"      <employments>None</employments>\n"
+		"   </department>\n"
+		"</departments>\n"
+	));
+}
+
+TEST_CASE("SchemaReader: a malformed document fails like the generic path") {
+	const string truncated{ string(company_xml).substr(0, string_view(company_xml).find("</employment>")) };
+	CHECK(!load_generic(truncated).error.empty());
+	CHECK(loads_alike(truncated));
+}
+
+TEST_CASE("Workgroup: rename onto an existing full name is rejected and keeps the order") {
+	LoadedCompany loaded;
+	auto& company{ loaded.company };
+	auto& department{ company.at("Third") };
+	const FullName alekseev{ "Alekseev", "Ivan", "Ivanovich" },
+		borisov{ "Borisov", "Ivan", "Ivanovich" };
+	department.InsertEmployee(make_employee(alekseev, company));
+	department.InsertEmployee(make_employee(borisov, company));
+	const auto* employee{ addressof(department.at(alekseev.Ref())) };
+
+	CHECK(department.ChangeEmployeeSurname(alekseev.Ref(), "Borisov") == wrapper::RenameResult::IsDuplicate);
+	CHECK(department.ChangeEmployeeSurname(alekseev.Ref(), "Alekseev") == wrapper::RenameResult::NothingChanged);
+	CHECK(surnames_of(department) == vector<string>{ "Alekseev", "Borisov" });
+	CHECK(addressof(department.at(alekseev.Ref())) == employee);
+	CHECK(department.at(borisov.Ref()).GetSurname().get() == "Borisov");
+	CHECK(department.EmployeeCount() == 2);
+	CHECK(company.FindEmployee(alekseev.Ref(), department) != nullptr);
+}
+
+TEST_CASE("Workgroup: rename moves the employee to its new sort position") {
+	LoadedCompany loaded;
+	auto& company{ loaded.company };
+	auto& department{ company.at("Third") };
+	const FullName konstantinov{ "Konstantinov", "Ivan", "Ivanovich" },			//Общий 8-байтовый префикс фамилии
+		konstantinova{ "Konstantinova", "Anna", "Ivanovna" },
+		borisov{ "Borisov", "Boris", "Borisovich" },
+		vasiliev{ "Vasiliev", "Vasily", "Vasilievich" };
+	for (const auto* full_name : { &vasiliev, &konstantinova, &borisov, &konstantinov }) {
+		department.InsertEmployee(make_employee(*full_name, company));
+	}
+	CHECK(surnames_of(department) == vector<string>{ "Borisov", "Konstantinov", "Konstantinova", "Vasiliev" });
+	const auto* employee{ addressof(department.at(borisov.Ref())) };
+
+	CHECK(department.ChangeEmployeeSurname(borisov.Ref(), "Yakovlev") == wrapper::RenameResult::Success);	//Вперёд, в конец
+	CHECK(surnames_of(department) == vector<string>{ "Konstantinov", "Konstantinova", "Vasiliev", "Yakovlev" });
+	const FullName yakovlev{ "Yakovlev", "Boris", "Borisovich" };
+	CHECK(addressof(department.at(yakovlev.Ref())) == employee);				//Обёртка не перемещается
+	CHECK(!department.Containts(borisov.Ref()));
+
+	CHECK(department.ChangeEmployeeSurname(yakovlev.Ref(), "Konstantin") == wrapper::RenameResult::Success);	//Назад, перед тем же префиксом
+	CHECK(surnames_of(department) == vector<string>{ "Konstantin", "Konstantinov", "Konstantinova", "Vasiliev" });
+	const FullName konstantin{ "Konstantin", "Boris", "Borisovich" };
+	CHECK(addressof(department.at(konstantin.Ref())) == employee);
+
+	CHECK(department.ChangeEmployeeName(konstantinova.Ref(), "Alla") == wrapper::RenameResult::Success);	//Позиция не меняется
+	CHECK(surnames_of(department) == vector<string>{ "Konstantin", "Konstantinov", "Konstantinova", "Vasiliev" });
+
+	for (const auto& [full_name, staff] : department.GetEmployees()) {			//Каталог компании следует за новыми ключами
+		CHECK(company.FindEmployee(full_name, department) != nullptr);
+		CHECK(addressof(department.at(full_name)) == addressof(staff));
+	}
+	CHECK(company.FindEmployee(borisov.Ref(), department) == nullptr);
+	CHECK(company.FindEmployee(yakovlev.Ref(), department) == nullptr);
+}
+
+int main() {
+	return test::RunTests();
+}
@@ -0,0 +1,176 @@
+#include "thread_pool.h"
+#include "tracing.h"
+
+#include <string>
+using namespace std;
+
+namespace concurrency {
+	namespace {
+		thread_local const ThreadPool* current_pool{ nullptr };				//Пул и номер потока, в котором выполняется код
+		thread_local size_t current_idx{ 0 };
+	}
+
+	ThreadPool::ThreadPool(size_t thread_count) {
+		if (!thread_count) {
+			thread_count = max(thread::hardware_concurrency(), 1u);
+		}
+		m_workers.reserve(thread_count);
+		for (size_t idx = 0; idx < thread_count; ++idx) {
+			m_workers.push_back(make_unique<Worker>());
+		}
+		m_threads.reserve(thread_count);
+		for (size_t idx = 0; idx < thread_count; ++idx) {
+			m_threads.emplace_back([this, idx] { run(idx); });
+		}
+	}
+
+	ThreadPool::~ThreadPool() {
+		{
+			lock_guard lock(m_idle_mutex);
+			m_stop.store(true);
+		}
+		m_idle_cv.notify_all();
+		for (auto& thread : m_threads) {
+			thread.join();
+		}
+	}
+
+	bool ThreadPool::RunPendingTask() {
+		size_t worker_idx{ current_worker() };
+		auto task{ pop_task(worker_idx) };
+		if (!task) {
+			return false;
+		}
+		(*task)();
+		if (worker_idx == npos) {
+			m_helped.fetch_add(1, memory_order_relaxed);
+		}
+		else {
+			m_workers[worker_idx]->executed.fetch_add(1, memory_order_relaxed);
+		}
+		return true;
+	}
+
+	size_t ThreadPool::ThreadCount() const noexcept {
+		return m_workers.size();
+	}
+
+	ThreadPool::Metrics ThreadPool::GetMetrics() const {
+		Metrics metrics;
+		metrics.workers.reserve(m_workers.size());
+		for (const auto& worker : m_workers) {
+			WorkerMetrics worker_metrics;
+			{
+				lock_guard lock(worker->mutex);
+				worker_metrics.queue_depth = worker->tasks.size();
+			}
+			worker_metrics.executed = worker->executed.load(memory_order_relaxed);
+			worker_metrics.stolen = worker->stolen.load(memory_order_relaxed);
+			worker_metrics.idle_time = chrono::nanoseconds(worker->idle_ns.load(memory_order_relaxed));
+
+			metrics.queue_depth += worker_metrics.queue_depth;
+			metrics.executed += worker_metrics.executed;
+			metrics.stolen += worker_metrics.stolen;
+			metrics.idle_time += worker_metrics.idle_time;
+			metrics.workers.push_back(worker_metrics);
+		}
+		metrics.helped = m_helped.load(memory_order_relaxed);
+		return metrics;
+	}
+
+	ThreadPool& ThreadPool::Shared() {
+		static ThreadPool pool;
+		return pool;
+	}
+
+	void ThreadPool::push_task(Task task) {
+		size_t worker_idx{ current_worker() };
+		if (worker_idx == npos) {
+			worker_idx = m_next_worker.fetch_add(1, memory_order_relaxed) % m_workers.size();
+		}
+		m_queued.fetch_add(1);														//До вставки: счётчик не уходит ниже нуля при немедленном перехвате
+		{
+			auto& worker{ *m_workers[worker_idx] };
+			lock_guard lock(worker.mutex);
+			worker.tasks.push_back(move(task));
+		}
+		if (m_sleeping.load()) {													//Счётчики seq_cst: уснувший поток либо увидит задачу,
+			{																		//либо будет разбужен
+				lock_guard lock(m_idle_mutex);
+			}
+			m_idle_cv.notify_one();
+		}
+	}
+
+	optional<Task> ThreadPool::pop_task(size_t worker_idx) {
+		if (worker_idx == npos) {
+			return steal_task(m_next_worker.load(memory_order_relaxed), npos);
+		}
+		{
+			auto& worker{ *m_workers[worker_idx] };
+			lock_guard lock(worker.mutex);
+			if (!worker.tasks.empty()) {
+				Task task{ move(worker.tasks.back()) };							//Своя очередь - с конца
+				worker.tasks.pop_back();
+				m_queued.fetch_sub(1);
+				return task;
+			}
+		}
+		return steal_task(worker_idx + 1, worker_idx);
+	}
+
+	optional<Task> ThreadPool::steal_task(size_t first_victim, size_t thief_idx) {
+		if (!m_queued.load()) {
+			return nullopt;
+		}
+		for (size_t offset = 0; offset < m_workers.size(); ++offset) {
+			size_t victim_idx{ (first_victim + offset) % m_workers.size() };
+			if (victim_idx == thief_idx) {
+				continue;
+			}
+			auto& victim{ *m_workers[victim_idx] };
+			lock_guard lock(victim.mutex);
+			if (!victim.tasks.empty()) {
+				Task task{ move(victim.tasks.front()) };							//Чужая очередь - с начала
+				victim.tasks.pop_front();
+				m_queued.fetch_sub(1);
+				if (thief_idx != npos) {
+					m_workers[thief_idx]->stolen.fetch_add(1, memory_order_relaxed);
+				}
+				return task;
+			}
+		}
+		return nullopt;
+	}
+
+	size_t ThreadPool::current_worker() const noexcept {
+		return current_pool == this ? current_idx : npos;
+	}
+
+	void ThreadPool::run(size_t worker_idx) {
+		current_pool = this;
+		current_idx = worker_idx;
+		tracing::Tracer::Instance().SetThreadName("pool worker " + to_string(worker_idx));
+		auto& worker{ *m_workers[worker_idx] };
+		for (;;) {
+			if (auto task{ pop_task(worker_idx) }) {
+				tracing::Span span("pool/task", "pool");
+				(*task)();
+				worker.executed.fetch_add(1, memory_order_relaxed);
+				continue;
+			}
+			unique_lock lock(m_idle_mutex);
+			m_sleeping.fetch_add(1);
+			auto idle_start{ clock::now() };
+			m_idle_cv.wait(lock, [this] { return m_queued.load() || m_stop.load(); });
+			worker.idle_ns.fetch_add(
+				chrono::duration_cast<chrono::nanoseconds>(clock::now() - idle_start).count(),
+				memory_order_relaxed
+			);
+			m_sleeping.fetch_sub(1);
+			if (!m_queued.load() && m_stop.load()) {
+				break;																//Остановка - после выполнения всех задач
+			}
+		}
+	}
+}
@@ -0,0 +1,360 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <variant>
+#include <exception>
+#include <type_traits>
+#include <utility>
+#include <algorithm>
+#include <cstdint>
+
+/***********************************************************
+Общий для движка пул потоков с перехватом работы (work stealing).
+У каждого потока - собственная очередь: задачи, порождённые
+внутри пула, кладутся в очередь текущего потока и извлекаются
+из её конца (LIFO - данные ещё в кэше), а простаивающие потоки
+забирают задачи из начала чужих очередей. Задачи извне
+распределяются по очередям по кругу.
+
+Submit() возвращает Future; Then() ставит продолжение в пул
+после готовности результата, исключения передаются дальше
+по цепочке продолжений. Ожидающий Get() поток не простаивает,
+а выполняет задачи из очередей пула - поэтому вложенные
+ожидания внутри задач не приводят к взаимной блокировке.
+
+Разбор, сериализация, индексация и аналитика используют
+ThreadPool::Shared() вместо создания собственных потоков.
+Задачи не должны работать с ObjectPool и документами,
+изменяемыми другими потоками: они не потокобезопасны
+************************************************************/
+
+namespace concurrency {
+	class ThreadPool;
+
+	class Task {																//Перемещаемая обёртка: std::function требует копируемого callable
+	public:
+		Task() = default;
+		template <
+			class Fn,
+			std::enable_if_t<
+				!std::is_same_v<std::decay_t<Fn>, Task>
+				&& std::is_invocable_v<std::decay_t<Fn>&>, int> = 0
+		>
+		Task(Fn&& fn)
+			: m_callable(std::make_unique<Callable<std::decay_t<Fn>>>(std::forward<Fn>(fn)))
+		{
+		}
+		void operator()() {
+			m_callable->Invoke();
+		}
+		explicit operator bool() const noexcept {
+			return static_cast<bool>(m_callable);
+		}
+	private:
+		struct CallableBase {
+			virtual ~CallableBase() = default;
+			virtual void Invoke() = 0;
+		};
+		template <class Fn>
+		struct Callable : CallableBase {
+			Callable(Fn&& fn) : fn(std::move(fn)) {}
+			Callable(const Fn& fn) : fn(fn) {}
+			void Invoke() override {
+				fn();
+			}
+			Fn fn;
+		};
+	private:
+		std::unique_ptr<CallableBase> m_callable;
+	};
+
+	namespace detail {
+		template <class Ty>
+		class SharedState {
+		public:
+			using value_type = std::conditional_t<std::is_void_v<Ty>, std::monostate, Ty>;
+		public:
+			explicit SharedState(ThreadPool& pool) noexcept
+				: m_pool(std::addressof(pool))
+			{
+			}
+			bool IsReady() const noexcept {
+				return m_ready.load(std::memory_order_acquire);
+			}
+			ThreadPool& GetPool() const noexcept {
+				return *m_pool;
+			}
+			void SetValue(value_type value);
+			void SetException(std::exception_ptr exc);
+			void Wait();														//Ожидающий поток выполняет задачи пула
+			value_type Take();													//После Wait(); пробрасывает исключение задачи
+			void AddContinuation(Task task);									//Сразу в пул, если результат уже готов
+		private:
+			void complete(std::unique_lock<std::mutex>& lock);
+		private:
+			ThreadPool* m_pool;
+			std::mutex m_mutex;
+			std::condition_variable m_ready_cv;
+			std::atomic<bool> m_ready{ false };
+			std::optional<value_type> m_value;
+			std::exception_ptr m_exception;
+			std::vector<Task> m_continuations;
+		};
+	}
+
+	template <class Ty>
+	class Future {
+	public:
+		using value_type = Ty;
+	public:
+		Future() = default;
+
+		bool IsValid() const noexcept {
+			return static_cast<bool>(m_state);
+		}
+		bool IsReady() const noexcept {
+			return m_state->IsReady();
+		}
+		Future& Wait() {
+			m_state->Wait();
+			return *this;
+		}
+		Ty Get() {																//Однократно, как у std::future
+			auto state{ std::move(m_state) };
+			state->Wait();
+			if constexpr (std::is_void_v<Ty>) {
+				state->Take();
+			}
+			else {
+				return state->Take();
+			}
+		}
+
+		template <class Fn>
+		auto Then(Fn&& fn);														//Fn(Ty) либо Fn() для void; забирает результат - Get() после Then() недопустим
+	private:
+		friend class ThreadPool;
+		template <class OtherTy>
+		friend class Future;
+
+		explicit Future(std::shared_ptr<detail::SharedState<Ty>> state) noexcept
+			: m_state(std::move(state))
+		{
+		}
+	private:
+		std::shared_ptr<detail::SharedState<Ty>> m_state;
+	};
+
+	class ThreadPool {
+	public:
+		using clock = std::chrono::steady_clock;
+
+		struct WorkerMetrics {
+			size_t queue_depth{ 0 };
+			uint64_t executed{ 0 };
+			uint64_t stolen{ 0 };												//Задачи, забранные из чужих очередей
+			std::chrono::nanoseconds idle_time{ 0 };
+		};
+		struct Metrics {
+			std::vector<WorkerMetrics> workers;
+			size_t queue_depth{ 0 };
+			uint64_t executed{ 0 };
+			uint64_t stolen{ 0 };
+			uint64_t helped{ 0 };												//Задачи, выполненные потоками в ожидании Future
+			std::chrono::nanoseconds idle_time{ 0 };
+		};
+	public:
+		explicit ThreadPool(size_t thread_count = 0);							//0 - по числу аппаратных потоков
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+		~ThreadPool();															//Дожидается выполнения всех поставленных задач
+
+		template <class Fn>
+		auto Submit(Fn&& fn) {													//Fn(); Future<результат Fn>
+			using result_t = std::invoke_result_t<std::decay_t<Fn>&>;
+			auto state{ std::make_shared<detail::SharedState<result_t>>(*this) };
+			push_task(
+				[state, fn = std::forward<Fn>(fn)]() mutable {
+					fulfill(*state, fn);
+				});
+			return Future<result_t>(std::move(state));
+		}
+
+		template <class Fn>
+		void ParallelFor(size_t count, size_t grain, Fn&& fn) {					//Fn(first, last) для отрезков [0, count) длиной не более grain
+			grain = std::max<size_t>(grain, 1);
+			std::vector<Future<void>> parts;
+			parts.reserve(count / grain);
+			for (size_t first = grain; first < count; first += grain) {
+				size_t last{ std::min(first + grain, count) };
+				parts.push_back(Submit([&fn, first, last] { fn(first, last); }));
+			}
+			std::exception_ptr exc;
+			try {
+				fn(size_t{ 0 }, std::min(grain, count));						//Первый отрезок - в текущем потоке
+			}
+			catch (...) {
+				exc = std::current_exception();
+			}
+			for (auto& part : parts) {											//fn должна пережить все отрезки, даже при исключении
+				try {
+					part.Get();
+				}
+				catch (...) {
+					if (!exc) {
+						exc = std::current_exception();
+					}
+				}
+			}
+			if (exc) {
+				std::rethrow_exception(exc);
+			}
+		}
+
+		bool RunPendingTask();													//Выполнение одной задачи из очередей в текущем потоке; false, если очереди пусты
+		size_t ThreadCount() const noexcept;
+		Metrics GetMetrics() const;
+
+		static ThreadPool& Shared();											//Общий пул движка
+	private:
+		struct alignas(64) Worker {
+			mutable std::mutex mutex;
+			std::deque<Task> tasks;
+			std::atomic<uint64_t> executed{ 0 };
+			std::atomic<uint64_t> stolen{ 0 };
+			std::atomic<int64_t> idle_ns{ 0 };
+		};
+		static constexpr size_t npos{ static_cast<size_t>(-1) };
+
+		template <class Ty>
+		friend class detail::SharedState;
+		template <class Ty>
+		friend class Future;
+
+		template <class Ty, class Fn>
+		static void fulfill(detail::SharedState<Ty>& state, Fn& fn) noexcept {
+			try {
+				if constexpr (std::is_void_v<Ty>) {
+					fn();
+					state.SetValue({});
+				}
+				else {
+					state.SetValue(fn());
+				}
+			}
+			catch (...) {
+				state.SetException(std::current_exception());
+			}
+		}
+
+		void push_task(Task task);
+		std::optional<Task> pop_task(size_t worker_idx);						//npos - поток вне пула: только перехват
+		std::optional<Task> steal_task(size_t first_victim, size_t thief_idx);
+		size_t current_worker() const noexcept;									//npos, если текущий поток не принадлежит пулу
+		void run(size_t worker_idx);
+	private:
+		std::vector<std::unique_ptr<Worker>> m_workers;
+		std::atomic<size_t> m_queued{ 0 };										//Задачи во всех очередях
+		std::atomic<size_t> m_sleeping{ 0 };
+		std::atomic<size_t> m_next_worker{ 0 };									//Очередь для следующей внешней задачи
+		std::atomic<uint64_t> m_helped{ 0 };
+		std::atomic<bool> m_stop{ false };
+		std::mutex m_idle_mutex;
+		std::condition_variable m_idle_cv;
+		std::vector<std::thread> m_threads;										//Запускаются последними
+	};
+
+	namespace detail {
+		template <class Ty>
+		void SharedState<Ty>::SetValue(value_type value) {
+			std::unique_lock lock(m_mutex);
+			m_value.emplace(std::move(value));
+			complete(lock);
+		}
+
+		template <class Ty>
+		void SharedState<Ty>::SetException(std::exception_ptr exc) {
+			std::unique_lock lock(m_mutex);
+			m_exception = std::move(exc);
+			complete(lock);
+		}
+
+		template <class Ty>
+		void SharedState<Ty>::Wait() {
+			using namespace std::chrono_literals;
+			while (!IsReady()) {
+				if (!m_pool->RunPendingTask()) {								//Задачи могут появиться и позже - поэтому ожидание с таймаутом
+					std::unique_lock lock(m_mutex);
+					m_ready_cv.wait_for(lock, 200us, [this] { return IsReady(); });
+				}
+			}
+		}
+
+		template <class Ty>
+		auto SharedState<Ty>::Take() -> value_type {
+			if (m_exception) {
+				std::rethrow_exception(m_exception);
+			}
+			return std::move(*m_value);
+		}
+
+		template <class Ty>
+		void SharedState<Ty>::AddContinuation(Task task) {
+			{
+				std::lock_guard lock(m_mutex);
+				if (!IsReady()) {
+					m_continuations.push_back(std::move(task));
+					return;
+				}
+			}
+			m_pool->push_task(std::move(task));
+		}
+
+		template <class Ty>
+		void SharedState<Ty>::complete(std::unique_lock<std::mutex>& lock) {
+			m_ready.store(true, std::memory_order_release);
+			std::vector<Task> continuations(std::move(m_continuations));
+			lock.unlock();
+			m_ready_cv.notify_all();
+			for (auto& continuation : continuations) {
+				m_pool->push_task(std::move(continuation));
+			}
+		}
+	}
+
+	template <class Ty>
+	template <class Fn>
+	auto Future<Ty>::Then(Fn&& fn) {
+		using result_t = typename std::conditional_t<
+			std::is_void_v<Ty>,
+			std::invoke_result<std::decay_t<Fn>&>,
+			std::invoke_result<std::decay_t<Fn>&, Ty>
+		>::type;
+		auto antecedent{ std::move(m_state) };
+		auto next{ std::make_shared<detail::SharedState<result_t>>(antecedent->GetPool()) };
+		auto* antecedent_ptr{ antecedent.get() };
+		antecedent_ptr->AddContinuation(
+			[antecedent = std::move(antecedent), next, fn = std::forward<Fn>(fn)]() mutable {
+				auto call{
+					[&]() -> result_t {
+						if constexpr (std::is_void_v<Ty>) {
+							antecedent->Take();									//Исключение предшественника уходит в next
+							return fn();
+						}
+						else {
+							return fn(antecedent->Take());
+						}
+					}
+				};
+				ThreadPool::fulfill(*next, call);
+			});
+		return Future<result_t>(std::move(next));
+	}
+}
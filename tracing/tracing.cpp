@@ -0,0 +1,190 @@
+#include "tracing.h"
+
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+using namespace std;
+
+namespace tracing {
+	struct Tracer::ThreadBuffer {
+		std::mutex guard;															//Захватывается владельцем при записи и при выгрузке - без конкуренции в обычной работе
+		vector<Event> events;													//Растёт до ёмкости, затем используется как кольцевой буфер
+		size_t next{ 0 };														//Позиция следующей записи после заполнения
+		size_t capacity{ DEFAULT_CAPACITY };
+		uint64_t dropped{ 0 };
+		size_t thread_id{ 0 };
+		string thread_name;
+		bool thread_alive{ true };
+	};
+
+	struct Tracer::ThreadState {
+		shared_ptr<ThreadBuffer> buffer;										//Создаётся при первой записи события
+		string name;
+		~ThreadState() {														//Буфер завершившегося потока удаляется при следующем Start()
+			if (buffer) {
+				lock_guard lock(buffer->guard);
+				buffer->thread_alive = false;
+			}
+		}
+	};
+
+	Tracer& Tracer::Instance() {
+		static Tracer tracer;
+		return tracer;
+	}
+
+	void Tracer::Start(size_t events_per_thread) {
+		lock_guard lock(m_mutex);
+		m_buffers.erase(
+			remove_if(
+				m_buffers.begin(), m_buffers.end(),
+				[](const shared_ptr<ThreadBuffer>& buffer) {
+					lock_guard buffer_lock(buffer->guard);
+					return !buffer->thread_alive;									//События прежней записи больше не нужны
+				}),
+			m_buffers.end()
+		);
+		size_t capacity{ max<size_t>(events_per_thread, 1) };
+		for (auto& buffer : m_buffers) {
+			lock_guard buffer_lock(buffer->guard);
+			buffer->events.clear();
+			buffer->next = 0;
+			buffer->dropped = 0;
+			buffer->capacity = capacity;
+		}
+		m_capacity.store(capacity);
+		m_epoch.store(clock::now().time_since_epoch().count());
+		s_enabled.store(true);
+	}
+
+	void Tracer::Stop() noexcept {
+		s_enabled.store(false);
+	}
+
+	void Tracer::Record(const char* name, const char* category, clock::time_point start, clock::time_point end, int64_t count) noexcept {
+		try {
+			auto& buffer{ current_buffer() };
+			clock::time_point epoch{ clock::duration(m_epoch.load(memory_order_relaxed)) };
+			Event event{
+				name,
+				category,
+				chrono::duration_cast<chrono::nanoseconds>(start - epoch).count(),
+				chrono::duration_cast<chrono::nanoseconds>(end - start).count(),
+				count
+			};
+			lock_guard lock(buffer.guard);
+			if (buffer.events.size() < buffer.capacity) {
+				buffer.events.push_back(event);
+			}
+			else {
+				buffer.events[buffer.next] = event;
+				buffer.next = (buffer.next + 1) % buffer.capacity;
+				++buffer.dropped;
+			}
+		}
+		catch (...) {															//Трассировка не должна нарушать работу программы
+		}
+	}
+
+	void Tracer::SetThreadName(string name) {
+		auto& state{ thread_state() };
+		if (state.buffer) {
+			lock_guard lock(state.buffer->guard);
+			state.buffer->thread_name = name;
+		}
+		state.name = move(name);
+	}
+
+	size_t Tracer::WriteChromeTrace(ostream& output) const {
+		lock_guard lock(m_mutex);
+		size_t written{ 0 };
+		uint64_t dropped{ 0 };
+		auto flags{ output.flags() };													//Формат потока вызывающего восстанавливается в конце
+		auto precision{ output.precision() };
+		output << fixed << setprecision(3);
+		output << "{\"traceEvents\":[\n";
+		output << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"CompanyManager\"}}";
+		for (const auto& buffer : m_buffers) {
+			lock_guard buffer_lock(buffer->guard);
+			dropped += buffer->dropped;
+			if (!buffer->thread_name.empty()) {
+				output << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->thread_id << ",\"args\":{\"name\":";
+				write_json_string(output, buffer->thread_name.c_str());
+				output << "}}";
+			}
+			size_t size{ buffer->events.size() };
+			for (size_t idx = 0; idx < size; ++idx) {
+				const Event& event{ buffer->events[(buffer->next + idx) % size] };		//От самого старого
+				output << ",\n{\"name\":";
+				write_json_string(output, event.name);
+				output << ",\"cat\":";
+				write_json_string(output, event.category);
+				output << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread_id
+					<< ",\"ts\":" << event.start_ns / 1000.0
+					<< ",\"dur\":" << event.duration_ns / 1000.0;
+				if (event.count >= 0) {
+					output << ",\"args\":{\"count\":" << event.count << '}';
+				}
+				output << '}';
+				++written;
+			}
+		}
+		output << "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped_events\":" << dropped << "}}\n";
+		output.flags(flags);
+		output.precision(precision);
+		return written;
+	}
+
+	bool Tracer::SaveChromeTrace(const string& path) const {
+		ofstream output(path);
+		if (!output.is_open()) {
+			return false;
+		}
+		WriteChromeTrace(output);
+		return static_cast<bool>(output.flush());
+	}
+
+	uint64_t Tracer::DroppedEvents() const {
+		lock_guard lock(m_mutex);
+		uint64_t dropped{ 0 };
+		for (const auto& buffer : m_buffers) {
+			lock_guard buffer_lock(buffer->guard);
+			dropped += buffer->dropped;
+		}
+		return dropped;
+	}
+
+	Tracer::ThreadState& Tracer::thread_state() {
+		thread_local ThreadState state;
+		return state;
+	}
+
+	Tracer::ThreadBuffer& Tracer::current_buffer() {
+		auto& state{ thread_state() };
+		if (!state.buffer) {
+			auto buffer{ make_shared<ThreadBuffer>() };
+			buffer->thread_name = state.name;
+			lock_guard lock(m_mutex);
+			buffer->thread_id = m_next_thread_id++;
+			buffer->capacity = m_capacity.load();
+			m_buffers.push_back(buffer);
+			state.buffer = move(buffer);
+		}
+		return *state.buffer;
+	}
+
+	void Tracer::write_json_string(ostream& output, const char* str) {
+		output << '"';
+		for (; str && *str; ++str) {
+			switch (*str) {
+			case '"': output << "\\\""; break;
+			case '\\': output << "\\\\"; break;
+			default:
+				if (static_cast<unsigned char>(*str) >= 0x20) {
+					output << *str;
+				}
+			}
+		}
+		output << '"';
+	}
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include <chrono>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <string>
+#include <iostream>
+#include <cstdint>
+
+/***********************************************************
+Трассировка горячих участков: Span замеряет время своей
+области видимости и записывает событие в кольцевой буфер
+текущего потока. Буферы не разделяются между потоками,
+поэтому запись не конкурирует за общие данные; при
+переполнении вытесняются самые старые события.
+
+Пока запись не включена (Tracer::Start()), Span стоит
+одного чтения атомарного флага. Без COMPANY_MANAGER_TRACING
+(опция сборки) Span - пустой класс и удаляется компилятором.
+
+Результат - JSON формата Chrome Trace Event, который
+открывается в chrome://tracing и Perfetto (ui.perfetto.dev).
+Имена и категории событий - строковые литералы: буфер
+хранит только указатели на них
+************************************************************/
+
+namespace tracing {
+	using clock = std::chrono::steady_clock;
+
+	struct Event {
+		const char* name{ nullptr };
+		const char* category{ nullptr };
+		int64_t start_ns{ 0 };													//От начала записи
+		int64_t duration_ns{ 0 };
+		int64_t count{ -1 };													//Число обработанных элементов; -1 - не задано
+	};
+
+	class Tracer {
+	public:
+		static constexpr size_t DEFAULT_CAPACITY{ 1 << 16 };					//Событий на поток
+	public:
+		static Tracer& Instance();
+
+		static bool IsEnabled() noexcept {
+			return s_enabled.load(std::memory_order_relaxed);
+		}
+
+		void Start(size_t events_per_thread = DEFAULT_CAPACITY);				//Сбрасывает ранее записанные события
+		void Stop() noexcept;
+		void Record(const char* name, const char* category, clock::time_point start, clock::time_point end, int64_t count) noexcept;
+		void SetThreadName(std::string name);									//Для текущего потока; не требует включённой записи
+
+		size_t WriteChromeTrace(std::ostream& output) const;					//Возвращает число записанных событий
+		bool SaveChromeTrace(const std::string& path) const;
+		uint64_t DroppedEvents() const;											//Вытеснены при переполнении буферов
+	private:
+		struct ThreadBuffer;
+		struct ThreadState;
+
+		Tracer() = default;
+		static ThreadState& thread_state();
+		ThreadBuffer& current_buffer();
+		static void write_json_string(std::ostream& output, const char* str);
+	private:
+		static inline std::atomic<bool> s_enabled{ false };
+		std::atomic<int64_t> m_epoch{ 0 };										//clock::time_point начала записи в тиках
+		std::atomic<size_t> m_capacity{ DEFAULT_CAPACITY };
+		mutable std::mutex m_mutex;
+		std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;					//Переживают свои потоки, чтобы события можно было выгрузить
+		size_t m_next_thread_id{ 1 };
+	};
+
+#ifdef COMPANY_MANAGER_TRACING
+	class Span {
+	public:
+		explicit Span(const char* name, const char* category = "engine", bool active = true) noexcept
+			: m_name(name), m_category(category)
+		{
+			if (active && Tracer::IsEnabled()) {
+				m_active = true;
+				m_start = clock::now();
+			}
+		}
+		Span(const Span&) = delete;
+		Span& operator=(const Span&) = delete;
+		~Span() {
+			if (m_active) {
+				Tracer::Instance().Record(m_name, m_category, m_start, clock::now(), m_count);
+			}
+		}
+		void SetCount(int64_t count) noexcept {
+			m_count = count;
+		}
+	private:
+		const char* m_name;
+		const char* m_category;
+		bool m_active{ false };
+		int64_t m_count{ -1 };
+		clock::time_point m_start;
+	};
+#else
+	class Span {
+	public:
+		explicit Span(const char*, const char* = "engine", bool = true) noexcept {}
+		void SetCount(int64_t) noexcept {}
+	};
+#endif
+}
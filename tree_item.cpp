@@ -6,7 +6,7 @@ CompanyTreeItem::CompanyTreeItem(
 	CompanyTreeItem* parent
 )
 	: m_node_type(type), m_node_info(std::move(node_info)),
-	m_parent(parent)
+	m_name_key(MakeNameKey(m_node_info.wrapper_node)), m_parent(parent)
 {
 }
 
@@ -42,6 +42,17 @@ bool CompanyTreeItem::insertChild(tree_item_holder&& child, size_t position) {
 	return true;
 }
 
+bool CompanyTreeItem::insertChildren(children_list&& children, size_t position) {
+	if (position > m_child_items.size()) {
+		return false;
+	}
+	m_child_items.insert(																	//Однократный сдвиг хвоста вместо сдвига на каждый элемент
+		m_child_items.begin() + position,
+		std::make_move_iterator(children.begin()),
+		std::make_move_iterator(children.end())
+	);
+	return true;
+}
 
 bool CompanyTreeItem::removeChild(size_t position) {
 	if (position >= m_child_items.size()) {						
@@ -51,6 +62,15 @@ bool CompanyTreeItem::removeChild(size_t position) {
 	return true;
 }
 
+bool CompanyTreeItem::removeChildren(size_t position, size_t count) {
+	if (position + count > m_child_items.size()) {
+		return false;
+	}
+	auto first{ m_child_items.begin() + position };
+	m_child_items.erase(first, first + count);
+	return true;
+}
+
 size_t CompanyTreeItem::childNumber() const {
 	if (!m_parent) {
 		return 0;
@@ -74,34 +94,63 @@ size_t CompanyTreeItem::find_child(const children_list& children, const CompanyT
 		)
 	};
 	if (it == children.end()) {
-		throw std::logic_error("The parent has no information about the child");	//     parent
+		throw std::logic_error("The parent has no information about the child");	//Защита от узлов с некорректным parent
 	}
-	return it - children.begin();													// 
+	return it - children.begin();													//Индекс элемента
 }
 
 CompanyTreeItem::Type CompanyTreeItem::GetType() const noexcept {
 	return m_node_type;
 }
 
-const QString& CompanyTreeItem::GetName() const noexcept {
-	return m_node_info.displayed_name;
-}
-
-QString CompanyTreeItem::ExchangeName(QString new_name) noexcept {
-	return std::exchange(m_node_info.displayed_name, std::move(new_name));
+QString CompanyTreeItem::GetName() const {
+	const auto& node{ m_node_info.wrapper_node };
+	if (const auto* department = std::get_if<const Department*>(&node); department) {
+		return QString::fromStdString((*department)->GetName());
+	}
+	if (const auto* employee = std::get_if<const Employee*>(&node); employee) {
+		return FullNameRefToQString((*employee)->GetFullName());
+	}
+	return QString();														//Имя компании в модели не отображается, отвязанный элемент имени не имеет
 }
 
 const CompanyTreeItem::wrapper_node_ptr& CompanyTreeItem::GetWrapperNode() const noexcept {
 	return m_node_info.wrapper_node;
 }
 
-CompanyTreeItem& CompanyTreeItem::SetWrapperNode(wrapper_node_ptr node_ptr) noexcept {
+CompanyTreeItem& CompanyTreeItem::SetWrapperNode(wrapper_node_ptr node_ptr) {
 	m_node_info.wrapper_node = node_ptr;
+	return UpdateNameKey();
+}
+
+CompanyTreeItem& CompanyTreeItem::Detach() noexcept {
+	m_node_info.wrapper_node = std::monostate{};
+	return *this;
+}
+
+const CompanyTreeItem::name_key_t& CompanyTreeItem::GetNameKey() const noexcept {
+	return m_name_key;
+}
+
+CompanyTreeItem& CompanyTreeItem::UpdateNameKey() {
+	m_name_key = MakeNameKey(m_node_info.wrapper_node);
 	return *this;
 }
 
 wrapper::string_ref CompanyTreeItem::GetParentWrapperName() const {
-	return m_node_info.parent_wrapper_name.value();
+	if (!m_parent) {
+		throw std::logic_error("The item has no parent");
+	}
+	return std::get<const Department*>(m_parent->GetWrapperNode())->GetName();	//Имя берётся из узла, поэтому переименование подразделения не требует обхода сотрудников
+}
+
+bool CompanyTreeItem::IsFetched() const noexcept {
+	return m_fetched;
+}
+
+CompanyTreeItem& CompanyTreeItem::SetFetched(bool fetched) noexcept {
+	m_fetched = fetched;
+	return *this;
 }
 
 size_t CompanyTreeItem::Find(const QString& request) {
@@ -116,21 +165,38 @@ size_t CompanyTreeItem::Find(const QString& request) {
 	return it - m_child_items.begin();
 }
 
-size_t CompanyTreeItem::UpperBound(const QString& request) {
+size_t CompanyTreeItem::FindNode(const wrapper_node_ptr& node) const {
 	auto it{
-		std::upper_bound(
+		std::find_if(
 			m_child_items.begin(), m_child_items.end(),
-			request,
-			[](const QString& value, const tree_item_holder& item) {
-				return QString::compare(value, item->GetName(), Qt::CaseInsensitive) < 1;		// "<"   
+			[&node](const tree_item_holder& item) {
+				return item->GetWrapperNode() == node;
 			}
 		)
 	};
 	return it - m_child_items.begin();
 }
 
+size_t CompanyTreeItem::UpperBound(const QString& request, std::optional<size_t> skipped_pos) {
+	auto less{
+		[](const QString& value, const tree_item_holder& item) {
+			return QString::compare(value, item->GetName(), Qt::CaseInsensitive) < 1;			//Сравнение "<" без учета регистра
+		}
+	};
+	auto first{ m_child_items.begin() };
+	if (skipped_pos && *skipped_pos < m_child_items.size()) {								//Диапазоны до и после пропускаемого элемента отсортированы
+		auto skipped{ m_child_items.begin() + *skipped_pos };
+		if (auto it = std::upper_bound(first, skipped, request, less); 
+			it != skipped) {
+			return it - m_child_items.begin();
+		}
+		first = skipped + 1;
+	}
+	return std::upper_bound(first, m_child_items.end(), request, less) - m_child_items.begin();
+}
+
 std::optional<size_t> CompanyTreeItem::MoveChild(size_t from, size_t to) {
-	if (from == to											  //      - O(N) -       
+	if (from == to											  //Проверка во избежание ненужного выполнения длительной - O(N) - операции сдвига элементов    
 		|| from >= m_child_items.size()
 		|| to > m_child_items.size()
 		) {
@@ -156,3 +222,27 @@ CompanyTreeItem::tree_item_holder CompanyTreeItem::make_instance(
 ) {
 	return allocate_instance(type, std::move(node_info), parent);
 }
+
+QString CompanyTreeItem::FullNameRefToQString(const wrapper::FullNameRef& name) {
+	QString full_name(name.surname.get().data());
+	full_name += ' ';
+	full_name += name.name.get().data();
+	full_name += ' ';
+	full_name += name.middle_name.get().data();
+	return full_name;
+}
+
+CompanyTreeItem::name_key_t CompanyTreeItem::MakeNameKey(const wrapper_node_ptr& node) {
+	if (const auto* department = std::get_if<const Department*>(&node); department) {
+		return (*department)->GetName().get();
+	}
+	if (const auto* employee = std::get_if<const Employee*>(&node); employee) {
+		auto full_name{ (*employee)->GetFullName() };
+		name_key_t key;
+		key.reserve(full_name.surname.get().size() + full_name.name.get().size() + full_name.middle_name.get().size() + 2);
+		key.append(full_name.surname.get()).append(1, '\0');							//Разделитель исключает совпадение ключей
+		key.append(full_name.name.get()).append(1, '\0');								//при разном разбиении ФИО на части
+		return key.append(full_name.middle_name.get());
+	}
+	return name_key_t{};
+}
\ No newline at end of file
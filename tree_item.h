@@ -3,12 +3,17 @@
 #include "xml_wrappers.h"
 
 #include <variant>               
+#include <optional>
 #include <memory>
 #include <utility>
 #include <vector>
 #include <algorithm>
 #include <limits>
 #include <stdexcept>
+#include <string>
+#include <string_view>
+#include <functional>
+#include <iterator>
 
 #include <QVector>
 #include <QVariant>
@@ -27,11 +32,10 @@ public:
         std::monostate,
         const Department*,
         const Employee*
-    >;                                       //,    ,     
-    struct NodeInfo {
-        QString displayed_name;
-        wrapper_node_ptr wrapper_node;    
-        std::optional<wrapper::string_ref> parent_wrapper_name;
+    >;                                       //Указатель, в отличие от итератора, не инвалидируется при редактировании имени
+    using name_key_t = std::string;          //Полное имя в UTF-8: сопоставление по хэшу допускало бы коллизии
+    struct NodeInfo {                        //Отображаемое имя (QString) не хранится, а вычисляется по узлу XML-дерева: 
+        wrapper_node_ptr wrapper_node;       //для больших компаний копии имён удваивали расход памяти
     };
 public:
     static constexpr size_t 
@@ -49,42 +53,56 @@ public:
 
     CompanyTreeItem* parent();
     CompanyTreeItem* child(size_t idx);
-    size_t childNumber() const;                                                //  m_child_items  
+    size_t childNumber() const;                                                //Индекс в m_child_items родительского узла
     tree_item_holder& operator[](size_t idx) noexcept;
 
-    void appendChild(tree_item_holder&& child);                                 //tree_item_holder  ->    move c-tor
+    void appendChild(tree_item_holder&& child);                                 //tree_item_holder некопируем -> избегаем лишнего вызова move c-tor
     bool insertChild(tree_item_holder&& child, size_t pos);
+    bool insertChildren(children_list&& children, size_t pos);
     bool removeChild(size_t pos);
+    bool removeChildren(size_t pos, size_t count);
    
     Type GetType() const noexcept;
-    const QString& GetName() const noexcept;
-    QString ExchangeName(QString new_name) noexcept;
+    QString GetName() const;                                                    //Вычисляется при каждом обращении
     const wrapper_node_ptr& GetWrapperNode() const noexcept;
-    CompanyTreeItem& SetWrapperNode(wrapper_node_ptr node_ptr) noexcept;
-    wrapper::string_ref GetParentWrapperName() const;                              //throw if empty
+    CompanyTreeItem& SetWrapperNode(wrapper_node_ptr node_ptr);               //Ключ имени пересчитывается по новому узлу
+    CompanyTreeItem& Detach() noexcept;                                        //Отвязка от узла с сохранением ключа имени
+    const name_key_t& GetNameKey() const noexcept;                             //Имя для сопоставления с узлами нового XML-дерева
+    CompanyTreeItem& UpdateNameKey();                                          //После переименования узла
+    wrapper::string_ref GetParentWrapperName() const;                              //throw if parent is not a department
+
+    bool IsFetched() const noexcept;                                           //Построены ли дочерние элементы
+    CompanyTreeItem& SetFetched(bool fetched) noexcept;
 
     size_t Find(const QString& request);
-    size_t UpperBound(const QString& request);                                  //Binary search. Behaviour is undefined if children list is unsorted
+    size_t FindNode(const wrapper_node_ptr& node) const;                       //linear search by wrapper node
+    size_t UpperBound(                                                         //Binary search. Behaviour is undefined if children list is unsorted
+        const QString& request,
+        std::optional<size_t> skipped_pos = std::nullopt                       //Элемент, не участвующий в поиске (например, переименовываемый)
+    );
 
-    std::optional<size_t> MoveChild(size_t from, size_t to);                    //   .       
+    std::optional<size_t> MoveChild(size_t from, size_t to);                    //Перемещение потомка в списке. Возвращает новую позицию с учётом сдвига элементов
 
     static tree_item_holder make_instance(
         wrapper::XmlWrapper::Type type, 
         NodeInfo node_info,
         CompanyTreeItem* parent = nullptr
     );
+
+    static QString FullNameRefToQString(const wrapper::FullNameRef& name);
+    static name_key_t MakeNameKey(const wrapper_node_ptr& node);
 private:
     static size_t find_child(const children_list& children, const CompanyTreeItem* sought_child);
 
-    template <class ForwardIt>                                                  //  C++20     
-    static ForwardIt shift_left(ForwardIt first, ForwardIt last) {              //  1  
+    template <class ForwardIt>                                                  //При использовании C++20 были быдоступны одноименные стандартные алгоритмы
+    static ForwardIt shift_left(ForwardIt first, ForwardIt last) {              //Сдвиг на 1 позицию влево
         for (; first + 1 < last; ++first) {
             *first = std::move(*(first + 1));
         }
         return first;
     }
     template <class ForwardIt>
-    ForwardIt shift_right(ForwardIt first, ForwardIt last) {              //  1  
+    ForwardIt shift_right(ForwardIt first, ForwardIt last) {              //Сдвиг на 1 позицию вправо
         for (--last; last > first; --last) {
             *(last) = std::move(*(last - 1));
         }
@@ -93,6 +111,8 @@ private:
 private:
     wrapper::XmlWrapper::Type m_node_type;
     NodeInfo m_node_info;
+    name_key_t m_name_key;
     CompanyTreeItem* m_parent;
     children_list m_child_items;
+    bool m_fetched{ true };                                                    //Сотрудники подразделения создаются лишь при раскрытии
 };  
\ No newline at end of file
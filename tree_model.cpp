@@ -7,7 +7,10 @@ CompanyTreeModel::CompanyTreeModel(const CompanyManager& cm, QObject* parent)
 
 
 CompanyTreeModel& CompanyTreeModel::SetCompany(const CompanyManager& cm) {
-    beginResetModel();                                                  //   view'    
+    if (m_root_item) {
+        return Synchronize(cm);                                         //Выделение и раскрытые ветви сохраняются
+    }
+    beginResetModel();                                                  //Уведомляем все привязанные view'ы об инвалидации даных модели
     m_root_item = build_company_tree(cm.Read());
     endResetModel();
     return *this;
@@ -22,17 +25,91 @@ CompanyTreeModel& CompanyTreeModel::Reset() noexcept {
 }
 
 
+CompanyTreeModel& CompanyTreeModel::Synchronize(const CompanyManager& cm) {
+    if (!m_root_item) {                                                 //Сравнивать не с чем
+        beginResetModel();
+        m_root_item = build_company_tree(cm.Read());
+        endResetModel();
+        return *this;
+    }
+    detach_branch(*m_root_item);                                        //Пока указатели не обновлены, элементы не должны обращаться к узлам прежнего дерева
+    
+    const Company& company{ cm.Read() };
+    std::vector<ChildEntry> departments;
+    departments.reserve(company.DepartmentCount());
+    auto department_range{ company.GetDepartments() };
+    for (auto it = department_range.begin(); it != department_range.end(); ++it) {
+        const Department* department{ std::addressof(*it) };
+        departments.push_back({ CompanyTreeItem::MakeNameKey(department), department });
+    }
+    synchronize_children(*m_root_item, QModelIndex(), departments);
+
+    std::vector<ChildEntry> staff;
+    for (size_t row = 0; row < m_root_item->childCount(); ++row) {
+        auto& department_item{ *m_root_item->child(row) };
+        if (!department_item.IsFetched()) {                             //Новые и нераскрытые подразделения будут заполнены в fetchMore()
+            continue;
+        }
+        staff.clear();
+        auto employee_range{ get_department(department_item)->GetEmployees() };
+        for (auto it = employee_range.begin(); it != employee_range.end(); ++it) {
+            const Employee* employee{ std::addressof(it->second) };
+            staff.push_back({ CompanyTreeItem::MakeNameKey(employee), employee });
+        }
+        synchronize_children(department_item, DepartmentIndex(row), staff);
+    }
+    if (size_t count = m_root_item->childCount(); count) {
+        emit dataChanged(DepartmentIndex(0), DepartmentIndex(count - 1));    //Число сотрудников нераскрытых подразделений могло измениться
+    }
+    return *this;
+}
+
+
+CompanyTreeModel& CompanyTreeModel::Detach() noexcept {
+    if (m_root_item) {
+        detach_branch(*m_root_item);
+    }
+    return *this;
+}
+
+
 int CompanyTreeModel::rowCount(const QModelIndex& parent) const {
     const auto* item{ get_item(parent) };
     if (item) {
         return static_cast<int>(item->childCount());
     }
-    return m_root_item ?                                                //  Reset()     -                             
+    return m_root_item ?                                                //После сброса Reset() внешние объекты могут запрашивать кол-во дочерних узлов для перерисовки                         
         static_cast<int>(m_root_item->childCount()) : 0;
 }
 
+bool CompanyTreeModel::hasChildren(const QModelIndex& parent) const {
+    const auto* item{ get_item(parent) };
+    if (!item) {
+        return false;
+    }
+    if (item->GetType() == ItemType::Department && !item->IsFetched()) {                //Стрелка раскрытия отображается без создания элементов
+        const auto* department{ get_department(*item) };
+        return department && department->EmployeeCount() > 0;
+    }
+    return item->childCount() > 0;
+}
+
+bool CompanyTreeModel::canFetchMore(const QModelIndex& parent) const {
+    const auto* item{ get_item(parent) };
+    return item
+        && !item->IsFetched()
+        && get_department(*item);
+}
+
+void CompanyTreeModel::fetchMore(const QModelIndex& parent) {
+    if (auto* item = get_item(parent); 
+        item && item->GetType() == ItemType::Department) {
+        fetch_employees(*item, parent);
+    }
+}
+
 int CompanyTreeModel::columnCount(const QModelIndex& parent) const {
-    (void)parent;                                                       // 
+    (void)parent;                                                       //Неиспользуемый параметр
     return m_root_item ?
         static_cast<int>(m_root_item->columnCount()) : 1;
 }
@@ -107,19 +184,20 @@ std::optional<CompanyTreeModel::ItemType> CompanyTreeModel::GetItemType(const QM
 
 std::optional<QString> CompanyTreeModel::GetItemName(const QModelIndex& index) const noexcept {
     auto* item{ get_item(index) };
-    if (!item || item == m_root_item.get()) {                                       //      ,   data_storage
-        return std::nullopt;                                                        //  1! 
-    }                                                                               //   UB
+    if (!item || item == m_root_item.get()) {                                       //Имя компании в текущей модели не предусмотрено, а её data_storage
+        return std::nullopt;                                                        //имеет размер 1! 
+    }                                                                               //Проверка во избежание UB
     return item->GetName();
 }
 
-std::optional<QString> CompanyTreeModel::ExchangeItemName(const QModelIndex& index, QString new_name) noexcept {
+bool CompanyTreeModel::RefreshItemName(const QModelIndex& index) {
     auto* item{ get_item(index) };
-    if (!item || item == m_root_item.get()) {                                      
-        return std::nullopt;                                                       
+    if (!index.isValid() || !item || item == m_root_item.get()) {
+        return false;
     }
-    emit dataChanged(index, index);                                                 //   
-    return item->ExchangeName(std::move(new_name));
+    item->UpdateNameKey();
+    emit dataChanged(index, index);                                                 //Имя будет заново вычислено в data()
+    return true;
 }
 
 CompanyTreeModel::wrapper_node_ptr CompanyTreeModel::GetItemNode(const QModelIndex& index) {
@@ -155,7 +233,7 @@ QModelIndex CompanyTreeModel::GetNextItem(const QModelIndex& old_index) {
     if (!old_index.isValid()) {
         return QModelIndex();
     }
-    QModelIndex parent_idx(parent(old_index));                              // (, ) 
+    QModelIndex parent_idx(parent(old_index));                              //Родительский (возможно, корневой) индекс
    
     size_t row_count{ static_cast<size_t>(rowCount(parent_idx)) };
     return static_cast<size_t>(old_index.row()) + 1 >= row_count ?
@@ -170,12 +248,16 @@ std::optional<size_t> CompanyTreeModel::FindChild(const QString& request, const
     return item->Find(request);
 }
 
-std::optional<size_t> CompanyTreeModel::UpperBoundChild(const QString& request, const QModelIndex& parent) {
+std::optional<size_t> CompanyTreeModel::UpperBoundChild(
+    const QString& request, 
+    const QModelIndex& parent, 
+    std::optional<size_t> skipped_row
+) {
     auto* item{ get_item(parent) };
     if (!item) {
         return std::nullopt;
     }
-    return item->UpperBound(request);
+    return item->UpperBound(request, skipped_row);
 }
 
 std::optional<size_t> CompanyTreeModel::MoveItem(size_t row_from, size_t row_to, const QModelIndex& parent) {
@@ -184,7 +266,7 @@ std::optional<size_t> CompanyTreeModel::MoveItem(size_t row_from, size_t row_to,
         return std::nullopt;
     }
     std::optional<size_t> result{ (row_from > row_to ? row_to : row_to - 1) };
-    if (beginMoveRows(                                                                      //     beginMoveRows()
+    if (beginMoveRows(                                                                      //Все необходимые проверки возложены на beginMoveRows()
         parent,
         static_cast<int>(row_from), static_cast<int>(row_from),                             //source
         parent,
@@ -262,18 +344,16 @@ bool CompanyTreeModel::RestoreDepartmentItem(Memento&& item, const Department* n
 
 QModelIndex CompanyTreeModel::InsertEmployeeItem(const Employee& source, const QModelIndex& department, size_t pos) {
     auto* item{ get_item(department) };
-    if (!item
-        || item->GetType() != ItemType::Department
-        || pos > item->childCount()) {
+    if (!item || item->GetType() != ItemType::Department) {
         return QModelIndex();
     }
-    tree_item_holder child{
-        build_employee_tree(
-            source,
-            std::get<const wrapper::Department*>(item->GetWrapperNode())->GetName(),
-            item
-        )
-    };
+    if (fetch_employees(*item, department)) {                                   //Подразделение заполнено по XML-дереву, где сотрудник уже есть
+        return EmployeeIndex(department, item->FindNode(std::addressof(source)));
+    }
+    if (pos > item->childCount()) {
+        return QModelIndex();
+    }
+    tree_item_holder child{ build_employee_tree(source, item) };
     beginInsertRows(department, static_cast<int>(pos), static_cast<int>(pos));
     if(pos == item->childCount()) {
          item->appendChild(std::move(child));
@@ -301,7 +381,7 @@ bool CompanyTreeModel::RemoveEmployeeItem(const QModelIndex& department, size_t
 CompanyTreeModel::Memento CompanyTreeModel::DumpEmployeeItem(const QModelIndex& department, size_t pos) {
     auto* item{ get_item(department) };
     if (!item
-        || item->GetType() != ItemType::Department          //  - 
+        || item->GetType() != ItemType::Department          //Родительский узел - подразделение
         || pos >= item->childCount()) {
         return Memento();
     }
@@ -313,7 +393,7 @@ CompanyTreeModel::Memento CompanyTreeModel::DumpEmployeeItem(const QModelIndex&
     beginRemoveRows(department, static_cast<int>(pos), static_cast<int>(pos));
     item->removeChild(pos);
     endRemoveRows();
-    return std::move(dump);                                     //   Memento
+    return std::move(dump);                                     //Перемещаем в конструктор Memento
 }
 
 bool CompanyTreeModel::RestoreEmployeeItem(Memento&& item, const Employee* new_node) {
@@ -323,9 +403,12 @@ bool CompanyTreeModel::RestoreEmployeeItem(Memento&& item, const Employee* new_n
     }
     QModelIndex department_q_idx{ DepartmentIndex(employee_dump.parent_pos.value()) };
     auto* department{ get_item(department_q_idx) };
-    if (!department) {
+    if (!department || department->GetType() != ItemType::Department) {
         return false;
     }
+    if (fetch_employees(*department, department_q_idx)) {                       //Восстановленный сотрудник уже есть в XML-дереве
+        return true;
+    }
     beginInsertRows(
         department_q_idx,
         static_cast<int>(employee_dump.pos),
@@ -341,6 +424,22 @@ bool CompanyTreeModel::RestoreEmployeeItem(Memento&& item, const Employee* new_n
     return success;
 }
 
+QModelIndex CompanyTreeModel::LocateEmployee(const Department& department, const Employee& employee) {
+    if (!m_root_item) {
+        return QModelIndex();
+    }
+    size_t department_row{ m_root_item->FindNode(std::addressof(department)) };
+    if (department_row == m_root_item->childCount()) {
+        return QModelIndex();
+    }
+    QModelIndex department_idx{ DepartmentIndex(department_row) };
+    auto* department_item{ get_item(department_idx) };
+    fetch_employees(*department_item, department_idx);
+    size_t employee_row{ department_item->FindNode(std::addressof(employee)) };
+    return employee_row < department_item->childCount() ?
+        EmployeeIndex(department_idx, employee_row) : QModelIndex();
+}
+
 
 CompanyTreeModel::tree_item_holder CompanyTreeModel::build_company_tree(const wrapper::Company& company) {
     tree_item_holder root_item{
@@ -349,7 +448,7 @@ CompanyTreeModel::tree_item_holder CompanyTreeModel::build_company_tree(const wr
            {}
        )
     };
-    auto range{ company.GetDepartments()};                                               //   
+    auto range{ company.GetDepartments()};                                               //Диапазон итераторов с сотрудниками
     for (auto it = range.begin(); it != range.end(); ++it) {
         root_item->appendChild(
             build_department_tree(*it, root_item.get())
@@ -363,51 +462,141 @@ CompanyTreeModel::build_department_tree(const Department& department, CompanyTre
     tree_item_holder item{
         CompanyTreeItem::make_instance(
             ItemType::Department,
-            CompanyTreeItem::NodeInfo{
-                QString::fromStdString(department.GetName()),
-                std::addressof(department),
-                std::nullopt
-            },
+            CompanyTreeItem::NodeInfo{ std::addressof(department) },
             parent
         )
     };
-    auto range{ department.GetEmployees() };                                               //   
-    for (auto it = range.begin(); it != range.end(); ++it) {
-        item->appendChild(
-            build_employee_tree(
-                it->second,
-                department.GetName(),    
-                item.get()
-            )
-        );
-    }
+    item->SetFetched(false);                                                                //Сотрудники будут созданы в fetchMore()
     return item;
 }
 
 CompanyTreeModel::tree_item_holder 
-CompanyTreeModel::build_employee_tree(
-    const Employee& employee,
-    wrapper::string_ref department_name,
-    CompanyTreeItem* parent
-) {
+CompanyTreeModel::build_employee_tree(const Employee& employee, CompanyTreeItem* parent) {
     return CompanyTreeItem::make_instance(
         ItemType::Employee,
-        CompanyTreeItem::NodeInfo{
-           FullNameRefToQString(employee.GetFullName()),
-            std::addressof(employee),
-            department_name
-        },
+        CompanyTreeItem::NodeInfo{ std::addressof(employee) },
         parent
     );
 }
 
+void CompanyTreeModel::build_staff(CompanyTreeItem& department) {
+    auto range{ std::get<const Department*>(department.GetWrapperNode())->GetEmployees() };   //Диапазон итераторов с сотрудниками
+    for (auto it = range.begin(); it != range.end(); ++it) {
+        department.appendChild(
+            build_employee_tree(it->second, std::addressof(department))
+        );
+    }
+    department.SetFetched(true);
+}
+
+bool CompanyTreeModel::fetch_employees(CompanyTreeItem& department, const QModelIndex& department_idx) {
+    const auto* node{ get_department(department) };
+    if (department.IsFetched() || !node) {
+        return false;
+    }
+    int count{ static_cast<int>(node->EmployeeCount()) };
+    if (count) {
+        beginInsertRows(department_idx, 0, count - 1);
+    }
+    build_staff(department);
+    if (count) {
+        endInsertRows();
+    }
+    return true;
+}
+
+CompanyTreeModel::tree_item_holder CompanyTreeModel::build_child(const wrapper_node_ptr& node, CompanyTreeItem* parent) {
+    if (const auto* department = std::get_if<const Department*>(&node); department) {
+        return build_department_tree(**department, parent);
+    }
+    return build_employee_tree(*std::get<const Employee*>(node), parent);
+}
+
+void CompanyTreeModel::detach_branch(CompanyTreeItem& item) noexcept {
+    item.Detach();
+    for (size_t idx = 0; idx < item.childCount(); ++idx) {
+        detach_branch(*item.child(idx));
+    }
+}
+
+const CompanyTreeModel::Department* CompanyTreeModel::get_department(const CompanyTreeItem& item) noexcept {
+    const auto* department{ std::get_if<const Department*>(&item.GetWrapperNode()) };
+    return department ? *department : nullptr;
+}
+
+void CompanyTreeModel::synchronize_children(
+    CompanyTreeItem& parent,
+    const QModelIndex& parent_idx,
+    const std::vector<ChildEntry>& entries
+) {
+    std::unordered_map<std::string_view, size_t> unmatched;                                 //Ключ -> число ещё не сопоставленных узлов;
+    for (const auto& entry : entries) {                                                     //ключи ссылаются на entries, которые переживают обе таблицы
+        ++unmatched[entry.name_key];
+    }
+
+    std::vector<bool> obsolete(parent.childCount(), false);                                 //Элементы, для которых не осталось узлов
+    std::unordered_map<std::string_view, size_t> retained;                                  //Ключ -> число сохраняемых элементов
+    for (size_t row = 0; row < parent.childCount(); ++row) {
+        if (auto it = unmatched.find(parent.child(row)->GetNameKey()); 
+            it != unmatched.end() && it->second > retained[it->first]) {                    //Ключ - полное имя: разные узлы не сопоставляются
+            ++retained[it->first];
+        }
+        else {
+            obsolete[row] = true;
+        }
+    }
+    for (size_t row = obsolete.size(); row > 0;) {                                          //С конца, чтобы индексы оставшихся серий не сдвигались
+        if (!obsolete[--row]) {
+            continue;
+        }
+        size_t last{ row };
+        while (row > 0 && obsolete[row - 1]) {
+            --row;
+        }
+        remove_children(parent, parent_idx, row, last);                                     //Одно уведомление на серию подряд идущих строк
+    }
+
+    size_t row{ 0 };
+    for (size_t idx = 0; idx < entries.size();) {
+        const auto& entry{ entries[idx] };
+        auto retained_it{ retained.find(entry.name_key) };
+        if (retained_it != retained.end() && retained_it->second > 0) {                      //Элемент уже есть - на месте либо ниже
+            size_t from{ row };
+            while (parent.child(from)->GetNameKey() != entry.name_key) {
+                ++from;
+            }
+            if (from != row) {
+                MoveItem(from, row, parent_idx);
+            }
+            parent.child(row)->SetWrapperNode(entry.node);
+            --retained_it->second;
+            ++row, ++idx;
+            continue;
+        }
+        CompanyTreeItem::children_list inserted;                                            //Серия подряд идущих новых узлов
+        for (; idx < entries.size(); ++idx) {
+            auto it{ retained.find(entries[idx].name_key) };
+            if (it != retained.end() && it->second > 0) {
+                break;
+            }
+            inserted.push_back(build_child(entries[idx].node, std::addressof(parent)));
+        }
+        int first{ static_cast<int>(row) };
+        row += inserted.size();
+        beginInsertRows(parent_idx, first, static_cast<int>(row) - 1);
+        parent.insertChildren(std::move(inserted), static_cast<size_t>(first));
+        endInsertRows();
+    }
+}
+
+void CompanyTreeModel::remove_children(CompanyTreeItem& parent, const QModelIndex& parent_idx, size_t first, size_t last) {
+    beginRemoveRows(parent_idx, static_cast<int>(first), static_cast<int>(last));
+    parent.removeChildren(first, last - first + 1);
+    endRemoveRows();
+}
+
 QString CompanyTreeModel::FullNameRefToQString(const wrapper::FullNameRef& name) {
-    QString full_name(name.surname.get().data());
-    full_name += ' ';
-    full_name += name.name.get().data();
-    full_name += ' ';
-    full_name += name.middle_name.get().data();
-    return full_name;
+    return CompanyTreeItem::FullNameRefToQString(name);
 }
 
 CompanyTreeItem* CompanyTreeModel::get_item(const QModelIndex& index) const {
@@ -7,6 +7,8 @@
 #include <optional>
 #include <utility>
 #include <string_view>
+#include <vector>
+#include <unordered_map>
 
 #include <QtWidgets>
 #include <QModelIndex>
@@ -28,8 +30,8 @@ public:
     using Employee = wrapper::Employee;
     
 /************************************************************
- Memento  
-        .
+Класс Memento хранит ветвь
+и позволяет её извлекать и вставлять без полной пересборки.
 ***********************************************************/
     class Memento {
     public:
@@ -39,7 +41,7 @@ public:
     private:
         struct Dump {
             size_t pos;
-            std::optional<size_t> parent_pos;                   //  Employee
+            std::optional<size_t> parent_pos;                   //Только для Employee
             tree_item_holder branch;
         };
 
@@ -50,7 +52,7 @@ public:
         {
         }
         Dump Extract() {
-            return std::move(*m_dump);                          //   
+            return std::move(*m_dump);                          //Строго для внутреннего использования
         }
     private:
         std::optional<Dump> m_dump;
@@ -59,11 +61,34 @@ public:
     CompanyTreeModel() = default;
     CompanyTreeModel(const CompanyManager& cm, QObject* parent = nullptr);
 
-    CompanyTreeModel& SetCompany(const CompanyManager& cm);
+    CompanyTreeModel& SetCompany(const CompanyManager& cm);                 //При наличии дерева элементов - Synchronize()
     CompanyTreeModel& Reset() noexcept;
 
+/************************************************************
+Synchronize() сравнивает дерево элементов с состоянием cm
+и отправляет минимальный набор уведомлений об удалении,
+перемещении и вставке строк вместо сброса модели, поэтому
+выделение и раскрытые ветви в view'ах сохраняются.
+Элементы сопоставляются по полным именам, а не по указателям:
+прежнее XML-дерево к моменту вызова может быть уничтожено.
+Detach() отвязывает элементы от уничтожаемого XML-дерева,
+сохраняя структуру для последующей синхронизации
+***********************************************************/
+    CompanyTreeModel& Synchronize(const CompanyManager& cm);
+    CompanyTreeModel& Detach() noexcept;
+
+/************************************************************
+Сотрудники подразделения создаются лишь при его раскрытии
+(canFetchMore()/fetchMore()), а отображаемые имена вычисляются
+в data() по узлам XML-дерева. Операции над сотрудниками
+ещё не раскрытого подразделения сводятся к его заполнению
+по текущему состоянию XML-дерева
+***********************************************************/
     int rowCount(const QModelIndex& parent = QModelIndex()) const override;
     int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
     Qt::ItemFlags flags(const QModelIndex& index) const override;
 
     QModelIndex parent(const QModelIndex& index) const override;
@@ -78,23 +103,27 @@ public:
     QVariant data(const QModelIndex& index, int role) const noexcept override;
     
 
-    std::optional<ItemType> GetItemType(const QModelIndex& index) const noexcept;                      //nullopt,    
+    std::optional<ItemType> GetItemType(const QModelIndex& index) const noexcept;                      //nullopt, если индекс не валиден
     std::optional<QString> GetItemName(const QModelIndex& index) const noexcept;                       
-    std::optional<QString> ExchangeItemName(const QModelIndex& index, QString new_name) noexcept;
+    bool RefreshItemName(const QModelIndex& index);                                                    //Уведомление view'ов о переименовании узла XML-дерева
 
     wrapper_node_ptr GetItemNode(const QModelIndex& index);
-    std::optional<wrapper::string_ref> GetDepartmentNameRef(const QModelIndex& index);                    //string_view  ,    XML-
+    std::optional<wrapper::string_ref> GetDepartmentNameRef(const QModelIndex& index);                    //string_view на строку, лежащую в далеком XML-узле
 
-    QModelIndex GetPrevItem(const QModelIndex& index);                                                  //   
-    QModelIndex GetNextItem(const QModelIndex& index);                                                  //   
+    QModelIndex GetPrevItem(const QModelIndex& index);                                                  //Обращенеи к предыдущей строке
+    QModelIndex GetNextItem(const QModelIndex& index);                                                  //Обращенеи к следующей строке
 
     std::optional<size_t> FindChild(const QString& request, const QModelIndex& parent = QModelIndex());          //linear search
-    std::optional<size_t> UpperBoundChild(const QString& request, const QModelIndex& parent = QModelIndex());    //binary search for sorted ranges
+    std::optional<size_t> UpperBoundChild(                                                                          //binary search for sorted ranges
+        const QString& request,
+        const QModelIndex& parent = QModelIndex(),
+        std::optional<size_t> skipped_row = std::nullopt                                                            //Строка, не участвующая в поиске
+    );
  
                                                                                             
-    std::optional<size_t> MoveItem(       //  parent   .         
-        size_t row_from,                                                                                // 
-        size_t row_before,                                                                              //,     
+    std::optional<size_t> MoveItem(       //Перемещение потомка parent на новую позицию. Возвращает обновленый индекс позиции с учётом сдвига соседних элементов
+        size_t row_from,                                                                                //Исходный индекс
+        size_t row_before,                                                                              //Позиция, перед которой будет произведена вставка
         const QModelIndex& parent = QModelIndex()
     );   
 
@@ -106,20 +135,36 @@ public:
     QModelIndex InsertEmployeeItem(const Employee& source, const QModelIndex& department, size_t pos);
     bool RemoveEmployeeItem(const QModelIndex& department, size_t pos);                    
     Memento DumpEmployeeItem(const QModelIndex& department, size_t pos);
-    bool RestoreEmployeeItem(Memento&& item, const Employee* new_node = nullptr);                       //  
+    bool RestoreEmployeeItem(Memento&& item, const Employee* new_node = nullptr);                       //Если узел изменён
+
+    QModelIndex LocateEmployee(const Department& department, const Employee& employee);                //Заполняет нераскрытое подразделение; невалидный индекс, если узла нет в дереве
 
 
     static QString FullNameRefToQString(const wrapper::FullNameRef& name);
+private:
+    struct ChildEntry {                                                                     //Узел XML-дерева, ожидаемый в списке потомков
+        CompanyTreeItem::name_key_t name_key;
+        wrapper_node_ptr node;
+    };
 private:
     static tree_item_holder build_company_tree(const Company& company);
     static tree_item_holder build_department_tree(const Department&  department, CompanyTreeItem* parent);
-    static tree_item_holder build_employee_tree(
-        const Employee& employee,
-        wrapper::string_ref department_name,
-        CompanyTreeItem* parent         
+    static tree_item_holder build_employee_tree(const Employee& employee, CompanyTreeItem* parent);
+    static void build_staff(CompanyTreeItem& department);
+
+    static tree_item_holder build_child(const wrapper_node_ptr& node, CompanyTreeItem* parent);
+    static void detach_branch(CompanyTreeItem& item) noexcept;
+    static const Department* get_department(const CompanyTreeItem& item) noexcept;              //nullptr, если элемент - не подразделение либо отвязан
+
+    bool fetch_employees(CompanyTreeItem& department, const QModelIndex& department_idx);     //false, если сотрудники уже были созданы
+    void synchronize_children(
+        CompanyTreeItem& parent, 
+        const QModelIndex& parent_idx, 
+        const std::vector<ChildEntry>& entries                                              //В требуемом порядке
     );
+    void remove_children(CompanyTreeItem& parent, const QModelIndex& parent_idx, size_t first, size_t last);
 
-    CompanyTreeItem* get_item(const QModelIndex& index) const;                              //    
+    CompanyTreeItem* get_item(const QModelIndex& index) const;                              //Получение элемента по модельному индексу
 private:
-    tree_item_holder m_root_item{ MakeDummyObjectHolder<CompanyTreeItem>() };               // 
+    tree_item_holder m_root_item{ MakeDummyObjectHolder<CompanyTreeItem>() };               //Корневой элемент
 };
\ No newline at end of file
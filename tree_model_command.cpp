@@ -11,20 +11,20 @@ namespace command {
 		{
 		}
 
-		std::any InsertDepartment::Execute() {
+		result_t<CompanyTreeModel> InsertDepartment::Execute() {
 			auto& tree_model{ get_target() };
 			QModelIndex q_idx{
 				tree_model.InsertDepartmentItem(
 					get_company().at(
 						get_department_name()
 					),
-					get_department_position()			//   
+					get_department_position()			//Вставка в указанную позицию
 				)
 			};
-			return q_idx.isValid();								//  m_department  
+			return q_idx.isValid();								//Сохраняем в m_department наименование подразделения
 		}
 
-		std::any InsertDepartment::Cancel() {
+		result_t<CompanyTreeModel> InsertDepartment::Cancel() {
 			auto& tree_model{ get_target() };
 			return tree_model.RemoveDepartmentItem(get_department_position());
 		}
@@ -44,27 +44,19 @@ namespace command {
 
 		RenameDepartment::RenameDepartment(
 			CompanyTreeModel& ctm,
-			size_t pos,
-			QString new_name
-		) : MyBase(ctm),
-			m_name(std::move(new_name)),
+			size_t pos
+		) noexcept : MyBase(ctm),
 			m_pos(pos)
 		{
 		}
 
-		std::any RenameDepartment::Execute() {
+		result_t<CompanyTreeModel> RenameDepartment::Execute() {
 			auto& tree_model{ get_target() };
-			QModelIndex q_idx{ tree_model.DepartmentIndex(m_pos) };
-			auto old_name{ tree_model.ExchangeItemName(q_idx, m_name) };		//  CoW
-			if (!old_name) {
-				return false;
-			}
-			m_name = std::move(*old_name);
-			return true;
+			return tree_model.RefreshItemName(tree_model.DepartmentIndex(m_pos));	//Новое имя уже записано в XML-дерево
 		}
 
-		std::any RenameDepartment::Cancel() {
-			return Execute();													//let's swap
+		result_t<CompanyTreeModel> RenameDepartment::Cancel() {
+			return Execute();													//Предыдущее имя восстанавливается в XML-дереве
 		}
 
 		Type RenameDepartment::GetType() const noexcept {
@@ -73,29 +65,28 @@ namespace command {
 
 		RenameDepartment::command_holder RenameDepartment::make_instance(
 			CompanyTreeModel& ctm,
-			size_t row,
-			QString new_name
+			size_t row
 		) {
-			return allocate_instance(ctm, row, std::move(new_name));
+			return allocate_instance(ctm, row);
 		}
 
 		RemoveDepartment::RemoveDepartment(
 			CompanyTreeModel& ctm,
 			const CompanyManager& company_manager,
-			wrapper::string_ref department_name,							//    
+			wrapper::string_ref department_name,							//Для обновления указателя на подразделение
 			size_t pos
 		) noexcept : MyBase(ctm, company_manager, department_name, pos)
 		{
 		}
 
-		std::any RemoveDepartment::Execute() {
+		result_t<CompanyTreeModel> RemoveDepartment::Execute() {
 			m_branch = get_target().DumpDepartmentItem(
 				get_department_position()
 			);
 			return make_default_value();
 		}
 
-		std::any RemoveDepartment::Cancel() {
+		result_t<CompanyTreeModel> RemoveDepartment::Cancel() {
 			return get_target().RestoreDepartmentItem(
 				std::move(*m_branch),
 				std::addressof(get_company().at(get_department_name()))
@@ -125,34 +116,42 @@ namespace command {
 		}
 
 
-		std::any ChangeEmployeeFullName::Execute() {
+		result_t<CompanyTreeModel> ChangeEmployeeFullName::Execute() {
 			auto& tree_model(get_target());
 			QModelIndex department_idx(get_department_index());
-			if (!m_employee_cached_insert_pos) {										//   
-				m_employee_cached_insert_pos = upper_bound_by_full_name(department_idx, m_full_name);
+			if (tree_model.canFetchMore(department_idx)) {								//Сотрудники подразделения ещё не созданы и будут построены
+				return QModelIndex();													//по XML-дереву, где ФИО уже изменено
 			}
-
-			m_full_name = *tree_model.ExchangeItemName(									//    
-				tree_model.EmployeeIndex(department_idx, m_personal_info.employee_pos),
-				std::move(m_full_name)
+			if (!m_employee_cached_insert_pos) {										//Поиск позиции для вставки. Сам сотрудник в поиске не участвует:
+				m_employee_cached_insert_pos = upper_bound_by_full_name(				//его отображаемое имя уже вычисляется по новому ФИО
+					department_idx, 
+					m_full_name, 
+					m_personal_info.employee_pos
+				);
+			}
+			tree_model.RefreshItemName(
+				tree_model.EmployeeIndex(department_idx, m_personal_info.employee_pos)
 			);
-			std::swap(*m_employee_cached_insert_pos, m_personal_info.employee_pos);			//  cached -  
-			size_t result{
-				*tree_model.MoveItem(												//..  UpperBound,    
+			std::swap(*m_employee_cached_insert_pos, m_personal_info.employee_pos);		//Теперь в cached - предыдущая позиция
+			std::optional<size_t> result{
+				tree_model.MoveItem(
 				*m_employee_cached_insert_pos,
 				m_personal_info.employee_pos,											
 				department_idx)
 			};
-			if (result < m_personal_info.employee_pos) {
-				m_personal_info.employee_pos = result;
+			if (!result) {																//Позиция не изменилась
+				m_personal_info.employee_pos = *m_employee_cached_insert_pos;
+			}
+			else if (*result < m_personal_info.employee_pos) {
+				m_personal_info.employee_pos = *result;
 			}
 			else {										
-				*m_employee_cached_insert_pos += 1;				//   ,          
+				*m_employee_cached_insert_pos += 1;				//Смещаем индекс для вставки, если целевая и итоговая с учетом сдвига элементов позиция совпали
 			}																			
-			return tree_model.EmployeeIndex(department_idx, m_personal_info.employee_pos);	//  
+			return tree_model.EmployeeIndex(department_idx, m_personal_info.employee_pos);	//Возвращаем обновленный индекс
 		}
 
-		std::any ChangeEmployeeFullName::Cancel() {
+		result_t<CompanyTreeModel> ChangeEmployeeFullName::Cancel() {
 			return Execute();
 		}
 
@@ -175,17 +174,17 @@ namespace command {
 			const Employee& employee
 		) noexcept : MyBase(
 			ctm, wrapper_info, 
-			EmployeePersonalFile{ department_pos, 0 }				//  
+			EmployeePersonalFile{ department_pos, 0 }				//Позиция пока неизвестна
 		),	
 			m_employee_ptr(std::addressof(employee))
 		{
 		}
 		
-		std::any InsertEmployee::Execute() {
+		result_t<CompanyTreeModel> InsertEmployee::Execute() {
 			auto& tree_model{ get_target() };
 			const Employee* emp_ptr;
-			if (m_employee_ptr) {					//     Execute() , ..      
-				emp_ptr = m_employee_ptr;			//     XML-
+			if (m_employee_ptr) {					//Хранить указатель после первого выполнения Execute() нельзя, т.к. после отмены операции при последующем повторе
+				emp_ptr = m_employee_ptr;			//элемент будет заново вставлен в XML-дерево
 				m_employee_name = emp_ptr->GetFullName();
 				m_employee_ptr = nullptr;
 			}
@@ -201,14 +200,20 @@ namespace command {
 							get_full_name()
 					)
 			);
-			return tree_model.InsertEmployeeItem(
-				*emp_ptr,
-				department_q_idx,
-				m_personal_info.employee_pos
-			).isValid();
+			QModelIndex employee_q_idx{
+				tree_model.InsertEmployeeItem(
+					*emp_ptr,
+					department_q_idx,
+					m_personal_info.employee_pos
+				)
+			};
+			if (employee_q_idx.isValid()) {										//При заполнении ещё не раскрытого подразделения
+				m_personal_info.employee_pos = employee_q_idx.row();			//сотрудник может оказаться в другой позиции
+			}
+			return employee_q_idx.isValid();
 		}
 
-		std::any InsertEmployee::Cancel() {
+		result_t<CompanyTreeModel> InsertEmployee::Cancel() {
 			return get_target().RemoveEmployeeItem(				
 				get_department_index(),
 				m_personal_info.employee_pos
@@ -242,7 +247,7 @@ namespace command {
 		{
 		}
 			
-		std::any RemoveEmployee::Execute() {									
+		result_t<CompanyTreeModel> RemoveEmployee::Execute() {									
 			QModelIndex department_q_idx{ get_department_index() };
 			if (!m_employee_name) {				
 				QModelIndex employee_q_idx{
@@ -251,8 +256,8 @@ namespace command {
 					m_personal_info.employee_pos
 				)
 			};		
-				m_employee_name = std::get<const Employee*>(					//   Execute()      , 
-						get_target().GetItemNode(employee_q_idx)		//      
+				m_employee_name = std::get<const Employee*>(					//На момент выполнения Execute() элемент модели и указатель еще валидны, 
+						get_target().GetItemNode(employee_q_idx)		//поскольку удаление из дерева данных выполняется позже
 					)->GetFullName();
 			}
 			m_branch = get_target().DumpEmployeeItem(						
@@ -262,8 +267,8 @@ namespace command {
 			 return make_default_value();
 		}
 
-		std::any RemoveEmployee::Cancel() {										// Remove-       
-			auto& tree_model{ get_target() };							//  ,      
+		result_t<CompanyTreeModel> RemoveEmployee::Cancel() {										//Для Remove-операций восстановление в дереве данных должно производиться раньше
+			auto& tree_model{ get_target() };							//восстановления в модели, чтобы можно было извлечь необходимые сведения
 			const Employee* emp_ptr{ get_employee_ptr(get_full_name()) };
 			return tree_model.RestoreEmployeeItem(
 				std::move(*m_branch),
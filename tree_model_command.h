@@ -11,6 +11,11 @@
 #include <string_view>
 
 namespace command {
+	template <>
+	struct result_traits<CompanyTreeModel> {
+		using type = basic_result<QModelIndex>;										//ChangeEmployeeFullName возвращает новый индекс элемента
+	};
+
 	namespace tree_model {
 		template <class ConcreteCommand>
 		class ModifyCommand : public AllocatedCommand<ConcreteCommand, CompanyTreeModel> {
@@ -63,11 +68,11 @@ namespace command {
 			InsertDepartment(
 				CompanyTreeModel& ctm, 
 				const CompanyManager& company_manager,
-				wrapper::string_ref department_name,							//    m_attributes XML-
+				wrapper::string_ref department_name,							//Исходная строка живёт в m_attributes XML-узла
 				size_t pos
 			) noexcept;
-			std::any Execute() override;										//return type: bool
-			std::any Cancel() override;											//return type: bool
+			result_t<CompanyTreeModel> Execute() override;						//return type: bool
+			result_t<CompanyTreeModel> Cancel() override;							//return type: bool
 			Type GetType() const noexcept override;
 			static command_holder make_instance(
 				CompanyTreeModel& ctm,
@@ -84,19 +89,16 @@ namespace command {
 		public:
 			RenameDepartment(
 				CompanyTreeModel& ctm,
-				size_t pos,														//QModelIndex  
-				QString new_name												//..     ,   QString
-			);
-			std::any Execute() override;										//return type: bool
-			std::any Cancel() override;											//return type: bool
+				size_t pos														//QModelIndex могут инвалидироваться
+			) noexcept;															//Имя отображается по узлу XML-дерева, команда лишь обновляет view'ы
+			result_t<CompanyTreeModel> Execute() override;						//return type: bool
+			result_t<CompanyTreeModel> Cancel() override;							//return type: bool
 			Type GetType() const noexcept override;
 			static command_holder make_instance(
 				CompanyTreeModel& ctm,
-				size_t pos,
-				QString new_name				
+				size_t pos
 			);
 		private:
-			QString m_name;
 			size_t m_pos{ 0 };
 		};
 
@@ -108,11 +110,11 @@ namespace command {
 			RemoveDepartment(
 				CompanyTreeModel& ctm,
 				const CompanyManager& company_manager,
-				wrapper::string_ref department_name,							//    
+				wrapper::string_ref department_name,							//Для обновления указателя на подразделение
 				size_t pos
 			) noexcept;
-			std::any Execute() override;										//return type: empty std::any
-			std::any Cancel() override;											//return type: bool
+			result_t<CompanyTreeModel> Execute() override;						//return type: std::monostate
+			result_t<CompanyTreeModel> Cancel() override;							//return type: bool
 			Type GetType() const noexcept override;
 			static command_holder make_instance(
 				CompanyTreeModel& ctm,
@@ -145,9 +147,11 @@ namespace command {
                 return MyBase::get_target().DepartmentIndex(m_personal_info.department_pos);
 			}
 			size_t upper_bound_by_full_name(
-				const QModelIndex& department, const QString& full_name
+				const QModelIndex& department, 
+				const QString& full_name,
+				std::optional<size_t> skipped_pos = std::nullopt
 			) const {
-                return *MyBase::get_target().UpperBoundChild(full_name, department);			//    
+                return *MyBase::get_target().UpperBoundChild(full_name, department, skipped_pos);	//Поиск позиции для вставки сотрудника
 			}
 		protected:
 			EmployeePersonalFile m_personal_info;
@@ -160,11 +164,11 @@ namespace command {
 		public:
 			ChangeEmployeeFullName(
 				CompanyTreeModel& ctm,
-				EmployeePersonalFile personal_info,						//QModelIndex      -    !
+				EmployeePersonalFile personal_info,						//QModelIndex может инвалидироваться при удалении элементов - на него полагаться нельзя!
 				QString new_full_name
 			) noexcept;
-			std::any Execute() override;								//return type: new QModelIndex
-			std::any Cancel() override;									//return type: new QModelIndex
+			result_t<CompanyTreeModel> Execute() override;				//return type: new QModelIndex
+			result_t<CompanyTreeModel> Cancel() override;					//return type: new QModelIndex
 			Type GetType() const noexcept override;
 			static command_holder make_instance(
 				CompanyTreeModel& ctm,
@@ -172,11 +176,11 @@ namespace command {
 				QString new_full_name
 			);
 		protected:
-			std::optional<size_t> m_employee_cached_insert_pos;			//       
+			std::optional<size_t> m_employee_cached_insert_pos;			//Кэширование позиции для ускорения операций отмены и повтора
 			QString m_full_name;
 		};
 
-		struct WrapperInfo {											//,  ,    -  
+		struct WrapperInfo {											//Ничего, кроме имён, хранить не можем из-за риска инвалидации
 			const wrapper::Company* company;	
 			wrapper::string_ref department_name;
 		};
@@ -198,14 +202,14 @@ namespace command {
 			}
 		protected:
 			const wrapper::FullNameRef& get_full_name() const {	
-				return m_employee_name.value();									//  ,    Employee
+				return m_employee_name.value();									//Имя не инвалидируется, пока жив объект Employee
 			}
 			const Employee* get_employee_ptr(const wrapper::FullNameRef& full_name) const {
 				return std::addressof(m_wrapper_info.company->at(m_wrapper_info.department_name).at(full_name));
 			}
 		protected:
 			WrapperInfo m_wrapper_info;									
-			std::optional<wrapper::FullNameRef> m_employee_name;				//   department
+			std::optional<wrapper::FullNameRef> m_employee_name;				//Для поиска в department
 		};
 
 		class InsertEmployee : public Recruiter<InsertEmployee> {
@@ -217,10 +221,10 @@ namespace command {
 				CompanyTreeModel& ctm,
 				const WrapperInfo& wrapper_info,
 				size_t department_pos,
-				const Employee& employee										//  
+				const Employee& employee										//Для первой вставки
 			) noexcept;
-			std::any Execute() override;										//return type: bool
-			std::any Cancel() override;											//return type: bool
+			result_t<CompanyTreeModel> Execute() override;						//return type: bool
+			result_t<CompanyTreeModel> Cancel() override;							//return type: bool
 			Type GetType() const noexcept override;
 			static command_holder make_instance(
 				CompanyTreeModel& ctm,
@@ -240,10 +244,10 @@ namespace command {
 			RemoveEmployee(
 				CompanyTreeModel& ctm,
 				const WrapperInfo& wrapper_info,
-				const QModelIndex& employee_q_idx								//      EmployeePersonalFile
+				const QModelIndex& employee_q_idx								//Из модельного индекса извлечём данные для EmployeePersonalFile
 			) noexcept;
-			std::any Execute() override;										//return type: empty std::any
-			std::any Cancel() override;											//return type: bool
+			result_t<CompanyTreeModel> Execute() override;						//return type: std::monostate
+			result_t<CompanyTreeModel> Cancel() override;							//return type: bool
 			Type GetType() const noexcept override;
 			static command_holder make_instance(
 				CompanyTreeModel& ctm,
@@ -0,0 +1,58 @@
+#include "atom_table.h"
+#include <cassert>
+using namespace std;
+
+namespace xml {
+	atom_t AtomTable::Intern(string_view name) {
+		if (auto it = m_lookup.find(name); it != m_lookup.end()) {
+			return it->second;
+		}
+		auto atom{ static_cast<atom_t>(m_names.size()) };
+		const string& stored{ m_names.emplace_back(name) };
+		m_lookup.emplace(stored, atom);
+		return atom;
+	}
+
+	optional<atom_t> AtomTable::Find(string_view name) const noexcept {
+		if (auto it = m_lookup.find(name); it != m_lookup.end()) {
+			return it->second;
+		}
+		return nullopt;
+	}
+
+	const string& AtomTable::Resolve(atom_t atom) const noexcept {
+		assert(atom < m_names.size() && "Unknown atom");
+		return m_names[atom];
+	}
+
+	size_t AtomTable::Size() const noexcept {
+		return m_names.size();
+	}
+
+	size_t AtomTable::MemoryUsage() const noexcept {
+		static const size_t sso_capacity{ string{}.capacity() };
+		size_t usage{ m_lookup.bucket_count() * sizeof(void*) };
+		for (const auto& name : m_names) {
+			usage += sizeof(string) + (name.capacity() > sso_capacity ? name.capacity() + 1 : 0)
+				+ sizeof(decltype(m_lookup)::value_type) + sizeof(void*);			//Строка и узел хеш-таблицы
+		}
+		for (const auto& [names, atoms] : m_vocabularies) {
+			usage += sizeof(decltype(m_vocabularies)::value_type) + atoms.capacity() * sizeof(atom_t);
+		}
+		return usage;
+	}
+
+	const vector<atom_t>& AtomTable::intern_vocabulary(const string_view* names, size_t count) {
+		for (const auto& [key, atoms] : m_vocabularies) {
+			if (key == names) {
+				return atoms;
+			}
+		}
+		vector<atom_t> atoms;
+		atoms.reserve(count);
+		for (size_t idx = 0; idx < count; ++idx) {
+			atoms.push_back(Intern(names[idx]));
+		}
+		return m_vocabularies.emplace_back(names, move(atoms)).second;
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <array>
+#include <deque>
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <optional>
+#include <cstdint>
+
+namespace xml {
+	using atom_t = uint32_t;
+
+	/***********************************************************
+	AtomTable - таблица интернированных имён узлов и атрибутов
+	одного документа. Каждое имя хранится однократно, узлы
+	держат лишь его 32-битный номер (атом), поэтому сравнение
+	имён узлов одного документа сводится к сравнению чисел.
+	Атомы не удаляются до уничтожения таблицы, ссылки на имена
+	остаются действительными всё это время.
+
+	Потокобезопасность - как у самого дерева: Intern() изменяет
+	таблицу и допустим лишь там, где допустимо изменение узлов
+	************************************************************/
+
+	class AtomTable {
+	public:
+		AtomTable() = default;
+		AtomTable(const AtomTable&) = delete;										//Ключи m_lookup ссылаются на строки m_names
+		AtomTable& operator=(const AtomTable&) = delete;
+		AtomTable(AtomTable&&) = default;											//Элементы deque при перемещении не переносятся
+		AtomTable& operator=(AtomTable&&) = default;
+
+		atom_t Intern(std::string_view name);
+		std::optional<atom_t> Find(std::string_view name) const noexcept;
+		const std::string& Resolve(atom_t atom) const noexcept;
+
+		template <size_t N>
+		const std::vector<atom_t>& InternVocabulary(const std::array<std::string_view, N>& names) {	//names должен иметь статическое время жизни:
+			return intern_vocabulary(names.data(), N);												//набор атомов кэшируется по его адресу до уничтожения таблицы
+		}
+
+		size_t Size() const noexcept;
+		size_t MemoryUsage() const noexcept;										//Приблизительный объём памяти (в байтах) без sizeof(AtomTable)
+	private:
+		const std::vector<atom_t>& intern_vocabulary(const std::string_view* names, size_t count);
+	private:
+		std::deque<std::string> m_names;											//Индекс - атом; адреса строк не меняются при добавлении
+		std::unordered_map<std::string_view, atom_t> m_lookup;
+		std::deque<std::pair<const std::string_view*, std::vector<atom_t>>> m_vocabularies;	//Единицы словарей - линейный поиск быстрее хеширования;
+																								//элементы deque не перемещаются при добавлении, ссылки на наборы действительны
+	};
+}
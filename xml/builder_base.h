@@ -12,7 +12,7 @@ namespace xml {
 	public:
 		ConcreteBuilder& SetAllocator(allocator_holder alloc) {
 			m_allocator = std::move(alloc);
-			return get_context<ConcreteBuilder>();				// get_context<ConcreteBuilder>() - protected,       BuilderBase
+			return get_context<ConcreteBuilder>();				//Поскольку get_context<ConcreteBuilder>() - protected, обратиться к ней смогут только наследники BuilderBase
 		}
 
 		ConcreteBuilder& Reset() {
@@ -22,7 +22,7 @@ namespace xml {
 
 	protected:
 		template <class OtherBuilder>
-		std::enable_if_t<										// 
+		std::enable_if_t<										//Дополнительная проверка
 			std::is_base_of_v<BuilderBase, OtherBuilder>, 
 			OtherBuilder&> get_context() {
 			return static_cast<OtherBuilder&>(*this);
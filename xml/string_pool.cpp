@@ -0,0 +1,98 @@
+#include "string_pool.h"
+#include <utility>
+using namespace std;
+
+namespace xml {
+	SharedText::SharedText(StringPool& pool, Entry& entry) noexcept
+		: m_pool(addressof(pool)),
+		m_entry(addressof(entry))
+	{
+		++m_entry->references;
+		++m_pool->m_references;
+	}
+
+	SharedText::SharedText(const SharedText& other) noexcept
+		: m_pool(other.m_pool),
+		m_entry(other.m_entry)
+	{
+		if (m_entry) {
+			++m_entry->references;
+			++m_pool->m_references;
+		}
+	}
+
+	SharedText::SharedText(SharedText&& other) noexcept
+		: m_pool(exchange(other.m_pool, nullptr)),
+		m_entry(exchange(other.m_entry, nullptr))
+	{
+	}
+
+	SharedText& SharedText::operator=(const SharedText& other) noexcept {
+		if (this != addressof(other)) {
+			SharedText copy(other);
+			*this = move(copy);
+		}
+		return *this;
+	}
+
+	SharedText& SharedText::operator=(SharedText&& other) noexcept {
+		if (this != addressof(other)) {
+			release();
+			m_pool = exchange(other.m_pool, nullptr);
+			m_entry = exchange(other.m_entry, nullptr);
+		}
+		return *this;
+	}
+
+	SharedText::~SharedText() {
+		release();
+	}
+
+	const string& SharedText::Get() const noexcept {
+		return m_entry->value;
+	}
+
+	void SharedText::release() noexcept {
+		if (m_entry) {
+			m_pool->release(*exchange(m_entry, nullptr));
+			m_pool = nullptr;
+		}
+	}
+
+	SharedText StringPool::Acquire(string_view value) {
+		auto it{ m_entries.find(value) };
+		if (it == m_entries.end()) {
+			auto entry{ make_unique<SharedText::Entry>() };
+			entry->value.assign(value);
+			string_view key{ entry->value };
+			it = m_entries.emplace(key, move(entry)).first;
+		}
+		return SharedText(*this, *it->second);
+	}
+
+	size_t StringPool::Size() const noexcept {
+		return m_entries.size();
+	}
+
+	size_t StringPool::References() const noexcept {
+		return m_references;
+	}
+
+	size_t StringPool::MemoryUsage() const noexcept {
+		static const size_t sso_capacity{ string{}.capacity() };
+		size_t usage{ m_entries.bucket_count() * sizeof(void*) };
+		for (const auto& [key, entry] : m_entries) {
+			usage += sizeof(decltype(m_entries)::value_type) + 2 * sizeof(void*)		//Узел хеш-таблицы с кэшированным хешем
+				+ sizeof(SharedText::Entry)
+				+ (entry->value.capacity() > sso_capacity ? entry->value.capacity() + 1 : 0);
+		}
+		return usage;
+	}
+
+	void StringPool::release(SharedText::Entry& entry) noexcept {
+		--m_references;
+		if (!--entry.references) {
+			m_entries.erase(string_view(entry.value));									//Ключ разрушается вместе с записью
+		}
+	}
+}
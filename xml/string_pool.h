@@ -0,0 +1,65 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <memory>
+
+namespace xml {
+	class StringPool;
+
+	class SharedText {																//Ссылка на строку пула; копирование лишь увеличивает счётчик
+	public:
+		SharedText(const SharedText& other) noexcept;
+		SharedText(SharedText&& other) noexcept;
+		SharedText& operator=(const SharedText& other) noexcept;
+		SharedText& operator=(SharedText&& other) noexcept;
+		~SharedText();
+
+		const std::string& Get() const noexcept;
+	private:
+		friend class StringPool;
+		struct Entry {
+			std::string value;
+			size_t references{ 0 };
+		};
+		SharedText(StringPool& pool, Entry& entry) noexcept;
+		void release() noexcept;
+	private:
+		StringPool* m_pool{ nullptr };
+		Entry* m_entry{ nullptr };
+	};
+
+	/***********************************************************
+	StringPool - пул значений с подсчётом ссылок, общий для узлов
+	одного документа. Одинаковые значения хранятся однократно;
+	строка удаляется вместе с последней ссылкой на неё. Узел,
+	хранящий SharedText, при изменении текста получает
+	собственную копию (copy-on-write), остальные узлы видят
+	прежнее значение.
+
+	Экономия возможна лишь для строк длиннее буфера SSO:
+	короткие значения std::string и так хранит без кучи.
+	Потокобезопасность - как у дерева и AtomTable
+	************************************************************/
+
+	class StringPool {
+	public:
+		StringPool() = default;
+		StringPool(const StringPool&) = delete;										//SharedText ссылаются на пул по адресу
+		StringPool& operator=(const StringPool&) = delete;
+		StringPool(StringPool&&) = delete;
+		StringPool& operator=(StringPool&&) = delete;
+
+		SharedText Acquire(std::string_view value);
+
+		size_t Size() const noexcept;												//Различные значения
+		size_t References() const noexcept;											//Действующие SharedText
+		size_t MemoryUsage() const noexcept;										//Приблизительный объём памяти (в байтах) без sizeof(StringPool)
+	private:
+		friend class SharedText;
+		void release(SharedText::Entry& entry) noexcept;
+	private:
+		std::unordered_map<std::string_view, std::unique_ptr<SharedText::Entry>> m_entries;	//Ключ ссылается на строку записи
+		size_t m_references{ 0 };
+	};
+}
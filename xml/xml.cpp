@@ -3,45 +3,82 @@ using namespace std;
 
 namespace xml {
 	Node::Node(Header header, allocator_weak alloc)
-		: m_header(move(header)),
-		m_allocator(move(alloc))
+		: m_tree(alloc.lock().get()),
+		m_allocator(move(alloc)),
+		m_name(GetAtoms().Intern(header.name))
 	{
+		m_attributes.reserve(header.attributes.size());
+		for (auto& [name, value] : header.attributes) {
+			AddAttribute(move(name), move(value));
+		}
 	}
 
 	Node::Type Node::GetType() const noexcept {
-		return static_cast<Type>(m_body.index());
+		return holds_alternative<SharedText>(m_body) ?
+			Type::Element : static_cast<Type>(m_body.index());
 	}
 
-	void Node::ChangeName(text_t new_name) noexcept {
-		m_header.name = move(new_name);
+	void Node::ChangeName(string_view new_name) {
+		m_name = GetAtoms().Intern(new_name);
 	}
 
 	const text_t& Node::GetName() const noexcept {
-		return m_header.name;
+		return GetAtoms().Resolve(m_name);
+	}
+
+	atom_t Node::GetAtom() const noexcept {
+		return m_name;
+	}
+
+	bool Node::IsNamed(const AtomTable& atoms, atom_t name) const noexcept {
+		return addressof(GetAtoms()) == addressof(atoms) ?
+			m_name == name : GetName() == atoms.Resolve(name);
+	}
+
+	AtomTable& Node::GetAtoms() noexcept {
+		return m_tree->GetAtoms();
+	}
+
+	const AtomTable& Node::GetAtoms() const noexcept {
+		return m_tree->GetAtoms();
 	}
 
 	void Node::AddAttribute(text_t name, text_t value) {
-		m_header.attributes.emplace(move(name), move(value));
+		atom_t atom{ GetAtoms().Intern(name) };
+		if (!find_attribute(atom)) {												//Как и emplace() в ассоциативном контейнере
+			m_attributes.emplace_back(atom, move(value));
+		}
 	}
 
 	void Node::AddAttribute(attribute_holder attr) {
-		m_header.attributes.insert(move(attr));
+		AddAttribute(move(attr.first), move(attr.second));
 	}
 
 	size_t Node::AttributesCount() const noexcept{ 
-		return m_header.attributes.size();
+		return m_attributes.size();
 	}
 
 	Node::attribute_range Node::GetAttributes() const noexcept {
-		return { m_header.attributes.begin(), m_header.attributes.end() };
+		return { m_attributes.begin(), m_attributes.end() };
 	}
 
-	text_t& Node::operator[](const text_t& attr_name) {
-		return m_header.attributes[attr_name];
+	text_t& Node::operator[](string_view attr_name) {
+		atom_t atom{ GetAtoms().Intern(attr_name) };
+		if (text_t* value = find_attribute(atom); value) {
+			return *value;
+		}
+		return m_attributes.emplace_back(atom, text_t{}).second;
 	}
 
-	const text_t& Node::at(const text_t& attr_name) const {
-		return m_header.attributes.at(attr_name);
+	const text_t& Node::at(string_view attr_name) const {
+		const text_t* value{ nullptr };
+		if (auto atom = GetAtoms().Find(attr_name); atom) {
+			value = find_attribute(*atom);
+		}
+		if (!value) {
+			throw out_of_range("Attribute not found");								//Как и unordered_map::at()
+		}
+		return *value;
 	}
 
 	void Node::Reset() {
@@ -65,10 +102,16 @@ namespace xml {
 	}
 
 	text_t& Node::AsText() {
+		if (auto* shared = get_if<SharedText>(addressof(m_body)); shared) {		//Копирование при записи: у других узлов остаётся значение пула
+			m_body = shared->Get();
+		}
 		return get<text_t>(m_body);
 	}
 
 	const text_t& Node::AsText() const {
+		if (auto* shared = get_if<SharedText>(addressof(m_body)); shared) {
+			return shared->Get();
+		}
 		return get<text_t>(m_body);
 	}
 
@@ -80,6 +123,14 @@ namespace xml {
 		m_body = ""s;
 	}
 
+	void Node::ShareText(string_view value) {
+		m_body = m_tree->GetStrings().Acquire(value);
+	}
+
+	bool Node::IsSharedText() const noexcept {
+		return holds_alternative<SharedText>(m_body);
+	}
+
 	container_t& Node::AsContainer() {
 		return get<container_t>(m_body);
 	}
@@ -104,6 +155,60 @@ namespace xml {
 		return m_allocator.lock();
 	}
 
+	size_t Node::MemoryUsage() const noexcept {
+		size_t usage{ sizeof(Node) + m_attributes.capacity() * sizeof(attribute_t) };	//Имена учитываются в таблице атомов документа
+		for (const auto& [name, value] : m_attributes) {
+			usage += dynamic_size(value);
+		}
+		switch (GetType()) {
+		case Type::Element: usage += IsSharedText() ? 0 : dynamic_size(AsText()); break;	//Разделяемый текст учитывается в пуле документа
+		case Type::Tree: {
+			const auto& children{ AsContainer() };
+			usage += children.capacity() * sizeof(node_holder);
+			for (const auto& child : children) {
+				usage += child->MemoryUsage();
+			}
+			break;
+		}
+		default: break;
+		}
+		return usage;
+	}
+
+	text_t* Node::find_attribute(atom_t name) noexcept {
+		for (auto& [attr_name, value] : m_attributes) {
+			if (attr_name == name) {
+				return addressof(value);
+			}
+		}
+		return nullptr;
+	}
+
+	const text_t* Node::find_attribute(atom_t name) const noexcept {
+		return const_cast<Node*>(this)->find_attribute(name);
+	}
+
+	size_t Node::dynamic_size(const text_t& str) noexcept {
+		static const size_t sso_capacity{ text_t{}.capacity() };					//Короткие строки хранятся внутри объекта и не занимают кучу
+		return str.capacity() > sso_capacity ? str.capacity() + 1 : 0;
+	}
+
+	AtomTable& TreeAllocator::GetAtoms() noexcept {
+		return m_atoms;
+	}
+
+	const AtomTable& TreeAllocator::GetAtoms() const noexcept {
+		return m_atoms;
+	}
+
+	StringPool& TreeAllocator::GetStrings() noexcept {
+		return m_strings;
+	}
+
+	const StringPool& TreeAllocator::GetStrings() const noexcept {
+		return m_strings;
+	}
+
 	Document::Document(
 		node_holder declaration,
 		node_holder root,
@@ -131,6 +236,14 @@ namespace xml {
 		return m_tree_allocator;
 	}
 
+	const AtomTable& Document::GetAtoms() const noexcept {
+		return m_tree_allocator->GetAtoms();
+	}
+
+	const StringPool& Document::GetStrings() const noexcept {
+		return m_tree_allocator->GetStrings();
+	}
+
 	DocumentBuilder& DocumentBuilder::SetDeclaration(node_holder new_declaration) {
 		m_declaration = move(new_declaration);
 		return *this;
@@ -2,6 +2,8 @@
 #include "range.h"				//iterator range
 #include "pool_allocator.h"		//allocator for nodes
 #include "xml_exceptions.h"
+#include "atom_table.h"		//interned names
+#include "string_pool.h"		//shared text values
 
 
 #include <string>	
@@ -17,17 +19,18 @@
 
 namespace xml {
 	class Node;
+	class TreeAllocator;
 
 	using empty_t = std::monostate;
-	using service_block_t = uintmax_t;														//2x4  2x8 
+	using service_block_t = uintmax_t;														//2x4 или 2x8 байт
 	using service_t = std::pair<service_block_t, std::optional<service_block_t>>;		
 	using text_t = std::string;
-	using property_map = std::unordered_map<text_t, text_t>;
+	using attribute_holder = std::pair<text_t, text_t>;
+	using property_map = std::vector<attribute_holder>;								//Атрибуты до создания узла в порядке документа; из повторов действует первый
 	using deleter_t = std::function<void(Node*)>;
 	using node_holder = std::unique_ptr<Node, deleter_t>;
 	using container_t = std::vector<node_holder>;
-	using attribute_holder = std::pair<text_t, text_t>;
-	using allocator_t = utility::memory::PoolAllocator<Node>;
+	using allocator_t = TreeAllocator;
 	using allocator_holder = std::shared_ptr<allocator_t>;
 	using allocator_weak = std::weak_ptr<allocator_t>;
 
@@ -37,7 +40,10 @@ namespace xml {
 			text_t name;
 			property_map attributes;
 		};
-		using attribute_it = property_map::const_iterator;
+		using attribute_t = std::pair<atom_t, text_t>;
+		using attribute_list = std::vector<attribute_t>;							//Атрибутов у узла единицы: вектор компактнее хеш-таблицы и сохраняет порядок;
+																					//ссылки на значения действительны до добавления нового атрибута
+		using attribute_it = attribute_list::const_iterator;
 		using attribute_range = Range<attribute_it>;
 
 	public:
@@ -63,16 +69,21 @@ namespace xml {
 		Type GetType() const noexcept;	
 
 		const text_t& GetName() const noexcept;
-		void ChangeName(text_t new_name) noexcept;
+		atom_t GetAtom() const noexcept;
+		bool IsNamed(const AtomTable& atoms, atom_t name) const noexcept;			//Сравнение атомов; для узла из другого документа - сравнение строк
+		void ChangeName(std::string_view new_name);
+
+		AtomTable& GetAtoms() noexcept;												//Таблица имён документа, в котором создан узел
+		const AtomTable& GetAtoms() const noexcept;
 
 		size_t AttributesCount() const noexcept;
-		attribute_range GetAttributes() const noexcept;
+		attribute_range GetAttributes() const noexcept;								//Имена атрибутов - атомы GetAtoms()
 
 		void AddAttribute(text_t name, text_t value);
 		void AddAttribute(attribute_holder attr);
 
-		text_t& operator[](const text_t& attr_name);
-		const text_t& at(const text_t& attr_name) const;
+		text_t& operator[](std::string_view attr_name);
+		const text_t& at(std::string_view attr_name) const;
 
 		void Reset();
 		
@@ -81,10 +92,12 @@ namespace xml {
 		void SetService(service_t new_nalue) noexcept;
 		void ResetAsService();
 
-		text_t& AsText();
+		text_t& AsText();															//Разделяемый текст предварительно копируется в узел
 		const text_t& AsText() const;
 		void SetText(text_t new_nalue) noexcept;
 		void ResetAsText();
+		void ShareText(std::string_view value);										//Текст в пуле документа; тип узла - Element
+		bool IsSharedText() const noexcept;
 
 		container_t& AsContainer();
 		const container_t& AsContainer() const;	
@@ -93,25 +106,51 @@ namespace xml {
 
 		void Clear() noexcept;
 		allocator_holder GetAllocator() const noexcept;
+
+		size_t MemoryUsage() const noexcept;										//Приблизительный объём памяти (в байтах), занимаемой узлом и его потомками
+	private:
+		text_t* find_attribute(atom_t name) noexcept;
+		const text_t* find_attribute(atom_t name) const noexcept;
+		static size_t dynamic_size(const text_t& str) noexcept;
 	private:
-		Header m_header;
+		TreeAllocator* m_tree;														//Аллокатор переживает узел: им владеет deleter
+		attribute_list m_attributes;
 		allocator_weak m_allocator;
 		std::variant<
 			empty_t,
 			service_t,
 			text_t,
-			container_t> m_body;
+			container_t,
+			SharedText> m_body;
+		atom_t m_name;
+	};
+
+	class TreeAllocator : public utility::memory::PoolAllocator<Node> {			//Ресурсы, общие для всех узлов документа:
+	public:																			//пул узлов и таблица их имён
+		using MyBase = utility::memory::PoolAllocator<Node>;
+	public:
+		using MyBase::MyBase;
+
+		AtomTable& GetAtoms() noexcept;
+		const AtomTable& GetAtoms() const noexcept;
+		StringPool& GetStrings() noexcept;
+		const StringPool& GetStrings() const noexcept;
+	private:
+		AtomTable m_atoms;
+		StringPool m_strings;
 	};
 
 	class DocumentBuilder;
 
 	class Document {
 	public:
-		Document() = default;												//          
+		Document() = default;												//Для возможности создания пустого объекта и дальнейшего вызова оператора присваивания 
 		Node& GetRoot() noexcept;
 		const Node& GetDeclaration() const noexcept;
 		const Node& GetRoot() const noexcept;
 		allocator_holder GetAllocator() const noexcept;
+		const AtomTable& GetAtoms() const noexcept;
+		const StringPool& GetStrings() const noexcept;
 	private:
 		friend class DocumentBuilder;
 		Document(
@@ -8,7 +8,7 @@ namespace xml {
 	public:
 		using MyBase = BuilderBase<NodeBuilderBase<ConcreteBuilder>>;
 	public:
-		ConcreteBuilder& SetAllocator(allocator_holder alloc) {						//   BuilderBase    NodeBuilderBase  
+		ConcreteBuilder& SetAllocator(allocator_holder alloc) {						//Для возврата из BuilderBase ссылки на наследующие NodeBuilderBase классы 
 			MyBase::SetAllocator(move(alloc));
 			return MyBase::template get_context<ConcreteBuilder>();
 		}
@@ -19,7 +19,7 @@ namespace xml {
 		}
 
 		ConcreteBuilder& SetAttribute(std::string name, std::string value) {
-			m_attrs.emplace(move(name), move(value));
+			m_attrs.emplace_back(move(name), move(value));
 			return MyBase::template get_context<ConcreteBuilder>();
 		}
 
@@ -39,7 +39,7 @@ namespace xml {
 			return make_node_holder(
 				alloc,
 				Node::Header{ move(m_name), move(m_attrs) },
-				alloc												//  -       !
+				alloc												//Перемещать нельзя - порядок вычисления аргументов функции не регламентируется Стандартом!
 			);
 		}
 
@@ -79,15 +79,16 @@ namespace xml {
 	public:
 		using MyBase = NodeBuilderBase<NodeBuilder>;
 	public:
-		static node_holder Duplicate(const Node& source) {									//  
-			auto attrs_range{ source.GetAttributes() };
+		static node_holder Duplicate(const Node& source) {									//Копирование ветви дерева
+			property_map attrs;
+			attrs.reserve(source.AttributesCount());
+			for (const auto& [name, value] : source.GetAttributes()) {
+				attrs.emplace_back(source.GetAtoms().Resolve(name), value);
+			}
 			node_holder deep_copy {
 				make_node_holder(
 					source.GetAllocator(),
-					Node::Header{
-						source.GetName(),
-						property_map(attrs_range.begin(), attrs_range.end())
-					},
+					Node::Header{ source.GetName(), move(attrs) },
 					source.GetAllocator()
 				)
 			};
@@ -95,7 +96,7 @@ namespace xml {
 			return deep_copy;
 		}
 
-		static node_holder Take(Node&& source) {											//      
+		static node_holder Take(Node&& source) {											//Перемещение узла с принадлежащими ему ветвями дерева
 			allocator_holder alloc{ source.GetAllocator() };
 			return make_node_holder(
 				alloc,
@@ -107,7 +108,14 @@ namespace xml {
 		static void duplicate_value(Node& target, const Node& source) {									
 			switch (source.GetType()) {
 			case Node::Type::Service: target.SetService(source.AsService()); break;
-			case Node::Type::Element: target.SetText(source.AsText()); break;
+			case Node::Type::Element:
+				if (source.IsSharedText()) {
+					target.ShareText(source.AsText());									//Копия остаётся в пуле документа
+				}
+				else {
+					target.SetText(source.AsText());
+				}
+				break;
 			case Node::Type::Tree: target.SetContainer(duplicate_children(source.AsContainer())); break;
 			default: break;
 			}
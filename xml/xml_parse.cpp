@@ -1,5 +1,6 @@
 #include "xml_parse.h"
 #include "xml_exceptions.h"
+#include "tracing.h"
 using namespace std;
 
 namespace xml {
@@ -9,12 +10,13 @@ namespace xml {
 	}
 
 	Document Reader::Load(allocator_holder external_alloc) {
-		m_tree_allocator = move(external_alloc);				//   
+		tracing::Span span("xml/Reader::Load", "xml");
+		start_loading(move(external_alloc));					//Может использоваться внешнийс аллокатор
 		return m_builder
-			.SetDeclaration(load_node())						// XML-
-			.SetRoot(load_node())								// DOM-
-			.SetAllocator(move(m_tree_allocator))				//  
-			.Assemble();										// 
+			.SetDeclaration(load_node())						//Считываем XML-декларацию
+			.SetRoot(load_node())								//Считываем DOM-дерево
+			.SetAllocator(finish_loading())						//Документ владеет аллокатором
+			.Assemble();										//Собираем документ
 	}
 
 	bool Reader::Fail() const noexcept {
@@ -25,34 +27,53 @@ namespace xml {
 		return !Fail();
 	}
 
+	void Reader::start_loading(allocator_holder external_alloc) {
+		m_depth = 0;
+		m_tree_allocator = move(external_alloc);
+	}
+
+	allocator_holder Reader::finish_loading() noexcept {
+		return move(m_tree_allocator);
+	}
+
 	node_holder Reader::load_node() {
 		left_strip();
 		if (get_next() != '<') {
 			throw parse_error("Ill-formed XML node");
 		}
 		auto first_service_block{ load_service_block() };
-		text_t name{
-			load_line(
-					[](char ch) {
-						return ch != '>' && !isspace(ch);  
-				}
-			)
-		};
+		return load_node_tail(load_node_name(), first_service_block);
+	}
 
-		node_holder node(
-			NodeBuilder()
-			.SetName(move(name))
-			.SetAttributes(load_attributes())
-			.SetAllocator(m_tree_allocator)
-			.Assemble()
-		);
+	node_holder Reader::load_node_tail(text_t name, optional<service_block_t> first_service_block) {
+		node_holder node{ load_node_header(move(name)) };
+		load_node_value(*node, first_service_block);
+		return node;
+	}
 
+	node_holder Reader::load_node_header(text_t name) {
+		node_holder node{ make_node(move(name), load_attributes()) };
 		left_strip();
-		load_node_value(*node, first_service_block);
 		return node;
 	}
 
-	void Reader::load_node_value(Node& node, optional<int64_t> first_service_block) {
+	node_holder Reader::make_node(text_t name, property_map attributes) {
+		return NodeBuilder()
+			.SetName(move(name))
+			.SetAttributes(move(attributes))
+			.SetAllocator(m_tree_allocator)
+			.Assemble();
+	}
+
+	void Reader::load_node_value(Node& node, optional<service_block_t> first_service_block) {
+		switch (load_node_opening(node, first_service_block)) {
+		case BodyType::Container: node.SetContainer(load_children()); break;
+		case BodyType::Text: load_node_text(node); break;
+		default: break;
+		};
+	}
+
+	Reader::BodyType Reader::load_node_opening(Node& node, optional<service_block_t> first_service_block) {
 		auto second_servie_block{ load_service_block() };
 		load_text('>');
 		bool new_line{ left_strip() };
@@ -61,34 +82,35 @@ namespace xml {
 			node.SetService(
 				make_pair(
 					*first_service_block,
-					second_servie_block ? optional<int64_t> (*second_servie_block) : nullopt
+					second_servie_block ? optional<service_block_t> (*second_servie_block) : nullopt
 				)
 			);
+			return BodyType::Service;
 		}
-		else if (peek_next() == '<' && new_line) {	//</...>        							
-			node.SetContainer(load_children());
-		}
-		else {										
-			node.SetText(load_text('<'));
-			close_line();
-		}
+		return peek_next() == '<' && new_line ?			//</...> без перевода строки означает конец пустого текстового блока
+			BodyType::Container : BodyType::Text;
 	}
-	container_t Reader::load_children() {
-		container_t children;
 
-		while (get_stream()) {
-			get_next();
-			if (peek_next() == '/') {
-				close_line();
-				break;
+	void Reader::load_node_text(Node& node) {
+		node.SetText(load_text('<'));
+		close_line();
+	}
+
+	container_t Reader::load_children() {
+		return load_children(
+			[this] {
+				tracing::Span span("xml/Reader::load_node", "xml", get_depth() == 1);		//Пакетами по поддереву верхнего уровня (подразделению)
+				return load_node();
 			}
-			else {
-				unget_character();
-				children.push_back(load_node());
+		);
+	}
+
+	text_t Reader::load_node_name() {
+		return load_line(
+			[](char ch) {
+				return ch != '>' && !isspace(ch);
 			}
-			left_strip();
-		}
-		return children;
+		);
 	}
 
 	text_t Reader::load_text(char limiter) {
@@ -101,7 +123,7 @@ namespace xml {
 		property_map attrs;
 		left_strip();
 		while (!ispunct(peek_next())) {
-			attrs.insert(load_attribute());
+			attrs.push_back(load_attribute());
 			left_strip();
 		}
 		return attrs;
@@ -110,7 +132,7 @@ namespace xml {
 	attribute_holder Reader::load_attribute() {
 		text_t name{ load_text('=') };
 		left_strip();
-		if (get_next() != '\"') {											// 
+		if (get_next() != '\"') {											//Извлекаем кавычку
 			throw parse_error("Attribute value must be quoted");
 		}
 		return { move(name), load_quoted_line() };
@@ -131,8 +153,8 @@ namespace xml {
 			return nullopt;
 		}
 		service_block_t result;
-		buffer.resize(sizeof(service_block_t), static_cast<char>(0));													//      
-		buffer.copy(reinterpret_cast<char*>(addressof(result)), sizeof(service_block_t), 0);		//  
+		buffer.resize(sizeof(service_block_t), static_cast<char>(0));													//Дополняем нулям для корретного считывания в дальнейшем
+		buffer.copy(reinterpret_cast<char*>(addressof(result)), sizeof(service_block_t), 0);		//Копируем содержимое строки
 		return result;																					
 	}
 
@@ -166,4 +188,8 @@ namespace xml {
 	istream& Reader::get_stream() {
 		return *m_input;
 	}
+
+	size_t Reader::get_depth() const noexcept {
+		return m_depth;
+	}
 }
\ No newline at end of file
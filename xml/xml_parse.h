@@ -9,6 +9,13 @@
 namespace xml {
 	using byte = unsigned char;
 
+	/***********************************************************
+	Reader - разбор XML произвольной структуры в DOM-дерево.
+	Защищённые методы позволяют наследникам (см.
+	wrapper::SchemaReader) разбирать известные им узлы
+	самостоятельно, а остальные передавать общему разбору
+	************************************************************/
+
 	class Reader {
 	public:
 		Reader(std::istream& input) noexcept;
@@ -16,10 +23,45 @@ namespace xml {
 
 		bool Fail() const noexcept;
 		explicit operator bool() const noexcept;
-	private:
+	protected:
+		enum class BodyType {
+			Service,
+			Container,
+			Text
+		};
+	protected:
+		void start_loading(allocator_holder external_alloc);						//Сбрасывает состояние перед разбором документа
+		allocator_holder finish_loading() noexcept;								//Аллокатор передаётся во владение документу
 		node_holder load_node();
-		void load_node_value(Node& node, std::optional<int64_t> service_ch);
+		node_holder load_node_tail(text_t name, std::optional<service_block_t> first_service_block);	//После '<', служебных символов и имени
+		node_holder load_node_header(text_t name);										//Узел с атрибутами, но без тела
+		node_holder make_node(text_t name, property_map attributes = {});
+		void load_node_value(Node& node, std::optional<service_block_t> first_service_block);
+		BodyType load_node_opening(Node& node, std::optional<service_block_t> first_service_block);	//Дочитывает заголовок; тело узла не загружается
+		void load_node_text(Node& node);
 		container_t load_children();
+
+		template <class ChildLoader>
+		container_t load_children(ChildLoader&& load_child) {						//ChildLoader: node_holder(); вызывается перед '<' очередного узла
+			container_t children;
+			++m_depth;
+			while (get_stream()) {
+				get_next();
+				if (peek_next() == '/') {
+					close_line();
+					break;
+				}
+				else {
+					unget_character();
+					children.push_back(load_child());
+				}
+				left_strip();
+			}
+			--m_depth;
+			return children;
+		}
+
+		text_t load_node_name();
 		text_t load_text(char limiter);
 		property_map load_attributes();
 		attribute_holder load_attribute();
@@ -29,7 +71,7 @@ namespace xml {
 		byte get_next();
 		void unget_character();
 		byte peek_next();	
-		bool left_strip();											//true     
+		bool left_strip();											//true при переходе на новую строку
 		void close_line();
 
 		template <class Predicate>
@@ -42,9 +84,11 @@ namespace xml {
 		}
 
 		std::istream& get_stream();
+		size_t get_depth() const noexcept;
 	private:
-		std::istream* m_input;									//      Reader'a
+		std::istream* m_input;									//Для возможности копирования и перемещения объектов Reader'a
 		allocator_holder m_tree_allocator;
 		DocumentBuilder m_builder;
+		size_t m_depth{ 0 };										//Вложенность загружаемых дочерних узлов - для трассировки
 	};
 }
\ No newline at end of file
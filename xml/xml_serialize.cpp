@@ -1,4 +1,5 @@
 #include "xml_serialize.h"
+#include "tracing.h"
 using namespace std;
 
 namespace xml {
@@ -18,6 +19,7 @@ namespace xml {
 	}
 
 	Writer& Writer::Save(const Document& doc) {
+		tracing::Span span("xml/Writer::Save", "xml");
 		serialize_node(doc.GetDeclaration(), m_base_indents_count);
 		serialize_node(doc.GetRoot(), m_base_indents_count);
 		return *this;
@@ -33,13 +35,13 @@ namespace xml {
 
 	void Writer::print_indents(optional<size_t> indents_count) {
 		if (m_indent && indents_count) {
-			m_indent->WriteIndents(get_stream(), *indents_count);					//     
-		}																			//      
+			m_indent->WriteIndents(get_stream(), *indents_count);					//В классе хранится начальное число отступов
+		}																			//При спуске вниз по дереву оно увеличивается
 	}
 
 	void Writer::print_attributes(const Node& node) {
 		for (const auto& [name, value] : node.GetAttributes()) {
-			get_stream() << ' ' << name << '=';
+			get_stream() << ' ' << node.GetAtoms().Resolve(name) << '=';
 			Writer::print_quoted(value);
 		}
 	}
@@ -68,7 +70,7 @@ namespace xml {
 	}
 
 	string Writer::read_service_block(service_block_t block) {
-		std::string buffer(													//    
+		std::string buffer(													//Копируем символы в буферную строку
 			reinterpret_cast<const char*>(
 				addressof(block)
 				),
@@ -0,0 +1,309 @@
+#include "schema_reader.h"
+#include "tracing.h"
+using namespace std;
+using xml::Node;
+using xml::node_holder;
+using xml::text_t;
+
+namespace wrapper {
+	constexpr bool SchemaReader::is_perfect_hash() noexcept {
+		for (size_t left = 0; left < TAG_COUNT; ++left) {
+			for (size_t right = left + 1; right < TAG_COUNT; ++right) {
+				if (tag_hash(tag_names[left]) == tag_hash(tag_names[right])) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	constexpr SchemaReader::tag_table_t SchemaReader::make_tag_table() noexcept {
+		tag_table_t table{};
+		for (auto& tag : table) {
+			tag = Tag::Unknown;
+		}
+		for (size_t idx = 0; idx < TAG_COUNT; ++idx) {
+			table[tag_hash(tag_names[idx])] = static_cast<Tag>(idx);
+		}
+		return table;
+	}
+
+	const SchemaReader::tag_table_t SchemaReader::tag_table{ make_tag_table() };		//Таблица строится при компиляции
+
+	SchemaReader::SchemaReader(istream& input) noexcept
+		: Reader(input)
+	{
+	}
+
+	SchemaReader& SchemaReader::ShareValues(Employee::Field field) {
+		if (!Employee::IsShareable(field)) {
+			throw invalid_argument("Field "s + string(Employee::GetFieldName(field)) + " can't be shared");
+		}
+		m_shared_fields.set(static_cast<size_t>(field));
+		return *this;
+	}
+
+	SchemaReader::Result SchemaReader::Load(xml::allocator_holder external_alloc) {
+		tracing::Span span("wrapper/SchemaReader::Load", "wrapper");
+		m_stats = {};
+		m_staff_hint = 0;
+		m_private_bytes = 0;
+		const auto& strings{ external_alloc->GetStrings() };						//Аллокатор может уже содержать разделяемые значения
+		size_t pool_size{ strings.Size() },
+			pool_usage{ strings.MemoryUsage() };
+		start_loading(move(external_alloc));
+		node_holder declaration{ load_node() };										//XML-декларация - служебный узел, её разбирает Reader
+		optional<Company::subdivision_t> subdivision;
+		node_holder root{ load_root(subdivision) };
+		Company company{
+			subdivision ?
+				Company(root.get(), move(*subdivision)) :
+				Company(root.get())													//Исключение для некорректного корня - как у общего пути
+		};
+		span.SetCount(static_cast<int64_t>(m_stats.employees));
+		m_stats.distinct_shared_values = strings.Size() - pool_size;
+		m_stats.saved_bytes = static_cast<int64_t>(m_private_bytes) - static_cast<int64_t>(strings.MemoryUsage() - pool_usage);
+		return {
+			xml::DocumentBuilder()
+				.SetDeclaration(move(declaration))
+				.SetRoot(move(root))												//Узлы не перемещаются: обёртки остаются действительными
+				.SetAllocator(finish_loading())
+				.Assemble(),
+			move(company)
+		};
+	}
+
+	const SchemaReader::Statistics& SchemaReader::GetStatistics() const noexcept {
+		return m_stats;
+	}
+
+	double SchemaReader::Statistics::DeduplicationRatio() const noexcept {
+		return distinct_shared_values ?
+			static_cast<double>(shared_values) / static_cast<double>(distinct_shared_values) : 0.0;
+	}
+
+	template <class SchemaLoader, class FallbackHandler>
+	node_holder SchemaReader::load_child(SchemaLoader&& schema_loader, FallbackHandler&& on_fallback) {
+		left_strip();
+		get_next();																	//'<' уже проверен в load_children()
+		optional<xml::service_block_t> first_service_block;
+		text_t name;
+		if (ispunct(peek_next())) {													//Служебные символы: имя узла читает Reader
+			first_service_block = load_service_block();
+			name = load_node_name();
+		}
+		else {
+			name = scan_name();
+		}
+		node_holder child;
+		if (!first_service_block) {
+			child = schema_loader(recognize(name), name);
+		}
+		if (!child) {
+			child = load_fallback(move(name), first_service_block);
+			on_fallback(*child);
+		}
+		return child;
+	}
+
+	node_holder SchemaReader::load_root(optional<Company::subdivision_t>& subdivision) {
+		left_strip();
+		if (get_next() != '<') {
+			throw xml::parse_error("Ill-formed XML node");
+		}
+		auto first_service_block{ load_service_block() };
+		text_t name{ load_node_name() };
+		if (first_service_block || recognize(name) != Tag::Departments) {
+			return load_fallback(move(name), first_service_block);
+		}
+		node_holder root{ load_node_header(move(name)) };
+		switch (load_node_opening(*root, nullopt)) {
+		case BodyType::Container: {
+			subdivision.emplace();
+			root->SetContainer(
+				load_children([this, &subdivision] {
+					return load_child(
+						[this, &subdivision](Tag tag, text_t& name) {
+							return tag == Tag::Department ?
+								load_department(move(name), *subdivision) : node_holder{};
+						},
+						[&subdivision](Node& node) {								//Любой дочерний узел корня - подразделение
+							subdivision->push_back(Department(addressof(node)));
+						});
+				})
+			);
+		} break;
+		case BodyType::Text: load_node_text(*root); break;
+		default: break;
+		};
+		return root;
+	}
+
+	node_holder SchemaReader::load_department(text_t name, Company::subdivision_t& subdivision) {
+		tracing::Span span("wrapper/SchemaReader::load_department", "wrapper");		//Пакетами по подразделению, как и xml/Reader::load_node
+		node_holder department{ load_node_header(move(name)) };
+		if (load_node_opening(*department, nullopt) != BodyType::Container) {
+			load_node_text(*department);
+			subdivision.push_back(Department(department.get()));					//Исключение, как и у общего пути
+			return department;
+		}
+		optional<vector<Employee>> staff;											//Как и try_get_staff(), учитывается лишь первый <employments>
+		bool generic_staff{ false };
+		department->SetContainer(
+			load_children([this, &staff, &generic_staff] {
+				return load_child(
+					[this, &staff, &generic_staff](Tag tag, text_t& name) {
+						if (tag != Tag::Employments || staff || generic_staff) {
+							return node_holder{};
+						}
+						staff.emplace().reserve(m_staff_hint);
+						node_holder employments{ load_employments(move(name), *staff) };
+						generic_staff = employments->GetType() != Node::Type::Tree;
+						return employments;
+					},
+					[&staff, &generic_staff](Node& node) {
+						if (!staff && node.GetName() == tag_names[static_cast<size_t>(Tag::Employments)]) {
+							generic_staff = true;											//Первый <employments> не из схемы
+						}
+					});
+			})
+		);
+		if (generic_staff) {
+			subdivision.push_back(Department(department.get()));
+		}
+		else {
+			Department::workgroup_t workgroup;
+			if (staff) {
+				span.SetCount(static_cast<int64_t>(staff->size()));
+				m_staff_hint = staff->size();
+				workgroup.merge(move(*staff), [](const FullNameRef&, Employee&) {});	//Дубликаты отбрасываются, как и в collect_employees()
+			}
+			subdivision.push_back(Department(department.get(), move(workgroup)));
+		}
+		++m_stats.departments;
+		return department;
+	}
+
+	node_holder SchemaReader::load_employments(text_t name, vector<Employee>& staff) {
+		node_holder employments{ load_node_header(move(name)) };
+		if (load_node_opening(*employments, nullopt) != BodyType::Container) {
+			load_node_text(*employments);
+			return employments;
+		}
+		employments->SetContainer(
+			load_children([this, &staff] {
+				return load_child(
+					[this, &staff](Tag tag, text_t& name) {
+						return tag == Tag::Employment ?
+							load_employment(move(name), staff) : node_holder{};
+					},
+					[&staff](Node& node) {											//Любой дочерний узел <employments> - сотрудник
+						staff.emplace_back(addressof(node));
+					});
+			})
+		);
+		return employments;
+	}
+
+	node_holder SchemaReader::load_employment(text_t name, vector<Employee>& staff) {
+		node_holder employment{ load_node_header(move(name)) };
+		if (load_node_opening(*employment, nullopt) != BodyType::Container) {
+			load_node_text(*employment);
+			staff.emplace_back(employment.get());									//Исключение, как и у общего пути
+			return employment;
+		}
+		Employee::fields_view_t fields{};
+		auto bind_field{
+			[&fields](Tag tag, Node& node) {										//Повторное поле замещает предыдущее, как и в collect_fields()
+				if (auto field = as_field(tag); field) {
+					fields[static_cast<size_t>(*field)] = addressof(as_const(node).AsText());
+				}
+			}
+		};
+		employment->SetContainer(
+			load_children([this, &bind_field] {
+				return load_child(
+					[this, &bind_field](Tag tag, text_t& name) {
+						if (!as_field(tag)) {
+							return node_holder{};
+						}
+						auto field_idx{ static_cast<size_t>(*as_field(tag)) };
+						node_holder field{ load_field(move(name), m_shared_fields[field_idx]) };
+						bind_field(tag, *field);
+						return field;
+					},
+					[&bind_field](Node& node) {
+						bind_field(recognize(node.GetName()), node);
+					});
+			})
+		);
+		staff.push_back(Employee(employment.get(), fields));
+		++m_stats.employees;
+		return employment;
+	}
+
+	node_holder SchemaReader::load_field(text_t name, bool shared) {
+		auto& buffer{ *get_stream().rdbuf() };
+		if (buffer.sgetc() != '>') {												//Атрибуты или пробелы после имени - общий разбор
+			return load_node_tail(move(name), nullopt);
+		}
+		buffer.sbumpc();
+		node_holder field{ make_node(move(name)) };
+		bool new_line{ left_strip() };
+		if (peek_next() == '<' && new_line) {										//Как и в Reader::load_node_opening()
+			field->SetContainer(load_children());
+		}
+		else if (shared) {
+			load_shared_text(*field);
+		}
+		else {
+			load_node_text(*field);
+		}
+		return field;
+	}
+
+	void SchemaReader::load_shared_text(Node& field) {
+		static const size_t sso_capacity{ text_t{}.capacity() };
+		text_t value{ load_text('<') };											//Как и в Reader::load_node_text()
+		close_line();
+		m_private_bytes += value.size() > sso_capacity ? value.size() + 1 : 0;
+		field.ShareText(value);
+		++m_stats.shared_values;
+	}
+
+	node_holder SchemaReader::load_fallback(text_t name, optional<xml::service_block_t> first_service_block) {
+		++m_stats.fallback_nodes;
+		return load_node_tail(move(name), first_service_block);
+	}
+
+	text_t SchemaReader::scan_name() {
+		using traits = istream::traits_type;
+		auto& buffer{ *get_stream().rdbuf() };
+		text_t name;
+		for (auto ch = buffer.sgetc(); ; ch = buffer.snextc()) {
+			if (traits::eq_int_type(ch, traits::eof())) {
+				get_stream().setstate(ios::eofbit);
+				break;
+			}
+			if (ch == '>' || isspace(ch)) {
+				break;
+			}
+			name.push_back(traits::to_char_type(ch));
+		}
+		return name;
+	}
+
+	SchemaReader::Tag SchemaReader::recognize(string_view name) noexcept {
+		static_assert(is_perfect_hash(), "Schema tags must not collide");
+		Tag tag{ tag_table[tag_hash(name)] };
+		return tag != Tag::Unknown && tag_names[static_cast<size_t>(tag)] == name ?
+			tag : Tag::Unknown;
+	}
+
+	optional<Employee::Field> SchemaReader::as_field(Tag tag) noexcept {
+		if (tag < Tag::Surname || tag == Tag::Unknown) {
+			return nullopt;
+		}
+		return static_cast<Employee::Field>(static_cast<size_t>(tag) - static_cast<size_t>(Tag::Surname));
+	}
+}
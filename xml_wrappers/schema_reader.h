@@ -0,0 +1,96 @@
+#pragma once
+#include "xml_parse.h"
+#include "xml_wrappers.h"
+
+#include <array>
+#include <bitset>
+#include <string_view>
+#include <optional>
+#include <vector>
+#include <cstdint>
+
+namespace wrapper {
+	/***********************************************************************************************************************
+	SchemaReader - загрузка документа компании за один проход: обёртки Company/Department/Employee строятся
+	одновременно с XML-узлами, на которые они ссылаются, без повторного обхода DOM-дерева с поиском узлов по именам
+	(Company(Node*) -> try_get_staff() -> collect_fields()). Теги схемы распознаются совершенной хеш-функцией,
+	построенной при компиляции. Узлы, не входящие в схему (а также узлы схемы со служебными символами или
+	неожиданным телом), разбираются общим xml::Reader, а обёртки над ними строятся обычными конструкторами,
+	поэтому результат совпадает с Reader::Load() + Company(Node*) для любого входного документа.
+
+	ShareValues() включает хранение значений выбранных полей сотрудников в пуле документа (xml::StringPool):
+	повторяющиеся должности и оклады хранятся однократно. Сведения о дедупликации - в GetStatistics()
+	************************************************************************************************************************/
+
+	class SchemaReader : protected xml::Reader {
+	public:
+		struct Statistics {
+			size_t departments{ 0 },
+				employees{ 0 },
+				fallback_nodes{ 0 };													//Поддеревья, переданные общему разбору
+			size_t shared_values{ 0 },													//Значения полей, помещённые в пул
+				distinct_shared_values{ 0 };											//Из них различных (прирост пула)
+			int64_t saved_bytes{ 0 };													//Куча собственных копий за вычетом прироста пула; < 0 - пул не окупился
+
+			double DeduplicationRatio() const noexcept;									//shared_values / distinct_shared_values
+		};
+		struct Result {
+			xml::Document document;
+			Company company;															//Наблюдает за корнем document
+		};
+	private:
+		enum class Tag : uint8_t {
+			Departments,
+			Department,
+			Employments,
+			Employment,
+			Surname,
+			Name,
+			MiddleName,
+			Function,
+			Salary,
+			Unknown
+		};
+		static constexpr size_t TAG_COUNT{ static_cast<size_t>(Tag::Unknown) };
+		static constexpr size_t TAG_TABLE_SIZE{ 16 };
+		static constexpr std::array<std::string_view, TAG_COUNT> tag_names{
+			"departments", "department", "employments", "employment",
+			"surname", "name", "middleName", "function", "salary"						//В порядке Employee::Field
+		};
+		using tag_table_t = std::array<Tag, TAG_TABLE_SIZE>;
+	public:
+		SchemaReader(std::istream& input) noexcept;
+		SchemaReader& ShareValues(Employee::Field field);								//std::invalid_argument, если !Employee::IsShareable(field)
+		Result Load(xml::allocator_holder external_alloc = xml::MakeDefaultAllocator());
+		const Statistics& GetStatistics() const noexcept;								//Сведения о последнем вызове Load()
+
+		using Reader::Fail;
+		using Reader::operator bool;
+	private:
+		xml::node_holder load_root(std::optional<Company::subdivision_t>& subdivision);	//nullopt - корень разобран общим Reader'ом
+		xml::node_holder load_department(xml::text_t name, Company::subdivision_t& subdivision);
+		xml::node_holder load_employments(xml::text_t name, std::vector<Employee>& staff);
+		xml::node_holder load_employment(xml::text_t name, std::vector<Employee>& staff);
+		xml::node_holder load_field(xml::text_t name, bool shared);
+		void load_shared_text(xml::Node& field);
+
+		template <class SchemaLoader, class FallbackHandler>
+		xml::node_holder load_child(SchemaLoader&& schema_loader, FallbackHandler&& on_fallback);	//SchemaLoader: node_holder(Tag, text_t&) - nullptr, если узел не из схемы;
+		xml::node_holder load_fallback(xml::text_t name, std::optional<xml::service_block_t> first_service_block);	//FallbackHandler: void(Node&)
+		xml::text_t scan_name();														//Посимвольно через streambuf, без sentry istream'а на каждый символ
+
+		static constexpr size_t tag_hash(std::string_view name) noexcept {
+			return name.empty() ? 0 : (name.size() * 4 + static_cast<unsigned char>(name.front())) % TAG_TABLE_SIZE;
+		}
+		static constexpr bool is_perfect_hash() noexcept;
+		static constexpr tag_table_t make_tag_table() noexcept;
+		static Tag recognize(std::string_view name) noexcept;							//Один хеш и одно сравнение строк
+		static std::optional<Employee::Field> as_field(Tag tag) noexcept;
+	private:
+		static const tag_table_t tag_table;
+		Statistics m_stats;
+		std::bitset<Employee::FIELD_COUNT> m_shared_fields;
+		size_t m_private_bytes{ 0 };													//Куча, которую заняли бы собственные копии разделённых значений
+		size_t m_staff_hint{ 0 };														//Штат предыдущего подразделения - оценка для reserve()
+	};
+}
@@ -1,4 +1,5 @@
 #include "xml_wrappers.h"
+#include "tracing.h"
 using namespace std;
 using xml::Node;
 using xml::node_holder;
@@ -34,7 +35,7 @@ namespace wrapper {
 		else {
 			m_node = exchange(source.m_node, nullptr);										
 		}
-		throw_if_different_wrapper_types(get_type(), source.get_type());					// take_dependencies()   dynamic_cast
+		throw_if_different_wrapper_types(get_type(), source.get_type());					//В take_dependencies() будет выполнен dynamic_cast
 		take_dependencies(source);
 		return *this;
 	}
@@ -59,12 +60,12 @@ namespace wrapper {
 	}
 
 	node_holder XmlWrapper::BuildXmlTree() {
-		Synchronize();															//      
+		Synchronize();															//Предварительная синхронизация обязательна во избежание утери изменений
 		if (IsObserver()) {
 			throw runtime_error("XML Node isn't owned by wrapper");
 		}
 		node_holder detached_node{ move(get<node_holder>(m_node)) };
-		m_node = detached_node.get();											//   
+		m_node = detached_node.get();											//Переключаемся в режим наблюдения
 		return detached_node;
 	}
 
@@ -76,6 +77,14 @@ namespace wrapper {
 		return get_node().GetAllocator();
 	}
 
+	size_t XmlWrapper::MemoryUsage() const noexcept {
+		const Node* node{
+			holds_alternative<Node*>(m_node) ?
+				get<Node*>(m_node) : get<node_holder>(m_node).get()
+		};
+		return node ? node->MemoryUsage() : 0;									//Пустая обертка узлом не владеет
+	}
+
 	void XmlWrapper::throw_if_another_node_type(const Node& node, Node::Type expected) {
 		if (auto type = node.GetType(); type != expected) {
 			throw runtime_error(
@@ -99,7 +108,7 @@ namespace wrapper {
 	}
 
 	xml::Node& XmlWrapper::get_node() {
-		if (holds_alternative<Node*>(m_node)) {										//   
+		if (holds_alternative<Node*>(m_node)) {										//Получение ссылки на узел
 			return *get<Node*>(m_node);
 		}
 		else {
@@ -118,13 +127,19 @@ namespace wrapper {
 
 	Employee::Employee(xml::Node* node_ptr)
 		: XmlWrapper(node_ptr), 
-		m_properties(collect_properties(*node_ptr))	
+		m_fields(collect_fields(*node_ptr))	
 	{
 	}
 
 	Employee::Employee(node_holder ready_node)
 		: XmlWrapper(move(ready_node)),
-		m_properties(collect_properties(get_node()))
+		m_fields(collect_fields(get_node()))
+	{
+	}
+
+	Employee::Employee(xml::Node* node_ptr, const fields_view_t& fields) noexcept
+		: XmlWrapper(node_ptr),
+		m_fields(fields)
 	{
 	}
 
@@ -134,87 +149,282 @@ namespace wrapper {
 
 	Employee& Employee::Reset() {
 		XmlWrapper::Reset();
-		m_properties.clear();
+		m_fields.fill(nullptr);
 		return *this;
 	}
 
+	size_t Employee::MemoryUsage() const noexcept {
+		return XmlWrapper::MemoryUsage();									//Таблица полей - часть объекта
+	}
+
 	XmlWrapper::Type Employee::get_type() const noexcept {
 		return Type::Employee;
 	}
 
 	Employee& Employee::update_dependencies() {
-		m_properties = collect_properties(get_node());
+		m_fields = collect_fields(get_node());
 		return *this;
 	}
 
 	Employee& Employee::take_dependencies(XmlWrapper& other) {
-		m_properties = move(static_cast<Employee&>(other).m_properties);
+		auto& other_fields{ static_cast<Employee&>(other).m_fields };
+		m_fields = other_fields;
+		other_fields.fill(nullptr);
 		return *this;
 	}
 
 	FullNameRef Employee::GetFullName() const {
 		return FullNameRef{
-			*m_properties.at("surname"),
-			*m_properties.at("name"),
-			*m_properties.at("middleName")
+			get_field(Field::Surname),
+			get_field(Field::Name),
+			get_field(Field::MiddleName)
 		};
 	}
 
 	string_ref Employee::GetSurname() const {
-		return *m_properties.at("surname");
+		return get_field(Field::Surname);
 	}
 
 	string_ref Employee::GetName() const {
-		return *m_properties.at("name");
+		return get_field(Field::Name);
 	}
 
 	string_ref Employee::GetMiddleName() const {
-		return *m_properties.at("middleName");
+		return get_field(Field::MiddleName);
 	}
 
 
 	string_ref Employee::GetFunction() const {
-		return *m_properties.at("function");
+		return get_field(Field::Function);
 	}
 
 	size_t Employee::GetSalary() const {
-		return stoll(*m_properties.at("salary"));
+		return stoll(get_field(Field::Salary));
 	}
 
 	Employee& Employee::SetSurname(string new_surname) {
-		*m_properties["surname"] = move(new_surname);
+		set_field(Field::Surname, move(new_surname));
 		return *this;
 	}
 
 	Employee& Employee::SetName(string new_name) {
-		*m_properties["name"] = move(new_name);
+		set_field(Field::Name, move(new_name));
 		return *this;
 	}
 	
 	Employee& Employee::SetMiddleName(string new_middle_name) {
-		*m_properties["middleName"] = move(new_middle_name);
+		set_field(Field::MiddleName, move(new_middle_name));
 		return *this;
 	}
 
 	Employee& Employee::SetFunction(string new_function) {
-		*m_properties["function"] = move(new_function);
+		set_field(Field::Function, move(new_function));
 		return *this;
 	}
 
 	Employee& Employee::SetSalary(size_t new_salary) {
-		*m_properties["salary"] = to_string(new_salary);
+		set_field(Field::Salary, to_string(new_salary));
 		return *this;
 	}
 
-	Employee::properties_view_t Employee::collect_properties(Node& node) {
-		throw_if_another_node_type(node, Node::Type::Tree);									//XML-    
+	string_view Employee::GetFieldName(Field field) noexcept {
+		return field_names[static_cast<size_t>(field)];
+	}
+
+	bool Employee::IsShareable(Field field) noexcept {
+		return field == Field::Function || field == Field::Salary;						//ФИО - ключи подразделения: ссылки на них должны видеть изменения
+	}
+
+	Employee::fields_view_t Employee::collect_fields(Node& node) {
+		throw_if_another_node_type(node, Node::Type::Tree);									//XML-узел должен хранить дочерние узлы
+
+		fields_view_t fields{};
+		auto& atoms{ node.GetAtoms() };
+		const auto& field_atoms{ atoms.InternVocabulary(field_names) };					//Атомы полей ищутся в таблице лишь при первом обращении
+		for (auto& field_holder : node.AsContainer()) {
+			for (size_t idx = 0; idx < FIELD_COUNT; ++idx) {								//Неизвестные поля игнорируются
+				if (field_holder->IsNamed(atoms, field_atoms[idx])) {
+					fields[idx] = addressof(as_const(*field_holder).AsText());				//Без копирования разделяемого текста
+					break;
+				}
+			}
+		}
+		return fields;
+	}
+
+	const string& Employee::get_field(Field field) const {
+		const string* text{ m_fields[static_cast<size_t>(field)] };
+		if (!text) {
+			throw_non_existent_key("Field "s + string(GetFieldName(field)));
+		}
+		return *text;
+	}
+
+	void Employee::set_field(Field field, string value) {
+		const string* text{ addressof(get_field(field)) };
+		Node& node{ get_node() };
+		auto& atoms{ node.GetAtoms() };
+		xml::atom_t name{ atoms.InternVocabulary(field_names)[static_cast<size_t>(field)] };
+		Node* field_node{ nullptr };
+		for (auto& field_holder : node.AsContainer()) {								//Последнее совпадение - как и в collect_fields()
+			if (field_holder->IsNamed(atoms, name)
+				&& field_holder->GetType() == Node::Type::Element
+				&& addressof(as_const(*field_holder).AsText()) == text) {
+				field_node = field_holder.get();
+			}
+		}
+		if (field_node->IsSharedText()) {
+			field_node->ShareText(value);											//Прежнее значение остаётся у других сотрудников
+		}
+		else {
+			field_node->AsText() = move(value);
+		}
+		m_fields[static_cast<size_t>(field)] = addressof(as_const(*field_node).AsText());
+	}
+
+	Workgroup::iterator Workgroup::begin() noexcept {
+		return iterator(m_slots.begin());
+	}
+
+	Workgroup::iterator Workgroup::end() noexcept {
+		return iterator(m_slots.end());
+	}
+
+	Workgroup::const_iterator Workgroup::begin() const noexcept {
+		return const_iterator(m_slots.begin());
+	}
+
+	Workgroup::const_iterator Workgroup::end() const noexcept {
+		return const_iterator(m_slots.end());
+	}
+
+	size_t Workgroup::size() const noexcept {
+		return m_slots.size();
+	}
+
+	bool Workgroup::empty() const noexcept {
+		return m_slots.empty();
+	}
+
+	void Workgroup::clear() noexcept {
+		m_slots.clear();
+	}
+
+	void Workgroup::reserve(size_t count) {
+		m_slots.reserve(count);
+	}
+
+	Workgroup::iterator Workgroup::find(const FullNameRef& name) {
+		auto it{ as_const(*this).find(name) };
+		return iterator(m_slots.begin() + (it.m_it - m_slots.cbegin()));
+	}
+
+	Workgroup::const_iterator Workgroup::find(const FullNameRef& name) const {
+		auto it{ lower_bound_slot(make_prefix(name.surname), name) };
+		return const_iterator(
+			it != m_slots.end() && it->name == name ? it : m_slots.end()
+		);
+	}
+
+	Workgroup::iterator Workgroup::lower_bound(const FullNameRef& name) {
+		auto it{ lower_bound_slot(make_prefix(name.surname), name) };
+		return iterator(m_slots.begin() + (it - m_slots.cbegin()));
+	}
+
+	Workgroup::const_iterator Workgroup::lower_bound(const FullNameRef& name) const {
+		return const_iterator(lower_bound_slot(make_prefix(name.surname), name));
+	}
+
+	size_t Workgroup::count(const FullNameRef& name) const {
+		return find(name) != end();
+	}
 
-		auto& raw_properties{ node.AsContainer() };
-		properties_view_t properties;
-		for (auto& employee_holder : raw_properties) {
-			properties.emplace(employee_holder->GetName(), addressof(employee_holder->AsText()));
+	Employee& Workgroup::at(const FullNameRef& name) {
+		return const_cast<Employee&>(as_const(*this).at(name));
+	}
+
+	const Employee& Workgroup::at(const FullNameRef& name) const {
+		auto it{ find(name) };
+		if (it == end()) {
+			throw out_of_range("Employee with full name " + FullNameRefAsString(name) + " doesn't exist");
+		}
+		return it->second;
+	}
+
+	pair<Workgroup::iterator, bool> Workgroup::emplace(Employee&& employee) {
+		auto name{ employee.GetFullName() };
+		auto prefix{ make_prefix(name.surname) };
+		auto pos{ m_slots.begin() + (lower_bound_slot(prefix, name) - m_slots.cbegin()) };
+		if (pos != m_slots.end() && pos->name == name) {
+			return { iterator(pos), false };
 		}
-		return properties;
+		auto holder{ make_unique<Employee>(move(employee)) };
+		name = holder->GetFullName();												//Строки узла при перемещении обёртки остаются на месте
+		return { iterator(m_slots.insert(pos, Slot{ prefix, name, move(holder) })), true };
+	}
+
+	Workgroup::iterator Workgroup::erase(iterator pos) {
+		return iterator(m_slots.erase(pos.m_it));
+	}
+
+	pair<Workgroup::iterator, bool> Workgroup::rekey(iterator pos) {
+		auto self{ pos.m_it };
+		self->name = self->employee->GetFullName();
+		self->prefix = make_prefix(self->name.surname);
+		auto target{ std::lower_bound(m_slots.begin(), self, *self, &slot_less) };	//Остальные элементы по-прежнему упорядочены
+		if (target != self) {
+			rotate(target, self, next(self));
+			return { iterator(target), true };
+		}
+		target = std::lower_bound(next(self), m_slots.end(), *self, &slot_less);
+		if (target != next(self)) {
+			rotate(self, next(self), target);
+			return { iterator(prev(target)), true };
+		}
+		return { pos, false };
+	}
+
+	size_t Workgroup::memory_usage() const noexcept {
+		return m_slots.capacity() * sizeof(Slot) + m_slots.size() * sizeof(Employee);
+	}
+
+	uint64_t Workgroup::make_prefix(const string& surname) noexcept {
+		uint64_t prefix{ 0 };
+		size_t length{ min<size_t>(surname.size(), sizeof(prefix)) };
+		for (size_t idx = 0; idx < sizeof(prefix); ++idx) {							//Байты сравниваются как unsigned char - как и в std::string
+			prefix <<= 8;
+			if (idx < length) {
+				prefix |= static_cast<unsigned char>(surname[idx]);
+			}
+		}
+		return prefix;
+	}
+
+	Workgroup::Slot Workgroup::make_slot(Employee&& employee) {
+		auto holder{ make_unique<Employee>(move(employee)) };
+		auto name{ holder->GetFullName() };
+		return Slot{ make_prefix(name.surname), name, move(holder) };
+	}
+
+	bool Workgroup::slot_less(const Slot& left, const Slot& right) {
+		if (left.prefix != right.prefix) {
+			return left.prefix < right.prefix;
+		}
+		return left.name < right.name;
+	}
+
+	bool Workgroup::contains(const Slot& slot) const {
+		auto it{ lower_bound_slot(slot.prefix, slot.name) };
+		return it != m_slots.end() && it->name == slot.name;
+	}
+
+	Workgroup::slot_storage_t::const_iterator Workgroup::lower_bound_slot(uint64_t prefix, const FullNameRef& name) const {
+		return partition_point(
+			m_slots.begin(),
+			m_slots.end(),
+			[prefix, &name](const Slot& slot) {
+				return slot.prefix != prefix ? slot.prefix < prefix : slot.name < name;
+			});
 	}
 
 	Department::Department(Node* node_ptr) 
@@ -231,66 +441,133 @@ namespace wrapper {
 	{
 	}
 
+	Department::Department(Node* node_ptr, workgroup_t workgroup)
+		: XmlContainerWrapper(node_ptr),
+		m_workgroup(move(workgroup)),
+		m_summary_salary(calc_summary_salary(m_workgroup))
+	{
+	}
+
+	Department::Department(Department&& other)
+		: XmlContainerWrapper(move(other))
+	{
+		take_dependencies(other);
+	}
+
+	Department& Department::operator=(Department&& other) {
+		if (this != addressof(other)) {
+			unregister_staff();														//Ключи индекса ссылаются на строки освобождаемых узлов
+			m_workgroup.clear();
+			XmlContainerWrapper::operator=(move(other));
+			take_dependencies(other);
+		}
+		return *this;
+	}
+
 	Department& Department::Reset() {
+		unregister_staff();
 		XmlWrapper::Reset();
 		m_workgroup.clear();
 		m_summary_salary = 0;
+		m_revision.Update();
 		return *this;
 	}
 
+	size_t Department::MemoryUsage() const noexcept {
+		size_t usage{ XmlWrapper::MemoryUsage() };								//Поддерево подразделения уже включает синхронизированные узлы сотрудников
+		usage += m_workgroup.memory_usage();										//Массив ключей и сами обёртки
+		for (const auto& [full_name, employee] : m_workgroup) {
+			if (!employee.IsObserver()) {
+				usage += employee.MemoryUsage();								//Вставленные после последней синхронизации сотрудники владеют своими узлами
+			}
+		}
+		return usage;
+	}
+
 	XmlWrapper::Type Department::get_type() const noexcept {
 		return Type::Department;
 	}
 
 	Department& Department::update_dependencies() {
+		unregister_staff();
 		m_workgroup = collect_employees(get_node());
 		m_summary_salary = calc_summary_salary(m_workgroup);
+		register_staff();
+		m_revision.Update();
 		return *this;
 	}
 
 	Department& Department::take_dependencies(XmlWrapper& other) {
 		auto& other_department{ static_cast<Department&>(other) };
+		unregister_staff();
+		other_department.unregister_staff();										//Записи индекса ссылаются на исходное подразделение
+		if (other_department.m_directory) {
+			m_directory = exchange(other_department.m_directory, nullptr);			//Перестроенное при синхронизации подразделение остаётся в индексе
+		}
 		m_workgroup = move(other_department.m_workgroup);
 		m_summary_salary = exchange(other_department.m_summary_salary, 0);
+		register_staff();
+		m_revision.Update();
+		other_department.m_revision.Update();
 		return *this;
 	}
 
 	RenameResult Department::employee_rename_helper(const FullNameRef& old_name, string&& value, FullNameField field){
 		FullNameRef new_full_name(old_name);
-		switch (field) {											//  
+		switch (field) {											//Для поиска дубликатов
 		case FullNameField::Surname: new_full_name.surname = value; break;
 		case FullNameField::Name: new_full_name.name = value; break;
 		case FullNameField::MiddleName: new_full_name.middle_name = value; break;
 		}
 
-		if (m_workgroup.count(new_full_name)) {						//    ""  -   workgroup
+		if (m_workgroup.count(new_full_name)) {						//Смена имени требует выполнения "тяжелой" операции - извлечения из workgroup
 			return new_full_name == old_name ?
-				RenameResult::NothingChanged : RenameResult::IsDuplicate; //     
+				RenameResult::NothingChanged : RenameResult::IsDuplicate; //Найдены дубликаты или имя не изменилось
 		}
 
-		auto employee_it{ m_workgroup.find(old_name) };				//todo:    
+		auto employee_it{ m_workgroup.find(old_name) };
 		if (employee_it == m_workgroup.end()) {	
 			throw_non_existent_key("Employee with full name " + FullNameRefAsString(old_name));
 		}
-		register_rename(old_name, new_full_name);					//    
-
-		auto next_it{ next(employee_it) };
-		auto node{ m_workgroup.extract(employee_it) };
+		register_rename(old_name, new_full_name);					//Обновление позиции элемента в кэше
+		if (m_directory) {
+			m_directory->Erase(*this, employee_it->first);			//До изменения строк, на которые ссылается ключ
+		}
 
-		switch (field) {											// 
-		case FullNameField::Surname: node.mapped().SetSurname(move(value)); break;
-		case FullNameField::Name: node.mapped().SetName(move(value)); break;
-		case FullNameField::MiddleName:  node.mapped().SetMiddleName(move(value)); break;
+		auto& employee{ employee_it->second };						//Адрес обёртки при смене позиции не меняется
+		switch (field) {											//Обновление поля
+		case FullNameField::Surname: employee.SetSurname(move(value)); break;
+		case FullNameField::Name: employee.SetName(move(value)); break;
+		case FullNameField::MiddleName: employee.SetMiddleName(move(value)); break;
 		};
 
-		node.key() = node.mapped().GetFullName();
-		employee_it = m_workgroup.insert(move(node)).position;
-		if (next(employee_it) != next_it) {
+		auto [new_it, moved] { m_workgroup.rekey(employee_it) };
+		if (moved) {
 			force_rebuild();
 		}
+		if (m_directory) {
+			m_directory->Insert(*this, new_it->first, employee);
+		}
+		m_revision.Update();
 		return RenameResult::Success;
 	}
 
+	void Department::register_staff() {
+		if (m_directory) {
+			for (const auto& [full_name, employee] : m_workgroup) {
+				m_directory->Insert(*this, full_name, employee);
+			}
+		}
+	}
+
+	void Department::unregister_staff() noexcept {
+		if (m_directory) {
+			for (const auto& [full_name, _] : m_workgroup) {
+				m_directory->Erase(*this, full_name);
+			}
+		}
+	}
+
 	void Department::recalc_summary_salary_after_recruitment(size_t new_employee_salary) {
 		m_summary_salary += new_employee_salary;
 	}
@@ -300,6 +577,7 @@ namespace wrapper {
 	}
 
 	Department& Department::Synchronize() {
+		tracing::Span span("wrapper/Department::Synchronize", "wrapper");
 		auto* staff{ try_get_staff(get_node()) };
 		if (!staff) {
 			auto& cont{ get_node().AsContainer() };
@@ -316,8 +594,8 @@ namespace wrapper {
 			m_workgroup.begin(),
 			m_workgroup.end(),
 			m_workgroup.size(),
-			[](workgroup_t::value_type& name_and_employee) -> Employee& {					//  ,   ,			
-				return name_and_employee.second;											//   (..    -)
+			[](const workgroup_t::value_type& name_and_employee) -> Employee& {				//Без явного указания, что возвращается ссылка,			
+				return name_and_employee.second;											//будет попытка копирования (т.к. возвращается поле аргумента ф-ции)
 			});	
 		return *this;
 	}
@@ -339,11 +617,11 @@ namespace wrapper {
 	}
 
 	size_t FullNameHasher::operator()(const FullNameRef& name) const noexcept {
-		static constexpr size_t coef{ 1873 };											// 
+		static constexpr size_t coef{ 1873 };											//Простое число
 		return
 			hash<string>()(name.surname) * coef * coef
-			+ hash<string>()(name.surname) * coef
-			+ hash<string>()(name.surname);
+			+ hash<string>()(name.name) * coef
+			+ hash<string>()(name.middle_name);
 	}
 
 	string FullNameRefAsString(const FullNameRef& full_name) {
@@ -352,7 +630,7 @@ namespace wrapper {
 			full_name.surname.get().size()
 			+ full_name.name.get().size()
 			+ full_name.middle_name.get().size()
-			+ 2															// 
+			+ 2															//Пробельные символы
 		);
 		full_name_str += full_name.surname;
 		full_name_str.push_back(' ');
@@ -366,25 +644,34 @@ namespace wrapper {
 	Department::workgroup_t Department::collect_employees(xml::Node& node) {
 		throw_if_another_node_type(node, Node::Type::Tree);
 
+		tracing::Span span("wrapper/Department::collect_employees", "wrapper");
 		workgroup_t workgroup;
 		auto* staff{ try_get_staff(node) };
 		if (staff) {
+			vector<Employee> employees;
+			employees.reserve(staff->AsContainer().size());
 			for (auto& nodeholder : staff->AsContainer()) {
-				Employee employee(nodeholder.get());
-				workgroup.emplace(employee.GetFullName(), move(employee));
+				employees.emplace_back(nodeholder.get());
 			}
+			workgroup.merge(move(employees), [](const FullNameRef&, Employee&) {});		//Однократная сортировка вместо поэлементной вставки
 		}
+		span.SetCount(static_cast<int64_t>(workgroup.size()));
 		return workgroup;
 	}
 		
-	xml::Node* Department::try_get_staff(xml::Node& node) {								//   XML- <employments>...</employments>
+	xml::Node* Department::try_get_staff(xml::Node& node) {								//Попытка обращения к XML-узлу <employments>...</employments>
 		auto& raw_info{ node.AsContainer() };
+		const auto& atoms{ as_const(node).GetAtoms() };
+		auto employments{ atoms.Find("employments") };								//Чтение не изменяет таблицу: без атома нет и узла с таким именем
+		if (!employments) {
+			return nullptr;
+		}
 		auto staff_it{
 			find_if(
 				raw_info.begin(),
 				raw_info.end(),
-				[](const node_holder& node) {
-					return node->GetName() == "employments"; 
+				[&atoms, employments = *employments](const node_holder& node) {
+					return node->IsNamed(atoms, employments); 
 				}
 			)
 		};
@@ -406,6 +693,7 @@ namespace wrapper {
 
 	Department& Department::SetName(string new_name) noexcept {
 		get_node()["name"] = move(new_name);
+		m_revision.Update();
 		return *this;
 	}
 
@@ -425,6 +713,13 @@ namespace wrapper {
 		auto& employee{ at(full_name) };
 		m_summary_salary += (new_salary - employee.GetSalary());
 		employee.SetSalary(new_salary);
+		m_revision.Update();
+		return *this;
+	}
+
+	Department& Department::ChangeEmployeeFunction(const FullNameRef& full_name, string new_function) {
+		at(full_name).SetFunction(move(new_function));
+		m_revision.Update();
 		return *this;
 	}
 
@@ -437,6 +732,10 @@ namespace wrapper {
 			static_cast<double>(m_summary_salary) / EmployeeCount() : 0;
 	}
 
+	uint64_t Department::GetRevision() const noexcept {
+		return m_revision.Get();
+	}
+
 	bool Department::Containts(const FullNameRef& name) const noexcept {
 		return static_cast<bool>(m_workgroup.count(name));
 	}
@@ -458,25 +757,48 @@ namespace wrapper {
 	}
 
 	Department::employee_it Department::InsertEmployee(Employee&& employee) {
-		auto [it, success] { 
-			m_workgroup.emplace(
-				employee.GetFullName(),
-				move(employee)
-			)
-		};
+		auto [it, success] { m_workgroup.emplace(move(employee)) };
 		if (success) {
 			register_insert(it->first, it == prev(m_workgroup.end()));
 			recalc_summary_salary_after_recruitment(it->second.GetSalary());
+			if (m_directory) {
+				m_directory->Insert(*this, it->first, it->second);
+			}
+			m_revision.Update();
 		}
 		return it;
 	}
 
+	vector<Employee> Department::InsertEmployees(vector<Employee>&& employees) {
+		bool inserted{ false };
+		auto duplicates{
+			m_workgroup.merge(														//Дубликаты среди существующих и вставленных в этом пакете
+				move(employees),
+				[this, &inserted](const FullNameRef& full_name, Employee& employee) {
+					recalc_summary_salary_after_recruitment(employee.GetSalary());
+					if (m_directory) {
+						m_directory->Insert(*this, full_name, employee);
+					}
+					inserted = true;
+				})
+		};
+		if (inserted) {
+			force_rebuild();														//Вместо регистрации каждого элемента - одна пересборка при Synchronize()
+			m_revision.Update();
+		}
+		return duplicates;
+	}
+
 	Department::employee_it Department::EraseEmployee(employee_it employee) {
 		if (employee == m_workgroup.end()) {
 			throw_non_existent_key("Employee");
 		}
 		register_erase(employee->second.GetFullName(), employee == prev(m_workgroup.end()));
 		recalc_summary_salary_before_dismissal(employee->second.GetSalary());
+		if (m_directory) {
+			m_directory->Erase(*this, employee->first);
+		}
+		m_revision.Update();
 		return m_workgroup.erase(employee);
 	}
 
@@ -498,8 +820,12 @@ namespace wrapper {
 			== prev(m_workgroup.end())
 		);
 		recalc_summary_salary_before_dismissal(employee->second.GetSalary());
+		if (m_directory) {
+			m_directory->Erase(*this, employee->first);
+		}
 		Employee extracted_employee{ MoveFrom<Employee>(employee->second) };	
 		m_workgroup.erase(employee);
+		m_revision.Update();
 		return extracted_employee;
 	}
 
@@ -508,8 +834,11 @@ namespace wrapper {
 	}
 
 	Department& Department::SetWorkgroup(workgroup_t new_workgroup) {
+		unregister_staff();
 		m_workgroup = move(new_workgroup);
+		register_staff();
 		force_rebuild();
+		m_revision.Update();
 		return *this;
 	}
 
@@ -521,24 +850,218 @@ namespace wrapper {
 		return { m_workgroup.begin(), m_workgroup.end() };
 	}
 
+	EmployeeDirectory& EmployeeDirectory::Attach(Department& department) {
+		department.m_directory = this;
+		department.register_staff();
+		return *this;
+	}
+
+	EmployeeDirectory& EmployeeDirectory::Detach(Department& department) noexcept {
+		if (department.m_directory == this) {
+			department.unregister_staff();
+			department.m_directory = nullptr;
+		}
+		return *this;
+	}
+
+	EmployeeDirectory& EmployeeDirectory::Clear() noexcept {
+		m_locations.clear();
+		return *this;
+	}
+
+	EmployeeDirectory& EmployeeDirectory::Reserve(size_t employee_count) {
+		m_locations.reserve(employee_count);
+		return *this;
+	}
+
+	EmployeeDirectory& EmployeeDirectory::Insert(const Department& department, const FullNameRef& name, const Employee& employee) {
+		m_locations.emplace(name, EmployeeLocation{ addressof(department), addressof(employee) });
+		return *this;
+	}
+
+	EmployeeDirectory& EmployeeDirectory::Erase(const Department& department, const FullNameRef& name) noexcept {
+		auto [first, last] { m_locations.equal_range(name) };
+		for (; first != last; ++first) {														//Тёзки из разных подразделений
+			if (first->second.department == addressof(department)) {
+				m_locations.erase(first);
+				break;
+			}
+		}
+		return *this;
+	}
+
+	EmployeeDirectory::location_range EmployeeDirectory::Find(const FullNameRef& name) const {
+		auto [first, last] { m_locations.equal_range(name) };
+		return { first, last };
+	}
+
+	const EmployeeLocation* EmployeeDirectory::Find(const FullNameRef& name, const Department& department) const {
+		for (const auto& [_, location] : Find(name)) {
+			if (location.department == addressof(department)) {
+				return addressof(location);
+			}
+		}
+		return nullptr;
+	}
+
+	size_t EmployeeDirectory::Size() const noexcept {
+		return m_locations.size();
+	}
+
+	Subdivision::iterator Subdivision::begin() noexcept {
+		return iterator(m_departments.begin());
+	}
+
+	Subdivision::iterator Subdivision::end() noexcept {
+		return iterator(m_departments.end());
+	}
+
+	Subdivision::const_iterator Subdivision::begin() const noexcept {
+		return const_iterator(m_departments.begin());
+	}
+
+	Subdivision::const_iterator Subdivision::end() const noexcept {
+		return const_iterator(m_departments.end());
+	}
+
+	size_t Subdivision::size() const noexcept {
+		return m_departments.size();
+	}
+
+	bool Subdivision::empty() const noexcept {
+		return m_departments.empty();
+	}
+
+	void Subdivision::clear() noexcept {
+		m_lookup.clear();
+		m_departments.clear();
+	}
+
+	void Subdivision::reserve(size_t count) {
+		m_departments.reserve(count);
+		m_lookup.reserve(count);
+	}
+
+	Department& Subdivision::operator[](size_t pos) noexcept {
+		return *m_departments[pos];
+	}
+
+	const Department& Subdivision::operator[](size_t pos) const noexcept {
+		return *m_departments[pos];
+	}
+
+	size_t Subdivision::position(const_iterator it) const noexcept {
+		return static_cast<size_t>(it - begin());
+	}
+
+	Subdivision::iterator Subdivision::find(const string& name) {
+		auto it{ m_lookup.find(name) };
+		return it == m_lookup.end() ? end() : begin() + it->second;
+	}
+
+	Subdivision::const_iterator Subdivision::find(const string& name) const {
+		auto it{ m_lookup.find(name) };
+		return it == m_lookup.end() ? end() : begin() + it->second;
+	}
+
+	bool Subdivision::contains(const string& name) const {
+		return static_cast<bool>(m_lookup.count(name));
+	}
+
+	Subdivision::iterator Subdivision::insert(const_iterator before, Department&& department) {
+		size_t pos{ position(before) };
+		auto holder{ make_unique<Department>(move(department)) };
+		string name{ holder->GetName().get() };
+		m_departments.insert(m_departments.begin() + pos, move(holder));
+		if (pos + 1 != m_departments.size()) {
+			shift_positions(pos, 1);
+		}
+		m_lookup.emplace(move(name), pos);											//Дубликат не замещает первое подразделение
+		return begin() + pos;
+	}
+
+	void Subdivision::push_back(Department&& department) {
+		insert(end(), move(department));
+	}
+
+	Subdivision::iterator Subdivision::erase(const_iterator pos) {
+		size_t idx{ position(pos) };
+		extract(pos);
+		return begin() + idx;
+	}
+
+	unique_ptr<Department> Subdivision::extract(const_iterator pos) {
+		size_t idx{ position(pos) };
+		if (auto it = m_lookup.find(pos->GetName().get());
+			it != m_lookup.end() && it->second == idx) {
+			m_lookup.erase(it);
+		}
+		auto department{ move(m_departments[idx]) };
+		m_departments.erase(m_departments.begin() + idx);
+		if (idx != m_departments.size()) {
+			shift_positions(idx + 1, -1);
+		}
+		return department;
+	}
+
+	void Subdivision::rename(const_iterator pos, string new_name) {
+		size_t idx{ position(pos) };
+		auto& department{ *m_departments[idx] };
+		if (auto it = m_lookup.find(department.GetName().get());
+			it != m_lookup.end() && it->second == idx) {
+			m_lookup.erase(it);
+		}
+		department.SetName(move(new_name));
+		m_lookup.emplace(department.GetName().get(), idx);
+	}
+
+	size_t Subdivision::memory_usage() const noexcept {
+		static const size_t sso_capacity{ string{}.capacity() };
+		size_t usage{
+			m_departments.capacity() * sizeof(storage_t::value_type)
+			+ m_departments.size() * sizeof(Department)
+			+ m_lookup.size() * (sizeof(lookup_t::value_type) + sizeof(void*))
+			+ m_lookup.bucket_count() * sizeof(void*)
+		};
+		for (const auto& [name, _] : m_lookup) {
+			usage += name.capacity() > sso_capacity ? name.capacity() + 1 : 0;		//Длинные имена - в куче
+		}
+		return usage;
+	}
+
+	void Subdivision::shift_positions(size_t first, ptrdiff_t offset) noexcept {
+		for (auto& [_, pos] : m_lookup) {
+			if (pos >= first) {
+				pos = static_cast<size_t>(static_cast<ptrdiff_t>(pos) + offset);
+			}
+		}
+	}
+
 	Company::Company(Node* node_ptr)
 		: XmlContainerWrapper(node_ptr),
 		m_subdivision(collect_departaments(*node_ptr)),
-		m_subdivision_map(make_subdivision_map(m_subdivision))
+		m_directory(make_directory(m_subdivision))
 	{
 	}
 
 	Company::Company(node_holder ready_node)
 		: XmlContainerWrapper(move(ready_node)),
 		m_subdivision(collect_departaments(get_node())),
-		m_subdivision_map(make_subdivision_map(m_subdivision))
+		m_directory(make_directory(m_subdivision))
+	{
+	}
+
+	Company::Company(Node* node_ptr, subdivision_t subdivision)
+		: XmlContainerWrapper(node_ptr),
+		m_subdivision(move(subdivision)),
+		m_directory(make_directory(m_subdivision))
 	{
 	}
 
 	Company& Company::Reset() {
 		XmlWrapper::Reset();
-		m_subdivision_map.clear();
 		m_subdivision.clear();
+		m_directory.reset();
 		return *this;
 	}
 
@@ -548,25 +1071,26 @@ namespace wrapper {
 
 	Company& Company::update_dependencies() {
 		m_subdivision = collect_departaments(get_node());
-		m_subdivision_map = make_subdivision_map(m_subdivision);
+		m_directory = make_directory(m_subdivision);
 		return *this;
 	}
 
 	Company& Company::take_dependencies(XmlWrapper& other) {
-		auto& other_company{ static_cast<Company&>(other) };							//, ..       OwnFrom()
+		auto& other_company{ static_cast<Company&>(other) };							//Допустимо, т.к. в случае несовпадения типов исключение выбросит OwnFrom()
 			
 		m_subdivision = move(other_company.m_subdivision);
-		m_subdivision_map = move(other_company.m_subdivision_map);
+		m_directory = move(other_company.m_directory);								//Подразделения ссылаются на индекс по указателю
 		return *this;
 	}
 
 	Company& Company::Synchronize() {
-		synchronize_helper<Department>(														//  
+		tracing::Span span("wrapper/Company::Synchronize", "wrapper");
+		synchronize_helper<Department>(														//Тип элементов диапазона
 			addressof(get_node().AsContainer()),
 			m_subdivision.begin(),
 			m_subdivision.end(),
 			m_subdivision.size(),
-			[](Department& department) -> Department& {										//-
+			[](Department& department) -> Department& {										//Экстрактор-заглушка
 			return department;
 		}
 		);
@@ -576,21 +1100,36 @@ namespace wrapper {
 	Company::subdivision_t Company::collect_departaments(Node& node) {
 		throw_if_another_node_type(node, Node::Type::Tree);
 
+		tracing::Span span("wrapper/Company::collect_departaments", "wrapper");
 		auto& raw_subdivision{ node.AsContainer() };
+		span.SetCount(static_cast<int64_t>(raw_subdivision.size()));
 		subdivision_t subdivision;
-	
+		subdivision.reserve(raw_subdivision.size());
 		for (auto& departament_holder : raw_subdivision) {
 			subdivision.push_back(Department(departament_holder.get()));
 		}
 		return subdivision;
 	}
 
-	Company::subdivision_map_t Company::make_subdivision_map(subdivision_t& list) {
-		subdivision_map_t subdivision_map;
-		for (auto it = list.begin(); it != list.end(); ++it) {
-			insert_to_subdivision_map(addressof(subdivision_map), it);
+	unique_ptr<EmployeeDirectory> Company::make_directory(subdivision_t& subdivision) {
+		tracing::Span span("wrapper/Company::make_directory", "wrapper");
+		auto directory{ make_unique<EmployeeDirectory>() };
+		size_t employee_count{ 0 };
+		for (const auto& department : subdivision) {
+			employee_count += department.EmployeeCount();
+		}
+		directory->Reserve(employee_count + employee_count / 4);						//Запас под вставки после загрузки: без перехеширования всего индекса
+		for (auto& department : subdivision) {
+			directory->Attach(department);
 		}
-		return subdivision_map;
+		return directory;
+	}
+
+	EmployeeDirectory& Company::get_directory() {
+		if (!m_directory) {
+			m_directory = make_unique<EmployeeDirectory>();
+		}
+		return *m_directory;
 	}
 
 	void Company::throw_non_existent_department(const string& name) {
@@ -598,19 +1137,16 @@ namespace wrapper {
 	}
 
 	RenameResult Company::RenameDepartment(const string& department, string new_name) {
-		if (m_subdivision_map.count(new_name)) {								//    - .    
+		if (m_subdivision.contains(new_name)) {								//Операции извлечения и вставки - долгие. Эффективнее предварительно сравнить строки
 			return department == new_name ?
 				RenameResult::NothingChanged : RenameResult::IsDuplicate;
 		}	
-		if (!m_subdivision_map.count(department)) {
+		auto it{ m_subdivision.find(department) };
+		if (it == m_subdivision.end()) {
 			throw_non_existent_department(department);
 		}
 		register_rename(department, new_name);								
-
-		auto node{ m_subdivision_map.extract(department) };
-		node.mapped()->SetName(move(new_name));
-		node.key() = node.mapped()->GetName().get();
-		m_subdivision_map.insert(move(node));
+		m_subdivision.rename(it, move(new_name));
 		return RenameResult::Success;
 	}
 
@@ -618,8 +1154,46 @@ namespace wrapper {
 		return m_subdivision.size();
 	}
 
+	Department& Company::GetDepartment(size_t pos) {
+		if (pos >= m_subdivision.size()) {
+			throw_non_existent_key("Department");
+		}
+		return m_subdivision[pos];
+	}
+
+	const Department& Company::GetDepartment(size_t pos) const {
+		if (pos >= m_subdivision.size()) {
+			throw_non_existent_key("Department");
+		}
+		return m_subdivision[pos];
+	}
+
+	optional<size_t> Company::GetDepartmentPosition(const string& name) const noexcept {
+		auto it{ m_subdivision.find(name) };
+		if (it == m_subdivision.end()) {
+			return nullopt;
+		}
+		return m_subdivision.position(it);
+	}
+
 	bool Company::Containts(const std::string& name) const noexcept {
-		return static_cast<bool>(m_subdivision_map.count(name));
+		return m_subdivision.contains(name);
+	}
+
+	EmployeeDirectory::location_range Company::FindEmployees(const FullNameRef& name) const {
+		if (!m_directory) {
+			return { EmployeeDirectory::location_it{}, EmployeeDirectory::location_it{} };
+		}
+		return m_directory->Find(name);
+	}
+
+	const EmployeeLocation* Company::FindEmployee(const FullNameRef& name, const Department& department) const {
+		return m_directory ? m_directory->Find(name, department) : nullptr;
+	}
+
+	bool Company::ContainsEmployee(const FullNameRef& name) const {
+		auto employees{ FindEmployees(name) };
+		return employees.begin() != employees.end();
 	}
 
 	Company::department_range Company::GetDepartments() noexcept {
@@ -631,85 +1205,78 @@ namespace wrapper {
 		return { m_subdivision.begin(), m_subdivision.end() };
 	}
 
-	void Company::insert_to_subdivision_map(subdivision_map_t* map, department_it it) {
-		map->emplace(it->GetName().get(), it);
-	}
-
 	Company::department_it Company::erase_from_subdivision(department_it department) {
+		get_directory().Detach(*department);
 		return m_subdivision.erase(department);
 	}
 
 	Department Company::extract_from_subdivision(department_it department) {
+		get_directory().Detach(*department);									//Извлечённое подразделение индекс не поддерживает
 		register_erase(
 			department->GetName().get(), department == prev(m_subdivision.end())
 		);
-		Department extracted_department{ MoveFrom<Department>(*department) };
-		m_subdivision.erase(department);
-		return extracted_department;
+		auto extracted{ m_subdivision.extract(department) };
+		return MoveFrom<Department>(*extracted);
 	}
 
 	Company::department_it Company::AddDepartment(Department&& new_department) {
-		if (auto already_exists_it = m_subdivision_map.find(new_department.GetName().get());
-			already_exists_it != m_subdivision_map.end()) {
-			return already_exists_it->second;
+		if (auto already_exists_it = m_subdivision.find(new_department.GetName().get());
+			already_exists_it != m_subdivision.end()) {
+			return already_exists_it;
 		}
-		auto it{ m_subdivision.insert(m_subdivision.end(), move(new_department)) };
-		register_insert(it->GetName().get(), it == prev(m_subdivision.end()));
-		insert_to_subdivision_map(addressof(m_subdivision_map), it);
-		return it;
+		return InsertDepartment(m_subdivision.end(), move(new_department));
 	}
 
 	Company::department_it Company::InsertDepartment(const std::string& before, Department&& new_department) {
-		if (auto already_exists_it = m_subdivision_map.find(new_department.GetName().get());
-			already_exists_it != m_subdivision_map.end()) {
-			return already_exists_it->second;
+		if (auto already_exists_it = m_subdivision.find(new_department.GetName().get());
+			already_exists_it != m_subdivision.end()) {
+			return already_exists_it;
 		}
-		auto before_it{ m_subdivision_map.find(before) };
-		if (before_it == m_subdivision_map.end()) {
+		auto before_it{ m_subdivision.find(before) };
+		if (before_it == m_subdivision.end()) {
 			throw_non_existent_department(before);
 		}
-		return InsertDepartment(before_it->second, move(new_department));
+		return InsertDepartment(before_it, move(new_department));
 	}
 
 	Company::department_it Company::InsertDepartment(department_it before, Department&& new_department) {
 		auto it{ m_subdivision.insert(before, move(new_department)) };
 		register_insert(it->GetName().get(), it == prev(m_subdivision.end()));
-		insert_to_subdivision_map(addressof(m_subdivision_map), it);
+		get_directory().Attach(*it);
 		return it;
 	}
 
 	const Department* Company::TryGetNext(const string& department) const noexcept {
-		auto it { m_subdivision_map.find(department)};
-		if (it == m_subdivision_map.end()) {
+		auto pos{ GetDepartmentPosition(department) };
+		if (!pos || *pos + 1 >= m_subdivision.size()) {
 			return nullptr;
 		}
-		return TryGetNext(it->second);
+		return addressof(m_subdivision[*pos + 1]);							//Соседнее подразделение - по индексу, без обхода списка
 	}
 
 	const Department* Company::TryGetNext(department_it department) const noexcept {
-		if (department == m_subdivision.end()
-			|| department == prev(m_subdivision.end())) {
+		department_view_it it{ department };
+		if (it == m_subdivision.end()
+			|| it == prev(m_subdivision.end())) {
 			return nullptr;
 		}
-		return addressof(*next(department));
+		return addressof(*next(it));
 	}
 
 	Company::department_it Company::EraseDepartment(department_it department) {
 		if (department == m_subdivision.end()) {
 			throw_non_existent_key("Department");
 		}
-		m_subdivision_map.erase(department->GetName().get());
 		register_erase(department->GetName().get(), department == prev(m_subdivision.end()));
 		return erase_from_subdivision(department);
 	}
 
 	bool Company::EraseDepartment(const string& name) {
-		auto it{ m_subdivision_map.find(name) };
-		if (it == m_subdivision_map.end()) {
+		auto it{ m_subdivision.find(name) };
+		if (it == m_subdivision.end()) {
 			return false;
 		}
-		erase_from_subdivision(it->second);
-		m_subdivision_map.erase(it);
+		EraseDepartment(it);
 		return true;
 	}
 
@@ -717,56 +1284,54 @@ namespace wrapper {
 		if (department == m_subdivision.end()) {
 			throw_non_existent_key("Department");
 		}
-		m_subdivision_map.erase(department->GetName().get());
 		return extract_from_subdivision(department);
 	}
 
 	Department Company::ExtractDepartment(const string& name) {
-		auto it{ m_subdivision_map.find(name) };
-		if (it == m_subdivision_map.end()) {
+		auto it{ m_subdivision.find(name) };
+		if (it == m_subdivision.end()) {
 			throw_non_existent_department(name);
 		}
-		auto dep_it{ it->second };
-		m_subdivision_map.erase(it);
-		return extract_from_subdivision(dep_it);
+		return extract_from_subdivision(it);
 	}
 
 	Company& Company::SetSubdivision(subdivision_t new_subdivision) {
 		m_subdivision = move(new_subdivision);
-		m_subdivision_map = make_subdivision_map(m_subdivision);
+		m_directory = make_directory(m_subdivision);
 		force_rebuild();
 		return *this;
 	}
 
 	Company& Company::ClearSubdivision() noexcept {
 		m_subdivision.clear();
-		m_subdivision_map.clear();
+		if (m_directory) {
+			m_directory->Clear();
+		}
 		force_rebuild();
 		return *this;
 	}
 
 	Department& Company::at(const string& name) {
-		return *m_subdivision_map.at(name);
+		return *Find(name);
 	}
 
 	const Department& Company::at(const string& name) const {
-		return *m_subdivision_map.at(name);
+		return *Find(name);
 	}
 
 	Company::department_it Company::Find(const string& name) {
-		auto department{ m_subdivision_map.find(name) };
-		if (department == m_subdivision_map.end()) {
+		auto department{ m_subdivision.find(name) };
+		if (department == m_subdivision.end()) {
 			throw_non_existent_key("Department");
 		}
-		return department->second;
+		return department;
 	}
 
 	Company::department_view_it Company::Find(const string& name) const {
-		auto department{ m_subdivision_map.find(name) };
-		if (department == m_subdivision_map.end()) {
+		auto department{ m_subdivision.find(name) };
+		if (department == m_subdivision.end()) {
 			throw_non_existent_key("Department");
 		}
-		return department->second;
+		return department;
 	}
 }
-
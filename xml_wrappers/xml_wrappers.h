@@ -3,10 +3,15 @@
 #include "xml_node_builders.h"
 
 #include <variant>
+#include <optional>
 #include <stdexcept>
 #include <string_view>
-#include <map>
-#include <list>
+#include <array>
+#include <vector>
+#include <memory>
+#include <iterator>
+#include <cstdint>
+#include <atomic>
 #include <unordered_map>	
 #include <unordered_set>
 #include <algorithm>
@@ -34,25 +39,26 @@ namespace wrapper {
 		};
 	public:
 		XmlWrapper() = default;
-		XmlWrapper(xml::Node* node_ptr);								//   
+		XmlWrapper(xml::Node* node_ptr);								//Инициализация в режиме наблюдения
 		XmlWrapper(XmlWrapper&& other) noexcept;
 		XmlWrapper& operator=(XmlWrapper&& other) noexcept;
 		virtual ~XmlWrapper() = default;
 
 		Mode CurrentMode() const noexcept;
-		bool IsObserver() const noexcept;								//true,  CurrentMode() == VIEW
+		bool IsObserver() const noexcept;								//true, если CurrentMode() == VIEW
 
-		virtual XmlWrapper& OwnFrom(XmlWrapper& source);				// ,      source     
-		XmlWrapper& CopyFrom(const XmlWrapper& source);					//   ,    source
+		virtual XmlWrapper& OwnFrom(XmlWrapper& source);				//Создает узел, перемещает в него данные из source и переключается в режим владения
+		XmlWrapper& CopyFrom(const XmlWrapper& source);					//Копирует содержимое из узла, на который ссылается source
 
-		virtual XmlWrapper& Synchronize() = 0;							//      . 
-		virtual XmlWrapper& Reset() = 0;								//    
+		virtual XmlWrapper& Synchronize() = 0;							//Синхронизирует дочерние элементы без перемещения владеющего узла. 
+		virtual XmlWrapper& Reset() = 0;								//Сбрасывает указатель на узел 
 		virtual xml::node_holder BuildXmlTree();
-		static xml::node_holder BuildXmlTree(XmlWrapper& wrapper);		//       
+		static xml::node_holder BuildXmlTree(XmlWrapper& wrapper);		//Возвращает владеющий узел и переключается в режим наблюдения
 
-		xml::allocator_holder GetAllocator() const noexcept;			//     
+		xml::allocator_holder GetAllocator() const noexcept;			//Позволяет получить аллокато из прикрепленного узла
+		virtual size_t MemoryUsage() const noexcept;					//Приблизительный объём памяти (в байтах), занятой узлом и служебными данными
 	protected:
-		template <class WrapperTy>										//     XmlWrapper 
+		template <class WrapperTy>										//Создает новый другого типа из XmlWrapper 
 		static WrapperTy MoveFrom(WrapperTy& source) {
 			WrapperTy wrapper;
 			wrapper.OwnFrom(source);
@@ -63,29 +69,29 @@ namespace wrapper {
 		static void throw_if_different_wrapper_types(Type left, Type right);
 		static void throw_non_existent_key(std::string key);
 
-		virtual Type get_type() const noexcept = 0;							//   
-		virtual XmlWrapper& update_dependencies() = 0;						//     OwnFrom()
-		virtual XmlWrapper& take_dependencies(XmlWrapper& other) = 0;		//     
+		virtual Type get_type() const noexcept = 0;							//Запрашивает тип текущего объекта
+		virtual XmlWrapper& update_dependencies() = 0;						//Обновляют служебные данные после вызова OwnFrom()
+		virtual XmlWrapper& take_dependencies(XmlWrapper& other) = 0;		//Передает служебные данные в другой объект
 
 		xml::Node& get_node();
 		const xml::Node& get_node() const;
 	protected:
 		std::variant<
-			xml::Node*,														// 
-			xml::node_holder												// 
+			xml::Node*,														//Режим наблюдения
+			xml::node_holder												//Режим владения
 		> m_node{ nullptr };
 	protected:
 		XmlWrapper(xml::node_holder ready_node);
 	};
 	
 	/***********************************************************************************************************************
-	 string_view ,        const char*, 
-	   string_view,   .     FullName   
-	  ,   StringRef, ..       
-	     XML-.
-	(   -   Employee-node, 
-	  -     Department-node).
-	  ++17,  ,  string_ref - TriviallyCopyable
+	Использовать string_view небезопасно, поскольку при установке нового значения поля строка const char*, 
+	на которую ссылается string_view, будет безвозвратно утеряна. Чтобы не вынуждать хранящие FullName внешние объекты 
+	делать полную копию, целесообразно применить StringRef, т.к. сами объекты строк не будут инвалидированы до
+	конца срока жизни хранящих их XML-узлов.
+	(Поля данных работника - дочерние узлы Employee-node, 
+	имя компании - элемент перемещаемого контейнера внутри Department-node).
+	Начиная с С++17, Стандартом гарантируется, что string_ref - TriviallyCopyable
 	************************************************************************************************************************/
 
 	using string_ref = std::reference_wrapper<const std::string>;
@@ -107,39 +113,210 @@ namespace wrapper {
 	class Employee : public XmlWrapper {
 	public:
 		using salary_t = size_t;
-		using properties_view_t = std::unordered_map<std::string_view, std::string*>;
+		enum class Field : uint8_t {										//Поля данных работника - дочерние узлы Employee-node
+			Surname,
+			Name,
+			MiddleName,
+			Function,
+			Salary
+		};
+		static constexpr size_t FIELD_COUNT{ 5 };
+		using fields_view_t = std::array<const std::string*, FIELD_COUNT>;	//Индексируется Field; nullptr - поля нет в узле. Запись - через узел поля
 	public:
 		Employee() = default;
 		Employee(xml::Node*);
 
-		Employee& Synchronize() override;									//-:      
+		Employee& Synchronize() override;									//Метод-заглушка: синхронизация выполняется непосредственно при внесении изменений
 		Employee& Reset() override;
+		size_t MemoryUsage() const noexcept override;
 
-		FullNameRef GetFullName() const;									//
+		FullNameRef GetFullName() const;									//ФИО
 		string_ref GetSurname() const;
 		string_ref GetName() const;
 		string_ref GetMiddleName() const;
 		string_ref GetFunction() const;
 		size_t GetSalary() const;
 																											
-		Employee& SetSurname(std::string new_surname);						//..        , 
-		Employee& SetName(std::string new_name);							//      !	
-		Employee& SetMiddleName(std::string new_middle_name);				//(   )		
+		Employee& SetSurname(std::string new_surname);						//Т.к. смена полей ФИО требует смены позиции в подразделении, 
+		Employee& SetName(std::string new_name);							//она должна выполняться только через интерфейс последнего!	
+		Employee& SetMiddleName(std::string new_middle_name);				//(если работник не извлечён)		
 		Employee& SetFunction(std::string new_function);											
-		Employee& SetSalary(size_t new_salary);				//     /     
+		Employee& SetSalary(size_t new_salary);				//Для корректного сбора статистики смена З/П должна производиться через интерфейс подразделения
 
+		static std::string_view GetFieldName(Field field) noexcept;			//Имя XML-узла поля
+		static bool IsShareable(Field field) noexcept;						//Значение может храниться в пуле документа (см. xml::StringPool)
 	protected:
 		friend class EmployeeBuilder;
+		friend class SchemaReader;
 		Employee(xml::node_holder ready_node);
+		Employee(xml::Node* node_ptr, const fields_view_t& fields) noexcept;	//Поля уже сопоставлены при разборе
 
 		Type get_type() const noexcept override;
 		Employee& update_dependencies() override;
 		Employee& take_dependencies(XmlWrapper& other) override;
 
-		static properties_view_t collect_properties(xml::Node&);
+		static fields_view_t collect_fields(xml::Node&);					//Поля сопоставляются по атомам имён однократно, далее - доступ по индексу
+		const std::string& get_field(Field field) const;
+		void set_field(Field field, std::string value);						//Разделяемое значение заменяется другим значением пула
+
+		static constexpr std::array<std::string_view, FIELD_COUNT> field_names{	//В порядке Field; адрес - ключ словаря в AtomTable
+			"surname", "name", "middleName", "function", "salary"
+		};
 
 	protected:
-		properties_view_t m_properties;
+		fields_view_t m_fields{};
+	};
+
+	/***********************************************************************************************************************
+	Workgroup - "плоский" упорядоченный по ФИО контейнер сотрудников подразделения. Ключи хранятся в непрерывном
+	отсортированном массиве вместе с 8-байтовым префиксом фамилии, упорядоченным так же, как сами строки: поиск -
+	бинарный по массиву, и большинство сравнений завершается на префиксе без обращения к строкам XML-узлов.
+	Обёртки Employee размещаются отдельно и при вставке и удалении соседей не перемещаются (на них ссылаются
+	модель дерева, индексы и команды), однако итераторы инвалидируются при любой вставке и удалении.
+	Интерфейс повторяет используемое подмножество std::map, разыменование итератора возвращает пару ссылок
+	(first - ФИО, second - сотрудник)
+	************************************************************************************************************************/
+
+	class Workgroup {
+	private:
+		struct Slot {
+			uint64_t prefix;														//Первые 8 байт фамилии (big-endian)
+			FullNameRef name;
+			std::unique_ptr<Employee> employee;
+		};
+		using slot_storage_t = std::vector<Slot>;
+	public:
+		template <bool IsConst>
+		class Iterator {
+		public:
+			using employee_t = std::conditional_t<IsConst, const Employee, Employee>;
+			using slot_it = std::conditional_t<IsConst, slot_storage_t::const_iterator, slot_storage_t::iterator>;
+
+			using iterator_category = std::random_access_iterator_tag;
+			using reference = std::pair<const FullNameRef&, employee_t&>;
+			using value_type = reference;
+			using difference_type = std::ptrdiff_t;
+			struct pointer {														//Для it->first и it->second
+				reference ref;
+				const reference* operator->() const noexcept {
+					return std::addressof(ref);
+				}
+			};
+		public:
+			Iterator() = default;
+			Iterator(slot_it it) noexcept
+				: m_it(it)
+			{
+			}
+			template <bool OtherConst, std::enable_if_t<IsConst && !OtherConst, int> = 0>
+			Iterator(const Iterator<OtherConst>& other) noexcept					//iterator -> const_iterator
+				: m_it(other.m_it)
+			{
+			}
+
+			reference operator*() const noexcept {
+				return { m_it->name, *m_it->employee };
+			}
+			pointer operator->() const noexcept {
+				return { **this };
+			}
+			reference operator[](difference_type offset) const noexcept {
+				return *(*this + offset);
+			}
+
+			Iterator& operator++() noexcept { ++m_it; return *this; }
+			Iterator operator++(int) noexcept { return Iterator(m_it++); }
+			Iterator& operator--() noexcept { --m_it; return *this; }
+			Iterator operator--(int) noexcept { return Iterator(m_it--); }
+			Iterator& operator+=(difference_type offset) noexcept { m_it += offset; return *this; }
+			Iterator& operator-=(difference_type offset) noexcept { m_it -= offset; return *this; }
+			Iterator operator+(difference_type offset) const noexcept { return Iterator(m_it + offset); }
+			Iterator operator-(difference_type offset) const noexcept { return Iterator(m_it - offset); }
+			difference_type operator-(const Iterator& other) const noexcept { return m_it - other.m_it; }
+
+			bool operator==(const Iterator& other) const noexcept { return m_it == other.m_it; }
+			bool operator!=(const Iterator& other) const noexcept { return m_it != other.m_it; }
+			bool operator<(const Iterator& other) const noexcept { return m_it < other.m_it; }
+			bool operator>(const Iterator& other) const noexcept { return m_it > other.m_it; }
+			bool operator<=(const Iterator& other) const noexcept { return m_it <= other.m_it; }
+			bool operator>=(const Iterator& other) const noexcept { return m_it >= other.m_it; }
+		private:
+			template <bool>
+			friend class Iterator;
+			friend class Workgroup;
+			slot_it m_it{};
+		};
+
+		using key_type = FullNameRef;
+		using mapped_type = Employee;
+		using iterator = Iterator<false>;
+		using const_iterator = Iterator<true>;
+		using value_type = iterator::value_type;
+	public:
+		iterator begin() noexcept;
+		iterator end() noexcept;
+		const_iterator begin() const noexcept;
+		const_iterator end() const noexcept;
+
+		size_t size() const noexcept;
+		bool empty() const noexcept;
+		void clear() noexcept;
+		void reserve(size_t count);
+
+		iterator find(const FullNameRef& name);
+		const_iterator find(const FullNameRef& name) const;
+		iterator lower_bound(const FullNameRef& name);
+		const_iterator lower_bound(const FullNameRef& name) const;
+		size_t count(const FullNameRef& name) const;
+		Employee& at(const FullNameRef& name);
+		const Employee& at(const FullNameRef& name) const;
+
+		std::pair<iterator, bool> emplace(Employee&& employee);					//Ключ - ФИО сотрудника; дубликат не перемещается
+		iterator erase(iterator pos);
+		std::pair<iterator, bool> rekey(iterator pos);							//После смены ФИО сотрудника; second - изменилась ли позиция
+
+		template <class Visitor>												//Пакетная вставка: сортировка и однократное слияние. 
+		std::vector<Employee> merge(std::vector<Employee>&& employees, Visitor on_insert) {	//on_insert(name, employee) - для каждого вставленного
+			std::vector<Slot> incoming;											//Возвращает дубликаты
+			incoming.reserve(employees.size());
+			for (auto& employee : employees) {
+				incoming.push_back(make_slot(std::move(employee)));
+			}
+			employees.clear();
+			std::stable_sort(incoming.begin(), incoming.end(), &slot_less);		//Из одинаковых ФИО остаётся первое
+
+			std::vector<Employee> duplicates;
+			auto accepted_end{ incoming.begin() };
+			for (auto it = incoming.begin(); it != incoming.end(); ++it) {
+				if ((accepted_end != incoming.begin() && !slot_less(*std::prev(accepted_end), *it))
+					|| contains(*it)) {
+					duplicates.push_back(std::move(*it->employee));
+					continue;
+				}
+				on_insert(it->name, *it->employee);
+				if (accepted_end != it) {
+					*accepted_end = std::move(*it);
+				}
+				++accepted_end;
+			}
+			incoming.erase(accepted_end, incoming.end());
+			if (!incoming.empty()) {
+				size_t middle{ m_slots.size() };
+				m_slots.insert(m_slots.end(), std::make_move_iterator(incoming.begin()), std::make_move_iterator(incoming.end()));
+				std::inplace_merge(m_slots.begin(), m_slots.begin() + middle, m_slots.end(), &slot_less);
+			}
+			return duplicates;
+		}
+
+		size_t memory_usage() const noexcept;									//Без узлов XML
+	private:
+		static uint64_t make_prefix(const std::string& surname) noexcept;
+		static Slot make_slot(Employee&& employee);
+		static bool slot_less(const Slot& left, const Slot& right);
+		bool contains(const Slot& slot) const;
+		slot_storage_t::const_iterator lower_bound_slot(uint64_t prefix, const FullNameRef& name) const;
+	private:
+		slot_storage_t m_slots;
 	};
 
 	template <class CachedTy, class Hasher = std::hash<CachedTy>>					//CachedTy must be easy-copyable
@@ -158,7 +335,7 @@ namespace wrapper {
 			if (insert_back) {
 				if (m_state.erased_back_count > 0) {
 					--m_state.erased_back_count;
-					force_rebuild();											//        -  
+					force_rebuild();											//Во избежании ситуации с удалением и вставкой одинакового кол-ва разных элементов
 				}
 				else {
 					++m_state.inserted_back_count;
@@ -196,15 +373,15 @@ namespace wrapper {
 		}
 
 		bool contains(const CachedTy& value) {
-			return static_cast<bool>(m_inserted.count(value));						// C++20  unordered_set   contains()
+			return static_cast<bool>(m_inserted.count(value));						//До C++20 у unordered_set нет метода contains()
 		}
 
 		void force_rebuild() {
 			m_state.force_rebuild = true;
 		}
 
-		template <class WrapperTy, class InputIt, class Extractor>					//Extractor    , ..  
-		void synchronize_helper(													//WrapperTy -   ,    [first, last)
+		template <class WrapperTy, class InputIt, class Extractor>					//Extractor не должены быть тяжелым, т.к. будет скопирован
+		void synchronize_helper(													//WrapperTy - тип дочерних элементов, хранящихся в диапазоне [first, last)
 			xml::container_t* dst,
 			InputIt first,
 			InputIt last,
@@ -215,10 +392,10 @@ namespace wrapper {
 			if (m_state.force_rebuild) {
 				rebuild_tree<WrapperTy>(dst, first, last, range_length, extractor);
 			}
-			else {																			//      , 
-				sync_and_update_size<WrapperTy>(dst, first, last, range_length, extractor);	//     
-			}																				// dst->size() == range_length (     ),
-			reset_state();																	//    
+			else {																			//Текущий уровень дерева может быть не изменен, 
+				sync_and_update_size<WrapperTy>(dst, first, last, range_length, extractor);	//однако состояние более нижних уровней неизвестно
+			}																				//если dst->size() == range_length (нет вновь вставленных и удаленных узлов),
+			reset_state();																	//выполнится только синронизация ранее созданных
 		}
 		void reset_state() {
 			m_inserted.clear();
@@ -235,7 +412,7 @@ namespace wrapper {
 		) {
 			xml::container_t buffer;
 			collect_children<WrapperTy>(
-				std::addressof(buffer),										//     
+				std::addressof(buffer),										//Перестроенные ветви собираются в буферное хранилище
 				first, last, range_length,
 				extractor
 			);
@@ -250,17 +427,17 @@ namespace wrapper {
 			size_t range_length,
 			Extractor extractor
 		) {
-			dst->reserve(dst->size() + range_length);						// dst  ,   reserve(), ..    
+			dst->reserve(dst->size() + range_length);						//Если dst не пуст, нужно вызвать reserve(), т.к. элементы добавляются в конец
 			for (; first != last; ++first) {
 				auto& wrapper{ extractor(*first) };
-				if (wrapper.IsObserver()) {									//  - ,   
-					wrapper = MoveFrom<WrapperTy>(wrapper);					//     unique_ptr   
-				}															//        
+				if (wrapper.IsObserver()) {									//Если узел - наблюдатель, отобрать владение 
+					wrapper = MoveFrom<WrapperTy>(wrapper);					//у находящегося в таинственной неизвестности unique_ptr не представляется возможным
+				}															//Перемещаем сам узел и передаем его себе во владение
 				dst->push_back(extractor(*first).BuildXmlTree());			
 			}																											
 		}
 
-		template <class WrapperTy, class InputIt, class Extractor>				//    
+		template <class WrapperTy, class InputIt, class Extractor>				//Перестраиваются только вновь вставленные элементы
 		void sync_and_update_size(
 			xml::container_t* dst,
 			InputIt first,
@@ -268,7 +445,7 @@ namespace wrapper {
 			size_t range_length,
 			Extractor extractor
 		) {					
-			first = synchronize_range(first, std::min(dst->size(), range_length), extractor); // ,    XML-	
+			first = synchronize_range(first, std::min(dst->size(), range_length), extractor); //Синхронизация ветвей, не требующих сборки XML-поддерева	
 			if (range_length <= dst->size()) {
 				dst->resize(range_length);
 			}
@@ -276,7 +453,7 @@ namespace wrapper {
 				dst->reserve(range_length);
 				collect_children<WrapperTy>(
 					dst,												
-					first, last, range_length - dst->size(),								//first    dst.size() 		
+					first, last, range_length - dst->size(),								//first уже сдвинут на dst.size() позиций		
 					extractor	
 				);
 			}
@@ -285,7 +462,7 @@ namespace wrapper {
 		template <class InputIt, class Extractor>								
 		InputIt synchronize_range(															
 			InputIt range_begin,											
-			size_t range_length,													// last    -       
+			size_t range_length,													//Передавать last не имеет смысла - важны только начало диапазона и его длина
 			Extractor&& extractor											
 		) {
 			while(range_length--) {
@@ -299,22 +476,60 @@ namespace wrapper {
 	};
 
 
-	enum class RenameResult {														//      						
+	class EmployeeDirectory;
+
+	enum class RenameResult {														//Результат попытки сменить имя подразделения или сотруднкиа						
 		Success,
 		IsDuplicate,
 		NothingChanged
 	};
 
+	/***********************************************************************************************************************
+	Revision - отметка версии объекта: уникальна в пределах процесса, обновляется при каждом изменении объекта.
+	Копия и перемещённый объект получают новую отметку, поэтому по её значению можно кэшировать производные данные
+	(например, снимки подразделений), не опасаясь повторного использования адресов
+	************************************************************************************************************************/
+
+	class Revision {
+	public:
+		Revision() noexcept 
+			: m_value(next())
+		{
+		}
+		Revision(const Revision&) noexcept
+			: m_value(next())
+		{
+		}
+		Revision& operator=(const Revision&) noexcept {
+			Update();
+			return *this;
+		}
+
+		uint64_t Get() const noexcept {
+			return m_value;
+		}
+		void Update() noexcept {
+			m_value = next();
+		}
+	private:
+		static uint64_t next() noexcept {
+			static std::atomic<uint64_t> counter{ 0 };
+			return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+		}
+	private:
+		uint64_t m_value;
+	};
+
 	class Department : public XmlContainerWrapper<FullNameRef, FullNameHasher> {
 	public:
 		using salary_t = Employee::salary_t;
-		using workgroup_t = std::map<FullNameRef, Employee>;
-		using employee_it = workgroup_t::iterator;									//,        
-		using employee_view_it = workgroup_t::const_iterator;						// Employee   Department,   Extract.../Erase...
+		using workgroup_t = Workgroup;
+		using employee_it = workgroup_t::iterator;									//Итераторы инвалидируются при вставке и удалении сотрудников,
+		using employee_view_it = workgroup_t::const_iterator;						//адреса самих Employee - только при вызовах Extract.../Erase...
 		using employee_range = Range<employee_it>;
 		using employee_view_range = Range<employee_view_it>;
 	private:
-		enum class FullNameField {													//     
+		enum class FullNameField {													//Для внутренних механизмов смены имени работника
 			Surname,
 			Name,
 			MiddleName
@@ -322,20 +537,25 @@ namespace wrapper {
 	public:
 		Department() = default;
 		Department(xml::Node*);
+		Department(Department&& other);												//Место в индексе компании переходит вместе с сотрудниками
+		Department& operator=(Department&& other);
 
 		Department& Reset() override;
 		Department& Synchronize() override;
+		size_t MemoryUsage() const noexcept override;
 
 		string_ref GetName() const;
 		Department& SetName(std::string new_name) noexcept;
 		
-		RenameResult ChangeEmployeeSurname(const FullNameRef& old_name, std::string new_surname);			//..        m_workgroup, 
-		RenameResult ChangeEmployeeName(const FullNameRef& old_name, std::string new_name);				//      !
+		RenameResult ChangeEmployeeSurname(const FullNameRef& old_name, std::string new_surname);			//Т.к. смена полей ФИО требует смены позиции в m_workgroup, 
+		RenameResult ChangeEmployeeName(const FullNameRef& old_name, std::string new_name);				//оно должно выполняться только через интерфейс подразделения!
 		RenameResult ChangeEmployeeMiddleName(const FullNameRef& old_name, std::string new_middle_name);
 		
-		Department& UpdateEmployeeSalary(const FullNameRef& full_name, size_t new_salary);			//       
-		size_t EmployeeCount() const noexcept;														//  
+		Department& UpdateEmployeeSalary(const FullNameRef& full_name, size_t new_salary);			//Для сбора правильной статистики изменение зарплаты выполняется 
+		Department& ChangeEmployeeFunction(const FullNameRef& full_name, std::string new_function);	//через интерфейс подразделения (как и смена должности - для учёта ревизий)
+		size_t EmployeeCount() const noexcept;														
 		double AverageSalary() const noexcept;
+		uint64_t GetRevision() const noexcept;														//Меняется при любом изменении подразделения через его интерфейс
 
 		bool Containts(const FullNameRef& name) const noexcept;
 
@@ -348,7 +568,8 @@ namespace wrapper {
 		employee_range GetEmployees() noexcept;
 		employee_view_range GetEmployees() const noexcept;
 
-		employee_it InsertEmployee(Employee&& employee);				//XMLWrapper  
+		employee_it InsertEmployee(Employee&& employee);				//XMLWrapper не копируется
+		std::vector<Employee> InsertEmployees(std::vector<Employee>&& employees);	//Пакетная вставка с однократной пересборкой при синхронизации. Возвращает дубликаты
 
 		employee_it EraseEmployee(employee_it employee);
 		bool EraseEmployee(const FullNameRef& name);
@@ -358,35 +579,179 @@ namespace wrapper {
 		Department& SetWorkgroup(workgroup_t new_workgroup);
 	protected:
 		friend class DepartmentBuilder;
+		friend class EmployeeDirectory;
+		friend class SchemaReader;
 		Department(xml::node_holder ready_node);
+		Department(xml::Node* node_ptr, workgroup_t workgroup);						//Сотрудники уже собраны при разборе
 
 		Type get_type() const noexcept override;
 		Department& update_dependencies() override;
 		Department& take_dependencies(XmlWrapper& other) override;
 
-		RenameResult employee_rename_helper(const FullNameRef& old_name, std::string&& value, FullNameField field);	//     																			
+		RenameResult employee_rename_helper(const FullNameRef& old_name, std::string&& value, FullNameField field);	//Во избежание дублирования кода операции извлечения																			
+
+		void register_staff();														//Добавление сотрудников в индекс компании (при его наличии)
+		void unregister_staff() noexcept;
 
 		void recalc_summary_salary_after_recruitment(size_t new_employee_salary);
 		void recalc_summary_salary_before_dismissal(size_t former_employee_salary);
 
-		static xml::Node* try_get_staff(xml::Node&);								//    <employments>  <department>
+		static xml::Node* try_get_staff(xml::Node&);								//Получение указателя на узел <employments> внутри <department>
 		static workgroup_t collect_employees(xml::Node&);
 		static salary_t calc_summary_salary(const workgroup_t& workgroup);
 	protected:
 		workgroup_t m_workgroup;
-		salary_t m_summary_salary{ 0 };					//     ,      
+		salary_t m_summary_salary{ 0 };					//Лучше хранить суммарную и вычислять среднюю, чем хранить среднюю и накапливать погрешность
+		EmployeeDirectory* m_directory{ nullptr };		//Индекс компании, в которую входит подразделение
+		Revision m_revision;
+	};
+
+	/***********************************************************************************************************************
+	Индекс сотрудников всей компании по ФИО: поиск по всем подразделениям за O(1) вместо обхода m_subdivision
+	с поиском в каждом m_workgroup. Ключи ссылаются на ключи m_workgroup (т.е. на строки XML-узлов сотрудников),
+	поэтому запись удаляется до изменения полей ФИО и добавляется после. Подразделения, входящие в компанию,
+	поддерживают индекс самостоятельно; извлечённые из компании подразделения от индекса отвязываются
+	************************************************************************************************************************/
+
+	struct EmployeeLocation {
+		const Department* department;
+		const Employee* employee;
+	};
+
+	class EmployeeDirectory {
+	public:
+		using location_map_t = std::unordered_multimap<FullNameRef, EmployeeLocation, FullNameHasher>;
+		using location_it = location_map_t::const_iterator;
+		using location_range = Range<location_it>;
+	public:
+		EmployeeDirectory& Attach(Department& department);							//Подразделение начинает сообщать об изменениях в индекс
+		EmployeeDirectory& Detach(Department& department) noexcept;
+		EmployeeDirectory& Clear() noexcept;										//Подразделения должны быть отвязаны или уничтожены
+		EmployeeDirectory& Reserve(size_t employee_count);
+
+		EmployeeDirectory& Insert(const Department& department, const FullNameRef& name, const Employee& employee);	//name ссылается на строки employee
+		EmployeeDirectory& Erase(const Department& department, const FullNameRef& name) noexcept;
+
+		location_range Find(const FullNameRef& name) const;						//Во всех подразделениях
+		const EmployeeLocation* Find(const FullNameRef& name, const Department& department) const;
+		size_t Size() const noexcept;
+	private:
+		location_map_t m_locations;
+	};
+
+	/***********************************************************************************************************************
+	Subdivision - упорядоченный контейнер подразделений компании. Указатели на Department хранятся в непрерывном
+	массиве (позиция строки в модели дерева - индекс в нём), сами обёртки размещаются отдельно и не перемещаются
+	при вставке и удалении соседей. Таблица имён хранит позиции подразделений, поэтому поиск по имени возвращает
+	итератор за O(1); при вставке и удалении не в конец позиции в таблице пересчитываются.
+	Итераторы, как и у std::vector, инвалидируются при любой вставке и удалении.
+	Дубликаты имён (например, из файла) хранятся, но по имени доступно лишь первое из них
+	************************************************************************************************************************/
+
+	class Subdivision {
+	private:
+		using storage_t = std::vector<std::unique_ptr<Department>>;
+		using lookup_t = std::unordered_map<std::string, size_t>;					//Имя -> позиция; строки атрибутов узла перемещаются при добавлении атрибутов
+	public:
+		template <bool IsConst>
+		class Iterator {
+		public:
+			using department_t = std::conditional_t<IsConst, const Department, Department>;
+			using storage_it = std::conditional_t<IsConst, storage_t::const_iterator, storage_t::iterator>;
+
+			using iterator_category = std::random_access_iterator_tag;
+			using value_type = Department;
+			using reference = department_t&;
+			using pointer = department_t*;
+			using difference_type = std::ptrdiff_t;
+		public:
+			Iterator() = default;
+			Iterator(storage_it it) noexcept
+				: m_it(it)
+			{
+			}
+			template <bool OtherConst, std::enable_if_t<IsConst && !OtherConst, int> = 0>
+			Iterator(const Iterator<OtherConst>& other) noexcept					//iterator -> const_iterator
+				: m_it(other.m_it)
+			{
+			}
+
+			reference operator*() const noexcept {
+				return **m_it;
+			}
+			pointer operator->() const noexcept {
+				return m_it->get();
+			}
+			reference operator[](difference_type offset) const noexcept {
+				return *m_it[offset];
+			}
+
+			Iterator& operator++() noexcept { ++m_it; return *this; }
+			Iterator operator++(int) noexcept { return Iterator(m_it++); }
+			Iterator& operator--() noexcept { --m_it; return *this; }
+			Iterator operator--(int) noexcept { return Iterator(m_it--); }
+			Iterator& operator+=(difference_type offset) noexcept { m_it += offset; return *this; }
+			Iterator& operator-=(difference_type offset) noexcept { m_it -= offset; return *this; }
+			Iterator operator+(difference_type offset) const noexcept { return Iterator(m_it + offset); }
+			Iterator operator-(difference_type offset) const noexcept { return Iterator(m_it - offset); }
+			difference_type operator-(const Iterator& other) const noexcept { return m_it - other.m_it; }
+
+			bool operator==(const Iterator& other) const noexcept { return m_it == other.m_it; }
+			bool operator!=(const Iterator& other) const noexcept { return m_it != other.m_it; }
+			bool operator<(const Iterator& other) const noexcept { return m_it < other.m_it; }
+			bool operator>(const Iterator& other) const noexcept { return m_it > other.m_it; }
+			bool operator<=(const Iterator& other) const noexcept { return m_it <= other.m_it; }
+			bool operator>=(const Iterator& other) const noexcept { return m_it >= other.m_it; }
+		private:
+			template <bool>
+			friend class Iterator;
+			friend class Subdivision;
+			storage_it m_it{};
+		};
+
+		using value_type = Department;
+		using iterator = Iterator<false>;
+		using const_iterator = Iterator<true>;
+	public:
+		iterator begin() noexcept;
+		iterator end() noexcept;
+		const_iterator begin() const noexcept;
+		const_iterator end() const noexcept;
+
+		size_t size() const noexcept;
+		bool empty() const noexcept;
+		void clear() noexcept;
+		void reserve(size_t count);
+
+		Department& operator[](size_t pos) noexcept;
+		const Department& operator[](size_t pos) const noexcept;
+		size_t position(const_iterator it) const noexcept;
+
+		iterator find(const std::string& name);
+		const_iterator find(const std::string& name) const;
+		bool contains(const std::string& name) const;
+
+		iterator insert(const_iterator before, Department&& department);
+		void push_back(Department&& department);
+		iterator erase(const_iterator pos);
+		std::unique_ptr<Department> extract(const_iterator pos);				//Адрес извлечённого подразделения сохраняется
+		void rename(const_iterator pos, std::string new_name);					//Смена имени с обновлением таблицы
+
+		size_t memory_usage() const noexcept;									//Без узлов XML
+	private:
+		void shift_positions(size_t first, std::ptrdiff_t offset) noexcept;		//Сдвиг позиций >= first
+	private:
+		storage_t m_departments;
+		lookup_t m_lookup;
 	};
 
 	class Company : public XmlContainerWrapper<std::string_view> {
 	public: 
-		using subdivision_t = std::list<Department>;		
-		using department_view_it = subdivision_t::const_iterator;
-		using department_view_range = Range<department_view_it>;
+		using subdivision_t = Subdivision;		
+		using department_view_it = subdivision_t::const_iterator;				//Итераторы инвалидируются при вставке и удалении подразделений,
+		using department_view_range = Range<department_view_it>;				//адреса самих Department - только при вызовах Extract.../Erase...
 		using department_it = subdivision_t::iterator;
 		using department_range = Range<department_it>;
-	private:
-		using subdivision_map_t = std::unordered_map<std::string_view, department_it>;
-		using internal_department_it = subdivision_map_t::iterator;
 	public:
 		Company() = default;
 		Company(xml::Node*);
@@ -398,8 +763,16 @@ namespace wrapper {
 		department_range GetDepartments() noexcept;
 		size_t DepartmentCount() const noexcept;
 
+		Department& GetDepartment(size_t pos);									//По позиции (строке модели дерева)
+		const Department& GetDepartment(size_t pos) const;
+		std::optional<size_t> GetDepartmentPosition(const std::string& name) const noexcept;
+
 		bool Containts(const std::string& name) const noexcept;
 
+		EmployeeDirectory::location_range FindEmployees(const FullNameRef& name) const;			//Во всех подразделениях
+		const EmployeeLocation* FindEmployee(const FullNameRef& name, const Department& department) const;	//nullptr, если не найден
+		bool ContainsEmployee(const FullNameRef& name) const;
+
 		Department& at(const std::string& name);
 		const Department& at(const std::string& name) const;
 
@@ -425,23 +798,25 @@ namespace wrapper {
 		Company& ClearSubdivision() noexcept;
 	protected:
 		friend class CompanyBuilder;
+		friend class SchemaReader;
 		Company(xml::node_holder ready_node);
+		Company(xml::Node* node_ptr, subdivision_t subdivision);						//Подразделения уже собраны при разборе
 
 		Type get_type() const noexcept override;
 		Company& update_dependencies() override;
 		Company& take_dependencies(XmlWrapper& other) override;
 
-		department_it erase_from_subdivision(department_it department);			//  m_subdivision     m_subdivision_map
-		Department extract_from_subdivision(department_it department);			//  m_subdivision     m_subdivision_map
+		department_it erase_from_subdivision(department_it department);
+		Department extract_from_subdivision(department_it department);
 
-		static void insert_to_subdivision_map(subdivision_map_t* map, department_it it);
 		static subdivision_t collect_departaments(xml::Node&);
-		static subdivision_map_t make_subdivision_map(subdivision_t& list);
+		static std::unique_ptr<EmployeeDirectory> make_directory(subdivision_t& subdivision);
+		EmployeeDirectory& get_directory();												//Перемещённая компания индексом не владеет
 
 		static void throw_non_existent_department(const std::string& name);
 	protected:
 		subdivision_t m_subdivision;
-		subdivision_map_t m_subdivision_map;
+		std::unique_ptr<EmployeeDirectory> m_directory;								//Адрес стабилен при перемещении компании
 	};
 
 }
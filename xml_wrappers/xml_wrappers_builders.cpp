@@ -34,18 +34,27 @@ namespace wrapper {
 	}
 
 	Employee EmployeeBuilder::Assemble() {
-		xml::ElementNodeBuilder element_builder;
-		element_builder.SetAllocator(take_allocator());
-
+		xml::allocator_holder alloc{ take_allocator() };							//Assemble() забирает аллокатор у builder'а, 
+		xml::ElementNodeBuilder element_builder;									//поэтому он передаётся каждому узлу явно
+		auto make_field{
+			[&alloc, &element_builder](Employee::Field field, string text) {
+				return element_builder
+					.SetAllocator(alloc)
+					.SetName(string(Employee::GetFieldName(field)))
+					.SetText(move(text))
+					.Assemble();
+			}
+		};
+		using Field = Employee::Field;
 		return xml::DocumentNodeBuilder()
 			.SetName("employment")
-			.SetAllocator(take_allocator())
+			.SetAllocator(alloc)
 			.SetChildren(
-				element_builder.SetName("surname").SetText(move(m_personal_data.surname)).Assemble(),
-				element_builder.SetName("name").SetText(move(m_personal_data.name)).Assemble(),
-				element_builder.SetName("middleName").SetText(move(m_personal_data.middle_name)).Assemble(),
-				element_builder.SetName("function").SetText(move(m_personal_data.function)).Assemble(),
-				element_builder.SetName("salary").SetText(to_string(m_personal_data.salary)).Assemble()
+				make_field(Field::Surname, move(m_personal_data.surname)),
+				make_field(Field::Name, move(m_personal_data.name)),
+				make_field(Field::MiddleName, move(m_personal_data.middle_name)),
+				make_field(Field::Function, move(m_personal_data.function)),
+				make_field(Field::Salary, to_string(m_personal_data.salary))
 			)
 			.Assemble();
 	}
@@ -56,14 +65,12 @@ namespace wrapper {
 	}
 
 	DepartmentBuilder& DepartmentBuilder::InsertEmployee(Employee&& employee) {
-		m_workgroup.emplace(employee.GetFullName(), move(employee));
+		m_workgroup.emplace(move(employee));
 		return *this;
 	}
 
 	DepartmentBuilder& DepartmentBuilder::InsertEmployees(vector<Employee>&& employees) {
-		for (auto& employee : employees) {
-			m_workgroup.emplace(employee.GetFullName(), move(employee));
-		}
+		m_workgroup.merge(move(employees), [](const FullNameRef&, Employee&) {});	//Дубликаты отбрасываются
 		return *this;
 	}
 
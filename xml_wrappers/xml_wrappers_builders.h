@@ -12,6 +12,11 @@ namespace wrapper {
 		size_t salary{ 0 };
 	};
 
+	struct StaffList {												//Сотрудники одного подразделения для пакетной вставки
+		std::string department;
+		std::vector<Employee> employees;
+	};
+
 	class EmployeeBuilder : public xml::BuilderBase<EmployeeBuilder> {
 	public:
 		using MyBase = xml::BuilderBase<EmployeeBuilder>;
@@ -34,7 +39,7 @@ namespace wrapper {
 	public:
 		DepartmentBuilder& SetName(std::string name) noexcept;
 		DepartmentBuilder& InsertEmployee(Employee&& employee);
-		DepartmentBuilder& InsertEmployees(std::vector<Employee>&& employees);	//      
+		DepartmentBuilder& InsertEmployees(std::vector<Employee>&& employees);	//Вектор некопируемых объектов не может быть скопирован
 		DepartmentBuilder& Reset() noexcept;
 
 		Department Assemble();